@@ -0,0 +1,492 @@
+"""Benchmarks for pyint64 against Python int.
+
+Every number slot of Pyint64, construction, str/repr, hash, rich compare
+and the bulk APIs are timed next to the equivalent int or list code.  The
+harness only needs the standard library.  Construction is timed both
+through the vectorcall constructor (object.construct_*) and through the
+tp_new/tp_init path of a subclass (object.construct_new_*), the path every
+Pyint64(x) took before vectorcall.
+
+    python benchmarks/bench_pyint64.py run -o base.json
+    python benchmarks/bench_pyint64.py run -o new.json -k 'slot.*'
+    python benchmarks/bench_pyint64.py compare base.json new.json
+    python benchmarks/bench_pyint64.py list
+    python benchmarks/bench_pyint64.py codecs
+
+run prints a table with the Pyint64/int time ratio and writes the results
+as JSON.  compare matches two result files by benchmark name and exits
+with status 1 when any benchmark got slower than the threshold allows.
+codecs reports the compression ratio and decode throughput of the integer
+codecs on a few kinds of data.
+"""
+
+import argparse
+import collections
+import fnmatch
+import json
+import math
+import os
+import pickle
+import platform
+import random
+import statistics
+import sys
+import time
+import timeit
+
+import pyint64
+from pyint64 import Divisor, Int64Array, Int64Counter, Int64Dict, Int64Set, Pyint64
+
+FORMAT_VERSION = 1
+
+PYINT64 = 'Pyint64'
+INT = 'int'
+
+
+class Benchmark:
+    """One timed statement, run against both implementations.
+
+    stmt maps an implementation name to the statement to time, setup
+    builds its namespace from the implementation's value type and the bulk
+    size.
+    """
+
+    def __init__(self, name, stmt, setup):
+        self.name = name
+        self.stmt = stmt
+        self.setup = setup
+
+    def matches(self, patterns):
+        return not patterns or any(fnmatch.fnmatchcase(self.name, p) for p in patterns)
+
+
+class Pyint64Subclass(Pyint64):
+    """Constructed through tp_new and tp_init, vectorcall is not inherited."""
+
+
+class IntSubclass(int):
+    pass
+
+
+def scalar_setup(a=123456789, b=9876, c=3):
+    """Three operands per implementation, a > b > c > 0."""
+
+    def setup(impl, size):
+        kind = Pyint64 if impl == PYINT64 else int
+        return {
+            'a': kind(a), 'b': kind(b), 'c': kind(c),
+            'e': kind(1000000005), 'm': kind(1000000007),
+            'x': a, 'f': float(a), 's': str(a), 'raw': a.to_bytes(8, 'little'),
+            'T': kind, 'S': Pyint64Subclass if impl == PYINT64 else IntSubclass,
+        }
+
+    return setup
+
+
+def bulk_setup(low=-(1 << 62), high=(1 << 62)):
+    """Random values of the given range, as an Int64Array and as a list."""
+
+    def setup(impl, size):
+        rng = random.Random(size)
+        values = [rng.randint(low, high) for _ in range(size)]
+        namespace = {
+            'pyint64': pyint64, 'math': math, 'pickle': pickle,
+            'collections': collections, 'Divisor': Divisor,
+            'Int64Array': Int64Array, 'Int64Set': Int64Set,
+            'Int64Dict': Int64Dict, 'Int64Counter': Int64Counter,
+            'lst': values, 'text': ','.join(map(str, values)),
+        }
+
+        if impl == PYINT64:
+            arr = Int64Array(values)
+            buffers = []
+            namespace.update(
+                arr=arr, blob=pyint64.dumps(arr), d7=Divisor(7),
+                iset=Int64Set(arr), idict=Int64Dict(zip(values, values)),
+                scalars=[pyint64.Pyint64(x) for x in values],
+                pickled=pickle.dumps(arr, protocol=5, buffer_callback=buffers.append),
+                buffers=buffers,
+            )
+        else:
+            namespace.update(
+                blob=pickle.dumps(values), pset=set(values),
+                pdict=dict(zip(values, values)), scalars=values,
+                pickled=pickle.dumps(values, protocol=5), buffers=None,
+            )
+
+        return namespace
+
+    return setup
+
+
+def same(stmt):
+    return {PYINT64: stmt, INT: stmt}
+
+
+SLOTS = [
+    # pyint64_as_number, in slot order.
+    ('add', same('a + b')),
+    ('add_mixed', same('a + 1')),
+    ('subtract', same('a - b')),
+    ('multiply', same('a * b')),
+    ('remainder', same('a % b')),
+    ('divmod', same('divmod(a, b)')),
+    ('power', same('b ** c')),
+    ('power_mod', same('pow(a, e, m)')),
+    ('negative', same('-a')),
+    ('positive', same('+a')),
+    ('absolute', same('abs(a)')),
+    ('bool', same('not a')),
+    ('invert', same('~a')),
+    ('lshift', same('a << c')),
+    ('rshift', same('a >> c')),
+    ('and', same('a & b')),
+    ('xor', same('a ^ b')),
+    ('or', same('a | b')),
+    ('floor_divide', same('a // b')),
+    ('true_divide', same('a / b')),
+    ('int', same('int(a)')),
+    ('float', same('float(a)')),
+]
+
+OBJECT = [
+    # T(...) takes the vectorcall constructor, the subclass S(...) the
+    # generic tp_new and tp_init path Pyint64 used before it.
+    ('construct_int', same('T(x)')),
+    ('construct_float', same('T(f)')),
+    ('construct_str', same('T(s)')),
+    ('construct_self', same('T(a)')),
+    ('construct_new_int', same('S(x)')),
+    ('construct_new_float', same('S(f)')),
+    ('construct_new_str', same('S(s)')),
+    ('construct_new_self', same('S(a)')),
+    ('str', same('str(a)')),
+    ('repr', same('repr(a)')),
+    ('hash', same('hash(a)')),
+    ('eq', same('a == b')),
+    ('lt', same('a < b')),
+    ('lt_mixed', same('a < 5')),
+    ('bit_length', same('a.bit_length()')),
+    ('bit_count', same('a.bit_count()')),
+    ('to_bytes', same("a.to_bytes(8, 'little')")),
+    ('from_bytes', same("T.from_bytes(raw, 'little')")),
+]
+
+BULK = [
+    ('sum', {PYINT64: 'pyint64.sum(arr)', INT: 'sum(lst)'}, bulk_setup()),
+    ('prod', {PYINT64: 'pyint64.prod(arr)', INT: 'math.prod(lst)'}, bulk_setup(-1, 1)),
+    ('min', {PYINT64: 'pyint64.min(arr)', INT: 'min(lst)'}, bulk_setup()),
+    ('max', {PYINT64: 'pyint64.max(arr)', INT: 'max(lst)'}, bulk_setup()),
+    ('argmin', {PYINT64: 'pyint64.argmin(arr)',
+                INT: 'min(range(len(lst)), key=lst.__getitem__)'}, bulk_setup()),
+    ('add', {PYINT64: 'arr + arr', INT: '[x + y for x, y in zip(lst, lst)]'}, bulk_setup()),
+    ('multiply_scalar', {PYINT64: 'arr * 3', INT: '[x * 3 for x in lst]'}, bulk_setup(-1000, 1000)),
+    ('floor_divide', {PYINT64: 'arr // 7', INT: '[x // 7 for x in lst]'}, bulk_setup()),
+    ('floor_divide_divisor', {PYINT64: 'arr // d7', INT: '[x // 7 for x in lst]'}, bulk_setup()),
+    ('power_mod', {PYINT64: 'pow(arr, 1000000005, 1000000007)',
+                   INT: '[pow(x, 1000000005, 1000000007) for x in lst]'}, bulk_setup()),
+    ('bit_count', {PYINT64: 'pyint64.bit_count(arr)',
+                   INT: '[x.bit_count() for x in lst]'}, bulk_setup()),
+    ('hash', {PYINT64: 'pyint64.hash64(arr)', INT: '[hash(x) for x in lst]'}, bulk_setup()),
+    ('sort', {PYINT64: 'pyint64.sort(arr.copy())', INT: 'sorted(lst)'}, bulk_setup()),
+    ('argsort', {PYINT64: 'pyint64.argsort(arr)',
+                 INT: 'sorted(range(len(lst)), key=lst.__getitem__)'}, bulk_setup()),
+    ('tolist', {PYINT64: 'arr.tolist()', INT: 'list(lst)'}, bulk_setup()),
+    ('from_list', {PYINT64: 'Int64Array(lst)', INT: 'list(lst)'}, bulk_setup()),
+    ('parse', {PYINT64: "pyint64.parse(text, ',')",
+               INT: "list(map(int, text.split(',')))"}, bulk_setup()),
+    ('join', {PYINT64: "pyint64.join(arr, ',')", INT: "','.join(map(str, lst))"}, bulk_setup()),
+    ('dumps', {PYINT64: 'pyint64.dumps(arr)', INT: 'pickle.dumps(lst)'}, bulk_setup()),
+    ('loads', {PYINT64: 'pyint64.loads(blob)', INT: 'pickle.loads(blob)'}, bulk_setup()),
+    # Protocol 5: Int64Array hands its values out of band, the list of int
+    # pickles inline; scalars are a list of Pyint64 (or int) objects.
+    ('pickle_dumps', {PYINT64: 'pickle.dumps(arr, protocol=5, buffer_callback=[].append)',
+                      INT: 'pickle.dumps(lst, protocol=5)'}, bulk_setup()),
+    ('pickle_loads', same('pickle.loads(pickled, buffers=buffers)'), bulk_setup()),
+    ('pickle_dumps_scalars', same('pickle.dumps(scalars, protocol=5)'), bulk_setup()),
+    ('set_build', {PYINT64: 'Int64Set(arr)', INT: 'set(lst)'}, bulk_setup()),
+    ('set_contains', {PYINT64: 'iset.contains_many(arr)',
+                      INT: '[x in pset for x in lst]'}, bulk_setup()),
+    ('dict_build', {PYINT64: 'Int64Dict(zip(lst, lst))', INT: 'dict(zip(lst, lst))'},
+     bulk_setup()),
+    ('dict_get', {PYINT64: 'idict.get_many(arr)', INT: '[pdict.get(x) for x in lst]'},
+     bulk_setup()),
+    ('counter', {PYINT64: 'Int64Counter(arr)', INT: 'collections.Counter(lst)'},
+     bulk_setup(0, 1000)),
+]
+
+
+def benchmarks():
+    result = []
+    for name, stmt in SLOTS:
+        result.append(Benchmark('slot.' + name, stmt, scalar_setup()))
+    for name, stmt in OBJECT:
+        result.append(Benchmark('object.' + name, stmt, scalar_setup()))
+    for name, stmt, setup in BULK:
+        result.append(Benchmark('bulk.' + name, stmt, setup))
+    return result
+
+
+def time_stmt(stmt, namespace, repeat, min_time):
+    """Best and median time per execution in ns, and the loop count."""
+    timer = timeit.Timer(stmt, globals=namespace)
+
+    # Grow the loop count until one repeat takes min_time.
+    loops = 1
+    while True:
+        elapsed = timer.timeit(loops)
+        if elapsed >= min_time:
+            break
+        loops = max(loops * 2, int(loops * min_time / max(elapsed, 1e-9) * 1.1))
+
+    times = [elapsed] + timer.repeat(repeat - 1, loops) if repeat > 1 else [elapsed]
+    per_loop = [t / loops * 1e9 for t in times]
+    return min(per_loop), statistics.median(per_loop), loops
+
+
+def metadata(args):
+    return {
+        'python': sys.version,
+        'implementation': platform.python_implementation(),
+        'platform': platform.platform(),
+        'machine': platform.machine(),
+        'cpu_count': os.cpu_count(),
+        'simd_isa': pyint64.simd_isa(),
+        'threads': pyint64.thread_info(),
+        'overflow_policy': pyint64.get_overflow_policy(),
+        'bulk_size': args.size,
+        'repeat': args.repeat,
+        'min_time': args.min_time,
+        'date': time.strftime('%Y-%m-%dT%H:%M:%S%z'),
+    }
+
+
+def format_ns(ns):
+    for unit, scale in (('s', 1e9), ('ms', 1e6), ('us', 1e3)):
+        if ns >= scale:
+            return f'{ns / scale:.2f} {unit}'
+    return f'{ns:.1f} ns'
+
+
+def run(args):
+    selected = [b for b in benchmarks() if b.matches(args.patterns)]
+    if not selected:
+        sys.exit('no benchmark matches ' + ' '.join(args.patterns))
+
+    results = []
+    print(f'{"benchmark":<28} {PYINT64:>12} {INT:>12} {"ratio":>7}', file=sys.stderr)
+    for bench in selected:
+        times = {}
+        for impl in (PYINT64, INT):
+            namespace = bench.setup(impl, args.size)
+            best, median, loops = time_stmt(bench.stmt[impl], namespace,
+                                            args.repeat, args.min_time)
+            times[impl] = best
+            results.append({
+                'name': bench.name, 'impl': impl, 'stmt': bench.stmt[impl],
+                'ns': best, 'median_ns': median, 'loops': loops,
+            })
+
+        ratio = times[PYINT64] / times[INT]
+        print(f'{bench.name:<28} {format_ns(times[PYINT64]):>12} '
+              f'{format_ns(times[INT]):>12} {ratio:>7.2f}', file=sys.stderr)
+
+    document = {'version': FORMAT_VERSION, 'metadata': metadata(args), 'benchmarks': results}
+    if args.output:
+        with open(args.output, 'w') as f:
+            json.dump(document, f, indent=1)
+    else:
+        json.dump(document, sys.stdout, indent=1)
+        print()
+
+
+def load(path):
+    with open(path) as f:
+        document = json.load(f)
+    if document.get('version') != FORMAT_VERSION:
+        sys.exit(f'{path}: unsupported result format {document.get("version")!r}')
+    return {(b['name'], b['impl']): b for b in document['benchmarks']}, document['metadata']
+
+
+def compare(args):
+    base, base_meta = load(args.base)
+    new, new_meta = load(args.new)
+
+    for key in ('python', 'simd_isa', 'bulk_size'):
+        if base_meta.get(key) != new_meta.get(key):
+            print(f'warning: {key} differs: {base_meta.get(key)!r} -> {new_meta.get(key)!r}',
+                  file=sys.stderr)
+
+    impls = [PYINT64] if not args.all else [PYINT64, INT]
+    regressions = 0
+    print(f'{"benchmark":<28} {"impl":<8} {"base":>12} {"new":>12} {"change":>8}')
+    for key in sorted(base.keys() & new.keys()):
+        name, impl = key
+        if impl not in impls:
+            continue
+
+        old_ns = base[key]['ns']
+        new_ns = new[key]['ns']
+        change = new_ns / old_ns - 1
+        if change > args.threshold:
+            flag = '  REGRESSION'
+            regressions += 1
+        elif change < -args.threshold:
+            flag = '  faster'
+        else:
+            flag = ''
+
+        print(f'{name:<28} {impl:<8} {format_ns(old_ns):>12} {format_ns(new_ns):>12} '
+              f'{change:>+8.1%}{flag}')
+
+    for key in sorted(base.keys() ^ new.keys()):
+        if key[1] not in impls:
+            continue
+        print(f'{key[0]:<28} {key[1]:<8} only in {"base" if key in base else "new"}')
+
+    if regressions:
+        print(f'{regressions} benchmark(s) slower by more than {args.threshold:.0%}')
+        sys.exit(1)
+
+
+def codec_data(kind, size):
+    rng = random.Random(size)
+    if kind == 'timestamps':
+        # Millisecond timestamps at a jittery rate, the delta-of-delta case.
+        start = 1_700_000_000_000
+        return [start + 1000 * i + rng.randint(-5, 5) for i in range(size)]
+    if kind == 'counters':
+        total = 0
+        values = []
+        for _ in range(size):
+            total += rng.randint(0, 300)
+            values.append(total)
+        return values
+    if kind == 'small':
+        return [rng.randint(-1000, 1000) for _ in range(size)]
+    return [rng.randint(-(1 << 63), (1 << 63) - 1) for _ in range(size)]
+
+
+CODEC_DATA = ['timestamps', 'counters', 'small', 'random']
+
+
+def delta_codec(order, inner_encode, inner_decode):
+    def encode(arr):
+        return inner_encode(pyint64.delta_encode(arr, order=order))
+
+    def decode(blob, out):
+        inner_decode(blob, out)
+        pyint64.delta_decode(out, order=order, out=out)
+
+    return encode, decode
+
+
+def varint_codec(zigzag):
+    return (lambda arr: pyint64.varint_encode(arr, zigzag=zigzag),
+            lambda blob, out: pyint64.varint_decode(blob, zigzag=zigzag, out=out))
+
+
+BITPACK = (pyint64.bitpack_encode, lambda blob, out: pyint64.bitpack_decode(blob, out=out))
+
+# name: (encode(arr) -> bytes, decode(blob, out)), decoding into out.
+CODECS = [
+    ('raw', (pyint64.dumps, lambda blob, out: out.__setitem__(slice(None), pyint64.loads(blob)))),
+    ('varint', varint_codec(False)),
+    ('varint_zigzag', varint_codec(True)),
+    ('delta_varint', delta_codec(1, *varint_codec(True))),
+    ('delta2_varint', delta_codec(2, *varint_codec(True))),
+    ('bitpack', BITPACK),
+    ('delta_bitpack', delta_codec(1, *BITPACK)),
+    ('delta2_bitpack', delta_codec(2, *BITPACK)),
+]
+
+
+def codecs(args):
+    results = []
+    print(f'{"data":<12} {"codec":<16} {"ratio":>7} {"decode":>10}', file=sys.stderr)
+    for kind in CODEC_DATA:
+        arr = Int64Array(codec_data(kind, args.size))
+        for name, (encode, decode) in CODECS:
+            if not fnmatch.fnmatchcase(name, args.codec):
+                continue
+
+            blob = encode(arr)
+            out = Int64Array(arr)
+            decode(blob, out)
+            if out.tolist() != arr.tolist():
+                sys.exit(f'{name} does not round-trip {kind} data')
+
+            best, median, loops = time_stmt('decode(blob, out)',
+                                            {'decode': decode, 'blob': blob, 'out': out},
+                                            args.repeat, args.min_time)
+            ratio = len(blob) / (8 * len(arr))
+            gbps = 8 * len(arr) / best
+            results.append({'data': kind, 'codec': name, 'bytes': len(blob), 'ratio': ratio,
+                            'decode_ns': best, 'decode_median_ns': median,
+                            'decode_gbps': gbps, 'loops': loops})
+            print(f'{kind:<12} {name:<16} {ratio:>7.3f} {gbps:>5.2f} GB/s', file=sys.stderr)
+
+    if args.output:
+        document = {'version': FORMAT_VERSION, 'metadata': metadata(args), 'codecs': results}
+        with open(args.output, 'w') as f:
+            json.dump(document, f, indent=1)
+
+
+def list_benchmarks(args):
+    for bench in benchmarks():
+        if bench.matches(args.patterns):
+            print(f'{bench.name:<28} {bench.stmt[PYINT64]}')
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    commands = parser.add_subparsers(dest='command', required=True)
+
+    run_parser = commands.add_parser('run', help='run benchmarks and write JSON results')
+    run_parser.add_argument('-o', '--output', help='result file, default stdout')
+    run_parser.add_argument('-k', dest='patterns', action='append', default=[],
+                            metavar='PATTERN', help='only names matching a glob, e.g. "bulk.*"')
+    run_parser.add_argument('--size', type=int, default=100_000,
+                            help='elements per bulk benchmark (default 100000)')
+    run_parser.add_argument('--repeat', type=int, default=5,
+                            help='timed repeats, the best is reported (default 5)')
+    run_parser.add_argument('--min-time', type=float, default=0.1,
+                            help='seconds per repeat (default 0.1)')
+    run_parser.add_argument('--quick', action='store_true',
+                            help='shorthand for --size 10000 --repeat 3 --min-time 0.02')
+    run_parser.set_defaults(func=run)
+
+    compare_parser = commands.add_parser('compare', help='compare two result files')
+    compare_parser.add_argument('base')
+    compare_parser.add_argument('new')
+    compare_parser.add_argument('--threshold', type=float, default=0.05,
+                                help='relative slowdown flagged as a regression (default 0.05)')
+    compare_parser.add_argument('--all', action='store_true',
+                                help='also compare the int baselines')
+    compare_parser.set_defaults(func=compare)
+
+    codecs_parser = commands.add_parser(
+        'codecs', help='compression ratio and decode GB/s of the integer codecs')
+    codecs_parser.add_argument('-o', '--output', help='also write the results to a JSON file')
+    codecs_parser.add_argument('-k', dest='codec', default='*', metavar='PATTERN',
+                               help='only codecs matching a glob, e.g. "*bitpack"')
+    codecs_parser.add_argument('--size', type=int, default=1_000_000,
+                               help='values per data set (default 1000000)')
+    codecs_parser.add_argument('--repeat', type=int, default=5,
+                               help='timed repeats, the best is reported (default 5)')
+    codecs_parser.add_argument('--min-time', type=float, default=0.1,
+                               help='seconds per repeat (default 0.1)')
+    codecs_parser.set_defaults(func=codecs)
+
+    list_parser = commands.add_parser('list', help='list benchmark names')
+    list_parser.add_argument('patterns', nargs='*')
+    list_parser.set_defaults(func=list_benchmarks)
+
+    args = parser.parse_args()
+    if getattr(args, 'quick', False):
+        args.size, args.repeat, args.min_time = 10_000, 3, 0.02
+    args.func(args)
+
+
+if __name__ == '__main__':
+    main()
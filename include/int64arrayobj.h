@@ -0,0 +1,109 @@
+#ifndef PY_INT64ARRAY_H
+#define PY_INT64ARRAY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PY_SSIZE_T_CLEAN
+#include "Python.h"
+
+#include "int64state.h"
+
+extern PyType_Spec PyInt64Array_Spec;
+
+/*
+ * An Int64Array either owns its storage (ob_owner == NULL) or is a view
+ * into the storage of an owning array (ob_owner holds the owner).  Views
+ * are created by slicing and may have any non-zero step, they never
+ * resize.  An owner cannot resize while views or buffer exports exist.
+ *
+ * An owner may also keep its items in the buffer of another object
+ * (ob_source holds that buffer), it then never resizes and is read-only
+ * if the buffer is.
+ */
+typedef struct
+{
+    PyObject_HEAD
+
+    int64_t *ob_item;
+    Py_ssize_t ob_length;
+    Py_ssize_t ob_step;
+    Py_ssize_t ob_stride;
+    Py_ssize_t allocated;
+    Py_ssize_t ob_exports;
+    PyObject *ob_owner;
+    Py_buffer *ob_source;
+} PyInt64ArrayObject;
+
+/*
+ * Read access to int64 values from any object: an exporter of a
+ * C-contiguous int64 buffer is used in place, anything else (strided
+ * views, other formats, iterables) is gathered into a temporary array.
+ */
+typedef struct
+{
+    const int64_t *items;
+    Py_ssize_t length;
+    Py_buffer view;
+    PyObject *temp;
+} PyInt64Buffer;
+
+// Public functions.
+PyObject* PyInt64Array_New(Py_ssize_t);
+
+// PyInt64Array_New() for the module of state, from a slot or method.
+PyObject* PyInt64Array_NewEx(PyInt64State*, Py_ssize_t);
+
+int PyInt64Array_Resize(PyObject*, Py_ssize_t);
+
+int PyInt64Array_Append(PyObject*, int64_t);
+
+int PyInt64Array_Extend(PyObject*, PyObject*);
+
+/*
+ * Array of count int64 stored in the buffer of obj from byte offset on,
+ * in little- or big-endian order.  The buffer is used in place when it is
+ * aligned and in native order, unless copy is set.
+ */
+PyObject* PyInt64Array_FromRaw(PyObject *obj, Py_ssize_t offset, Py_ssize_t count,
+                               int little_endian, int copy);
+
+/*
+ * Array over the items of a buffer exporter with format q, l or Q in any
+ * byte order.  An aligned C-contiguous buffer in native order is used in
+ * place, holding the export, unless copy is set; anything else is copied
+ * once and byte swapped if needed.
+ */
+PyObject* PyInt64Array_FromBuffer(PyObject *obj, int copy);
+
+/*
+ * Elementwise base ** exponent, or pow(base, exponent, modulus) with an
+ * integer modulus. base and exponent are Int64Arrays or integers, at least
+ * one an array; returns NotImplemented for other operands.
+ */
+PyObject* PyInt64Array_Power(PyObject *base, PyObject *exponent, PyObject *modulus);
+
+int PyInt64_IsInt64Format(const Py_buffer*);
+
+int PyInt64Buffer_Get(PyObject*, PyInt64Buffer*);
+
+void PyInt64Buffer_Release(PyInt64Buffer*);
+
+/*
+ * The out argument of function name: a writable, C-contiguous int64
+ * buffer, released with PyBuffer_Release.
+ */
+int PyInt64Buffer_GetWritable(PyObject *obj, const char *name, Py_buffer *view);
+
+// Public Macros
+#define PyInt64Array_Check(ob) PYINT64_STATE_CHECK(ob, array_type)
+#define PyInt64Array_CheckExact(ob) PYINT64_STATE_CHECK_EXACT(ob, array_type)
+#define PyInt64Array_GET_SIZE(ob) (((PyInt64ArrayObject*)ob)->ob_length)
+#define PyInt64Array_GET_ITEM(ob, i) \
+    (((PyInt64ArrayObject*)ob)->ob_item[(i) * ((PyInt64ArrayObject*)ob)->ob_step])
+
+#ifdef __cplusplus
+}
+#endif
+#endif // !PY_INT64ARRAY_H
@@ -0,0 +1,18 @@
+#ifndef PY_INT64BULK_H
+#define PY_INT64BULK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PY_SSIZE_T_CLEAN
+#include "Python.h"
+
+// Add the whole-buffer functions (hashing, reductions, bit operations)
+// to the module.
+int PyInt64Bulk_Init(PyObject*);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // !PY_INT64BULK_H
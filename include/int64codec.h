@@ -0,0 +1,41 @@
+#ifndef PY_INT64CODEC_H
+#define PY_INT64CODEC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PY_SSIZE_T_CLEAN
+#include "Python.h"
+
+/*
+ * Bit-packed int64 sequence format, version 1.  A 16 byte header
+ *
+ *     0  magic     "PIBP"
+ *     4  version   uint8
+ *     5  reserved  zero
+ *     8  count     uint64, little-endian
+ *
+ * followed by one block per PYINT64_PACK_BLOCK values (the last one padded
+ * with its reference):
+ *
+ *     0  width     uint8, 0 to 64
+ *     1  reference int64, little-endian, the smallest value of the block
+ *     9  PYINT64_PACK_SIZE(width) bytes of packed values, laid out as the
+ *        kernels describe in int64kernels.h
+ */
+#define PYINT64_BITPACK_MAGIC "PIBP"
+#define PYINT64_BITPACK_VERSION 1
+#define PYINT64_BITPACK_HEADER_SIZE 16
+#define PYINT64_BITPACK_BLOCK_HEADER_SIZE 9
+
+/*
+ * Add the zigzag, delta, varint (LEB128) and bitpack encoders and decoders
+ * to the module.
+ */
+int PyInt64Codec_Init(PyObject*);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // !PY_INT64CODEC_H
@@ -0,0 +1,108 @@
+#ifndef PY_INT64COLUMN_H
+#define PY_INT64COLUMN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PY_SSIZE_T_CLEAN
+#include "Python.h"
+
+#include "int64state.h"
+
+/*
+ * On-disk int64 column, version 1.  A 64 byte header
+ *
+ *     0  magic       "PI64COL\0"
+ *     8  version     uint8
+ *     9  byteorder   '<' or '>', order of the payload and checksums
+ *    10  itemsize    uint8, always 8
+ *    11  flags       uint8, PYINT64_COLUMN_MINMAX | PYINT64_COLUMN_CHECKSUMS
+ *    12  reserved    zero
+ *    16  count       uint64
+ *    24  min         int64, valid with PYINT64_COLUMN_MINMAX
+ *    32  max         int64, valid with PYINT64_COLUMN_MINMAX
+ *    40  block_size  uint64, values per checksum block
+ *    48  reserved    zero
+ *
+ * with every header integer little-endian, followed by count int64 values
+ * and, with PYINT64_COLUMN_CHECKSUMS, one uint64 checksum per block of
+ * block_size values (the last block may be shorter).  The payload starts
+ * 64 byte aligned in a mapping of the file.  ColumnWriter writes native
+ * order, Column reads both.
+ */
+#define PYINT64_COLUMN_MAGIC "PI64COL"
+#define PYINT64_COLUMN_VERSION 1
+#define PYINT64_COLUMN_HEADER_SIZE 64
+#define PYINT64_COLUMN_BLOCK_SIZE 65536
+
+#define PYINT64_COLUMN_MINMAX 1
+#define PYINT64_COLUMN_CHECKSUMS 2
+
+// Read-only (or writable) memory mapping of a column file.
+extern PyType_Spec PyInt64Column_Spec;
+
+// Append-only writer of a column file.
+extern PyType_Spec PyInt64ColumnWriter_Spec;
+
+typedef struct
+{
+    PyObject_HEAD
+
+    char *ob_map;           // the mapping, NULL once closed
+    size_t ob_map_size;
+    int64_t *ob_item;       // count values right after the header
+    Py_ssize_t ob_length;
+    const uint64_t *ob_checksums;
+    Py_ssize_t ob_block_size;
+    int64_t ob_min;
+    int64_t ob_max;
+    int ob_flags;
+    int ob_swapped;         // payload in the other byte order
+    int ob_writable;
+    Py_ssize_t ob_exports;
+    PyObject *ob_path;
+} PyInt64ColumnObject;
+
+// Running checksum of the block being written.
+typedef struct
+{
+    uint64_t lanes[4];
+    Py_ssize_t length;
+} PyInt64ColumnHasher;
+
+typedef struct
+{
+    PyObject_HEAD
+
+    int fd;                 // -1 once closed
+    Py_ssize_t ob_length;
+    int64_t ob_min;
+    int64_t ob_max;
+    int ob_flags;
+    int ob_sealed;          // the header on disk describes the file
+    Py_ssize_t ob_block_size;
+    uint64_t *ob_checksums; // of the completed blocks
+    Py_ssize_t ob_checksums_allocated;
+    PyInt64ColumnHasher hasher;
+    PyObject *ob_path;
+} PyInt64ColumnWriterObject;
+
+/*
+ * Plain file descriptors, shared with TextReader.  PyInt64File_Open raises
+ * an OSError naming path on failure.  PyInt64File_Read runs without the
+ * GIL, reads until size bytes or end of file and stores errno in *error
+ * when a read fails.
+ */
+int PyInt64File_Open(PyObject *path, int flags);
+
+Py_ssize_t PyInt64File_Read(int fd, char *out, Py_ssize_t size, int *error);
+
+void PyInt64File_Close(int fd);
+
+#define PyInt64Column_Check(ob) PYINT64_STATE_CHECK(ob, column_type)
+
+#ifdef __cplusplus
+}
+#endif
+#endif // !PY_INT64COLUMN_H
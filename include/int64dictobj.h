@@ -0,0 +1,33 @@
+#ifndef PY_INT64DICT_H
+#define PY_INT64DICT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PY_SSIZE_T_CLEAN
+#include "Python.h"
+
+#include "int64state.h"
+#include "int64table.h"
+
+// int64 -> object mapping.
+extern PyType_Spec PyInt64Dict_Spec;
+
+// int64 -> int64 mapping where missing keys count as zero.
+extern PyType_Spec PyInt64Counter_Spec;
+
+typedef struct
+{
+    PyObject_HEAD
+
+    PyInt64Table table;
+} PyInt64DictObject;
+
+#define PyInt64Dict_Check(ob) PYINT64_STATE_CHECK(ob, dict_type)
+#define PyInt64Counter_Check(ob) PYINT64_STATE_CHECK(ob, counter_type)
+
+#ifdef __cplusplus
+}
+#endif
+#endif // !PY_INT64DICT_H
@@ -0,0 +1,154 @@
+#ifndef PY_INT64DIVIDER_H
+#define PY_INT64DIVIDER_H
+
+#include <stdint.h>
+
+/*
+ * Division by an invariant int64 divisor without a divide instruction
+ * (Granlund and Montgomery, in the form libdivide uses).  The truncated
+ * quotient is the high half of a multiply by a precomputed magic number,
+ * plus a shift and a sign fix up; powers of two only shift.  The floor
+ * forms then correct quotient and remainder like pyint64_op_floordiv and
+ * pyint64_op_mod, including INT64_MIN // -1 wrapping to INT64_MIN.
+ */
+typedef struct
+{
+    int64_t divisor;
+    int64_t magic;          // 0 for a power of two magnitude
+    uint8_t shift;
+    uint8_t add;            // add the signed numerator after the multiply
+    uint8_t negative;       // divisor < 0
+} PyInt64Divider;
+
+// High 64 bits of the signed 128-bit product.
+static inline int64_t
+pyint64_divider_mulhi(int64_t a, int64_t b)
+{
+#if defined(__SIZEOF_INT128__)
+    return (int64_t)(((__int128)a * b) >> 64);
+#else
+    const uint64_t a_lo = (uint32_t)a;
+    const uint64_t a_hi = (uint64_t)a >> 32;
+    const uint64_t b_lo = (uint32_t)b;
+    const uint64_t b_hi = (uint64_t)b >> 32;
+    const uint64_t low = a_lo * b_lo;
+    const uint64_t mid1 = a_hi * b_lo + (low >> 32);
+    const uint64_t mid2 = a_lo * b_hi + (uint32_t)mid1;
+    const uint64_t high = a_hi * b_hi + (mid1 >> 32) + (mid2 >> 32);
+
+    // Unsigned high half to signed: subtract b if a < 0 and a if b < 0.
+    return (int64_t)(high - (a < 0 ? (uint64_t)b : 0) - (b < 0 ? (uint64_t)a : 0));
+#endif
+}
+
+// Set up the divider for a nonzero divisor.
+static inline void
+pyint64_divider_init(PyInt64Divider *divider, int64_t divisor)
+{
+    const uint64_t magnitude = divisor < 0 ? 0 - (uint64_t)divisor : (uint64_t)divisor;
+
+    int log2 = 63;
+    while (!(magnitude >> log2))
+    {
+        --log2;
+    }
+
+    divider->divisor = divisor;
+    divider->negative = divisor < 0;
+    divider->add = 0;
+
+    if ((magnitude & (magnitude - 1)) == 0)
+    {
+        divider->magic = 0;
+        divider->shift = (uint8_t)log2;
+        return;
+    }
+
+    // floor(2**(63 + log2) / magnitude) by shift and subtract, done once.
+    uint64_t quotient = 0;
+    uint64_t remainder = 1;
+    for (int bit = 0; bit < 63 + log2; ++bit)
+    {
+        remainder <<= 1;
+        quotient <<= 1;
+        if (remainder >= magnitude)
+        {
+            remainder -= magnitude;
+            quotient |= 1;
+        }
+    }
+
+    if (magnitude - remainder < ((uint64_t)1 << log2))
+    {
+        divider->shift = (uint8_t)(log2 - 1);
+    }
+    else
+    {
+        // The magic number needs 65 bits, keep 64 and add the numerator.
+        quotient += quotient;
+        const uint64_t twice = remainder + remainder;
+        if (twice >= magnitude || twice < remainder)
+        {
+            quotient += 1;
+        }
+
+        divider->shift = (uint8_t)log2;
+        divider->add = 1;
+    }
+
+    quotient += 1;
+    divider->magic = divider->negative ? (int64_t)(0 - quotient) : (int64_t)quotient;
+}
+
+// a / divisor truncated toward zero.
+static inline int64_t
+pyint64_divider_trunc(int64_t a, const PyInt64Divider *divider)
+{
+    const int64_t sign = -(int64_t)divider->negative;
+
+    if (!divider->magic)
+    {
+        // Bias negative numerators so the arithmetic shift truncates.
+        const uint64_t mask = ((uint64_t)1 << divider->shift) - 1;
+        const int64_t q = (int64_t)((uint64_t)a + ((uint64_t)(a >> 63) & mask)) >> divider->shift;
+        return (int64_t)(((uint64_t)q ^ (uint64_t)sign) - (uint64_t)sign);
+    }
+
+    uint64_t uq = (uint64_t)pyint64_divider_mulhi(divider->magic, a);
+    if (divider->add)
+    {
+        uq += ((uint64_t)a ^ (uint64_t)sign) - (uint64_t)sign;
+    }
+
+    const int64_t q = (int64_t)uq >> divider->shift;
+    return q + (q < 0);
+}
+
+// Floor quotient and remainder with the sign of the divisor.
+static inline int64_t
+pyint64_divider_divmod(int64_t a, const PyInt64Divider *divider, int64_t *remainder)
+{
+    const int64_t q = pyint64_divider_trunc(a, divider);
+    const int64_t r = (int64_t)((uint64_t)a - (uint64_t)q * (uint64_t)divider->divisor);
+    const int64_t adjust = (r != 0) & ((r ^ divider->divisor) < 0);
+
+    *remainder = (int64_t)((uint64_t)r + ((uint64_t)divider->divisor & (0 - (uint64_t)adjust)));
+    return q - adjust;
+}
+
+static inline int64_t
+pyint64_divider_floordiv(int64_t a, const PyInt64Divider *divider)
+{
+    int64_t remainder;
+    return pyint64_divider_divmod(a, divider, &remainder);
+}
+
+static inline int64_t
+pyint64_divider_mod(int64_t a, const PyInt64Divider *divider)
+{
+    int64_t remainder;
+    pyint64_divider_divmod(a, divider, &remainder);
+    return remainder;
+}
+
+#endif // !PY_INT64DIVIDER_H
@@ -0,0 +1,30 @@
+#ifndef PY_INT64DIVISOR_H
+#define PY_INT64DIVISOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PY_SSIZE_T_CLEAN
+#include "Python.h"
+
+#include "int64divider.h"
+#include "int64state.h"
+
+// Invariant int64 divisor for fast repeated //, % and divmod.
+extern PyType_Spec PyInt64Divisor_Spec;
+
+typedef struct
+{
+    PyObject_HEAD
+
+    PyInt64Divider divider;
+    PyObject* ob_value;     // the divisor as a Pyint64
+} PyInt64DivisorObject;
+
+#define PyInt64Divisor_Check(ob) PYINT64_STATE_CHECK(ob, divisor_type)
+
+#ifdef __cplusplus
+}
+#endif
+#endif // !PY_INT64DIVISOR_H
@@ -0,0 +1,20 @@
+#ifndef PY_INT64FORMAT_H
+#define PY_INT64FORMAT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PY_SSIZE_T_CLEAN
+#include "Python.h"
+
+// Streaming parser of integer text files, see int64format.c.
+extern PyType_Spec PyInt64TextReader_Spec;
+
+// Add the text conversion functions, ParseError and TextReader to the module.
+int PyInt64Format_Init(PyObject*);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // !PY_INT64FORMAT_H
@@ -0,0 +1,212 @@
+#ifndef PY_INT64KERNELS_H
+#define PY_INT64KERNELS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PY_SSIZE_T_CLEAN
+#include "Python.h"
+
+#include "int64divider.h"
+#include "int64ops.h"
+
+typedef enum
+{
+    PYINT64_ISA_SCALAR,
+    PYINT64_ISA_SSE42,
+    PYINT64_ISA_AVX2,
+    PYINT64_ISA_AVX512,
+    PYINT64_ISA_COUNT
+} PyInt64Isa;
+
+typedef enum
+{
+    PYINT64_OP_ADD,
+    PYINT64_OP_SUB,
+    PYINT64_OP_MUL,
+    PYINT64_OP_FLOORDIV,
+    PYINT64_OP_MOD,
+    PYINT64_OP_AND,
+    PYINT64_OP_OR,
+    PYINT64_OP_XOR,
+    PYINT64_OP_LSHIFT,
+    PYINT64_OP_RSHIFT,
+    PYINT64_BINARY_OP_COUNT
+} PyInt64BinaryOp;
+
+typedef enum
+{
+    PYINT64_OP_NEG,
+    PYINT64_OP_ABS,
+    PYINT64_OP_INVERT,
+    PYINT64_UNARY_OP_COUNT
+} PyInt64UnaryOp;
+
+typedef enum
+{
+    PYINT64_OP_BIT_LENGTH,
+    PYINT64_OP_BIT_COUNT,
+    PYINT64_OP_CLZ,
+    PYINT64_OP_CTZ,
+    PYINT64_OP_BSWAP,
+    PYINT64_BIT_OP_COUNT
+} PyInt64BitOp;
+
+typedef enum
+{
+    PYINT64_SCAN_SUM,
+    PYINT64_SCAN_MIN,
+    PYINT64_SCAN_MAX,
+    PYINT64_SCAN_XOR,
+    PYINT64_SCAN_OP_COUNT
+} PyInt64ScanOp;
+
+/*
+ * How a kernel treats overflow: wrap silently, wrap but report it, or
+ * clamp to the int64 range.
+ */
+typedef enum
+{
+    PYINT64_KERNEL_WRAP,
+    PYINT64_KERNEL_CHECKED,
+    PYINT64_KERNEL_SATURATE,
+    PYINT64_KERNEL_MODE_COUNT
+} PyInt64KernelMode;
+
+// Kernels return nonzero if any element overflowed (checked mode only).
+
+// out[i] = a[i] op b[i]
+typedef int (*PyInt64BinaryKernel)(const int64_t*, const int64_t*, int64_t*, Py_ssize_t);
+
+// out[i] = a[i] op b
+typedef int (*PyInt64BinaryScalarKernel)(const int64_t*, int64_t, int64_t*, Py_ssize_t);
+
+// out[i] = a op b[i]
+typedef int (*PyInt64ScalarBinaryKernel)(int64_t, const int64_t*, int64_t*, Py_ssize_t);
+
+// out[i] = op a[i]
+typedef int (*PyInt64UnaryKernel)(const int64_t*, int64_t*, Py_ssize_t);
+
+// out[i] = pyint64_op_mix64(a[i], seed)
+typedef void (*PyInt64HashKernel)(const int64_t*, uint64_t, int64_t*, Py_ssize_t);
+
+/*
+ * Exact sum split in two halves: *hi = sum of a[i] >> 32 and *lo = sum of
+ * a[i] & 0xffffffff, so the total is *hi * 2**32 + *lo.  Neither half can
+ * overflow for n <= PYINT64_SUM_BLOCK.
+ */
+typedef void (*PyInt64SumKernel)(const int64_t*, Py_ssize_t, int64_t*, int64_t*);
+
+#define PYINT64_SUM_BLOCK ((Py_ssize_t)1 << 30)
+
+// Fold a[0..n) into init: wrapping product, min or max.
+typedef int64_t (*PyInt64FoldKernel)(const int64_t*, Py_ssize_t, int64_t);
+
+// out[i] = op a[i], none of the bit operations can overflow.
+typedef void (*PyInt64BitKernel)(const int64_t*, int64_t*, Py_ssize_t);
+
+// out[i] = pyint64_op_rotl(a[i], b)
+typedef void (*PyInt64RotateKernel)(const int64_t*, int64_t, int64_t*, Py_ssize_t);
+
+/*
+ * quotient[i], remainder[i] = divmod(a[i], divider) with floor semantics
+ * and INT64_MIN // -1 wrapping; either output may be NULL.
+ */
+typedef void (*PyInt64DivideKernel)(const int64_t*, const PyInt64Divider*,
+                                    int64_t*, int64_t*, Py_ssize_t);
+
+// out[i] = init op a[0] op ... op a[i], sums wrap.
+typedef void (*PyInt64ScanKernel)(const int64_t*, int64_t*, Py_ssize_t, int64_t);
+
+/*
+ * Whether a wrapped sum scan from init overflowed at any element, judged
+ * from its output alone: each step is an add of out[i] - out[i - 1].
+ */
+typedef int (*PyInt64ScanCheckKernel)(const int64_t*, Py_ssize_t, int64_t);
+
+/*
+ * Frame-of-reference block of PYINT64_PACK_BLOCK values: every value minus
+ * a reference, in width bits (0 to 64).  The block is cut into
+ * PYINT64_PACK_LANES streams of little-endian uint32 words, interleaved
+ * word by word, with value i in stream i % PYINT64_PACK_LANES at bit
+ * (i / PYINT64_PACK_LANES) * width.  Each stream is exactly width words, a
+ * block 16 * width bytes, and every lane does the same shifts, so packing
+ * and unpacking vectorize for any width.
+ */
+#define PYINT64_PACK_BLOCK 128
+#define PYINT64_PACK_LANES 4
+
+#define PYINT64_PACK_SIZE(width) ((Py_ssize_t)(width) * (PYINT64_PACK_BLOCK / 8))
+
+// Pack a block of values, all in [reference, reference + 2**width).
+typedef void (*PyInt64PackKernel)(const int64_t*, int64_t, int, unsigned char*);
+
+// Unpack a block, adding the reference back.
+typedef void (*PyInt64UnpackKernel)(const unsigned char*, int64_t, int, int64_t*);
+
+/*
+ * One table per instruction set.  Kernels assume validated input: no
+ * zero divisors and no negative shift counts (see PyInt64Kernels_Check*).
+ * out may alias an input exactly, but must not partially overlap it.
+ */
+typedef struct
+{
+    PyInt64BinaryKernel binary[PYINT64_KERNEL_MODE_COUNT][PYINT64_BINARY_OP_COUNT];
+    PyInt64BinaryScalarKernel binary_scalar[PYINT64_KERNEL_MODE_COUNT][PYINT64_BINARY_OP_COUNT];
+    PyInt64ScalarBinaryKernel scalar_binary[PYINT64_KERNEL_MODE_COUNT][PYINT64_BINARY_OP_COUNT];
+    PyInt64UnaryKernel unary[PYINT64_KERNEL_MODE_COUNT][PYINT64_UNARY_OP_COUNT];
+    PyInt64HashKernel hash;
+    PyInt64SumKernel sum;
+    PyInt64FoldKernel prod;
+    PyInt64FoldKernel min;
+    PyInt64FoldKernel max;
+    PyInt64BitKernel bits[PYINT64_BIT_OP_COUNT];
+    PyInt64RotateKernel rotl;
+    PyInt64DivideKernel divide;
+    PyInt64PackKernel pack;
+    PyInt64UnpackKernel unpack;
+    PyInt64ScanKernel scan[PYINT64_SCAN_OP_COUNT];
+    PyInt64ScanCheckKernel scan_overflow;
+} PyInt64KernelTable;
+
+// Table of the selected instruction set, set up at module import.
+extern PYINT64_SETTING(const PyInt64KernelTable*) PyInt64Kernels_Selected;
+
+static inline const PyInt64KernelTable*
+PyInt64Kernels_Get(void)
+{
+#if PYINT64_SETTINGS_ATOMICS
+    // Pairs with the release store that publishes a table Init filled in.
+    return atomic_load_explicit(&PyInt64Kernels_Selected, memory_order_acquire);
+#else
+    return PyInt64Kernels_Selected;
+#endif
+}
+
+// Detect the CPU and select the best table, once per process.
+void PyInt64Kernels_Init(void);
+
+PyInt64Isa PyInt64Kernels_Detect(void);
+
+PyInt64Isa PyInt64Kernels_Current(void);
+
+int PyInt64Kernels_Select(PyInt64Isa);
+
+const char* PyInt64Kernels_IsaName(PyInt64Isa);
+
+const PyInt64KernelTable* PyInt64Kernels_Table(PyInt64Isa);
+
+int PyInt64Kernels_CheckOperands(PyInt64BinaryOp, const int64_t*, Py_ssize_t);
+
+// Kernel mode for the current overflow policy, promote maps to checked.
+PyInt64KernelMode PyInt64Kernels_Mode(void);
+
+const char* PyInt64Kernels_BinaryOpName(PyInt64BinaryOp);
+
+const char* PyInt64Kernels_UnaryOpName(PyInt64UnaryOp);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // !PY_INT64KERNELS_H
@@ -0,0 +1,273 @@
+#ifndef PY_INT64MODPOW_H
+#define PY_INT64MODPOW_H
+
+#include <stdint.h>
+
+/*
+ * pow(a, b, m) for int64 operands with the result of Python int: in
+ * [0, m) for m > 0 and in (m, 0] for m < 0.  Products are reduced with a
+ * 128-bit multiply and remainder, or for odd moduli in Montgomery form,
+ * where every reduction is two multiplies and a subtract.  The modulus is
+ * set up once so that batches with a shared modulus reuse it.
+ */
+typedef struct
+{
+    int64_t modulus;        // nonzero
+    uint64_t n;             // |modulus|, up to 2**63
+    uint64_t inverse;       // -n**-1 mod 2**64
+    uint64_t r2;            // 2**128 mod n
+    uint8_t montgomery;     // n odd and > 1
+} PyInt64Modulus;
+
+#if defined(__SIZEOF_INT128__)
+#define PYINT64_HAVE_INT128 1
+#else
+#define PYINT64_HAVE_INT128 0
+#endif
+
+// a * b mod n for a, b < n.
+static inline uint64_t
+pyint64_modulus_mulmod(uint64_t a, uint64_t b, uint64_t n)
+{
+#if PYINT64_HAVE_INT128
+    return (uint64_t)(((unsigned __int128)a * b) % n);
+#else
+    // Double and add; n <= 2**63 keeps every sum below 2**64.
+    uint64_t result = 0;
+    for (; b; b >>= 1)
+    {
+        if (b & 1)
+        {
+            result += a;
+            result -= result >= n ? n : 0;
+        }
+
+        a += a;
+        a -= a >= n ? n : 0;
+    }
+
+    return result;
+#endif
+}
+
+#if PYINT64_HAVE_INT128
+/*
+ * t * 2**-64 mod n for t < n * 2**64.  n < 2**63 keeps t + q * n below
+ * 2**128.
+ */
+static inline uint64_t
+pyint64_modulus_redc(unsigned __int128 t, const PyInt64Modulus *modulus)
+{
+    const uint64_t q = (uint64_t)t * modulus->inverse;
+    const uint64_t r = (uint64_t)((t + (unsigned __int128)q * modulus->n) >> 64);
+    return r >= modulus->n ? r - modulus->n : r;
+}
+
+static inline uint64_t
+pyint64_modulus_montmul(uint64_t a, uint64_t b, const PyInt64Modulus *modulus)
+{
+    return pyint64_modulus_redc((unsigned __int128)a * b, modulus);
+}
+#endif
+
+static inline void
+pyint64_modulus_init(PyInt64Modulus *modulus, int64_t m)
+{
+    const uint64_t n = m < 0 ? 0 - (uint64_t)m : (uint64_t)m;
+
+    modulus->modulus = m;
+    modulus->n = n;
+    modulus->inverse = 0;
+    modulus->r2 = 0;
+    modulus->montgomery = 0;
+
+#if PYINT64_HAVE_INT128
+    if ((n & 1) && n > 1)
+    {
+        // Newton's iteration doubles the correct low bits, from 3 to 96.
+        uint64_t inverse = n;
+        for (int step = 0; step < 5; ++step)
+        {
+            inverse *= 2 - n * inverse;
+        }
+
+        const uint64_t r = (0 - n) % n;
+        modulus->inverse = 0 - inverse;
+        modulus->r2 = (uint64_t)(((unsigned __int128)r * r) % n);
+        modulus->montgomery = 1;
+    }
+#endif
+}
+
+// a mod n in [0, n).
+static inline uint64_t
+pyint64_modulus_reduce(int64_t a, const PyInt64Modulus *modulus)
+{
+    if (a >= 0)
+    {
+        return (uint64_t)a % modulus->n;
+    }
+
+    const uint64_t r = (0 - (uint64_t)a) % modulus->n;
+    return r ? modulus->n - r : 0;
+}
+
+// Map a residue in [0, n) to the sign convention of the modulus.
+static inline int64_t
+pyint64_modulus_result(uint64_t r, const PyInt64Modulus *modulus)
+{
+    return (int64_t)(modulus->modulus < 0 && r ? r - modulus->n : r);
+}
+
+/*
+ * Store the inverse of a mod n in [0, n), return 0 when a and n are not
+ * coprime.  Extended Euclid; the coefficients stay within n / 2, only the
+ * one computed after the final step may wrap and it is never read.
+ */
+static inline int
+pyint64_modulus_inverse(uint64_t a, const PyInt64Modulus *modulus, uint64_t *result)
+{
+    uint64_t r0 = modulus->n;
+    uint64_t r1 = a;
+    uint64_t s0 = 0;
+    uint64_t s1 = 1;
+
+    while (r1)
+    {
+        const uint64_t q = r0 / r1;
+        const uint64_t r2 = r0 - q * r1;
+        const uint64_t s2 = s0 - q * s1;
+        r0 = r1;
+        r1 = r2;
+        s0 = s1;
+        s1 = s2;
+    }
+
+    if (r0 != 1)
+    {
+        return 0;
+    }
+
+    *result = (int64_t)s0 < 0 ? s0 + modulus->n : s0;
+    return 1;
+}
+
+// base ** exponent mod n for base < n.
+static inline uint64_t
+pyint64_modulus_pow_residue(uint64_t base, uint64_t exponent, const PyInt64Modulus *modulus)
+{
+    if (modulus->n == 1)
+    {
+        return 0;
+    }
+
+#if PYINT64_HAVE_INT128
+    if (modulus->montgomery)
+    {
+        uint64_t x = pyint64_modulus_montmul(base, modulus->r2, modulus);
+        uint64_t result = pyint64_modulus_redc(modulus->r2, modulus);
+        for (; exponent; exponent >>= 1)
+        {
+            if (exponent & 1)
+            {
+                result = pyint64_modulus_montmul(result, x, modulus);
+            }
+
+            if (exponent > 1)
+            {
+                x = pyint64_modulus_montmul(x, x, modulus);
+            }
+        }
+
+        return pyint64_modulus_redc(result, modulus);
+    }
+#endif
+
+    uint64_t result = 1;
+    for (; exponent; exponent >>= 1)
+    {
+        if (exponent & 1)
+        {
+            result = pyint64_modulus_mulmod(result, base, modulus->n);
+        }
+
+        if (exponent > 1)
+        {
+            base = pyint64_modulus_mulmod(base, base, modulus->n);
+        }
+    }
+
+    return result;
+}
+
+#if PYINT64_HAVE_INT128
+/*
+ * Four residues to the same exponent in Montgomery form.  Each chain of
+ * multiplies is latency bound, running four side by side keeps the
+ * multiplier busy.
+ */
+static inline void
+pyint64_modulus_pow_residues4(const uint64_t *base, uint64_t exponent,
+                              const PyInt64Modulus *modulus, uint64_t *result)
+{
+    uint64_t x[4];
+    uint64_t r[4];
+    const uint64_t one = pyint64_modulus_redc(modulus->r2, modulus);
+
+    for (int lane = 0; lane < 4; ++lane)
+    {
+        x[lane] = pyint64_modulus_montmul(base[lane], modulus->r2, modulus);
+        r[lane] = one;
+    }
+
+    for (; exponent; exponent >>= 1)
+    {
+        if (exponent & 1)
+        {
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                r[lane] = pyint64_modulus_montmul(r[lane], x[lane], modulus);
+            }
+        }
+
+        if (exponent > 1)
+        {
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                x[lane] = pyint64_modulus_montmul(x[lane], x[lane], modulus);
+            }
+        }
+    }
+
+    for (int lane = 0; lane < 4; ++lane)
+    {
+        result[lane] = pyint64_modulus_redc(r[lane], modulus);
+    }
+}
+#endif
+
+/*
+ * pow(a, b, modulus).  A negative b raises the inverse of a to -b; returns
+ * 0 without storing a result when a has no inverse.
+ */
+static inline int
+pyint64_modulus_pow(int64_t a, int64_t b, const PyInt64Modulus *modulus, int64_t *result)
+{
+    uint64_t base = pyint64_modulus_reduce(a, modulus);
+    uint64_t exponent = (uint64_t)b;
+
+    if (b < 0 && modulus->n > 1)
+    {
+        if (!pyint64_modulus_inverse(base, modulus, &base))
+        {
+            return 0;
+        }
+
+        exponent = 0 - (uint64_t)b;
+    }
+
+    *result = pyint64_modulus_result(pyint64_modulus_pow_residue(base, exponent, modulus), modulus);
+    return 1;
+}
+
+#endif // !PY_INT64MODPOW_H
@@ -0,0 +1,530 @@
+#ifndef PY_INT64OPS_H
+#define PY_INT64OPS_H
+
+#include <stdint.h>
+
+/*
+ * Scalar int64 semantics shared by the Pyint64 number slots and the
+ * Int64Array kernels, so both always agree.  Arithmetic wraps in two's
+ * complement, division floors like Python int, shifts by 64 or more
+ * saturate like an infinitely wide int truncated to 64 bits.  Callers
+ * reject zero divisors and negative shift counts before getting here.
+ *
+ * Every op also has an _overflow form, which stores the wrapped result
+ * and returns nonzero when the exact result does not fit, and a _sat
+ * form, which clamps to INT64_MIN/INT64_MAX instead.
+ */
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PYINT64_HAVE_BUILTIN_OVERFLOW 1
+#else
+#define PYINT64_HAVE_BUILTIN_OVERFLOW 0
+#endif
+
+/*
+ * Process-wide settings (overflow policy, kernel table, thread pool) can
+ * be changed by one interpreter while threads of others, which hold a GIL
+ * of their own, read them.  They are atomics read and written relaxed: a
+ * reader sees the old or the new value, never a torn one.
+ */
+#if !defined(__STDC_NO_ATOMICS__) && !defined(_MSC_VER)
+#include <stdatomic.h>
+#define PYINT64_SETTINGS_ATOMICS 1
+#define PYINT64_SETTING(type) _Atomic(type)
+#define PYINT64_SETTING_LOAD(setting) atomic_load_explicit(&(setting), memory_order_relaxed)
+#define PYINT64_SETTING_STORE(setting, value) \
+    atomic_store_explicit(&(setting), (value), memory_order_relaxed)
+#else
+#define PYINT64_SETTINGS_ATOMICS 0
+#define PYINT64_SETTING(type) volatile type
+#define PYINT64_SETTING_LOAD(setting) (setting)
+#define PYINT64_SETTING_STORE(setting, value) ((setting) = (value))
+#endif
+
+typedef enum
+{
+    PYINT64_OVERFLOW_WRAP,
+    PYINT64_OVERFLOW_CHECKED,
+    PYINT64_OVERFLOW_SATURATE,
+    PYINT64_OVERFLOW_PROMOTE,
+    PYINT64_OVERFLOW_POLICY_COUNT
+} PyInt64OverflowPolicy;
+
+// What Pyint64 and Int64Array arithmetic does when a result overflows.
+extern PYINT64_SETTING(PyInt64OverflowPolicy) PyInt64_OverflowPolicy;
+
+static inline int64_t
+pyint64_op_add(int64_t a, int64_t b)
+{
+    return (int64_t)((uint64_t)a + (uint64_t)b);
+}
+
+static inline int64_t
+pyint64_op_sub(int64_t a, int64_t b)
+{
+    return (int64_t)((uint64_t)a - (uint64_t)b);
+}
+
+static inline int64_t
+pyint64_op_mul(int64_t a, int64_t b)
+{
+    return (int64_t)((uint64_t)a * (uint64_t)b);
+}
+
+static inline int64_t
+pyint64_op_floordiv(int64_t a, int64_t b)
+{
+    if (b == -1)
+    {
+        // INT64_MIN // -1 wraps instead of trapping.
+        return (int64_t)(0 - (uint64_t)a);
+    }
+
+    const int64_t q = a / b;
+    return (a % b != 0 && ((a < 0) != (b < 0))) ? q - 1 : q;
+}
+
+static inline int64_t
+pyint64_op_mod(int64_t a, int64_t b)
+{
+    if (b == -1)
+    {
+        return 0;
+    }
+
+    const int64_t r = a % b;
+    return (r != 0 && ((r < 0) != (b < 0))) ? r + b : r;
+}
+
+static inline int64_t
+pyint64_op_and(int64_t a, int64_t b)
+{
+    return a & b;
+}
+
+static inline int64_t
+pyint64_op_or(int64_t a, int64_t b)
+{
+    return a | b;
+}
+
+static inline int64_t
+pyint64_op_xor(int64_t a, int64_t b)
+{
+    return a ^ b;
+}
+
+static inline int64_t
+pyint64_op_lshift(int64_t a, int64_t b)
+{
+    return b >= 64 ? 0 : (int64_t)((uint64_t)a << b);
+}
+
+static inline int64_t
+pyint64_op_rshift(int64_t a, int64_t b)
+{
+    return b >= 64 ? (a < 0 ? -1 : 0) : a >> b;
+}
+
+// a ** b for b >= 0 by square and multiply.
+static inline int64_t
+pyint64_op_pow(int64_t a, int64_t b)
+{
+    uint64_t result = 1;
+    uint64_t base = (uint64_t)a;
+    for (uint64_t exponent = (uint64_t)b; exponent; exponent >>= 1)
+    {
+        if (exponent & 1)
+        {
+            result *= base;
+        }
+        base *= base;
+    }
+
+    return (int64_t)result;
+}
+
+static inline int64_t
+pyint64_op_neg(int64_t a)
+{
+    return (int64_t)(0 - (uint64_t)a);
+}
+
+static inline int64_t
+pyint64_op_abs(int64_t a)
+{
+    return a < 0 ? pyint64_op_neg(a) : a;
+}
+
+static inline int64_t
+pyint64_op_invert(int64_t a)
+{
+    return ~a;
+}
+
+static inline int64_t
+pyint64_op_bswap(int64_t a)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (int64_t)__builtin_bswap64((uint64_t)a);
+#else
+    uint64_t x = (uint64_t)a;
+    x = ((x & UINT64_C(0x00ff00ff00ff00ff)) << 8) | ((x >> 8) & UINT64_C(0x00ff00ff00ff00ff));
+    x = ((x & UINT64_C(0x0000ffff0000ffff)) << 16) | ((x >> 16) & UINT64_C(0x0000ffff0000ffff));
+    return (int64_t)((x << 32) | (x >> 32));
+#endif
+}
+
+/*
+ * Bit operations.  popcount, clz and ctz look at the 64-bit two's
+ * complement pattern and give 64 for the all zero pattern where that
+ * applies; bit_length and bit_count follow int and look at |a|.
+ */
+static inline int64_t
+pyint64_op_popcount(int64_t a)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll((uint64_t)a);
+#else
+    uint64_t x = (uint64_t)a;
+    x = x - ((x >> 1) & UINT64_C(0x5555555555555555));
+    x = (x & UINT64_C(0x3333333333333333)) + ((x >> 2) & UINT64_C(0x3333333333333333));
+    x = (x + (x >> 4)) & UINT64_C(0x0f0f0f0f0f0f0f0f);
+    return (int64_t)((x * UINT64_C(0x0101010101010101)) >> 56);
+#endif
+}
+
+static inline int64_t
+pyint64_op_clz(int64_t a)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return a ? __builtin_clzll((uint64_t)a) : 64;
+#else
+    uint64_t x = (uint64_t)a;
+    int64_t count = 64;
+    for (int shift = 32; shift; shift >>= 1)
+    {
+        if (x >> shift)
+        {
+            x >>= shift;
+            count -= shift;
+        }
+    }
+    return count - (int64_t)x;
+#endif
+}
+
+static inline int64_t
+pyint64_op_ctz(int64_t a)
+{
+    // The ones below the lowest set bit. Unlike a ctz instruction this
+    // vectorizes (VPOPCNTQ) and needs no special case for zero.
+    const uint64_t x = (uint64_t)a;
+    return pyint64_op_popcount((int64_t)(~x & (x - 1)));
+}
+
+// |a| as unsigned without a branch, INT64_MIN gives 2**63.
+static inline uint64_t
+pyint64_op_magnitude(int64_t a)
+{
+    const uint64_t sign = (uint64_t)(a >> 63);
+    return ((uint64_t)a ^ sign) - sign;
+}
+
+static inline int64_t
+pyint64_op_bit_length(int64_t a)
+{
+    return 64 - pyint64_op_clz((int64_t)pyint64_op_magnitude(a));
+}
+
+static inline int64_t
+pyint64_op_bit_count(int64_t a)
+{
+    return pyint64_op_popcount((int64_t)pyint64_op_magnitude(a));
+}
+
+// Rotate the 64-bit pattern left by b mod 64, right for negative b.
+static inline int64_t
+pyint64_op_rotl(int64_t a, int64_t b)
+{
+    const uint64_t x = (uint64_t)a;
+    const unsigned shift = (unsigned)b & 63;
+    return (int64_t)((x << shift) | (x >> ((64 - shift) & 63)));
+}
+
+/*
+ * 64-bit finalizer of splitmix64 applied to value ^ seed.  It is a
+ * bijection for a fixed seed, so distinct values never collide, and every
+ * input bit affects every output bit, which suits hash partitioning.
+ */
+static inline int64_t
+pyint64_op_mix64(int64_t a, uint64_t seed)
+{
+    uint64_t z = ((uint64_t)a ^ seed) + UINT64_C(0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+    z = (z ^ (z >> 27)) * UINT64_C(0x94d049bb133111eb);
+    return (int64_t)(z ^ (z >> 31));
+}
+
+/*
+ * Zigzag mapping of int64 onto uint64, 0, -1, 1, -2, ... to 0, 1, 2, 3,
+ * ..., so small magnitudes of either sign get few significant bits.
+ */
+static inline uint64_t
+pyint64_op_zigzag(int64_t a)
+{
+    return ((uint64_t)a << 1) ^ (uint64_t)(a >> 63);
+}
+
+static inline int64_t
+pyint64_op_unzigzag(uint64_t a)
+{
+    return (int64_t)((a >> 1) ^ (0 - (a & 1)));
+}
+
+/* Overflow checked forms */
+
+static inline int
+pyint64_op_add_overflow(int64_t a, int64_t b, int64_t *result)
+{
+#if PYINT64_HAVE_BUILTIN_OVERFLOW
+    return __builtin_add_overflow(a, b, result);
+#else
+    *result = pyint64_op_add(a, b);
+    return ((a ^ *result) & (b ^ *result)) < 0;
+#endif
+}
+
+static inline int
+pyint64_op_sub_overflow(int64_t a, int64_t b, int64_t *result)
+{
+#if PYINT64_HAVE_BUILTIN_OVERFLOW
+    return __builtin_sub_overflow(a, b, result);
+#else
+    *result = pyint64_op_sub(a, b);
+    return ((a ^ b) & (a ^ *result)) < 0;
+#endif
+}
+
+static inline int
+pyint64_op_mul_overflow(int64_t a, int64_t b, int64_t *result)
+{
+#if PYINT64_HAVE_BUILTIN_OVERFLOW
+    return __builtin_mul_overflow(a, b, result);
+#else
+    *result = pyint64_op_mul(a, b);
+    if (a == 0 || b == 0)
+    {
+        return 0;
+    }
+
+    if ((a == -1 && b == INT64_MIN) || (b == -1 && a == INT64_MIN))
+    {
+        return 1;
+    }
+
+    return *result / b != a;
+#endif
+}
+
+static inline int
+pyint64_op_floordiv_overflow(int64_t a, int64_t b, int64_t *result)
+{
+    *result = pyint64_op_floordiv(a, b);
+    return a == INT64_MIN && b == -1;
+}
+
+static inline int
+pyint64_op_mod_overflow(int64_t a, int64_t b, int64_t *result)
+{
+    *result = pyint64_op_mod(a, b);
+    return 0;
+}
+
+static inline int
+pyint64_op_and_overflow(int64_t a, int64_t b, int64_t *result)
+{
+    *result = a & b;
+    return 0;
+}
+
+static inline int
+pyint64_op_or_overflow(int64_t a, int64_t b, int64_t *result)
+{
+    *result = a | b;
+    return 0;
+}
+
+static inline int
+pyint64_op_xor_overflow(int64_t a, int64_t b, int64_t *result)
+{
+    *result = a ^ b;
+    return 0;
+}
+
+static inline int
+pyint64_op_lshift_overflow(int64_t a, int64_t b, int64_t *result)
+{
+    *result = pyint64_op_lshift(a, b);
+    return b >= 64 ? a != 0 : (*result >> b) != a;
+}
+
+static inline int
+pyint64_op_rshift_overflow(int64_t a, int64_t b, int64_t *result)
+{
+    *result = pyint64_op_rshift(a, b);
+    return 0;
+}
+
+/*
+ * The base is only squared while exponent bits are left, and a square
+ * that overflows then means the power does too.
+ */
+static inline int
+pyint64_op_pow_overflow(int64_t a, int64_t b, int64_t *result)
+{
+    *result = pyint64_op_pow(a, b);
+    if (a >= -1 && a <= 1)
+    {
+        return 0;
+    }
+
+    if (b >= 64)
+    {
+        return 1;
+    }
+
+    int64_t product = 1;
+    int64_t base = a;
+    for (; b; b >>= 1)
+    {
+        if ((b & 1) && pyint64_op_mul_overflow(product, base, &product))
+        {
+            return 1;
+        }
+
+        if (b > 1 && pyint64_op_mul_overflow(base, base, &base))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static inline int
+pyint64_op_neg_overflow(int64_t a, int64_t *result)
+{
+    *result = pyint64_op_neg(a);
+    return a == INT64_MIN;
+}
+
+static inline int
+pyint64_op_abs_overflow(int64_t a, int64_t *result)
+{
+    *result = pyint64_op_abs(a);
+    return a == INT64_MIN;
+}
+
+static inline int
+pyint64_op_invert_overflow(int64_t a, int64_t *result)
+{
+    *result = ~a;
+    return 0;
+}
+
+/* Saturating forms */
+
+static inline int64_t
+pyint64_op_add_sat(int64_t a, int64_t b)
+{
+    int64_t result;
+    return pyint64_op_add_overflow(a, b, &result) ? (a < 0 ? INT64_MIN : INT64_MAX) : result;
+}
+
+static inline int64_t
+pyint64_op_sub_sat(int64_t a, int64_t b)
+{
+    int64_t result;
+    return pyint64_op_sub_overflow(a, b, &result) ? (a < 0 ? INT64_MIN : INT64_MAX) : result;
+}
+
+static inline int64_t
+pyint64_op_mul_sat(int64_t a, int64_t b)
+{
+    int64_t result;
+    return pyint64_op_mul_overflow(a, b, &result)
+        ? ((a < 0) != (b < 0) ? INT64_MIN : INT64_MAX)
+        : result;
+}
+
+static inline int64_t
+pyint64_op_floordiv_sat(int64_t a, int64_t b)
+{
+    int64_t result;
+    return pyint64_op_floordiv_overflow(a, b, &result) ? INT64_MAX : result;
+}
+
+static inline int64_t
+pyint64_op_mod_sat(int64_t a, int64_t b)
+{
+    return pyint64_op_mod(a, b);
+}
+
+static inline int64_t
+pyint64_op_and_sat(int64_t a, int64_t b)
+{
+    return a & b;
+}
+
+static inline int64_t
+pyint64_op_or_sat(int64_t a, int64_t b)
+{
+    return a | b;
+}
+
+static inline int64_t
+pyint64_op_xor_sat(int64_t a, int64_t b)
+{
+    return a ^ b;
+}
+
+static inline int64_t
+pyint64_op_lshift_sat(int64_t a, int64_t b)
+{
+    int64_t result;
+    return pyint64_op_lshift_overflow(a, b, &result) ? (a < 0 ? INT64_MIN : INT64_MAX) : result;
+}
+
+static inline int64_t
+pyint64_op_rshift_sat(int64_t a, int64_t b)
+{
+    return pyint64_op_rshift(a, b);
+}
+
+static inline int64_t
+pyint64_op_pow_sat(int64_t a, int64_t b)
+{
+    int64_t result;
+    return pyint64_op_pow_overflow(a, b, &result) ? (a < 0 && (b & 1) ? INT64_MIN : INT64_MAX) : result;
+}
+
+static inline int64_t
+pyint64_op_neg_sat(int64_t a)
+{
+    return a == INT64_MIN ? INT64_MAX : -a;
+}
+
+static inline int64_t
+pyint64_op_abs_sat(int64_t a)
+{
+    return a == INT64_MIN ? INT64_MAX : pyint64_op_abs(a);
+}
+
+static inline int64_t
+pyint64_op_invert_sat(int64_t a)
+{
+    return ~a;
+}
+
+#endif // !PY_INT64OPS_H
@@ -0,0 +1,53 @@
+#ifndef PY_INT64POOL_H
+#define PY_INT64POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PY_SSIZE_T_CLEAN
+#include "Python.h"
+
+/*
+ * Thread pool for the bulk kernels.  A job is a range [0, n) cut into
+ * chunks of a fixed number of elements; chunk boundaries depend only on n
+ * and the grain, never on the thread count, so per-chunk partial results
+ * combined in chunk order are the same however many threads ran them.
+ *
+ * Every participating thread starts on its own contiguous run of chunks
+ * and steals from the runs of the others once it is done.  Tasks run
+ * without the GIL and must not touch Python objects or PyMem_Malloc.
+ */
+
+/*
+ * Process elements [begin, end) of chunk number chunk.  Returns a flag
+ * (overflow, error, ...), the flags of all chunks are or-ed together.
+ */
+typedef int (*PyInt64PoolTask)(Py_ssize_t begin, Py_ssize_t end, Py_ssize_t chunk, void *arg);
+
+// Chunk size in elements for streaming kernels, 256 KiB of int64.
+#define PYINT64_POOL_GRAIN ((Py_ssize_t)1 << 15)
+
+// Number of chunks a job of n elements is cut into.
+#define PyInt64Pool_CHUNKS(n, grain) (((n) + (grain) - 1) / (grain))
+
+// Whether a job of n elements is large enough to leave the GIL for.
+int PyInt64Pool_Parallel(Py_ssize_t n);
+
+/*
+ * Run task over every chunk of [0, n) and return the or of their flags.
+ * Called with the GIL held; below the parallel threshold the caller runs
+ * the chunks itself, otherwise the GIL is released and the pool helps.
+ */
+int PyInt64Pool_For(Py_ssize_t n, Py_ssize_t grain, PyInt64PoolTask task, void *arg);
+
+// Run tasks independent tasks (chunks of one element) without the GIL.
+int PyInt64Pool_Run(Py_ssize_t tasks, PyInt64PoolTask task, void *arg);
+
+// Add configure_threads and thread_info to the module.
+int PyInt64Pool_Init(PyObject*);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // !PY_INT64POOL_H
@@ -0,0 +1,17 @@
+#ifndef PY_INT64SCAN_H
+#define PY_INT64SCAN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PY_SSIZE_T_CLEAN
+#include "Python.h"
+
+// Add the prefix scan and sliding-window functions to the module.
+int PyInt64Scan_Init(PyObject*);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // !PY_INT64SCAN_H
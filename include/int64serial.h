@@ -0,0 +1,34 @@
+#ifndef PY_INT64SERIAL_H
+#define PY_INT64SERIAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PY_SSIZE_T_CLEAN
+#include "Python.h"
+
+/*
+ * Binary int64 sequence format, version 1.  A 16 byte header
+ *
+ *     0  magic     "PI64"
+ *     4  version   uint8
+ *     5  byteorder '<' or '>', order of the payload
+ *     6  itemsize  uint8, always 8
+ *     7  reserved  zero
+ *     8  count     uint64, little-endian
+ *
+ * followed by count int64 values.  dumps always writes '<', loads accepts
+ * both.  The payload starts 8 byte aligned if the data does.
+ */
+#define PYINT64_SERIAL_MAGIC "PI64"
+#define PYINT64_SERIAL_VERSION 1
+#define PYINT64_SERIAL_HEADER_SIZE 16
+
+// Add dumps and loads to the module.
+int PyInt64Serial_Init(PyObject*);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // !PY_INT64SERIAL_H
@@ -0,0 +1,28 @@
+#ifndef PY_INT64SET_H
+#define PY_INT64SET_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PY_SSIZE_T_CLEAN
+#include "Python.h"
+
+#include "int64state.h"
+#include "int64table.h"
+
+extern PyType_Spec PyInt64Set_Spec;
+
+typedef struct
+{
+    PyObject_HEAD
+
+    PyInt64Table table;
+} PyInt64SetObject;
+
+#define PyInt64Set_Check(ob) PYINT64_STATE_CHECK(ob, set_type)
+
+#ifdef __cplusplus
+}
+#endif
+#endif // !PY_INT64SET_H
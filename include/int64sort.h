@@ -0,0 +1,23 @@
+#ifndef PY_INT64SORT_H
+#define PY_INT64SORT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PY_SSIZE_T_CLEAN
+#include "Python.h"
+
+/*
+ * Stable LSD radix sort of n keys in place. When index is not NULL it is
+ * permuted along with the keys. Returns -1 with MemoryError set.
+ */
+int PyInt64Sort_Sort(int64_t *keys, int64_t *index, Py_ssize_t n);
+
+// Add sort and argsort to the module.
+int PyInt64Sort_Init(PyObject*);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // !PY_INT64SORT_H
@@ -0,0 +1,233 @@
+#ifndef PY_INT64STATE_H
+#define PY_INT64STATE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PY_SSIZE_T_CLEAN
+#include "Python.h"
+
+#include <stddef.h>
+
+/*
+ * Per-interpreter module state.
+ *
+ * The module uses multi-phase init, so every interpreter that imports it
+ * gets a module object of its own with its own heap types, exception
+ * class, small value cache and freelist.  Nothing in here is shared
+ * between interpreters, so interpreters with a GIL of their own never
+ * contend on it.
+ *
+ * Process-wide settings stay global on purpose: the kernel instruction
+ * set, the overflow policy and the thread pool configuration describe the
+ * machine and the process, not an interpreter.  They are atomics (see
+ * PYINT64_SETTING), as interpreters with a GIL of their own may change
+ * and read them at the same time.
+ *
+ * Slots, methods and the _Check macros reach the state through the type
+ * of an argument (PyInt64State_OfType), module functions through their
+ * module, so objects of a module that was imported again keep working
+ * with their own types.  Entry points without either (PyInt64_FromInt64)
+ * use PyInt64_State(): while a single interpreter has the module that is
+ * one load, otherwise it finds the state of the current interpreter
+ * through a registry and caches the answer per thread.  Objects can
+ * outlive the state, a module being torn down clears its types first;
+ * then allocations raise RuntimeError and the _Check macros answer false.
+ */
+#if defined(_MSC_VER)
+#define PYINT64_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__) && defined(__ELF__)
+// One pointer of static TLS saves the __tls_get_addr call of a dlopen'ed module.
+#define PYINT64_THREAD_LOCAL __thread __attribute__((tls_model("initial-exec")))
+#else
+#define PYINT64_THREAD_LOCAL _Thread_local
+#endif
+
+#if !defined(__STDC_NO_ATOMICS__) && !defined(_MSC_VER)
+#include <stdatomic.h>
+#define PYINT64_STATE_ATOMICS 1
+typedef _Atomic(uint64_t) PyInt64StateGeneration;
+typedef struct PyInt64State* _Atomic PyInt64StatePointer;
+#else
+// Interpreters are registered and looked up with the GIL held.
+#define PYINT64_STATE_ATOMICS 0
+typedef volatile uint64_t PyInt64StateGeneration;
+typedef struct PyInt64State* volatile PyInt64StatePointer;
+#endif
+
+#define PYINT64_NSMALLNEGINTS 256
+#define PYINT64_NSMALLPOSINTS 1025
+#define PYINT64_MAXFREELIST 1024
+
+// PYINT64_STAT_COUNT of int64stats.h, which includes this header.
+#define PYINT64_STAT_SLOTS 8
+
+/*
+ * The freelist serializes nothing with a GIL per interpreter, but the
+ * free-threaded build runs the threads of one interpreter in parallel.
+ * There it is left out: the allocator already keeps per-thread pages.
+ */
+#ifdef Py_GIL_DISABLED
+#define PYINT64_FREELIST 0
+#else
+#define PYINT64_FREELIST 1
+#endif
+
+typedef struct PyInt64State
+{
+    PyTypeObject* int64_type;
+    PyTypeObject* array_type;
+    PyTypeObject* dict_type;
+    PyTypeObject* counter_type;
+    PyTypeObject* set_type;
+    PyTypeObject* divisor_type;
+    PyTypeObject* column_type;
+    PyTypeObject* column_writer_type;
+    PyTypeObject* text_reader_type;
+    PyObject* parse_error;
+
+    // Small value cache and freelist of Pyint64 objects, see pyint64obj.c.
+    PyObject* small_values[PYINT64_NSMALLNEGINTS + PYINT64_NSMALLPOSINTS];
+    int small_values_enabled;
+
+    PyObject* free_list;
+    Py_ssize_t free_list_len;
+    Py_ssize_t free_list_max;
+
+    struct
+    {
+        uint64_t small_hits;
+        uint64_t freelist_hits;
+        uint64_t freelist_misses;
+        uint64_t freelist_returns;
+        uint64_t freelist_overflows;
+    } cache_stats;
+
+    // Totals of stats() at the last stats_reset(), one per PyInt64Stat.
+    uint64_t stats_baseline[PYINT64_STAT_SLOTS];
+
+    // Registry of the states of all interpreters, see int64state.c.
+    PyInterpreterState* interp;
+    struct PyInt64State* next;
+} PyInt64State;
+
+typedef struct
+{
+    PyInterpreterState* interp;
+    uint64_t generation;
+    PyInt64State* state;
+} PyInt64StateCache;
+
+extern PYINT64_THREAD_LOCAL PyInt64StateCache PyInt64State_Cache;
+
+// Bumped whenever a state is registered or goes away, invalidating every cache.
+extern PyInt64StateGeneration PyInt64State_Generation;
+
+// The registered state while there is exactly one, otherwise NULL.
+extern PyInt64StatePointer PyInt64State_Only;
+
+// Definition of the module, it tells heap types of the module from others.
+extern PyModuleDef PyInt64_ModuleDef;
+
+// Add state to the registry under the current interpreter.
+void PyInt64State_Register(PyInt64State*);
+
+// Remove state from the registry, if it is there.
+void PyInt64State_Unregister(PyInt64State*);
+
+// State of the current interpreter from the registry, refreshing the cache;
+// NULL without an exception if it has none.
+PyInt64State* PyInt64State_Lookup(void);
+
+// The registered state while there is exactly one, otherwise NULL.
+static inline PyInt64State*
+PyInt64State_Single(void)
+{
+#if PYINT64_STATE_ATOMICS
+    return atomic_load_explicit(&PyInt64State_Only, memory_order_acquire);
+#else
+    return PyInt64State_Only;
+#endif
+}
+
+static inline PyInt64State*
+PyInt64_State(void)
+{
+    PyInt64State* only = PyInt64State_Single();
+    if (only)
+    {
+        return only;
+    }
+
+    const PyInt64StateCache* cache = &PyInt64State_Cache;
+#if PYINT64_STATE_ATOMICS
+    const uint64_t generation =
+        atomic_load_explicit(&PyInt64State_Generation, memory_order_acquire);
+#else
+    const uint64_t generation = PyInt64State_Generation;
+#endif
+
+    if (cache->generation == generation && cache->interp == PyInterpreterState_Get())
+    {
+        return cache->state;
+    }
+
+    return PyInt64State_Lookup();
+}
+
+// State of the module that defined type or a base of it, else PyInt64_State().
+PyInt64State* PyInt64State_LookupType(PyTypeObject*);
+
+static inline PyInt64State*
+PyInt64State_OfType(PyTypeObject* type)
+{
+    // With a single state every type of the module belongs to it.
+    PyInt64State* only = PyInt64State_Single();
+    return only ? only : PyInt64State_LookupType(type);
+}
+
+// The type at offset in the state of ob's module, NULL if it has none.
+static inline PyTypeObject*
+PyInt64State_TypeOf(PyObject* ob, size_t offset)
+{
+    const PyInt64State* state = PyInt64State_OfType(Py_TYPE(ob));
+    return state ? *(PyTypeObject* const*)((const char*)state + offset) : NULL;
+}
+
+// The _Check and _CheckExact macros, member names a type of the state.
+#define PYINT64_STATE_CHECK(ob, member) \
+    PyInt64State_IsInstance((PyObject*)(ob), offsetof(PyInt64State, member))
+#define PYINT64_STATE_CHECK_EXACT(ob, member) \
+    PyInt64State_IsExact((PyObject*)(ob), offsetof(PyInt64State, member))
+
+static inline int
+PyInt64State_IsInstance(PyObject* ob, size_t offset)
+{
+    PyTypeObject* type = PyInt64State_TypeOf(ob, offset);
+    return type && PyObject_TypeCheck(ob, type);
+}
+
+static inline int
+PyInt64State_IsExact(PyObject* ob, size_t offset)
+{
+    PyTypeObject* type = PyInt64State_TypeOf(ob, offset);
+    return type && Py_IS_TYPE(ob, type);
+}
+
+/*
+ * State of the module that created type.  NULL without an exception for
+ * subclasses defined in Python, and once the garbage collector cleared
+ * the type.
+ */
+static inline PyInt64State*
+PyInt64State_FromType(PyTypeObject* type)
+{
+    PyObject* module = ((PyHeapTypeObject*)type)->ht_module;
+    return module ? (PyInt64State*)PyModule_GetState(module) : NULL;
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif // !PY_INT64STATE_H
@@ -0,0 +1,97 @@
+#ifndef PY_INT64STATS_H
+#define PY_INT64STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PY_SSIZE_T_CLEAN
+#include "Python.h"
+
+#include "int64state.h"
+
+/*
+ * Hot-path event counters, compiled in with -DPYINT64_STATS=1 (setup.py
+ * does that when PYINT64_STATS is set in the environment).  Without it
+ * PYINT64_STAT_INC expands to nothing.
+ *
+ * Every thread counts into a block of its own, found through a thread
+ * local pointer and taken from a list the first time the thread counts
+ * anything.  Only the owner writes a block; stats() sums all of them with
+ * relaxed loads, so incrementing is a plain load, add and store.  When a
+ * thread exits, its counts move into a retired total and the block goes
+ * back to the list, free for the next thread that registers.
+ */
+#ifndef PYINT64_STATS
+#define PYINT64_STATS 0
+#endif
+
+typedef enum
+{
+    PYINT64_STAT_ALLOC,             // Pyint64 objects allocated by PyInt64_FromInt64
+    PYINT64_STAT_FREE,              // Pyint64 objects deallocated
+    PYINT64_STAT_CONVERT_INT,       // int operands off the compact fast path
+    PYINT64_STAT_CONVERT_FLOAT,     // float operands
+    PYINT64_STAT_CONVERT_SUBCLASS,  // Pyint64 subclass operands
+    PYINT64_STAT_NOT_IMPLEMENTED,   // operands of other types
+    PYINT64_STAT_OVERFLOW,          // Pyint64 results that did not fit, any policy
+    PYINT64_STAT_ERROR,             // exceptions raised by the number slots
+    PYINT64_STAT_COUNT
+} PyInt64Stat;
+
+#if PYINT64_STATS
+
+#if !defined(__STDC_NO_ATOMICS__) && !defined(_MSC_VER)
+#include <stdatomic.h>
+#define PYINT64_STATS_ATOMICS 1
+typedef _Atomic(uint64_t) PyInt64StatCounter;
+#define PYINT64_STAT_LOAD(counter) atomic_load_explicit(&(counter), memory_order_relaxed)
+#define PYINT64_STAT_STORE(counter, value) \
+    atomic_store_explicit(&(counter), (value), memory_order_relaxed)
+#else
+// Counting only happens with the GIL held, which orders registration.
+#define PYINT64_STATS_ATOMICS 0
+typedef volatile uint64_t PyInt64StatCounter;
+#define PYINT64_STAT_LOAD(counter) (counter)
+#define PYINT64_STAT_STORE(counter, value) ((counter) = (value))
+#endif
+
+typedef struct PyInt64StatsBlock
+{
+    PyInt64StatCounter counts[PYINT64_STAT_COUNT];
+    int in_use;     // owned by a running thread, under the list lock
+    struct PyInt64StatsBlock *next;
+} PyInt64StatsBlock;
+
+extern PYINT64_THREAD_LOCAL PyInt64StatsBlock *PyInt64Stats_Local;
+
+// Claim a free block, or allocate one, for the calling thread; NULL if out of memory.
+PyInt64StatsBlock* PyInt64Stats_Register(void);
+
+static inline void
+PyInt64Stats_Inc(PyInt64Stat stat)
+{
+    PyInt64StatsBlock* block = PyInt64Stats_Local;
+    if (!block && !(block = PyInt64Stats_Register()))
+    {
+        return;
+    }
+
+    PYINT64_STAT_STORE(block->counts[stat], PYINT64_STAT_LOAD(block->counts[stat]) + 1);
+}
+
+#define PYINT64_STAT_INC(stat) PyInt64Stats_Inc(stat)
+
+#else
+
+#define PYINT64_STAT_INC(stat) ((void)0)
+
+#endif // PYINT64_STATS
+
+// Add stats and stats_reset to the module.
+int PyInt64Stats_Init(PyObject*);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // !PY_INT64STATS_H
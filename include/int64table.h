@@ -0,0 +1,71 @@
+#ifndef PY_INT64TABLE_H
+#define PY_INT64TABLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PY_SSIZE_T_CLEAN
+#include "Python.h"
+
+/*
+ * Flat open-addressing table of raw int64 keys shared by Int64Dict,
+ * Int64Counter and Int64Set.  Each slot has a control byte, zero when the
+ * slot is empty, otherwise 0x80 | the top 7 bits of the key hash, so most
+ * mismatching slots are rejected without touching the key array.  Probing
+ * is linear and deletion shifts the following cluster back, so there are
+ * no tombstones and a lookup always stops at the first empty slot.
+ */
+typedef union
+{
+    PyObject *object;
+    int64_t value;
+} PyInt64TableValue;
+
+typedef struct
+{
+    uint8_t *ctrl;
+    int64_t *keys;
+    PyInt64TableValue *values;  // NULL for sets
+    Py_ssize_t size;
+    Py_ssize_t capacity;        // zero or a power of two
+    int has_values;
+} PyInt64Table;
+
+// Draw the process-wide hash seed, once, before the first table is used.
+int PyInt64Table_Seed(void);
+
+void PyInt64Table_Init(PyInt64Table*, int has_values);
+
+// Free the storage, values are not released.
+void PyInt64Table_Free(PyInt64Table*);
+
+// Make room for n keys without rehashing.
+int PyInt64Table_Reserve(PyInt64Table*, Py_ssize_t n);
+
+// Slot of key, or -1 if absent.
+Py_ssize_t PyInt64Table_Lookup(const PyInt64Table*, int64_t key);
+
+/*
+ * Slot of key, adding it if absent (*inserted is then set and the new
+ * value is zeroed).  Returns -1 with MemoryError set on failure.
+ */
+Py_ssize_t PyInt64Table_Insert(PyInt64Table*, int64_t key, int *inserted);
+
+// Remove the entry in slot, its value must already be released.
+void PyInt64Table_DeleteSlot(PyInt64Table*, Py_ssize_t slot);
+
+/*
+ * Convert a key for a lookup: returns 1 with *key set, 0 if obj cannot be
+ * present (an int outside the int64 range, a float that is no int64, any
+ * other hashable object), -1 on error (unhashable objects raise TypeError,
+ * as in dict and set).
+ */
+int PyInt64Table_LookupKey(PyObject *obj, int64_t *key);
+
+#define PyInt64Table_SLOT_USED(table, slot) ((table)->ctrl[slot] != 0)
+
+#ifdef __cplusplus
+}
+#endif
+#endif // !PY_INT64TABLE_H
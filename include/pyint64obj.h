@@ -8,7 +8,10 @@ extern "C" {
 #define PY_SSIZE_T_CLEAN
 #include "Python.h"
 
-PyTypeObject PyInt64_Type;
+#include "int64state.h"
+
+// Spec of the Pyint64 heap type, created per module by PyInit_pyint64.
+extern PyType_Spec PyInt64_Spec;
 
 typedef struct
 {
@@ -24,11 +27,21 @@ PyObject* PyInt64_FromString(PyObject*);
 
 PyObject* PyInt64_FromInt64(int64_t);
 
+// PyInt64_FromInt64() for the module of state, from a slot or method.
+PyObject* PyInt64_FromInt64Ex(PyInt64State*, int64_t);
+
 PyObject* PyInt64_FromPyInt64(PyObject*);
 
+/*
+ * tp_dealloc of every Pyint64 type.  Subclasses defined in Python get
+ * subtype_dealloc instead, so comparing it is an exact type check that
+ * needs no module state.
+ */
+void PyInt64_Dealloc(PyObject*);
+
 // Public Macros
-#define PyInt64_Check(ob) (PyObject_TypeCheck(ob, &PyInt64_Type))
-#define PyInt64_CheckExact(ob) (Py_IS_TYPE(ob, &PyInt64_Type))
+#define PyInt64_CheckExact(ob) (Py_TYPE(ob)->tp_dealloc == PyInt64_Dealloc)
+#define PyInt64_Check(ob) (PyInt64_CheckExact(ob) || PYINT64_STATE_CHECK(ob, int64_type))
 #define PyInt64_GetValue(ob) (((PyInt64Object*)ob)->ob_int64val)
 
 #ifdef __cplusplus
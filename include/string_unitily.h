@@ -3,8 +3,31 @@
 
 #include <stdint.h>
 
+// Longest decimal int64, "-9223372036854775808".
+#define INT64_MAX_CHARS 20
+
+int unsignedDigitCount(uint64_t);
+
+int signedDigitCount(int64_t);
+
+// Write backwards so the last digit lands just before the given end.
 char* unsignedToString(uint64_t, char*);
 
+// Write into a buffer of at least 21 chars, returns the first char.
 char* signedToString(int64_t, char*);
 
-#endif //!PY_LONGLONG_STRING_UNITILY
\ No newline at end of file
+// Write forwards from first, returns one past the last char.
+char* signedToChars(int64_t, char*);
+
+typedef enum
+{
+    PARSE_INT64_OK,
+    PARSE_INT64_INVALID,
+    PARSE_INT64_OVERFLOW
+} ParseInt64Status;
+
+// Parse an optionally signed run of ASCII digits at the start of
+// [first, last), *end is set one past the last digit consumed.
+ParseInt64Status parseInt64(const char*, const char*, int64_t*, const char**);
+
+#endif //!PY_LONGLONG_STRING_UNITILY
@@ -19,6 +19,14 @@ def get_sources(current_path: str, extension: tuple[str, ...] | str = '') -> [st
 
     return ret
 
+def get_macros() -> [tuple[str, str]]:
+        # PYINT64_STATS=1 in the environment compiles in the stats() counters.
+        if os.environ.get('PYINT64_STATS', '0') not in ('', '0'):
+            return [('PYINT64_STATS', '1')]
+
+        return []
+
+
 def main():
         setup(
             name="PyInt64", 
@@ -29,7 +37,8 @@ def main():
             url='www.GTerm.com',
             license='LICENSE',
             ext_modules=[
-                Extension('pyint64', get_sources(os.getcwd(), ('.cpp', '.c', '.cc', '.cxx')), get_includes())
+                Extension('pyint64', get_sources(os.getcwd(), ('.cpp', '.c', '.cc', '.cxx')), get_includes(),
+                          define_macros=get_macros())
             ]
         )
 
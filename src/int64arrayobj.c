@@ -0,0 +1,1866 @@
+#include <stdbool.h>
+#include <string.h>
+
+#include "pyint64obj.h"
+#include "int64arrayobj.h"
+#include "int64kernels.h"
+#include "int64ops.h"
+#include "int64modpow.h"
+#include "int64pool.h"
+
+#define CHECK_RESIZABLE(self, ret)                                          \
+    do {                                                                    \
+        if ((self)->ob_owner)                                                \
+        {                                                                   \
+            PyErr_SetString(PyExc_BufferError,                              \
+                "Int64Array view cannot be re-sized");                      \
+            return ret;                                                     \
+        }                                                                   \
+        if ((self)->ob_source)                                              \
+        {                                                                   \
+            PyErr_SetString(PyExc_BufferError,                              \
+                "Int64Array over a foreign buffer cannot be re-sized");     \
+            return ret;                                                     \
+        }                                                                   \
+        if ((self)->ob_exports > 0)                                         \
+        {                                                                   \
+            PyErr_SetString(PyExc_BufferError,                              \
+                "Existing exports of data: object cannot be re-sized");     \
+            return ret;                                                     \
+        }                                                                   \
+    } while (0)
+
+#define ARRAY_ROOT(self) \
+    ((self)->ob_owner ? (PyInt64ArrayObject*)(self)->ob_owner : (self))
+
+#define ARRAY_READONLY(self) \
+    (ARRAY_ROOT(self)->ob_source && ARRAY_ROOT(self)->ob_source->readonly)
+
+#define CHECK_WRITABLE(self, ret)                                           \
+    do {                                                                    \
+        if (ARRAY_READONLY(self))                                           \
+        {                                                                   \
+            PyErr_SetString(PyExc_TypeError,                                \
+                "cannot modify read-only Int64Array");                      \
+            return ret;                                                     \
+        }                                                                   \
+    } while (0)
+
+
+static PyObject *
+int64array_new(PyTypeObject *type, PyObject *args, PyObject *kwds);
+
+static void
+int64array_dealloc(PyInt64ArrayObject *self);
+
+static PyObject *
+int64array_repr(PyInt64ArrayObject *self);
+
+static Py_ssize_t
+int64array_length(PyInt64ArrayObject *self);
+
+static PyObject *
+int64array_item(PyInt64ArrayObject *self, Py_ssize_t index);
+
+static int
+int64array_ass_item(PyInt64ArrayObject *self, Py_ssize_t index, PyObject *value);
+
+static PyObject *
+int64array_subscript(PyInt64ArrayObject *self, PyObject *item);
+
+static int
+int64array_ass_subscript(PyInt64ArrayObject *self, PyObject *item, PyObject *value);
+
+static int
+int64array_getbuffer(PyInt64ArrayObject *self, Py_buffer *view, int flags);
+
+static void
+int64array_releasebuffer(PyInt64ArrayObject *self, Py_buffer *view);
+
+static PyObject *
+int64array_append(PyInt64ArrayObject *self, PyObject *value);
+
+static PyObject *
+int64array_extend(PyInt64ArrayObject *self, PyObject *iterable);
+
+static PyObject *
+int64array_copy(PyInt64ArrayObject *self, PyObject *unused);
+
+static PyObject *
+int64array_tolist(PyInt64ArrayObject *self, PyObject *unused);
+
+static PyObject *
+int64array_frombuffer(PyTypeObject *type, PyObject *args, PyObject *kwds);
+
+static PyObject *
+int64array_asarray(PyTypeObject *type, PyObject *args, PyObject *kwds);
+
+static PyObject *
+int64array_frompickle(PyTypeObject *type, PyObject *data);
+
+static PyObject *
+int64array_reduce_ex(PyInt64ArrayObject *self, PyObject *arg);
+
+static PyObject *
+int64array_binary_op(PyObject *left, PyObject *right, PyInt64BinaryOp op,
+                     PyInt64ArrayObject *inplace);
+
+static PyObject *
+int64array_unary_op(PyInt64ArrayObject *self, PyInt64UnaryOp op);
+
+#define DEFINE_ARRAY_BINARY_SLOT(name, op)                                      \
+    static PyObject *                                                           \
+    int64array_##name(PyObject *left, PyObject *right)                          \
+    {                                                                           \
+        return int64array_binary_op(left, right, op, NULL);                     \
+    }                                                                           \
+    static PyObject *                                                           \
+    int64array_inplace_##name(PyObject *left, PyObject *right)                  \
+    {                                                                           \
+        return int64array_binary_op(left, right, op, (PyInt64ArrayObject*)left);\
+    }
+
+#define DEFINE_ARRAY_UNARY_SLOT(name, op)                                       \
+    static PyObject *                                                           \
+    int64array_##name(PyObject *self)                                           \
+    {                                                                           \
+        return int64array_unary_op((PyInt64ArrayObject*)self, op);              \
+    }
+
+DEFINE_ARRAY_BINARY_SLOT(add, PYINT64_OP_ADD)
+DEFINE_ARRAY_BINARY_SLOT(sub, PYINT64_OP_SUB)
+DEFINE_ARRAY_BINARY_SLOT(mul, PYINT64_OP_MUL)
+DEFINE_ARRAY_BINARY_SLOT(floor_divide, PYINT64_OP_FLOORDIV)
+DEFINE_ARRAY_BINARY_SLOT(remainder, PYINT64_OP_MOD)
+DEFINE_ARRAY_BINARY_SLOT(and, PYINT64_OP_AND)
+DEFINE_ARRAY_BINARY_SLOT(or, PYINT64_OP_OR)
+DEFINE_ARRAY_BINARY_SLOT(xor, PYINT64_OP_XOR)
+DEFINE_ARRAY_BINARY_SLOT(lshift, PYINT64_OP_LSHIFT)
+DEFINE_ARRAY_BINARY_SLOT(rshift, PYINT64_OP_RSHIFT)
+DEFINE_ARRAY_UNARY_SLOT(negative, PYINT64_OP_NEG)
+DEFINE_ARRAY_UNARY_SLOT(absolute, PYINT64_OP_ABS)
+DEFINE_ARRAY_UNARY_SLOT(invert, PYINT64_OP_INVERT)
+
+static
+PyMethodDef int64array_methods[] =
+{
+    {"append", (PyCFunction)int64array_append, METH_O,
+        "Append a single int64 value to the end of the array."},
+    {"extend", (PyCFunction)int64array_extend, METH_O,
+        "Append all values from an iterable or an int64 buffer."},
+    {"copy", (PyCFunction)int64array_copy, METH_NOARGS,
+        "Return a new contiguous array owning a copy of the values."},
+    {"tolist", (PyCFunction)int64array_tolist, METH_NOARGS,
+        "Return the values as a list of Pyint64."},
+    {"frombuffer", (PyCFunction)(void(*)(void))int64array_frombuffer,
+        METH_VARARGS | METH_KEYWORDS | METH_CLASS,
+        "frombuffer(data, copy=False)\n"
+        "Array over the raw little-endian int64 values in a bytes-like object.\n"
+        "An aligned buffer is used without copying unless copy is true, the\n"
+        "array is then read-only if data is."},
+    {"asarray", (PyCFunction)(void(*)(void))int64array_asarray,
+        METH_VARARGS | METH_KEYWORDS | METH_CLASS,
+        "asarray(data, copy=False)\n"
+        "Array over the items of a buffer exporter (array.array('q'), mmap,\n"
+        "memoryview, ...) with format q, l or Q in any byte order, or over the\n"
+        "native-order values in a buffer of bytes (bytes, mmap, ...) whose size\n"
+        "is a multiple of 8. An aligned C-contiguous buffer in native order is\n"
+        "used without copying unless copy is true, keeping data alive and\n"
+        "read-only if data is; anything else is copied once. Q items are taken\n"
+        "as two's complement."},
+    {"_frompickle", (PyCFunction)int64array_frompickle, METH_O | METH_CLASS,
+        "_frompickle(data)\n"
+        "Unpickle protocol 5 data: a payload stored in the pickle is copied,\n"
+        "a buffer passed out-of-band is used without copying."},
+    {"__reduce_ex__", (PyCFunction)int64array_reduce_ex, METH_O,
+        "Pickle support, protocol 5 passes the values as a PickleBuffer."},
+    {NULL} /* sentinel */
+};
+
+// Type object.
+static
+PyType_Slot int64array_slots[] =
+{
+    {Py_tp_doc, "Int64Array(iterable=(), /)\n"
+                "Contiguous array of int64 values supporting the buffer protocol."},
+    {Py_tp_dealloc, int64array_dealloc},
+    {Py_tp_repr, int64array_repr},
+    {Py_tp_hash, PyObject_HashNotImplemented},
+    {Py_tp_getattro, PyObject_GenericGetAttr},
+    {Py_tp_methods, int64array_methods},
+    {Py_tp_new, int64array_new},
+    {Py_nb_add, int64array_add},
+    {Py_nb_subtract, int64array_sub},
+    {Py_nb_multiply, int64array_mul},
+    {Py_nb_remainder, int64array_remainder},
+    {Py_nb_power, PyInt64Array_Power},
+    {Py_nb_negative, int64array_negative},
+    {Py_nb_positive, int64array_copy},
+    {Py_nb_absolute, int64array_absolute},
+    {Py_nb_invert, int64array_invert},
+    {Py_nb_lshift, int64array_lshift},
+    {Py_nb_rshift, int64array_rshift},
+    {Py_nb_and, int64array_and},
+    {Py_nb_xor, int64array_xor},
+    {Py_nb_or, int64array_or},
+    {Py_nb_floor_divide, int64array_floor_divide},
+    {Py_nb_inplace_add, int64array_inplace_add},
+    {Py_nb_inplace_subtract, int64array_inplace_sub},
+    {Py_nb_inplace_multiply, int64array_inplace_mul},
+    {Py_nb_inplace_remainder, int64array_inplace_remainder},
+    {Py_nb_inplace_lshift, int64array_inplace_lshift},
+    {Py_nb_inplace_rshift, int64array_inplace_rshift},
+    {Py_nb_inplace_and, int64array_inplace_and},
+    {Py_nb_inplace_xor, int64array_inplace_xor},
+    {Py_nb_inplace_or, int64array_inplace_or},
+    {Py_nb_inplace_floor_divide, int64array_inplace_floor_divide},
+    {Py_sq_length, int64array_length},
+    {Py_sq_item, int64array_item},
+    {Py_sq_ass_item, int64array_ass_item},
+    {Py_mp_length, int64array_length},
+    {Py_mp_subscript, int64array_subscript},
+    {Py_mp_ass_subscript, int64array_ass_subscript},
+    {Py_bf_getbuffer, int64array_getbuffer},
+    {Py_bf_releasebuffer, int64array_releasebuffer},
+    {0, NULL}
+};
+
+PyType_Spec PyInt64Array_Spec =
+{
+    .name = "pyint64.Int64Array",
+    .basicsize = sizeof(PyInt64ArrayObject),
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_SEQUENCE,
+    .slots = int64array_slots,
+};
+
+int PyInt64_IsInt64Format(const Py_buffer* view)
+{
+    if (view->itemsize != sizeof(int64_t))
+    {
+        return 0;
+    }
+
+    if (!view->format)
+    {
+        return 0;
+    }
+
+    const char* format = view->format;
+    if (*format == '@' || *format == '=')
+    {
+        ++format;
+    }
+#if PY_LITTLE_ENDIAN
+    else if (*format == '<')
+    {
+        ++format;
+    }
+#else
+    else if (*format == '>' || *format == '!')
+    {
+        ++format;
+    }
+#endif
+
+    return (format[0] == 'q' || format[0] == 'l') && format[1] == '\0';
+}
+
+int PyInt64Buffer_Get(PyObject* obj, PyInt64Buffer* buffer)
+{
+    memset(buffer, 0, sizeof(*buffer));
+
+    if (PyObject_CheckBuffer(obj))
+    {
+        if (PyObject_GetBuffer(obj, &buffer->view, PyBUF_FORMAT | PyBUF_C_CONTIGUOUS) == 0)
+        {
+            if (PyInt64_IsInt64Format(&buffer->view))
+            {
+                buffer->items = buffer->view.buf;
+                buffer->length = buffer->view.len / (Py_ssize_t)sizeof(int64_t);
+                return 0;
+            }
+
+            PyBuffer_Release(&buffer->view);
+        }
+        else
+        {
+            PyErr_Clear();
+        }
+    }
+
+    buffer->temp = PyInt64Array_New(0);
+    if (!buffer->temp)
+    {
+        return -1;
+    }
+
+    if (PyInt64Array_Extend(buffer->temp, obj) < 0)
+    {
+        Py_CLEAR(buffer->temp);
+        return -1;
+    }
+
+    buffer->items = ((PyInt64ArrayObject*)buffer->temp)->ob_item;
+    buffer->length = PyInt64Array_GET_SIZE(buffer->temp);
+    return 0;
+}
+
+void PyInt64Buffer_Release(PyInt64Buffer* buffer)
+{
+    PyBuffer_Release(&buffer->view);
+    Py_CLEAR(buffer->temp);
+    buffer->items = NULL;
+    buffer->length = 0;
+}
+
+int PyInt64Buffer_GetWritable(PyObject* obj, const char* name, Py_buffer* view)
+{
+    if (PyObject_GetBuffer(obj, view, PyBUF_WRITABLE | PyBUF_FORMAT | PyBUF_C_CONTIGUOUS) < 0)
+    {
+        return -1;
+    }
+
+    if (!PyInt64_IsInt64Format(view))
+    {
+        PyErr_Format(PyExc_TypeError, "%s() out must be an int64 buffer, not format '%s'",
+            name, view->format ? view->format : "B");
+        PyBuffer_Release(view);
+        return -1;
+    }
+
+    return 0;
+}
+
+static PyInt64ArrayObject *
+int64array_alloc(PyTypeObject *type, Py_ssize_t size)
+{
+    if (size < 0)
+    {
+        PyErr_BadInternalCall();
+        return NULL;
+    }
+
+    if ((size_t)size > PY_SSIZE_T_MAX / sizeof(int64_t))
+    {
+        PyErr_NoMemory();
+        return NULL;
+    }
+
+    PyInt64ArrayObject* self = (PyInt64ArrayObject*)type->tp_alloc(type, 0);
+    if (!self)
+    {
+        return NULL;
+    }
+
+    self->ob_step = 1;
+    self->ob_stride = sizeof(int64_t);
+
+    if (size > 0)
+    {
+        self->ob_item = PyMem_Malloc(size * sizeof(int64_t));
+        if (!self->ob_item)
+        {
+            Py_DECREF(self);
+            PyErr_NoMemory();
+            return NULL;
+        }
+    }
+
+    self->ob_length = size;
+    self->allocated = size;
+    return self;
+}
+
+PyObject*
+PyInt64Array_New(Py_ssize_t size)
+{
+    return PyInt64Array_NewEx(PyInt64_State(), size);
+}
+
+PyObject*
+PyInt64Array_NewEx(PyInt64State *state, Py_ssize_t size)
+{
+    // No module in this interpreter, or one torn down under live objects.
+    if (!state || !state->array_type)
+    {
+        PyErr_SetString(PyExc_RuntimeError, "pyint64 is not initialized in this interpreter");
+        return NULL;
+    }
+
+    return (PyObject*)int64array_alloc(state->array_type, size);
+}
+
+static int
+int64array_reserve(PyInt64ArrayObject *self, Py_ssize_t newsize)
+{
+    if (newsize <= self->allocated)
+    {
+        return 0;
+    }
+
+    // Amortized growth, same shape as list_resize.
+    size_t new_allocated = (size_t)newsize + ((size_t)newsize >> 3) + 6;
+    if (new_allocated > (size_t)PY_SSIZE_T_MAX / sizeof(int64_t))
+    {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    int64_t* items = PyMem_Realloc(self->ob_item, new_allocated * sizeof(int64_t));
+    if (!items)
+    {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    self->ob_item = items;
+    self->allocated = (Py_ssize_t)new_allocated;
+    return 0;
+}
+
+int PyInt64Array_Resize(PyObject* array, Py_ssize_t newsize)
+{
+    if (!PyInt64Array_Check(array) || newsize < 0)
+    {
+        PyErr_BadInternalCall();
+        return -1;
+    }
+
+    PyInt64ArrayObject* self = (PyInt64ArrayObject*)array;
+    CHECK_RESIZABLE(self, -1);
+
+    if (int64array_reserve(self, newsize) < 0)
+    {
+        return -1;
+    }
+
+    self->ob_length = newsize;
+    return 0;
+}
+
+int PyInt64Array_Append(PyObject* array, int64_t value)
+{
+    PyInt64ArrayObject* self = (PyInt64ArrayObject*)array;
+    const Py_ssize_t length = self->ob_length;
+
+    if (PyInt64Array_Resize(array, length + 1) < 0)
+    {
+        return -1;
+    }
+
+    self->ob_item[length] = value;
+    return 0;
+}
+
+// Convert one item, with the common exact types checked first.
+static inline int
+int64array_item_value(PyObject *item, int64_t *value)
+{
+    if (PyInt64_CheckExact(item))
+    {
+        *value = PyInt64_GetValue(item);
+        return 0;
+    }
+
+    if (PyLong_CheckExact(item))
+    {
+        // Walks the digits, PyLong_AsLongLong goes through a byte array.
+        int overflow;
+        *value = PyLong_AsLongLongAndOverflow(item, &overflow);
+        if (overflow)
+        {
+            PyErr_SetString(PyExc_OverflowError, "int too big to convert");
+            return -1;
+        }
+    }
+    else
+    {
+        *value = PyInt64_AsInt64(item);
+    }
+
+    return (*value == -1 && PyErr_Occurred()) ? -1 : 0;
+}
+
+static int
+int64array_extend_sequence(PyInt64ArrayObject *self, PyObject *sequence)
+{
+    const Py_ssize_t length = self->ob_length;
+    const Py_ssize_t count = PySequence_Fast_GET_SIZE(sequence);
+
+    if (PyInt64Array_Resize((PyObject*)self, length + count) < 0)
+    {
+        return -1;
+    }
+
+    // __index__ may run Python code that changes the list or grows self,
+    // so items are re-read by index and stored only after converting.
+    for (Py_ssize_t index = 0; index < PySequence_Fast_GET_SIZE(sequence) && index < count; ++index)
+    {
+        int64_t value;
+        PyObject* item = Py_NewRef(PySequence_Fast_GET_ITEM(sequence, index));
+        const int failed = int64array_item_value(item, &value);
+        Py_DECREF(item);
+        if (failed)
+        {
+            return -1;
+        }
+
+        self->ob_item[length + index] = value;
+    }
+
+    if (PySequence_Fast_GET_SIZE(sequence) < count)
+    {
+        PyErr_SetString(PyExc_RuntimeError, "list changed size during iteration");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int
+int64array_extend_iterable(PyInt64ArrayObject *self, PyObject *iterable)
+{
+    if (PyList_CheckExact(iterable) || PyTuple_CheckExact(iterable))
+    {
+        return int64array_extend_sequence(self, iterable);
+    }
+
+    PyObject* iterator = PyObject_GetIter(iterable);
+    if (!iterator)
+    {
+        return -1;
+    }
+
+    const Py_ssize_t hint = PyObject_LengthHint(iterable, 0);
+    if (hint < 0 || int64array_reserve(self, self->ob_length + hint) < 0)
+    {
+        Py_DECREF(iterator);
+        return -1;
+    }
+
+    PyObject* item;
+    while ((item = PyIter_Next(iterator)) != NULL)
+    {
+        int64_t value;
+        const int failed = int64array_item_value(item, &value);
+        Py_DECREF(item);
+        if (failed)
+        {
+            Py_DECREF(iterator);
+            return -1;
+        }
+
+        if (PyInt64Array_Append((PyObject*)self, value) < 0)
+        {
+            Py_DECREF(iterator);
+            return -1;
+        }
+    }
+
+    Py_DECREF(iterator);
+    return PyErr_Occurred() ? -1 : 0;
+}
+
+int PyInt64Array_Extend(PyObject* array, PyObject* iterable)
+{
+    if (!PyInt64Array_Check(array))
+    {
+        PyErr_BadInternalCall();
+        return -1;
+    }
+
+    PyInt64ArrayObject* self = (PyInt64ArrayObject*)array;
+    CHECK_RESIZABLE(self, -1);
+
+    const Py_ssize_t length = self->ob_length;
+
+    if (PyInt64Array_Check(iterable))
+    {
+        PyInt64ArrayObject* other = (PyInt64ArrayObject*)iterable;
+        const Py_ssize_t count = other->ob_length;
+
+        // Reserve first, other may be self and its items may move.
+        if (PyInt64Array_Resize(array, length + count) < 0)
+        {
+            return -1;
+        }
+
+        const int64_t* src = other->ob_item;
+        if (other->ob_step == 1)
+        {
+            memcpy(self->ob_item + length, src, count * sizeof(int64_t));
+        }
+        else
+        {
+            for (Py_ssize_t index = 0; index < count; ++index)
+            {
+                self->ob_item[length + index] = src[index * other->ob_step];
+            }
+        }
+
+        return 0;
+    }
+
+    if (PyObject_CheckBuffer(iterable))
+    {
+        Py_buffer view;
+        if (PyObject_GetBuffer(iterable, &view, PyBUF_FORMAT | PyBUF_C_CONTIGUOUS) == 0)
+        {
+            if (PyInt64_IsInt64Format(&view))
+            {
+                const Py_ssize_t count = view.len / (Py_ssize_t)sizeof(int64_t);
+                if (PyInt64Array_Resize(array, length + count) < 0)
+                {
+                    PyBuffer_Release(&view);
+                    return -1;
+                }
+
+                memcpy(self->ob_item + length, view.buf, count * sizeof(int64_t));
+                PyBuffer_Release(&view);
+                return 0;
+            }
+
+            PyBuffer_Release(&view);
+        }
+        else
+        {
+            // Not contiguous, the iterator protocol still works.
+            PyErr_Clear();
+        }
+    }
+
+    if (int64array_extend_iterable(self, iterable) < 0)
+    {
+        self->ob_length = length;
+        return -1;
+    }
+
+    return 0;
+}
+
+static PyObject *
+int64array_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    PyObject* initializer = NULL;
+
+    if (kwds && PyDict_GET_SIZE(kwds) != 0)
+    {
+        PyErr_SetString(PyExc_TypeError, "Int64Array() takes no keyword arguments");
+        return NULL;
+    }
+
+    if (!PyArg_UnpackTuple(args, "Int64Array", 0, 1, &initializer))
+    {
+        return NULL;
+    }
+
+    PyInt64ArrayObject* self = int64array_alloc(type, 0);
+    if (!self)
+    {
+        return NULL;
+    }
+
+    if (initializer && PyInt64Array_Extend((PyObject*)self, initializer) < 0)
+    {
+        Py_DECREF(self);
+        return NULL;
+    }
+
+    return (PyObject*)self;
+}
+
+static void
+int64array_dealloc(PyInt64ArrayObject *self)
+{
+    if (self->ob_owner)
+    {
+        --((PyInt64ArrayObject*)self->ob_owner)->ob_exports;
+        Py_DECREF(self->ob_owner);
+    }
+    else if (self->ob_source)
+    {
+        PyBuffer_Release(self->ob_source);
+        PyMem_Free(self->ob_source);
+    }
+    else
+    {
+        PyMem_Free(self->ob_item);
+    }
+
+    PyTypeObject* type = Py_TYPE(self);
+    type->tp_free((PyObject*)self);
+    Py_DECREF(type);
+}
+
+static PyObject *
+int64array_repr(PyInt64ArrayObject *self)
+{
+    if (self->ob_length == 0)
+    {
+        return PyUnicode_FromFormat("%s()", _PyType_Name(Py_TYPE(self)));
+    }
+
+    PyObject* list = int64array_tolist(self, NULL);
+    if (!list)
+    {
+        return NULL;
+    }
+
+    PyObject* result = PyUnicode_FromFormat("%s(%R)", _PyType_Name(Py_TYPE(self)), list);
+    Py_DECREF(list);
+    return result;
+}
+
+static Py_ssize_t
+int64array_length(PyInt64ArrayObject *self)
+{
+    return self->ob_length;
+}
+
+static PyObject *
+int64array_item(PyInt64ArrayObject *self, Py_ssize_t index)
+{
+    PyInt64State* state = PyInt64State_OfType(Py_TYPE(self));
+    if (index < 0 || index >= self->ob_length)
+    {
+        PyErr_SetString(PyExc_IndexError, "Int64Array index out of range");
+        return NULL;
+    }
+
+    return PyInt64_FromInt64Ex(state, PyInt64Array_GET_ITEM(self, index));
+}
+
+static int
+int64array_ass_item(PyInt64ArrayObject *self, Py_ssize_t index, PyObject *value)
+{
+    if (index < 0 || index >= self->ob_length)
+    {
+        PyErr_SetString(PyExc_IndexError, "Int64Array assignment index out of range");
+        return -1;
+    }
+
+    if (!value)
+    {
+        PyErr_SetString(PyExc_TypeError, "Int64Array does not support item deletion");
+        return -1;
+    }
+
+    CHECK_WRITABLE(self, -1);
+
+    const int64_t val = PyInt64_AsInt64(value);
+    if (val == -1 && PyErr_Occurred())
+    {
+        return -1;
+    }
+
+    PyInt64Array_GET_ITEM(self, index) = val;
+    return 0;
+}
+
+static PyObject *
+int64array_slice(PyInt64ArrayObject *self, Py_ssize_t start, Py_ssize_t step,
+                 Py_ssize_t length)
+{
+    PyInt64ArrayObject* root = ARRAY_ROOT(self);
+    const PyInt64State* state = PyInt64State_OfType(Py_TYPE(self));
+    if (!state || !state->array_type)
+    {
+        PyErr_SetString(PyExc_RuntimeError, "pyint64 is not initialized in this interpreter");
+        return NULL;
+    }
+
+    PyTypeObject* type = state->array_type;
+    PyInt64ArrayObject* view = (PyInt64ArrayObject*)type->tp_alloc(type, 0);
+    if (!view)
+    {
+        return NULL;
+    }
+
+    view->ob_item = self->ob_item + start * self->ob_step;
+    view->ob_length = length;
+    view->ob_step = self->ob_step * step;
+    view->ob_stride = view->ob_step * (Py_ssize_t)sizeof(int64_t);
+    view->ob_owner = Py_NewRef(root);
+    ++root->ob_exports;
+    return (PyObject*)view;
+}
+
+static PyObject *
+int64array_subscript(PyInt64ArrayObject *self, PyObject *item)
+{
+    if (PyIndex_Check(item))
+    {
+        Py_ssize_t index = PyNumber_AsSsize_t(item, PyExc_IndexError);
+        if (index == -1 && PyErr_Occurred())
+        {
+            return NULL;
+        }
+
+        if (index < 0)
+        {
+            index += self->ob_length;
+        }
+
+        return int64array_item(self, index);
+    }
+
+    if (PySlice_Check(item))
+    {
+        Py_ssize_t start, stop, step;
+        if (PySlice_Unpack(item, &start, &stop, &step) < 0)
+        {
+            return NULL;
+        }
+
+        const Py_ssize_t length = PySlice_AdjustIndices(self->ob_length, &start, &stop, step);
+        return int64array_slice(self, start, step, length);
+    }
+
+    PyErr_Format(PyExc_TypeError,
+        "Int64Array indices must be integers or slices, not %.200s",
+        Py_TYPE(item)->tp_name);
+    return NULL;
+}
+
+static int
+int64array_ass_subscript(PyInt64ArrayObject *self, PyObject *item, PyObject *value)
+{
+    PyInt64State* state = PyInt64State_OfType(Py_TYPE(self));
+    if (PyIndex_Check(item))
+    {
+        Py_ssize_t index = PyNumber_AsSsize_t(item, PyExc_IndexError);
+        if (index == -1 && PyErr_Occurred())
+        {
+            return -1;
+        }
+
+        if (index < 0)
+        {
+            index += self->ob_length;
+        }
+
+        return int64array_ass_item(self, index, value);
+    }
+
+    if (!PySlice_Check(item))
+    {
+        PyErr_Format(PyExc_TypeError,
+            "Int64Array indices must be integers or slices, not %.200s",
+            Py_TYPE(item)->tp_name);
+        return -1;
+    }
+
+    if (!value)
+    {
+        PyErr_SetString(PyExc_TypeError, "Int64Array does not support item deletion");
+        return -1;
+    }
+
+    CHECK_WRITABLE(self, -1);
+
+    Py_ssize_t start, stop, step;
+    if (PySlice_Unpack(item, &start, &stop, &step) < 0)
+    {
+        return -1;
+    }
+
+    const Py_ssize_t length = PySlice_AdjustIndices(self->ob_length, &start, &stop, step);
+
+    // Materialize the source first so overlapping views of self are safe.
+    PyInt64ArrayObject* source = (PyInt64ArrayObject*)PyInt64Array_NewEx(state, 0);
+    if (!source)
+    {
+        return -1;
+    }
+
+    if (PyInt64Array_Extend((PyObject*)source, value) < 0)
+    {
+        Py_DECREF(source);
+        return -1;
+    }
+
+    if (source->ob_length != length)
+    {
+        PyErr_Format(PyExc_ValueError,
+            "attempt to assign sequence of size %zd to slice of size %zd",
+            source->ob_length, length);
+        Py_DECREF(source);
+        return -1;
+    }
+
+    int64_t* first = self->ob_item + start * self->ob_step;
+    const Py_ssize_t stride = self->ob_step * step;
+    for (Py_ssize_t index = 0; index < length; ++index)
+    {
+        first[index * stride] = source->ob_item[index];
+    }
+
+    Py_DECREF(source);
+    return 0;
+}
+
+static int
+int64array_getbuffer(PyInt64ArrayObject *self, Py_buffer *view, int flags)
+{
+    if (self->ob_step != 1 && self->ob_length > 1
+        && ((flags & PyBUF_STRIDES) != PyBUF_STRIDES
+            || (flags & PyBUF_C_CONTIGUOUS) == PyBUF_C_CONTIGUOUS
+            || (flags & PyBUF_F_CONTIGUOUS) == PyBUF_F_CONTIGUOUS
+            || (flags & PyBUF_ANY_CONTIGUOUS) == PyBUF_ANY_CONTIGUOUS))
+    {
+        PyErr_SetString(PyExc_BufferError, "Int64Array view is not contiguous");
+        return -1;
+    }
+
+    const int readonly = ARRAY_READONLY(self);
+    if (readonly && (flags & PyBUF_WRITABLE) == PyBUF_WRITABLE)
+    {
+        PyErr_SetString(PyExc_BufferError, "Int64Array is not writable");
+        return -1;
+    }
+
+    view->obj = Py_NewRef(self);
+    view->buf = self->ob_item;
+    view->len = self->ob_length * (Py_ssize_t)sizeof(int64_t);
+    view->readonly = readonly;
+    view->itemsize = sizeof(int64_t);
+    view->format = (flags & PyBUF_FORMAT) ? "q" : NULL;
+    view->ndim = 1;
+    view->shape = (flags & PyBUF_ND) ? &self->ob_length : NULL;
+    view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? &self->ob_stride : NULL;
+    view->suboffsets = NULL;
+    view->internal = NULL;
+
+    ++ARRAY_ROOT(self)->ob_exports;
+    return 0;
+}
+
+static void
+int64array_releasebuffer(PyInt64ArrayObject *self, Py_buffer *view)
+{
+    --ARRAY_ROOT(self)->ob_exports;
+}
+
+static PyObject *
+int64array_append(PyInt64ArrayObject *self, PyObject *value)
+{
+    const int64_t val = PyInt64_AsInt64(value);
+    if (val == -1 && PyErr_Occurred())
+    {
+        return NULL;
+    }
+
+    if (PyInt64Array_Append((PyObject*)self, val) < 0)
+    {
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+int64array_extend(PyInt64ArrayObject *self, PyObject *iterable)
+{
+    if (PyInt64Array_Extend((PyObject*)self, iterable) < 0)
+    {
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+int64array_copy(PyInt64ArrayObject *self, PyObject *unused)
+{
+    PyInt64State* state = PyInt64State_OfType(Py_TYPE(self));
+    PyObject* result = PyInt64Array_NewEx(state, 0);
+    if (!result)
+    {
+        return NULL;
+    }
+
+    if (PyInt64Array_Extend(result, (PyObject*)self) < 0)
+    {
+        Py_DECREF(result);
+        return NULL;
+    }
+
+    return result;
+}
+
+static PyObject *
+int64array_tolist(PyInt64ArrayObject *self, PyObject *unused)
+{
+    PyInt64State* state = PyInt64State_OfType(Py_TYPE(self));
+    PyObject* list = PyList_New(self->ob_length);
+    if (!list)
+    {
+        return NULL;
+    }
+
+    for (Py_ssize_t index = 0; index < self->ob_length; ++index)
+    {
+        PyObject* item = PyInt64_FromInt64Ex(state, PyInt64Array_GET_ITEM(self, index));
+        if (!item)
+        {
+            Py_DECREF(list);
+            return NULL;
+        }
+
+        PyList_SET_ITEM(list, index, item);
+    }
+
+    return list;
+}
+
+// Array using count items at first in view, taking over view.
+static PyObject *
+int64array_over_view(Py_buffer *view, int64_t *first, Py_ssize_t count)
+{
+    PyInt64ArrayObject* self = (PyInt64ArrayObject*)PyInt64Array_New(0);
+    if (!self)
+    {
+        return NULL;
+    }
+
+    self->ob_item = first;
+    self->ob_length = count;
+    self->ob_source = view;
+    return (PyObject*)self;
+}
+
+PyObject* PyInt64Array_FromRaw(PyObject *obj, Py_ssize_t offset, Py_ssize_t count,
+                               int little_endian, int copy)
+{
+    Py_buffer* view = PyMem_Malloc(sizeof(Py_buffer));
+    if (!view)
+    {
+        return PyErr_NoMemory();
+    }
+
+    if (PyObject_GetBuffer(obj, view, PyBUF_SIMPLE) < 0)
+    {
+        PyMem_Free(view);
+        return NULL;
+    }
+
+    if (offset < 0 || count < 0 || offset > view->len
+        || count > (view->len - offset) / (Py_ssize_t)sizeof(int64_t))
+    {
+        PyErr_SetString(PyExc_ValueError, "int64 data out of buffer bounds");
+        goto error;
+    }
+
+    const char* first = (const char*)view->buf + offset;
+    const int swap = little_endian != PY_LITTLE_ENDIAN;
+
+    if (!copy && !swap && ((uintptr_t)first % sizeof(int64_t)) == 0)
+    {
+        PyObject* self = int64array_over_view(view, (int64_t*)first, count);
+        if (!self)
+        {
+            goto error;
+        }
+
+        return self;
+    }
+
+    PyInt64ArrayObject* self = (PyInt64ArrayObject*)PyInt64Array_New(count);
+    if (!self)
+    {
+        goto error;
+    }
+
+    memcpy(self->ob_item, first, count * sizeof(int64_t));
+    if (swap)
+    {
+        for (Py_ssize_t index = 0; index < count; ++index)
+        {
+            self->ob_item[index] = pyint64_op_bswap(self->ob_item[index]);
+        }
+    }
+
+    PyBuffer_Release(view);
+    PyMem_Free(view);
+    return (PyObject*)self;
+
+error:
+    PyBuffer_Release(view);
+    PyMem_Free(view);
+    return NULL;
+}
+
+/*
+ * Byte order of the items of an 8-byte integer buffer: 0 native, 1
+ * swapped, -1 for any other format.
+ */
+static int
+int64array_buffer_order(const Py_buffer *view)
+{
+    if (view->itemsize != sizeof(int64_t) || !view->format)
+    {
+        return -1;
+    }
+
+    const char* format = view->format;
+    int swapped = 0;
+    switch (*format)
+    {
+    case '@':
+    case '=':
+        ++format;
+        break;
+    case '<':
+        swapped = !PY_LITTLE_ENDIAN;
+        ++format;
+        break;
+    case '>':
+    case '!':
+        swapped = PY_LITTLE_ENDIAN;
+        ++format;
+        break;
+    }
+
+    if ((format[0] != 'q' && format[0] != 'l' && format[0] != 'Q') || format[1] != '\0')
+    {
+        return -1;
+    }
+
+    return swapped;
+}
+
+// Whether the items of a buffer are single bytes, like those of bytes or mmap.
+static int
+int64array_buffer_is_bytes(const Py_buffer *view)
+{
+    if (view->itemsize != 1)
+    {
+        return 0;
+    }
+
+    const char* format = view->format ? view->format : "B";
+    if (*format == '@' || *format == '=' || *format == '<' || *format == '>' || *format == '!')
+    {
+        ++format;
+    }
+
+    return (format[0] == 'B' || format[0] == 'b' || format[0] == 'c') && format[1] == '\0';
+}
+
+PyObject* PyInt64Array_FromBuffer(PyObject *obj, int copy)
+{
+    Py_buffer* view = PyMem_Malloc(sizeof(Py_buffer));
+    if (!view)
+    {
+        return PyErr_NoMemory();
+    }
+
+    if (PyObject_GetBuffer(obj, view, PyBUF_RECORDS_RO) < 0)
+    {
+        PyMem_Free(view);
+        return NULL;
+    }
+
+    int swap = int64array_buffer_order(view);
+    if (swap < 0 && int64array_buffer_is_bytes(view))
+    {
+        // Raw bytes hold native-order values, misaligned ones get copied below.
+        if (view->len % (Py_ssize_t)sizeof(int64_t) != 0)
+        {
+            PyErr_Format(PyExc_ValueError,
+                "buffer size must be a multiple of 8, not %zd", view->len);
+            goto error;
+        }
+
+        swap = 0;
+    }
+    else if (swap < 0)
+    {
+        PyErr_Format(PyExc_TypeError,
+            "Int64Array needs a buffer of 8-byte integers (format q, l or Q) "
+            "or of bytes, not '%s'",
+            view->format ? view->format : "B");
+        goto error;
+    }
+
+    const Py_ssize_t count = view->len / (Py_ssize_t)sizeof(int64_t);
+    const int contiguous = PyBuffer_IsContiguous(view, 'C');
+
+    if (!copy && !swap && contiguous && ((uintptr_t)view->buf % sizeof(int64_t)) == 0)
+    {
+        PyObject* self = int64array_over_view(view, view->buf, count);
+        if (!self)
+        {
+            goto error;
+        }
+
+        return self;
+    }
+
+    PyInt64ArrayObject* self = (PyInt64ArrayObject*)PyInt64Array_New(count);
+    if (!self)
+    {
+        goto error;
+    }
+
+    if (contiguous)
+    {
+        memcpy(self->ob_item, view->buf, count * sizeof(int64_t));
+    }
+    else if (PyBuffer_ToContiguous(self->ob_item, view, view->len, 'C') < 0)
+    {
+        Py_DECREF(self);
+        goto error;
+    }
+
+    if (swap)
+    {
+        PyInt64Kernels_Get()->bits[PYINT64_OP_BSWAP](self->ob_item, self->ob_item, count);
+    }
+
+    PyBuffer_Release(view);
+    PyMem_Free(view);
+    return (PyObject*)self;
+
+error:
+    PyBuffer_Release(view);
+    PyMem_Free(view);
+    return NULL;
+}
+
+// Array over the raw little-endian int64 values in data.
+static PyObject *
+int64array_from_raw_data(PyObject *data, int copy)
+{
+    Py_buffer view;
+    if (PyObject_GetBuffer(data, &view, PyBUF_SIMPLE) < 0)
+    {
+        return NULL;
+    }
+
+    const Py_ssize_t length = view.len;
+    PyBuffer_Release(&view);
+
+    if (length % (Py_ssize_t)sizeof(int64_t) != 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "buffer size must be a multiple of 8");
+        return NULL;
+    }
+
+    return PyInt64Array_FromRaw(data, 0, length / (Py_ssize_t)sizeof(int64_t), 1, copy);
+}
+
+static PyObject *
+int64array_frombuffer(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"data", "copy", NULL};
+    PyObject* data;
+    int copy = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|p:frombuffer", kwlist, &data, &copy))
+    {
+        return NULL;
+    }
+
+    return int64array_from_raw_data(data, copy);
+}
+
+static PyObject *
+int64array_frompickle(PyTypeObject *type, PyObject *data)
+{
+    // An in-band PickleBuffer loads as a bytearray (bytes if it was
+    // read-only) that only the unpickler holds; a view over it could never
+    // grow.  Out-of-band buffers belong to the caller and stay shared.
+    const int copy = PyByteArray_CheckExact(data) || PyBytes_CheckExact(data);
+    return int64array_from_raw_data(data, copy);
+}
+
+static PyObject *
+int64array_asarray(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"data", "copy", NULL};
+    PyObject* data;
+    int copy = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|p:asarray", kwlist, &data, &copy))
+    {
+        return NULL;
+    }
+
+    return PyInt64Array_FromBuffer(data, copy);
+}
+
+static PyObject *
+int64array_reduce_ex(PyInt64ArrayObject *self, PyObject *arg)
+{
+    const long protocol = PyLong_AsLong(arg);
+    if (protocol == -1 && PyErr_Occurred())
+    {
+        return NULL;
+    }
+
+    const int pickle_buffer = protocol >= 5 && PY_LITTLE_ENDIAN;
+    const PyInt64State* state = PyInt64State_OfType(Py_TYPE(self));
+    PyObject* frombuffer = state && state->array_type ?
+        PyObject_GetAttrString((PyObject*)state->array_type,
+                               pickle_buffer ? "_frompickle" : "frombuffer") : NULL;
+    if (!frombuffer)
+    {
+        return NULL;
+    }
+
+    PyObject* data;
+    PyObject* result = NULL;
+
+    if (pickle_buffer)
+    {
+        // Out-of-band capable: hand pickle the values themselves.
+        PyObject* source = self->ob_step == 1
+            ? Py_NewRef(self)
+            : int64array_copy(self, NULL);
+        if (!source)
+        {
+            goto done;
+        }
+
+        data = PyPickleBuffer_FromObject(source);
+        Py_DECREF(source);
+        if (data)
+        {
+            result = Py_BuildValue("N(N)", frombuffer, data);
+            frombuffer = NULL;
+        }
+
+        goto done;
+    }
+
+    data = PyBytes_FromStringAndSize(NULL, self->ob_length * (Py_ssize_t)sizeof(int64_t));
+    if (!data)
+    {
+        goto done;
+    }
+
+    int64_t* out = (int64_t*)PyBytes_AS_STRING(data);
+    for (Py_ssize_t index = 0; index < self->ob_length; ++index)
+    {
+        const int64_t value = PyInt64Array_GET_ITEM(self, index);
+        out[index] = PY_LITTLE_ENDIAN ? value : pyint64_op_bswap(value);
+    }
+
+    // Copy on load, an in-band bytes payload would make the array read-only.
+    result = Py_BuildValue("N(NO)", frombuffer, data, Py_True);
+    frombuffer = NULL;
+
+done:
+    Py_XDECREF(frombuffer);
+    return result;
+}
+
+/* Int64Array Number Methods */
+
+/*
+ * Return a pointer to the values of self laid out contiguously.  Views
+ * with a step are gathered into a temporary block stored in *temp, which
+ * the caller releases with PyMem_Free.  NULL only on error: empty arrays
+ * own no block, so they get a temporary one too.
+ */
+static int64_t *
+int64array_contiguous(PyInt64ArrayObject *self, int64_t **temp)
+{
+    *temp = NULL;
+    if (self->ob_step == 1 && self->ob_item)
+    {
+        return self->ob_item;
+    }
+
+    int64_t* buffer = PyMem_Malloc(Py_MAX(self->ob_length, 1) * sizeof(int64_t));
+    if (!buffer)
+    {
+        PyErr_NoMemory();
+        return NULL;
+    }
+
+    for (Py_ssize_t index = 0; index < self->ob_length; ++index)
+    {
+        buffer[index] = PyInt64Array_GET_ITEM(self, index);
+    }
+
+    *temp = buffer;
+    return buffer;
+}
+
+static void
+int64array_scatter(PyInt64ArrayObject *self, const int64_t *values)
+{
+    for (Py_ssize_t index = 0; index < self->ob_length; ++index)
+    {
+        PyInt64Array_GET_ITEM(self, index) = values[index];
+    }
+}
+
+// Return 1 for an array operand, 0 for a scalar stored in *value, -1 otherwise.
+static int
+int64array_classify(PyObject *obj, int64_t *value)
+{
+    if (PyInt64Array_Check(obj))
+    {
+        return 1;
+    }
+
+    if (PyInt64_Check(obj) || PyIndex_Check(obj))
+    {
+        *value = PyInt64_AsInt64(obj);
+        if (*value == -1 && PyErr_Occurred())
+        {
+            return -2;
+        }
+
+        return 0;
+    }
+
+    return -1;
+}
+
+// One element-wise kernel call, split into chunks over the thread pool.
+typedef struct
+{
+    PyInt64BinaryKernel binary;
+    PyInt64BinaryScalarKernel binary_scalar;
+    PyInt64ScalarBinaryKernel scalar_binary;
+    PyInt64UnaryKernel unary;
+    const int64_t* a_items;
+    const int64_t* b_items;
+    int64_t a_value;
+    int64_t b_value;
+    int64_t* out;
+} int64array_kernel_job;
+
+static int
+int64array_kernel_task(Py_ssize_t begin, Py_ssize_t end, Py_ssize_t chunk, void *arg)
+{
+    const int64array_kernel_job* job = arg;
+    const Py_ssize_t length = end - begin;
+    int64_t* out = job->out + begin;
+
+    if (job->unary)
+    {
+        return job->unary(job->a_items + begin, out, length);
+    }
+
+    if (job->binary)
+    {
+        return job->binary(job->a_items + begin, job->b_items + begin, out, length);
+    }
+
+    if (job->binary_scalar)
+    {
+        return job->binary_scalar(job->a_items + begin, job->b_value, out, length);
+    }
+
+    return job->scalar_binary(job->a_value, job->b_items + begin, out, length);
+}
+
+/*
+ * Whether n items at a and at b share memory without being the same items:
+ * an element-wise kernel writing b would then read results as operands.
+ */
+static inline int
+int64array_overlaps(const int64_t *a, const int64_t *b, Py_ssize_t n)
+{
+    const uintptr_t begin_a = (uintptr_t)a;
+    const uintptr_t begin_b = (uintptr_t)b;
+    const uintptr_t size = (uintptr_t)n * sizeof(int64_t);
+    return a && begin_a != begin_b && begin_a < begin_b + size && begin_b < begin_a + size;
+}
+
+// Keep an operand from being re-sized while a kernel runs without the GIL.
+static inline void
+int64array_pin(PyInt64ArrayObject *self, Py_ssize_t delta)
+{
+    if (self)
+    {
+        ARRAY_ROOT(self)->ob_exports += delta;
+    }
+}
+
+static PyObject *
+int64array_binary_op(PyObject *left, PyObject *right, PyInt64BinaryOp op,
+                     PyInt64ArrayObject *inplace)
+{
+    int64_t a_value = 0;
+    int64_t b_value = 0;
+
+    const int a_kind = int64array_classify(left, &a_value);
+    if (a_kind == -2)
+    {
+        return NULL;
+    }
+
+    const int b_kind = int64array_classify(right, &b_value);
+    if (b_kind == -2)
+    {
+        return NULL;
+    }
+
+    if (a_kind < 0 || b_kind < 0)
+    {
+        Py_RETURN_NOTIMPLEMENTED;
+    }
+
+    if (inplace)
+    {
+        CHECK_WRITABLE(inplace, NULL);
+    }
+
+    PyInt64ArrayObject* a = a_kind ? (PyInt64ArrayObject*)left : NULL;
+    PyInt64ArrayObject* b = b_kind ? (PyInt64ArrayObject*)right : NULL;
+    const Py_ssize_t length = a ? a->ob_length : b->ob_length;
+
+    if (a && b && a->ob_length != b->ob_length)
+    {
+        PyErr_Format(PyExc_ValueError,
+            "Int64Array operands have different lengths (%zd and %zd)",
+            a->ob_length, b->ob_length);
+        return NULL;
+    }
+
+    int64_t* a_temp = NULL;
+    int64_t* b_temp = NULL;
+    int64_t* out_temp = NULL;
+    const int64_t* a_items = NULL;
+    const int64_t* b_items = NULL;
+    PyInt64ArrayObject* result = NULL;
+
+    if (a && !(a_items = int64array_contiguous(a, &a_temp)))
+    {
+        goto error;
+    }
+
+    if (b && !(b_items = int64array_contiguous(b, &b_temp)))
+    {
+        goto error;
+    }
+
+    if (b ? PyInt64Kernels_CheckOperands(op, b_items, length) < 0
+          : PyInt64Kernels_CheckOperands(op, &b_value, 1) < 0)
+    {
+        goto error;
+    }
+
+    const PyInt64KernelMode mode = PyInt64Kernels_Mode();
+    int64_t* out;
+
+    if (inplace)
+    {
+        // Checked results only land in self once nothing overflowed, and
+        // results for a view of self shifted against it go through out_temp.
+        result = (PyInt64ArrayObject*)Py_NewRef(inplace);
+        if (inplace->ob_step == 1 && mode != PYINT64_KERNEL_CHECKED
+            && !int64array_overlaps(a_items, inplace->ob_item, length)
+            && !int64array_overlaps(b_items, inplace->ob_item, length))
+        {
+            out = inplace->ob_item;
+        }
+        else
+        {
+            out = out_temp = PyMem_Malloc(Py_MAX(length, 1) * sizeof(int64_t));
+            if (!out)
+            {
+                PyErr_NoMemory();
+                goto error;
+            }
+        }
+    }
+    else
+    {
+        result = (PyInt64ArrayObject*)PyInt64Array_NewEx(
+            PyInt64State_OfType(Py_TYPE(a ? a : b)), length);
+        if (!result)
+        {
+            goto error;
+        }
+
+        out = result->ob_item;
+    }
+
+    int64array_kernel_job job = {
+        .a_items = a_items,
+        .b_items = b_items,
+        .a_value = a_value,
+        .b_value = b_value,
+        .out = out,
+    };
+
+    if (a && b)
+    {
+        job.binary = PyInt64Kernels_Get()->binary[mode][op];
+    }
+    else if (a)
+    {
+        job.binary_scalar = PyInt64Kernels_Get()->binary_scalar[mode][op];
+    }
+    else
+    {
+        job.scalar_binary = PyInt64Kernels_Get()->scalar_binary[mode][op];
+    }
+
+    int64array_pin(a, 1);
+    int64array_pin(b, 1);
+    int64array_pin(inplace, 1);
+    const int overflow = PyInt64Pool_For(length, PYINT64_POOL_GRAIN,
+                                         int64array_kernel_task, &job);
+    int64array_pin(a, -1);
+    int64array_pin(b, -1);
+    int64array_pin(inplace, -1);
+
+    if (overflow)
+    {
+        PyErr_Format(PyExc_OverflowError, "int64 %s overflow in Int64Array",
+            PyInt64Kernels_BinaryOpName(op));
+        goto error;
+    }
+
+    if (out_temp)
+    {
+        int64array_scatter(inplace, out_temp);
+    }
+
+    PyMem_Free(a_temp);
+    PyMem_Free(b_temp);
+    PyMem_Free(out_temp);
+    return (PyObject*)result;
+
+error:
+    Py_XDECREF(result);
+    PyMem_Free(a_temp);
+    PyMem_Free(b_temp);
+    PyMem_Free(out_temp);
+    return NULL;
+}
+
+// Flags of int64array_power_task.
+#define INT64ARRAY_POWER_OVERFLOW 1
+#define INT64ARRAY_POWER_NEGATIVE 2
+#define INT64ARRAY_POWER_NOT_INVERTIBLE 4
+
+typedef struct
+{
+    const int64_t* base_items;
+    const int64_t* exponent_items;
+    int64_t base_value;
+    int64_t exponent_value;
+    const PyInt64Modulus* modulus;
+    PyInt64KernelMode mode;
+    int64_t* out;
+} int64array_power_job;
+
+static int
+int64array_power_task(Py_ssize_t begin, Py_ssize_t end, Py_ssize_t chunk, void *arg)
+{
+    const int64array_power_job* job = arg;
+    int flags = 0;
+
+#if PYINT64_HAVE_INT128
+    // A shared exponent and odd modulus take four bases at a time.
+    if (job->modulus && job->modulus->montgomery && !job->exponent_items
+        && job->exponent_value >= 0 && job->base_items)
+    {
+        for (; begin + 4 <= end; begin += 4)
+        {
+            uint64_t base[4];
+            uint64_t residue[4];
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                base[lane] = pyint64_modulus_reduce(job->base_items[begin + lane], job->modulus);
+            }
+
+            pyint64_modulus_pow_residues4(base, (uint64_t)job->exponent_value, job->modulus, residue);
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                job->out[begin + lane] = pyint64_modulus_result(residue[lane], job->modulus);
+            }
+        }
+    }
+#endif
+
+    for (Py_ssize_t index = begin; index < end; ++index)
+    {
+        const int64_t a = job->base_items ? job->base_items[index] : job->base_value;
+        const int64_t b = job->exponent_items ? job->exponent_items[index] : job->exponent_value;
+        int64_t* out = job->out + index;
+
+        if (job->modulus)
+        {
+            if (!pyint64_modulus_pow(a, b, job->modulus, out))
+            {
+                *out = 0;
+                flags |= INT64ARRAY_POWER_NOT_INVERTIBLE;
+            }
+        }
+        else if (b < 0)
+        {
+            *out = 0;
+            flags |= INT64ARRAY_POWER_NEGATIVE;
+        }
+        else if (pyint64_op_pow_overflow(a, b, out))
+        {
+            if (job->mode == PYINT64_KERNEL_SATURATE)
+            {
+                *out = a < 0 && (b & 1) ? INT64_MIN : INT64_MAX;
+            }
+            else if (job->mode == PYINT64_KERNEL_CHECKED)
+            {
+                flags |= INT64ARRAY_POWER_OVERFLOW;
+            }
+        }
+    }
+
+    return flags;
+}
+
+PyObject* PyInt64Array_Power(PyObject *base, PyObject *exponent, PyObject *modulus)
+{
+    int64_t base_value = 0;
+    int64_t exponent_value = 0;
+    int64_t modulus_value = 0;
+
+    const int base_kind = int64array_classify(base, &base_value);
+    if (base_kind == -2)
+    {
+        return NULL;
+    }
+
+    const int exponent_kind = int64array_classify(exponent, &exponent_value);
+    if (exponent_kind == -2)
+    {
+        return NULL;
+    }
+
+    const int modulus_kind = Py_IsNone(modulus) ? 0 : int64array_classify(modulus, &modulus_value);
+    if (modulus_kind == -2)
+    {
+        return NULL;
+    }
+
+    if (base_kind < 0 || exponent_kind < 0 || modulus_kind != 0 || (!base_kind && !exponent_kind))
+    {
+        Py_RETURN_NOTIMPLEMENTED;
+    }
+
+    PyInt64ArrayObject* a = base_kind ? (PyInt64ArrayObject*)base : NULL;
+    PyInt64ArrayObject* b = exponent_kind ? (PyInt64ArrayObject*)exponent : NULL;
+    const Py_ssize_t length = a ? a->ob_length : b->ob_length;
+
+    if (a && b && a->ob_length != b->ob_length)
+    {
+        PyErr_Format(PyExc_ValueError,
+            "Int64Array operands have different lengths (%zd and %zd)",
+            a->ob_length, b->ob_length);
+        return NULL;
+    }
+
+    PyInt64Modulus shared;
+    if (!Py_IsNone(modulus))
+    {
+        if (modulus_value == 0)
+        {
+            PyErr_SetString(PyExc_ValueError, "pow() 3rd argument cannot be 0");
+            return NULL;
+        }
+
+        pyint64_modulus_init(&shared, modulus_value);
+    }
+
+    int64_t* a_temp = NULL;
+    int64_t* b_temp = NULL;
+    PyInt64ArrayObject* result = NULL;
+    int64array_power_job job = {
+        .base_value = base_value,
+        .exponent_value = exponent_value,
+        .modulus = Py_IsNone(modulus) ? NULL : &shared,
+        .mode = PyInt64Kernels_Mode(),
+    };
+
+    if ((a && !(job.base_items = int64array_contiguous(a, &a_temp)))
+        || (b && !(job.exponent_items = int64array_contiguous(b, &b_temp)))
+        || !(result = (PyInt64ArrayObject*)PyInt64Array_NewEx(
+                 PyInt64State_OfType(Py_TYPE(a ? a : b)), length)))
+    {
+        goto error;
+    }
+
+    job.out = result->ob_item;
+    int64array_pin(a, 1);
+    int64array_pin(b, 1);
+    const int flags = PyInt64Pool_For(length, PYINT64_POOL_GRAIN, int64array_power_task, &job);
+    int64array_pin(a, -1);
+    int64array_pin(b, -1);
+
+    if (flags & INT64ARRAY_POWER_NOT_INVERTIBLE)
+    {
+        PyErr_SetString(PyExc_ValueError, "base is not invertible for the given modulus");
+        goto error;
+    }
+
+    if (flags & INT64ARRAY_POWER_NEGATIVE)
+    {
+        PyErr_SetString(PyExc_ValueError,
+            "negative exponent in Int64Array power without a modulus");
+        goto error;
+    }
+
+    if (flags & INT64ARRAY_POWER_OVERFLOW)
+    {
+        PyErr_SetString(PyExc_OverflowError, "int64 power overflow in Int64Array");
+        goto error;
+    }
+
+    PyMem_Free(a_temp);
+    PyMem_Free(b_temp);
+    return (PyObject*)result;
+
+error:
+    Py_XDECREF(result);
+    PyMem_Free(a_temp);
+    PyMem_Free(b_temp);
+    return NULL;
+}
+
+static PyObject *
+int64array_unary_op(PyInt64ArrayObject *self, PyInt64UnaryOp op)
+{
+    PyInt64State* state = PyInt64State_OfType(Py_TYPE(self));
+    int64_t* temp;
+    const int64_t* items = int64array_contiguous(self, &temp);
+    if (!items)
+    {
+        return NULL;
+    }
+
+    PyInt64ArrayObject* result = (PyInt64ArrayObject*)PyInt64Array_NewEx(state, self->ob_length);
+    if (result)
+    {
+        int64array_kernel_job job = {
+            .unary = PyInt64Kernels_Get()->unary[PyInt64Kernels_Mode()][op],
+            .a_items = items,
+            .out = result->ob_item,
+        };
+
+        int64array_pin(self, 1);
+        const int overflow = PyInt64Pool_For(self->ob_length, PYINT64_POOL_GRAIN,
+                                             int64array_kernel_task, &job);
+        int64array_pin(self, -1);
+
+        if (overflow)
+        {
+            PyErr_Format(PyExc_OverflowError, "int64 %s overflow in Int64Array",
+                PyInt64Kernels_UnaryOpName(op));
+            Py_CLEAR(result);
+        }
+    }
+
+    PyMem_Free(temp);
+    return (PyObject*)result;
+}
+
+/* Int64Array Number Methods End */
@@ -0,0 +1,746 @@
+#include "pyint64obj.h"
+#include "int64arrayobj.h"
+#include "int64kernels.h"
+#include "int64ops.h"
+#include "int64pool.h"
+#include "int64bulk.h"
+
+static PyObject *
+int64bulk_hash64(PyObject *module, PyObject *args, PyObject *kwds);
+
+static PyObject *
+int64bulk_sum(PyObject *module, PyObject *args, PyObject *kwds);
+
+static PyObject *
+int64bulk_prod(PyObject *module, PyObject *args, PyObject *kwds);
+
+static PyObject *
+int64bulk_min(PyObject *module, PyObject *values);
+
+static PyObject *
+int64bulk_max(PyObject *module, PyObject *values);
+
+static PyObject *
+int64bulk_argmin(PyObject *module, PyObject *values);
+
+static PyObject *
+int64bulk_argmax(PyObject *module, PyObject *values);
+
+static PyObject *
+int64bulk_bit_length(PyObject *module, PyObject *values);
+
+static PyObject *
+int64bulk_bit_count(PyObject *module, PyObject *values);
+
+static PyObject *
+int64bulk_clz(PyObject *module, PyObject *values);
+
+static PyObject *
+int64bulk_ctz(PyObject *module, PyObject *values);
+
+static PyObject *
+int64bulk_byteswap(PyObject *module, PyObject *values);
+
+static PyObject *
+int64bulk_rotl(PyObject *module, PyObject *args);
+
+static PyObject *
+int64bulk_rotr(PyObject *module, PyObject *args);
+
+static PyObject *
+int64bulk_pow(PyObject *module, PyObject *args, PyObject *kwds);
+
+static
+PyMethodDef int64bulk_methods[] =
+{
+    {
+        "hash64", (PyCFunction)(void(*)(void))int64bulk_hash64,
+        METH_VARARGS | METH_KEYWORDS,
+        "hash64(values, seed=0)\n"
+        "Return an Int64Array of 64-bit mixed hashes of values (an int64\n"
+        "buffer or any iterable of integers). The mixer is a bijection for a\n"
+        "given seed, so equal hashes mean equal values; use it for hash\n"
+        "partitioning and deduplication, not for dict keys."
+    },
+    {
+        "sum", (PyCFunction)(void(*)(void))int64bulk_sum,
+        METH_VARARGS | METH_KEYWORDS,
+        "sum(values, start=0)\n"
+        "Sum an int64 buffer or iterable of integers in C. The total is exact,\n"
+        "a result outside int64 follows the overflow policy: wrap, raise\n"
+        "OverflowError, clamp, or return an int for 'promote'."
+    },
+    {
+        "prod", (PyCFunction)(void(*)(void))int64bulk_prod,
+        METH_VARARGS | METH_KEYWORDS,
+        "prod(values, start=1)\n"
+        "Product of an int64 buffer or iterable of integers, a result outside\n"
+        "int64 follows the overflow policy like sum()."
+    },
+    {
+        "min", (PyCFunction)int64bulk_min, METH_O,
+        "min(values)\n"
+        "Smallest value of a non-empty int64 buffer or iterable."
+    },
+    {
+        "max", (PyCFunction)int64bulk_max, METH_O,
+        "max(values)\n"
+        "Largest value of a non-empty int64 buffer or iterable."
+    },
+    {
+        "argmin", (PyCFunction)int64bulk_argmin, METH_O,
+        "argmin(values)\n"
+        "Index of the first smallest value of a non-empty int64 buffer or iterable."
+    },
+    {
+        "argmax", (PyCFunction)int64bulk_argmax, METH_O,
+        "argmax(values)\n"
+        "Index of the first largest value of a non-empty int64 buffer or iterable."
+    },
+    {
+        "bit_length", (PyCFunction)int64bulk_bit_length, METH_O,
+        "bit_length(values)\n"
+        "Int64Array of Pyint64.bit_length() of every value."
+    },
+    {
+        "bit_count", (PyCFunction)int64bulk_bit_count, METH_O,
+        "bit_count(values)\n"
+        "Int64Array of Pyint64.bit_count() of every value."
+    },
+    {
+        "clz", (PyCFunction)int64bulk_clz, METH_O,
+        "clz(values)\n"
+        "Int64Array of the leading zero bits of every value, 64 for 0."
+    },
+    {
+        "ctz", (PyCFunction)int64bulk_ctz, METH_O,
+        "ctz(values)\n"
+        "Int64Array of the trailing zero bits of every value, 64 for 0."
+    },
+    {
+        "byteswap", (PyCFunction)int64bulk_byteswap, METH_O,
+        "byteswap(values)\n"
+        "Int64Array of every value with its byte order reversed."
+    },
+    {
+        "rotl", (PyCFunction)int64bulk_rotl, METH_VARARGS,
+        "rotl(values, n)\n"
+        "Int64Array of every value rotated left by n mod 64 bits."
+    },
+    {
+        "rotr", (PyCFunction)int64bulk_rotr, METH_VARARGS,
+        "rotr(values, n)\n"
+        "Int64Array of every value rotated right by n mod 64 bits."
+    },
+    {
+        "pow", (PyCFunction)(void(*)(void))int64bulk_pow,
+        METH_VARARGS | METH_KEYWORDS,
+        "pow(base, exponent, modulus=None)\n"
+        "Int64Array of base ** exponent, or pow(base, exponent, modulus), for\n"
+        "every element. base and exponent are int64 buffers or iterables of\n"
+        "the same length, or one of them an integer; modulus is an integer.\n"
+        "Without a modulus exponents must be >= 0 and overflow follows the\n"
+        "overflow policy, with one a negative exponent inverts the base."
+    },
+    {NULL} /* sentinel */
+};
+
+int PyInt64Bulk_Init(PyObject* module)
+{
+    return PyModule_AddFunctions(module, int64bulk_methods);
+}
+
+typedef struct
+{
+    PyInt64HashKernel hash;
+    const int64_t* items;
+    uint64_t seed;
+    int64_t* out;
+} int64bulk_hash_job;
+
+static int
+int64bulk_hash_task(Py_ssize_t begin, Py_ssize_t end, Py_ssize_t chunk, void *arg)
+{
+    const int64bulk_hash_job* job = arg;
+    job->hash(job->items + begin, job->seed, job->out + begin, end - begin);
+    return 0;
+}
+
+static PyObject *
+int64bulk_hash64(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"values", "seed", NULL};
+    PyInt64State* state = PyModule_GetState(module);
+    PyObject* values;
+    PyObject* seed_obj = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O!:hash64", kwlist,
+                                     &values, &PyLong_Type, &seed_obj))
+    {
+        return NULL;
+    }
+
+    // Any int is accepted as seed, only its low 64 bits are used.
+    uint64_t seed = 0;
+    if (seed_obj)
+    {
+        seed = PyLong_AsUnsignedLongLongMask(seed_obj);
+        if (seed == (uint64_t)-1 && PyErr_Occurred())
+        {
+            return NULL;
+        }
+    }
+
+    PyInt64Buffer buffer;
+    if (PyInt64Buffer_Get(values, &buffer) < 0)
+    {
+        return NULL;
+    }
+
+    PyObject* result = PyInt64Array_NewEx(state, buffer.length);
+    if (!result)
+    {
+        PyInt64Buffer_Release(&buffer);
+        return NULL;
+    }
+
+    int64bulk_hash_job job = {
+        PyInt64Kernels_Get()->hash, buffer.items, seed, ((PyInt64ArrayObject*)result)->ob_item
+    };
+    PyInt64Pool_For(buffer.length, PYINT64_POOL_GRAIN, int64bulk_hash_task, &job);
+
+    PyInt64Buffer_Release(&buffer);
+    return result;
+}
+
+/*
+ * 128-bit two's complement accumulator, wide enough for the exact sum of
+ * any number of int64 values that fits in memory.
+ */
+typedef struct
+{
+    uint64_t lo;
+    int64_t hi;
+} int64bulk_wide;
+
+static inline void
+int64bulk_wide_add(int64bulk_wide *acc, int64_t hi, uint64_t lo)
+{
+    const uint64_t low = acc->lo + lo;
+    acc->hi = pyint64_op_add(acc->hi, pyint64_op_add(hi, low < lo));
+    acc->lo = low;
+}
+
+static inline int
+int64bulk_wide_fits(const int64bulk_wide *acc)
+{
+    return acc->hi == ((int64_t)acc->lo >> 63);
+}
+
+static PyObject *
+int64bulk_wide_to_pylong(const int64bulk_wide *acc)
+{
+    PyObject* high = PyLong_FromLongLong(acc->hi);
+    PyObject* shift = PyLong_FromLong(64);
+    PyObject* low = PyLong_FromUnsignedLongLong(acc->lo);
+    PyObject* shifted = high && shift ? PyNumber_Lshift(high, shift) : NULL;
+    PyObject* result = shifted && low ? PyNumber_Add(shifted, low) : NULL;
+
+    Py_XDECREF(high);
+    Py_XDECREF(shift);
+    Py_XDECREF(low);
+    Py_XDECREF(shifted);
+    return result;
+}
+
+// Apply the overflow policy to an exact result that does not fit int64.
+static PyObject *
+int64bulk_overflow(PyObject *module, const char *name, int negative,
+                   PyObject *(*promote)(void *), void *arg)
+{
+    switch (PYINT64_SETTING_LOAD(PyInt64_OverflowPolicy))
+    {
+    case PYINT64_OVERFLOW_CHECKED:
+        PyErr_Format(PyExc_OverflowError, "int64 %s overflow", name);
+        return NULL;
+    case PYINT64_OVERFLOW_SATURATE:
+        return PyInt64_FromInt64Ex(PyModule_GetState(module), negative ? INT64_MIN : INT64_MAX);
+    case PYINT64_OVERFLOW_PROMOTE:
+        return promote(arg);
+    default:
+        Py_UNREACHABLE();
+    }
+}
+
+static PyObject *
+int64bulk_promote_wide(void *acc)
+{
+    return int64bulk_wide_to_pylong(acc);
+}
+
+/*
+ * Reductions cut their input into at most this many chunks and combine the
+ * per-chunk partial results in chunk order, so the result does not depend
+ * on the number of threads.
+ */
+#define INT64BULK_MAX_CHUNKS 1024
+
+static inline Py_ssize_t
+int64bulk_grain(Py_ssize_t length)
+{
+    return Py_MAX(PYINT64_POOL_GRAIN, PyInt64Pool_CHUNKS(length, INT64BULK_MAX_CHUNKS));
+}
+
+typedef struct
+{
+    const int64_t* items;
+    PyInt64SumKernel sum;
+    PyInt64FoldKernel fold;
+    int64_t init;
+    int64bulk_wide* sums;
+    int64_t* folds;
+} int64bulk_reduce_job;
+
+static int
+int64bulk_reduce_task(Py_ssize_t begin, Py_ssize_t end, Py_ssize_t chunk, void *arg)
+{
+    const int64bulk_reduce_job* job = arg;
+    if (!job->sum)
+    {
+        job->folds[chunk] = job->fold(job->items + begin, end - begin, job->init);
+        return 0;
+    }
+
+    int64bulk_wide acc = {0, 0};
+    for (Py_ssize_t first = begin; first < end; first += PYINT64_SUM_BLOCK)
+    {
+        int64_t hi;
+        int64_t lo;
+        job->sum(job->items + first, Py_MIN(end - first, PYINT64_SUM_BLOCK), &hi, &lo);
+
+        // hi * 2**32 + lo, lo is never negative.
+        int64bulk_wide_add(&acc, hi >> 32, (uint64_t)hi << 32);
+        int64bulk_wide_add(&acc, 0, (uint64_t)lo);
+    }
+
+    job->sums[chunk] = acc;
+    return 0;
+}
+
+// Exact 128-bit sum of items plus start.
+static int64bulk_wide
+int64bulk_sum_wide(const int64_t *items, Py_ssize_t length, int64_t start)
+{
+    int64bulk_wide sums[INT64BULK_MAX_CHUNKS];
+    int64bulk_reduce_job job = {.items = items, .sum = PyInt64Kernels_Get()->sum, .sums = sums};
+    const Py_ssize_t grain = int64bulk_grain(length);
+    PyInt64Pool_For(length, grain, int64bulk_reduce_task, &job);
+
+    int64bulk_wide acc = {(uint64_t)start, start >> 63};
+    for (Py_ssize_t chunk = 0; chunk < PyInt64Pool_CHUNKS(length, grain); ++chunk)
+    {
+        int64bulk_wide_add(&acc, sums[chunk].hi, sums[chunk].lo);
+    }
+
+    return acc;
+}
+
+/*
+ * Fold items with an associative kernel: every chunk starts from
+ * chunk_init, the partial results are folded again starting from init.
+ */
+static int64_t
+int64bulk_fold(PyInt64FoldKernel fold, const int64_t *items, Py_ssize_t length,
+               int64_t chunk_init, int64_t init)
+{
+    int64_t folds[INT64BULK_MAX_CHUNKS];
+    int64bulk_reduce_job job = {.items = items, .fold = fold, .init = chunk_init, .folds = folds};
+    const Py_ssize_t grain = int64bulk_grain(length);
+    PyInt64Pool_For(length, grain, int64bulk_reduce_task, &job);
+    return fold(folds, PyInt64Pool_CHUNKS(length, grain), init);
+}
+
+// Start value for sum/prod: an int in the int64 range, default when NULL.
+static int
+int64bulk_start(PyObject *obj, int64_t default_value, int64_t *start)
+{
+    *start = default_value;
+    if (!obj)
+    {
+        return 0;
+    }
+
+    *start = PyInt64_AsInt64(obj);
+    return (*start == -1 && PyErr_Occurred()) ? -1 : 0;
+}
+
+static PyObject *
+int64bulk_sum(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"values", "start", NULL};
+    PyInt64State* state = PyModule_GetState(module);
+    PyObject* values;
+    PyObject* start_obj = NULL;
+    int64_t start;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O:sum", kwlist, &values, &start_obj)
+        || int64bulk_start(start_obj, 0, &start) < 0)
+    {
+        return NULL;
+    }
+
+    PyInt64Buffer buffer;
+    if (PyInt64Buffer_Get(values, &buffer) < 0)
+    {
+        return NULL;
+    }
+
+    int64bulk_wide acc = int64bulk_sum_wide(buffer.items, buffer.length, start);
+    PyInt64Buffer_Release(&buffer);
+
+    if (PYINT64_SETTING_LOAD(PyInt64_OverflowPolicy) == PYINT64_OVERFLOW_WRAP
+        || int64bulk_wide_fits(&acc))
+    {
+        return PyInt64_FromInt64Ex(state, (int64_t)acc.lo);
+    }
+
+    return int64bulk_overflow(module, "sum", acc.hi < 0, int64bulk_promote_wide, &acc);
+}
+
+static inline int
+int64bulk_umul_overflow(uint64_t a, uint64_t b, uint64_t *result)
+{
+#if PYINT64_HAVE_BUILTIN_OVERFLOW
+    return __builtin_mul_overflow(a, b, result);
+#else
+    *result = a * b;
+    return b != 0 && a > UINT64_MAX / b;
+#endif
+}
+
+typedef struct
+{
+    const PyInt64Buffer *buffer;
+    int64_t start;
+} int64bulk_prod_args;
+
+static PyObject *
+int64bulk_promote_prod(void *arg)
+{
+    const int64bulk_prod_args* prod = arg;
+    PyObject* result = PyLong_FromLongLong(prod->start);
+
+    for (Py_ssize_t index = 0; result && index < prod->buffer->length; ++index)
+    {
+        PyObject* value = PyLong_FromLongLong(prod->buffer->items[index]);
+        PyObject* product = value ? PyNumber_Multiply(result, value) : NULL;
+        Py_XDECREF(value);
+        Py_SETREF(result, product);
+    }
+
+    return result;
+}
+
+static PyObject *
+int64bulk_prod(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"values", "start", NULL};
+    PyInt64State* state = PyModule_GetState(module);
+    PyObject* values;
+    PyObject* start_obj = NULL;
+    int64_t start;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O:prod", kwlist, &values, &start_obj)
+        || int64bulk_start(start_obj, 1, &start) < 0)
+    {
+        return NULL;
+    }
+
+    PyInt64Buffer buffer;
+    if (PyInt64Buffer_Get(values, &buffer) < 0)
+    {
+        return NULL;
+    }
+
+    PyObject* result;
+    if (PYINT64_SETTING_LOAD(PyInt64_OverflowPolicy) == PYINT64_OVERFLOW_WRAP)
+    {
+        result = PyInt64_FromInt64Ex(state,
+            int64bulk_fold(PyInt64Kernels_Get()->prod, buffer.items, buffer.length, 1, start));
+        PyInt64Buffer_Release(&buffer);
+        return result;
+    }
+
+    /*
+     * Track sign and magnitude: once no factor is zero the magnitude never
+     * shrinks, so it only overflows when the exact product does, and a
+     * magnitude of 2**63 still fits when the sign is negative.
+     */
+    uint64_t magnitude = (uint64_t)pyint64_op_abs(start);
+    int negative = start < 0;
+    int overflow = 0;
+    int zero = start == 0;
+
+    for (Py_ssize_t index = 0; index < buffer.length && !zero; ++index)
+    {
+        const int64_t value = buffer.items[index];
+        zero = value == 0;
+        negative ^= value < 0;
+        if (!overflow)
+        {
+            overflow = int64bulk_umul_overflow(magnitude, (uint64_t)pyint64_op_abs(value), &magnitude);
+        }
+    }
+
+    if (zero)
+    {
+        result = PyInt64_FromInt64Ex(state, 0);
+    }
+    else if (!overflow && magnitude <= (negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX))
+    {
+        result = PyInt64_FromInt64Ex(state, negative ? (int64_t)(0 - magnitude) : (int64_t)magnitude);
+    }
+    else
+    {
+        int64bulk_prod_args prod = {&buffer, start};
+        result = int64bulk_overflow(module, "product", negative, int64bulk_promote_prod, &prod);
+    }
+
+    PyInt64Buffer_Release(&buffer);
+    return result;
+}
+
+static int
+int64bulk_get_nonempty(PyObject *values, PyInt64Buffer *buffer, const char *name)
+{
+    if (PyInt64Buffer_Get(values, buffer) < 0)
+    {
+        return -1;
+    }
+
+    if (buffer->length == 0)
+    {
+        PyInt64Buffer_Release(buffer);
+        PyErr_Format(PyExc_ValueError, "%s() arg is an empty sequence", name);
+        return -1;
+    }
+
+    return 0;
+}
+
+static PyObject *
+int64bulk_extreme(PyObject *module, PyObject *values, const char *name, int largest, int want_index)
+{
+    PyInt64State* state = PyModule_GetState(module);
+    PyInt64Buffer buffer;
+    if (int64bulk_get_nonempty(values, &buffer, name) < 0)
+    {
+        return NULL;
+    }
+
+    const PyInt64FoldKernel fold = largest ? PyInt64Kernels_Get()->max : PyInt64Kernels_Get()->min;
+    const int64_t extreme = int64bulk_fold(fold, buffer.items, buffer.length,
+                                           buffer.items[0], buffer.items[0]);
+
+    PyObject* result;
+    if (want_index)
+    {
+        // A second, early exit pass is cheaper than tracking the index
+        // inside the vectorized fold.
+        Py_ssize_t index = 0;
+        while (buffer.items[index] != extreme)
+        {
+            ++index;
+        }
+
+        result = PyLong_FromSsize_t(index);
+    }
+    else
+    {
+        result = PyInt64_FromInt64Ex(state, extreme);
+    }
+
+    PyInt64Buffer_Release(&buffer);
+    return result;
+}
+
+static PyObject *
+int64bulk_min(PyObject *module, PyObject *values)
+{
+    return int64bulk_extreme(module, values, "min", 0, 0);
+}
+
+static PyObject *
+int64bulk_max(PyObject *module, PyObject *values)
+{
+    return int64bulk_extreme(module, values, "max", 1, 0);
+}
+
+static PyObject *
+int64bulk_argmin(PyObject *module, PyObject *values)
+{
+    return int64bulk_extreme(module, values, "argmin", 0, 1);
+}
+
+static PyObject *
+int64bulk_argmax(PyObject *module, PyObject *values)
+{
+    return int64bulk_extreme(module, values, "argmax", 1, 1);
+}
+
+typedef struct
+{
+    PyInt64BitKernel bits;
+    PyInt64RotateKernel rotl;
+    const int64_t* items;
+    int64_t shift;
+    int64_t* out;
+} int64bulk_bits_job;
+
+static int
+int64bulk_bits_task(Py_ssize_t begin, Py_ssize_t end, Py_ssize_t chunk, void *arg)
+{
+    const int64bulk_bits_job* job = arg;
+    if (job->bits)
+    {
+        job->bits(job->items + begin, job->out + begin, end - begin);
+    }
+    else
+    {
+        job->rotl(job->items + begin, job->shift, job->out + begin, end - begin);
+    }
+
+    return 0;
+}
+
+// Int64Array of a bit kernel applied to values, rotl by shift if op < 0.
+static PyObject *
+int64bulk_bits(PyObject *module, PyObject *values, int op, int64_t shift)
+{
+    PyInt64State* state = PyModule_GetState(module);
+    PyInt64Buffer buffer;
+    if (PyInt64Buffer_Get(values, &buffer) < 0)
+    {
+        return NULL;
+    }
+
+    PyObject* result = PyInt64Array_NewEx(state, buffer.length);
+    if (result)
+    {
+        int64bulk_bits_job job = {
+            .bits = op >= 0 ? PyInt64Kernels_Get()->bits[op] : NULL,
+            .rotl = PyInt64Kernels_Get()->rotl,
+            .items = buffer.items,
+            .shift = shift,
+            .out = ((PyInt64ArrayObject*)result)->ob_item,
+        };
+        PyInt64Pool_For(buffer.length, PYINT64_POOL_GRAIN, int64bulk_bits_task, &job);
+    }
+
+    PyInt64Buffer_Release(&buffer);
+    return result;
+}
+
+static PyObject *
+int64bulk_bit_length(PyObject *module, PyObject *values)
+{
+    return int64bulk_bits(module, values, PYINT64_OP_BIT_LENGTH, 0);
+}
+
+static PyObject *
+int64bulk_bit_count(PyObject *module, PyObject *values)
+{
+    return int64bulk_bits(module, values, PYINT64_OP_BIT_COUNT, 0);
+}
+
+static PyObject *
+int64bulk_clz(PyObject *module, PyObject *values)
+{
+    return int64bulk_bits(module, values, PYINT64_OP_CLZ, 0);
+}
+
+static PyObject *
+int64bulk_ctz(PyObject *module, PyObject *values)
+{
+    return int64bulk_bits(module, values, PYINT64_OP_CTZ, 0);
+}
+
+static PyObject *
+int64bulk_byteswap(PyObject *module, PyObject *values)
+{
+    return int64bulk_bits(module, values, PYINT64_OP_BSWAP, 0);
+}
+
+static PyObject *
+int64bulk_rotate(PyObject *module, PyObject *args, const char *format, int right)
+{
+    PyObject* values;
+    PyObject* count;
+    if (!PyArg_ParseTuple(args, format, &values, &count))
+    {
+        return NULL;
+    }
+
+    const int64_t shift = PyInt64_AsInt64(count);
+    if (shift == -1 && PyErr_Occurred())
+    {
+        return NULL;
+    }
+
+    return int64bulk_bits(module, values, -1, right ? pyint64_op_neg(shift) : shift);
+}
+
+static PyObject *
+int64bulk_rotl(PyObject *module, PyObject *args)
+{
+    return int64bulk_rotate(module, args, "OO:rotl", 0);
+}
+
+static PyObject *
+int64bulk_rotr(PyObject *module, PyObject *args)
+{
+    return int64bulk_rotate(module, args, "OO:rotr", 1);
+}
+
+// An integer is passed on as is, anything else is gathered into an Int64Array.
+static PyObject *
+int64bulk_pow_operand(PyObject *module, PyObject *value)
+{
+    if (PyInt64Array_Check(value) || PyInt64_Check(value) || PyIndex_Check(value))
+    {
+        return Py_NewRef(value);
+    }
+
+    const PyInt64State* state = PyModule_GetState(module);
+    return PyObject_CallOneArg((PyObject*)state->array_type, value);
+}
+
+static PyObject *
+int64bulk_pow(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"base", "exponent", "modulus", NULL};
+    PyObject* base;
+    PyObject* exponent;
+    PyObject* modulus = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OO|O:pow", kwlist,
+                                     &base, &exponent, &modulus))
+    {
+        return NULL;
+    }
+
+    base = int64bulk_pow_operand(module, base);
+    exponent = base ? int64bulk_pow_operand(module, exponent) : NULL;
+    PyObject* result = exponent ? PyInt64Array_Power(base, exponent, modulus) : NULL;
+
+    if (result == Py_NotImplemented)
+    {
+        Py_SETREF(result, NULL);
+        PyErr_SetString(PyExc_TypeError,
+            "pow() needs an int64 buffer operand and an integer modulus");
+    }
+
+    Py_XDECREF(base);
+    Py_XDECREF(exponent);
+    return result;
+}
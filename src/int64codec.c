@@ -0,0 +1,852 @@
+#include <string.h>
+
+#include "pyint64obj.h"
+#include "int64arrayobj.h"
+#include "int64kernels.h"
+#include "int64ops.h"
+#include "int64pool.h"
+#include "int64codec.h"
+
+static PyObject *
+int64codec_zigzag_encode(PyObject *module, PyObject *args, PyObject *kwds);
+
+static PyObject *
+int64codec_zigzag_decode(PyObject *module, PyObject *args, PyObject *kwds);
+
+static PyObject *
+int64codec_delta_encode(PyObject *module, PyObject *args, PyObject *kwds);
+
+static PyObject *
+int64codec_delta_decode(PyObject *module, PyObject *args, PyObject *kwds);
+
+static PyObject *
+int64codec_varint_encode(PyObject *module, PyObject *args, PyObject *kwds);
+
+static PyObject *
+int64codec_varint_decode(PyObject *module, PyObject *args, PyObject *kwds);
+
+static PyObject *
+int64codec_bitpack_encode(PyObject *module, PyObject *values);
+
+static PyObject *
+int64codec_bitpack_decode(PyObject *module, PyObject *args, PyObject *kwds);
+
+static
+PyMethodDef int64codec_methods[] =
+{
+    {
+        "zigzag_encode", (PyCFunction)(void(*)(void))int64codec_zigzag_encode,
+        METH_VARARGS | METH_KEYWORDS,
+        "zigzag_encode(values, out=None)\n"
+        "Map every value to (v << 1) ^ (v >> 63), so 0, -1, 1, -2, ... become\n"
+        "0, 1, 2, 3, ... as unsigned. Returns a new Int64Array, or out (a\n"
+        "writable int64 buffer of the same length, values itself is fine)."
+    },
+    {
+        "zigzag_decode", (PyCFunction)(void(*)(void))int64codec_zigzag_decode,
+        METH_VARARGS | METH_KEYWORDS,
+        "zigzag_decode(values, out=None)\n"
+        "Inverse of zigzag_encode, same arguments."
+    },
+    {
+        "delta_encode", (PyCFunction)(void(*)(void))int64codec_delta_encode,
+        METH_VARARGS | METH_KEYWORDS,
+        "delta_encode(values, order=1, out=None)\n"
+        "Differences of consecutive values, the first value kept as is; order=2\n"
+        "takes the differences twice (delta-of-delta). Arithmetic wraps, so\n"
+        "delta_decode restores every input exactly. Returns a new Int64Array,\n"
+        "or out (a writable int64 buffer of the same length, values itself is\n"
+        "fine)."
+    },
+    {
+        "delta_decode", (PyCFunction)(void(*)(void))int64codec_delta_decode,
+        METH_VARARGS | METH_KEYWORDS,
+        "delta_decode(values, order=1, out=None)\n"
+        "Inverse of delta_encode, running sums order times, same arguments."
+    },
+    {
+        "varint_encode", (PyCFunction)(void(*)(void))int64codec_varint_encode,
+        METH_VARARGS | METH_KEYWORDS,
+        "varint_encode(values, zigzag=False)\n"
+        "Encode values as concatenated LEB128 varints: 7 bits per byte, low\n"
+        "groups first, the high bit set on all but the last byte. Values are\n"
+        "taken as unsigned 64-bit (negative ones take 10 bytes) unless zigzag\n"
+        "is true."
+    },
+    {
+        "varint_decode", (PyCFunction)(void(*)(void))int64codec_varint_decode,
+        METH_VARARGS | METH_KEYWORDS,
+        "varint_decode(data, zigzag=False, out=None)\n"
+        "Decode the output of varint_encode from a bytes-like object. Returns a\n"
+        "new Int64Array, or, with out (a writable int64 buffer), writes the\n"
+        "values to its start and returns their number."
+    },
+    {
+        "bitpack_encode", (PyCFunction)int64codec_bitpack_encode, METH_O,
+        "bitpack_encode(values)\n"
+        "Frame-of-reference encode an int64 buffer or iterable of integers:\n"
+        "blocks of BITPACK_BLOCK values, each stored as its minimum and the\n"
+        "offsets from it in as few bits as the largest needs."
+    },
+    {
+        "bitpack_decode", (PyCFunction)(void(*)(void))int64codec_bitpack_decode,
+        METH_VARARGS | METH_KEYWORDS,
+        "bitpack_decode(data, out=None)\n"
+        "Decode the output of bitpack_encode from a bytes-like object. Returns a\n"
+        "new Int64Array, or, with out (a writable int64 buffer), writes the\n"
+        "values to its start and returns their number."
+    },
+    {NULL} /* sentinel */
+};
+
+int PyInt64Codec_Init(PyObject* module)
+{
+    if (PyModule_AddIntConstant(module, "BITPACK_BLOCK", PYINT64_PACK_BLOCK) < 0)
+    {
+        return -1;
+    }
+
+    return PyModule_AddFunctions(module, int64codec_methods);
+}
+
+static inline uint64_t
+int64codec_load_le(const unsigned char *p)
+{
+    uint64_t word;
+    memcpy(&word, p, sizeof(word));
+#if !PY_LITTLE_ENDIAN
+    word = (uint64_t)pyint64_op_bswap((int64_t)word);
+#endif
+    return word;
+}
+
+static inline void
+int64codec_store_le(unsigned char *p, uint64_t word)
+{
+#if !PY_LITTLE_ENDIAN
+    word = (uint64_t)pyint64_op_bswap((int64_t)word);
+#endif
+    memcpy(p, &word, sizeof(word));
+}
+
+/*
+ * Elementwise transforms.  Every one works when out is items itself: the
+ * encoders read a value before the ones they overwrite.
+ */
+typedef void (*int64codec_transform)(const int64_t *items, int64_t *out, Py_ssize_t n,
+                                     int order);
+
+static void
+int64codec_zigzag_encode_items(const int64_t *items, int64_t *out, Py_ssize_t n, int order)
+{
+    for (Py_ssize_t index = 0; index < n; ++index)
+    {
+        out[index] = (int64_t)pyint64_op_zigzag(items[index]);
+    }
+}
+
+static void
+int64codec_zigzag_decode_items(const int64_t *items, int64_t *out, Py_ssize_t n, int order)
+{
+    for (Py_ssize_t index = 0; index < n; ++index)
+    {
+        out[index] = pyint64_op_unzigzag((uint64_t)items[index]);
+    }
+}
+
+static void
+int64codec_delta_encode_items(const int64_t *items, int64_t *out, Py_ssize_t n, int order)
+{
+    // Back to front, so items[index - 1] is still the input.
+    const uint64_t* a = (const uint64_t*)items;
+    if (order == 1)
+    {
+        for (Py_ssize_t index = n - 1; index > 0; --index)
+        {
+            out[index] = (int64_t)(a[index] - a[index - 1]);
+        }
+    }
+    else
+    {
+        for (Py_ssize_t index = n - 1; index > 1; --index)
+        {
+            out[index] = (int64_t)(a[index] - 2 * a[index - 1] + a[index - 2]);
+        }
+
+        if (n > 1)
+        {
+            out[1] = (int64_t)(a[1] - 2 * a[0]);
+        }
+    }
+
+    if (n > 0)
+    {
+        out[0] = items[0];
+    }
+}
+
+static void
+int64codec_delta_decode_items(const int64_t *items, int64_t *out, Py_ssize_t n, int order)
+{
+    uint64_t sum = 0;
+    uint64_t sum2 = 0;
+    if (order == 1)
+    {
+        for (Py_ssize_t index = 0; index < n; ++index)
+        {
+            sum += (uint64_t)items[index];
+            out[index] = (int64_t)sum;
+        }
+    }
+    else
+    {
+        for (Py_ssize_t index = 0; index < n; ++index)
+        {
+            sum += (uint64_t)items[index];
+            sum2 += sum;
+            out[index] = (int64_t)sum2;
+        }
+    }
+}
+
+static PyObject *
+int64codec_apply(PyObject *module, const char *name, PyObject *args, PyObject *kwds,
+                 int has_order, int64codec_transform transform)
+{
+    static char *kwlist[] = {"values", "out", NULL};
+    static char *order_kwlist[] = {"values", "order", "out", NULL};
+    char format[32];
+    PyObject* values;
+    PyObject* out = Py_None;
+    int order = 1;
+
+    if (has_order)
+    {
+        PyOS_snprintf(format, sizeof(format), "O|iO:%s", name);
+        if (!PyArg_ParseTupleAndKeywords(args, kwds, format, order_kwlist, &values, &order, &out))
+        {
+            return NULL;
+        }
+
+        if (order != 1 && order != 2)
+        {
+            PyErr_Format(PyExc_ValueError, "%s() order must be 1 or 2, not %d", name, order);
+            return NULL;
+        }
+    }
+    else
+    {
+        PyOS_snprintf(format, sizeof(format), "O|O:%s", name);
+        if (!PyArg_ParseTupleAndKeywords(args, kwds, format, kwlist, &values, &out))
+        {
+            return NULL;
+        }
+    }
+
+    PyInt64Buffer buffer;
+    if (PyInt64Buffer_Get(values, &buffer) < 0)
+    {
+        return NULL;
+    }
+
+    PyObject* result;
+    if (out == Py_None)
+    {
+        result = PyInt64Array_NewEx(PyModule_GetState(module), buffer.length);
+        if (result)
+        {
+            transform(buffer.items, ((PyInt64ArrayObject*)result)->ob_item, buffer.length, order);
+        }
+    }
+    else
+    {
+        Py_buffer view;
+        result = NULL;
+        if (PyInt64Buffer_GetWritable(out, name, &view) == 0)
+        {
+            const Py_ssize_t length = view.len / (Py_ssize_t)sizeof(int64_t);
+            if (length != buffer.length)
+            {
+                PyErr_Format(PyExc_ValueError, "%s() out holds %zd values, expected %zd",
+                    name, length, buffer.length);
+            }
+            else
+            {
+                transform(buffer.items, view.buf, length, order);
+                result = Py_NewRef(out);
+            }
+
+            PyBuffer_Release(&view);
+        }
+    }
+
+    PyInt64Buffer_Release(&buffer);
+    return result;
+}
+
+static PyObject *
+int64codec_zigzag_encode(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    return int64codec_apply(module, "zigzag_encode", args, kwds, 0, int64codec_zigzag_encode_items);
+}
+
+static PyObject *
+int64codec_zigzag_decode(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    return int64codec_apply(module, "zigzag_decode", args, kwds, 0, int64codec_zigzag_decode_items);
+}
+
+static PyObject *
+int64codec_delta_encode(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    return int64codec_apply(module, "delta_encode", args, kwds, 1, int64codec_delta_encode_items);
+}
+
+static PyObject *
+int64codec_delta_decode(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    return int64codec_apply(module, "delta_decode", args, kwds, 1, int64codec_delta_decode_items);
+}
+
+/*
+ * Decoded data goes to a new Int64Array, or to the start of out when the
+ * caller passed one.  Set up the destination for count values.
+ */
+typedef struct
+{
+    PyObject* result;
+    Py_buffer view;
+    int64_t* items;
+} int64codec_output;
+
+static int
+int64codec_output_open(PyObject *module, const char *name, PyObject *out, Py_ssize_t count,
+                       int64codec_output *output)
+{
+    output->result = NULL;
+    output->view.obj = NULL;
+    if (out == Py_None)
+    {
+        output->result = PyInt64Array_NewEx(PyModule_GetState(module), count);
+        if (!output->result)
+        {
+            return -1;
+        }
+
+        output->items = ((PyInt64ArrayObject*)output->result)->ob_item;
+        return 0;
+    }
+
+    if (PyInt64Buffer_GetWritable(out, name, &output->view) < 0)
+    {
+        return -1;
+    }
+
+    const Py_ssize_t length = output->view.len / (Py_ssize_t)sizeof(int64_t);
+    if (length < count)
+    {
+        PyErr_Format(PyExc_ValueError, "%s() decodes %zd values, out holds %zd",
+            name, count, length);
+        PyBuffer_Release(&output->view);
+        return -1;
+    }
+
+    output->items = output->view.buf;
+    return 0;
+}
+
+// Release the destination, return the array or count, NULL if failed.
+static PyObject *
+int64codec_output_close(int64codec_output *output, Py_ssize_t count, int failed)
+{
+    if (output->view.obj)
+    {
+        PyBuffer_Release(&output->view);
+        return failed ? NULL : PyLong_FromSsize_t(count);
+    }
+
+    if (failed)
+    {
+        Py_CLEAR(output->result);
+    }
+
+    return output->result;
+}
+
+/* LEB128 varints */
+
+#define INT64CODEC_VARINT_MAX 10
+
+static inline int
+int64codec_varint_size(uint64_t value)
+{
+    // ceil(bits / 7), one byte for zero.
+    return (int)((64 - pyint64_op_clz((int64_t)(value | 1)) + 6) / 7);
+}
+
+static PyObject *
+int64codec_varint_encode(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"values", "zigzag", NULL};
+    PyObject* values;
+    int zigzag = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|p:varint_encode", kwlist, &values, &zigzag))
+    {
+        return NULL;
+    }
+
+    PyInt64Buffer buffer;
+    if (PyInt64Buffer_Get(values, &buffer) < 0)
+    {
+        return NULL;
+    }
+
+    const int64_t* items = buffer.items;
+    const Py_ssize_t n = buffer.length;
+    if (n > PY_SSIZE_T_MAX / INT64CODEC_VARINT_MAX)
+    {
+        PyInt64Buffer_Release(&buffer);
+        return PyErr_NoMemory();
+    }
+
+    Py_ssize_t size = 0;
+    for (Py_ssize_t index = 0; index < n; ++index)
+    {
+        const uint64_t value = zigzag ? pyint64_op_zigzag(items[index]) : (uint64_t)items[index];
+        size += int64codec_varint_size(value);
+    }
+
+    PyObject* result = PyBytes_FromStringAndSize(NULL, size);
+    if (result)
+    {
+        unsigned char* p = (unsigned char*)PyBytes_AS_STRING(result);
+        for (Py_ssize_t index = 0; index < n; ++index)
+        {
+            uint64_t value = zigzag ? pyint64_op_zigzag(items[index]) : (uint64_t)items[index];
+            while (value >= 0x80)
+            {
+                *p++ = (unsigned char)(value | 0x80);
+                value >>= 7;
+            }
+            *p++ = (unsigned char)value;
+        }
+    }
+
+    PyInt64Buffer_Release(&buffer);
+    return result;
+}
+
+/*
+ * Gather the 7-bit groups of up to eight varint bytes, already cut to the
+ * bytes of the varint, into one value: pairs, then quads, then all eight.
+ */
+static inline uint64_t
+int64codec_varint_compact(uint64_t word)
+{
+    word &= UINT64_C(0x7f7f7f7f7f7f7f7f);
+    word = (word & UINT64_C(0x007f007f007f007f)) | ((word & UINT64_C(0x7f007f007f007f00)) >> 1);
+    word = (word & UINT64_C(0x00003fff00003fff)) | ((word & UINT64_C(0x3fff00003fff0000)) >> 2);
+    return (word & UINT64_C(0x000000000fffffff)) | ((word & UINT64_C(0x0fffffff00000000)) >> 4);
+}
+
+static inline int
+int64codec_lowest_bit(uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(word);
+#else
+    return (int)pyint64_op_ctz((int64_t)word);
+#endif
+}
+
+#define INT64CODEC_VARINT_OK 0
+#define INT64CODEC_VARINT_TRUNCATED 1
+#define INT64CODEC_VARINT_OVERFLOW 2
+
+/*
+ * Decode count varints from data.  While eight bytes remain, a varint that
+ * ends within them is found from the high bits of one word load and its
+ * groups gathered without a loop, and eight one-byte varints are taken at
+ * once; longer ones and the tail go byte by byte.
+ * Returns a status, with *offset at the varint in error.
+ */
+static int
+int64codec_varint_decode_items(const unsigned char *data, Py_ssize_t size, int64_t *out,
+                               Py_ssize_t count, int zigzag, Py_ssize_t *offset)
+{
+    Py_ssize_t position = 0;
+    for (Py_ssize_t index = 0; index < count; ++index)
+    {
+        uint64_t value = 0;
+        const uint64_t word = size - position >= 8 ? int64codec_load_le(data + position) : 0;
+        const uint64_t stops = ~word & UINT64_C(0x8080808080808080);
+
+        if (size - position >= 8 && stops == UINT64_C(0x8080808080808080)
+            && count - index >= 8)
+        {
+            // Eight one-byte varints, the usual case for small deltas.
+            for (int byte = 0; byte < 8; ++byte)
+            {
+                value = (word >> (8 * byte)) & 0x7f;
+                out[index + byte] = zigzag ? pyint64_op_unzigzag(value) : (int64_t)value;
+            }
+            position += 8;
+            index += 7;
+            continue;
+        }
+
+        if (size - position >= 8 && stops)
+        {
+            const int bytes = (int64codec_lowest_bit(stops) >> 3) + 1;
+            value = int64codec_varint_compact(word & (~(uint64_t)0 >> (64 - 8 * bytes)));
+            position += bytes;
+        }
+        else
+        {
+            *offset = position;
+            for (int shift = 0;; shift += 7)
+            {
+                if (position == size)
+                {
+                    return INT64CODEC_VARINT_TRUNCATED;
+                }
+
+                const unsigned char byte = data[position++];
+                if (shift == 63 && byte > 1)
+                {
+                    return INT64CODEC_VARINT_OVERFLOW;
+                }
+
+                value |= (uint64_t)(byte & 0x7f) << shift;
+                if (!(byte & 0x80))
+                {
+                    break;
+                }
+            }
+        }
+
+        out[index] = zigzag ? pyint64_op_unzigzag(value) : (int64_t)value;
+    }
+
+    return INT64CODEC_VARINT_OK;
+}
+
+static PyObject *
+int64codec_varint_decode(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"data", "zigzag", "out", NULL};
+    PyObject* data;
+    int zigzag = 0;
+    PyObject* out = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|pO:varint_decode", kwlist,
+                                     &data, &zigzag, &out))
+    {
+        return NULL;
+    }
+
+    Py_buffer view;
+    if (PyObject_GetBuffer(data, &view, PyBUF_SIMPLE) < 0)
+    {
+        return NULL;
+    }
+
+    // Every varint ends in the one byte of it with the high bit clear.
+    const unsigned char* bytes = view.buf;
+    Py_ssize_t count = 0;
+    for (Py_ssize_t index = 0; index < view.len; ++index)
+    {
+        count += bytes[index] < 0x80;
+    }
+
+    int64codec_output output;
+    if (int64codec_output_open(module, "varint_decode", out, count, &output) < 0)
+    {
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+
+    Py_ssize_t offset = 0;
+    int status = int64codec_varint_decode_items(bytes, view.len, output.items, count, zigzag,
+                                                &offset);
+    if (status == INT64CODEC_VARINT_OK && count && bytes[view.len - 1] >= 0x80)
+    {
+        // A last varint without its end, find where it starts.
+        status = INT64CODEC_VARINT_TRUNCATED;
+        for (offset = view.len - 1; offset > 0 && bytes[offset - 1] >= 0x80; --offset)
+        {
+        }
+    }
+    else if (!count && view.len)
+    {
+        status = INT64CODEC_VARINT_TRUNCATED;
+    }
+
+    if (status == INT64CODEC_VARINT_TRUNCATED)
+    {
+        PyErr_Format(PyExc_ValueError, "truncated varint at offset %zd", offset);
+    }
+    else if (status == INT64CODEC_VARINT_OVERFLOW)
+    {
+        PyErr_Format(PyExc_ValueError, "varint at offset %zd does not fit in 64 bits", offset);
+    }
+
+    PyBuffer_Release(&view);
+    return int64codec_output_close(&output, count, status != INT64CODEC_VARINT_OK);
+}
+
+/* Frame-of-reference blocks */
+
+#define INT64CODEC_BLOCKS(n) (((n) + PYINT64_PACK_BLOCK - 1) / PYINT64_PACK_BLOCK)
+
+typedef struct
+{
+    const int64_t* items;   // to pack
+    int64_t* out;           // unpacked
+    unsigned char* data;
+    int64_t* references;
+    unsigned char* widths;
+    Py_ssize_t* offsets;    // of the blocks in data
+    const PyInt64KernelTable* kernels;
+} int64codec_bitpack_job;
+
+// Chunk boundaries are multiples of the grain, which blocks divide.
+#define INT64CODEC_GRAIN PYINT64_POOL_GRAIN
+
+static int
+int64codec_measure_task(Py_ssize_t begin, Py_ssize_t end, Py_ssize_t chunk, void *arg)
+{
+    const int64codec_bitpack_job* job = arg;
+    for (Py_ssize_t first = begin; first < end; first += PYINT64_PACK_BLOCK)
+    {
+        const Py_ssize_t length = Py_MIN(end - first, PYINT64_PACK_BLOCK);
+        const int64_t* values = job->items + first;
+        const int64_t low = job->kernels->min(values, length, INT64_MAX);
+        const int64_t high = job->kernels->max(values, length, INT64_MIN);
+        const uint64_t range = (uint64_t)high - (uint64_t)low;
+
+        job->references[first / PYINT64_PACK_BLOCK] = low;
+        job->widths[first / PYINT64_PACK_BLOCK] =
+            (unsigned char)(64 - pyint64_op_clz((int64_t)range));
+    }
+
+    return 0;
+}
+
+static int
+int64codec_pack_task(Py_ssize_t begin, Py_ssize_t end, Py_ssize_t chunk, void *arg)
+{
+    const int64codec_bitpack_job* job = arg;
+    for (Py_ssize_t first = begin; first < end; first += PYINT64_PACK_BLOCK)
+    {
+        const Py_ssize_t block = first / PYINT64_PACK_BLOCK;
+        const int64_t reference = job->references[block];
+        const int width = job->widths[block];
+        unsigned char* p = job->data + job->offsets[block];
+
+        p[0] = (unsigned char)width;
+        int64codec_store_le(p + 1, (uint64_t)reference);
+
+        const int64_t* values = job->items + first;
+        int64_t padded[PYINT64_PACK_BLOCK];
+        if (end - first < PYINT64_PACK_BLOCK)
+        {
+            for (Py_ssize_t index = 0; index < PYINT64_PACK_BLOCK; ++index)
+            {
+                padded[index] = index < end - first ? values[index] : reference;
+            }
+            values = padded;
+        }
+
+        job->kernels->pack(values, reference, width, p + PYINT64_BITPACK_BLOCK_HEADER_SIZE);
+    }
+
+    return 0;
+}
+
+static int
+int64codec_unpack_task(Py_ssize_t begin, Py_ssize_t end, Py_ssize_t chunk, void *arg)
+{
+    const int64codec_bitpack_job* job = arg;
+    for (Py_ssize_t first = begin; first < end; first += PYINT64_PACK_BLOCK)
+    {
+        const unsigned char* p = job->data + job->offsets[first / PYINT64_PACK_BLOCK];
+        const int64_t reference = (int64_t)int64codec_load_le(p + 1);
+        const unsigned char* packed = p + PYINT64_BITPACK_BLOCK_HEADER_SIZE;
+
+        if (end - first >= PYINT64_PACK_BLOCK)
+        {
+            job->kernels->unpack(packed, reference, p[0], job->out + first);
+        }
+        else
+        {
+            int64_t values[PYINT64_PACK_BLOCK];
+            job->kernels->unpack(packed, reference, p[0], values);
+            memcpy(job->out + first, values, (end - first) * sizeof(int64_t));
+        }
+    }
+
+    return 0;
+}
+
+static PyObject *
+int64codec_bitpack_encode(PyObject *module, PyObject *values)
+{
+    PyInt64Buffer buffer;
+    if (PyInt64Buffer_Get(values, &buffer) < 0)
+    {
+        return NULL;
+    }
+
+    const Py_ssize_t n = buffer.length;
+    const Py_ssize_t blocks = INT64CODEC_BLOCKS(n);
+    int64codec_bitpack_job job = {
+        .items = buffer.items,
+        .references = PyMem_Malloc(Py_MAX(blocks, 1) * sizeof(int64_t)),
+        .widths = PyMem_Malloc(Py_MAX(blocks, 1)),
+        .offsets = PyMem_Malloc(Py_MAX(blocks, 1) * sizeof(Py_ssize_t)),
+        .kernels = PyInt64Kernels_Get(),
+    };
+
+    PyObject* result = NULL;
+    if (!job.references || !job.widths || !job.offsets)
+    {
+        PyErr_NoMemory();
+        goto done;
+    }
+
+    PyInt64Pool_For(n, INT64CODEC_GRAIN, int64codec_measure_task, &job);
+
+    // At most 8 + 1/128 bytes per value, n is far from overflowing that.
+    Py_ssize_t size = PYINT64_BITPACK_HEADER_SIZE;
+    for (Py_ssize_t block = 0; block < blocks; ++block)
+    {
+        job.offsets[block] = size;
+        size += PYINT64_BITPACK_BLOCK_HEADER_SIZE + PYINT64_PACK_SIZE(job.widths[block]);
+    }
+
+    result = PyBytes_FromStringAndSize(NULL, size);
+    if (!result)
+    {
+        goto done;
+    }
+
+    job.data = (unsigned char*)PyBytes_AS_STRING(result);
+    memcpy(job.data, PYINT64_BITPACK_MAGIC, 4);
+    job.data[4] = PYINT64_BITPACK_VERSION;
+    memset(job.data + 5, 0, 3);
+    int64codec_store_le(job.data + 8, (uint64_t)n);
+
+    PyInt64Pool_For(n, INT64CODEC_GRAIN, int64codec_pack_task, &job);
+
+done:
+    PyMem_Free(job.references);
+    PyMem_Free(job.widths);
+    PyMem_Free(job.offsets);
+    PyInt64Buffer_Release(&buffer);
+    return result;
+}
+
+static PyObject *
+int64codec_bitpack_decode(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"data", "out", NULL};
+    PyObject* data;
+    PyObject* out = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O:bitpack_decode", kwlist, &data, &out))
+    {
+        return NULL;
+    }
+
+    Py_buffer view;
+    if (PyObject_GetBuffer(data, &view, PyBUF_SIMPLE) < 0)
+    {
+        return NULL;
+    }
+
+    const unsigned char* bytes = view.buf;
+    const Py_ssize_t size = view.len;
+    if (size < PYINT64_BITPACK_HEADER_SIZE || memcmp(bytes, PYINT64_BITPACK_MAGIC, 4) != 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "not pyint64 bit-packed data");
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+
+    if (bytes[4] == 0 || bytes[4] > PYINT64_BITPACK_VERSION)
+    {
+        PyErr_Format(PyExc_ValueError, "unsupported pyint64 bit-packed version %d", bytes[4]);
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+
+    // Every block takes at least its header, which bounds a sane count.
+    const uint64_t count = int64codec_load_le(bytes + 8);
+    if (count > (uint64_t)(size / PYINT64_BITPACK_BLOCK_HEADER_SIZE) * PYINT64_PACK_BLOCK)
+    {
+        PyErr_Format(PyExc_ValueError, "pyint64 bit-packed data too short for %llu values",
+            (unsigned long long)count);
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+
+    const Py_ssize_t n = (Py_ssize_t)count;
+    const Py_ssize_t blocks = INT64CODEC_BLOCKS(n);
+    Py_ssize_t* offsets = PyMem_Malloc(Py_MAX(blocks, 1) * sizeof(Py_ssize_t));
+    if (!offsets)
+    {
+        PyBuffer_Release(&view);
+        return PyErr_NoMemory();
+    }
+
+    Py_ssize_t position = PYINT64_BITPACK_HEADER_SIZE;
+    Py_ssize_t block = 0;
+    for (; block < blocks; ++block)
+    {
+        offsets[block] = position;
+        if (size - position < PYINT64_BITPACK_BLOCK_HEADER_SIZE || bytes[position] > 64)
+        {
+            break;
+        }
+
+        const Py_ssize_t block_size =
+            PYINT64_BITPACK_BLOCK_HEADER_SIZE + PYINT64_PACK_SIZE(bytes[position]);
+        if (size - position < block_size)
+        {
+            break;
+        }
+
+        position += block_size;
+    }
+
+    if (block < blocks || position != size)
+    {
+        PyErr_Format(PyExc_ValueError, "corrupt pyint64 bit-packed block at offset %zd",
+            block < blocks ? offsets[block] : position);
+        PyMem_Free(offsets);
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+
+    int64codec_output output;
+    if (int64codec_output_open(module, "bitpack_decode", out, n, &output) < 0)
+    {
+        PyMem_Free(offsets);
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+
+    int64codec_bitpack_job job = {
+        .out = output.items,
+        .data = (unsigned char*)bytes,
+        .offsets = offsets,
+        .kernels = PyInt64Kernels_Get(),
+    };
+    PyInt64Pool_For(n, INT64CODEC_GRAIN, int64codec_unpack_task, &job);
+
+    PyMem_Free(offsets);
+    PyBuffer_Release(&view);
+    return int64codec_output_close(&output, n, 0);
+}
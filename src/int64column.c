@@ -0,0 +1,1617 @@
+#include <errno.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "pyint64obj.h"
+#include "int64arrayobj.h"
+#include "int64kernels.h"
+#include "int64ops.h"
+#include "int64pool.h"
+#include "int64column.h"
+
+#ifndef O_CLOEXEC
+#define O_CLOEXEC 0
+#endif
+
+// Advice values of madvise, -1 where the platform has no such hint.
+#if defined(MADV_NORMAL) && !defined(_WIN32)
+#define INT64COLUMN_NORMAL MADV_NORMAL
+#define INT64COLUMN_SEQUENTIAL MADV_SEQUENTIAL
+#define INT64COLUMN_RANDOM MADV_RANDOM
+#define INT64COLUMN_WILLNEED MADV_WILLNEED
+#define INT64COLUMN_DONTNEED MADV_DONTNEED
+#else
+#define INT64COLUMN_NORMAL -1
+#define INT64COLUMN_SEQUENTIAL -1
+#define INT64COLUMN_RANDOM -1
+#define INT64COLUMN_WILLNEED -1
+#define INT64COLUMN_DONTNEED -1
+#endif
+
+// Largest single read or write, the Windows CRT takes an unsigned int.
+#define INT64COLUMN_IO_CHUNK ((size_t)1 << 30)
+
+// Values read at a time when rehashing the last block for appending.
+#define INT64COLUMN_REHASH_CHUNK ((Py_ssize_t)1 << 16)
+
+#define CHECK_OPEN(self, ret)                                                   \
+    if (!(self)->ob_map)                                                       \
+    {                                                                           \
+        PyErr_SetString(PyExc_ValueError, "I/O operation on closed Column");    \
+        return ret;                                                             \
+    }
+
+#define CHECK_WRITER_OPEN(self, ret)                                            \
+    if ((self)->fd < 0)                                                         \
+    {                                                                           \
+        PyErr_SetString(PyExc_ValueError, "I/O operation on closed ColumnWriter");\
+        return ret;                                                             \
+    }
+
+// Header fields of a column file, see int64column.h.
+typedef struct
+{
+    int version;
+    int byteorder;
+    int flags;
+    uint64_t count;
+    int64_t min;
+    int64_t max;
+    uint64_t block_size;
+} int64column_header;
+
+static PyObject *
+int64column_new(PyTypeObject *type, PyObject *args, PyObject *kwds);
+
+static void
+int64column_dealloc(PyInt64ColumnObject *self);
+
+static PyObject *
+int64column_repr(PyInt64ColumnObject *self);
+
+static Py_ssize_t
+int64column_length(PyInt64ColumnObject *self);
+
+static PyObject *
+int64column_item(PyInt64ColumnObject *self, Py_ssize_t index);
+
+static int
+int64column_getbuffer(PyInt64ColumnObject *self, Py_buffer *view, int flags);
+
+static void
+int64column_releasebuffer(PyInt64ColumnObject *self, Py_buffer *view);
+
+static PyObject *
+int64column_advise(PyInt64ColumnObject *self, PyObject *args, PyObject *kwds);
+
+static PyObject *
+int64column_verify(PyInt64ColumnObject *self, PyObject *unused);
+
+static PyObject *
+int64column_close(PyInt64ColumnObject *self, PyObject *unused);
+
+static PyObject *
+int64column_enter(PyObject *self, PyObject *unused);
+
+static PyObject *
+int64column_exit(PyInt64ColumnObject *self, PyObject *args);
+
+static PyObject *
+int64column_get_path(PyInt64ColumnObject *self, void *closure);
+
+static PyObject *
+int64column_get_byteorder(PyInt64ColumnObject *self, void *closure);
+
+static PyObject *
+int64column_get_min(PyInt64ColumnObject *self, void *closure);
+
+static PyObject *
+int64column_get_max(PyInt64ColumnObject *self, void *closure);
+
+static PyObject *
+int64column_get_block_size(PyInt64ColumnObject *self, void *closure);
+
+static PyObject *
+int64column_get_checksums(PyInt64ColumnObject *self, void *closure);
+
+static PyObject *
+int64column_get_writable(PyInt64ColumnObject *self, void *closure);
+
+static PyObject *
+int64column_get_closed(PyInt64ColumnObject *self, void *closure);
+
+static PyObject *
+int64writer_new(PyTypeObject *type, PyObject *args, PyObject *kwds);
+
+static void
+int64writer_dealloc(PyInt64ColumnWriterObject *self);
+
+static PyObject *
+int64writer_repr(PyInt64ColumnWriterObject *self);
+
+static PyObject *
+int64writer_append(PyInt64ColumnWriterObject *self, PyObject *values);
+
+static PyObject *
+int64writer_flush(PyInt64ColumnWriterObject *self, PyObject *unused);
+
+static PyObject *
+int64writer_close(PyInt64ColumnWriterObject *self, PyObject *unused);
+
+static PyObject *
+int64writer_exit(PyInt64ColumnWriterObject *self, PyObject *args);
+
+static PyObject *
+int64writer_get_path(PyInt64ColumnWriterObject *self, void *closure);
+
+static PyObject *
+int64writer_get_count(PyInt64ColumnWriterObject *self, void *closure);
+
+static PyObject *
+int64writer_get_block_size(PyInt64ColumnWriterObject *self, void *closure);
+
+static PyObject *
+int64writer_get_checksums(PyInt64ColumnWriterObject *self, void *closure);
+
+static PyObject *
+int64writer_get_closed(PyInt64ColumnWriterObject *self, void *closure);
+
+static
+PyMethodDef int64column_methods[] =
+{
+    {"advise", (PyCFunction)(void(*)(void))int64column_advise, METH_VARARGS | METH_KEYWORDS,
+        "advise(access, start=0, stop=None)\n"
+        "Tell the OS how values[start:stop] will be read: 'sequential' reads\n"
+        "ahead aggressively and drops pages behind, 'random' reads only what\n"
+        "is touched, 'willneed' starts reading in now, 'dontneed' drops the\n"
+        "pages and 'normal' restores the default. A no-op where the platform\n"
+        "has no such hint."},
+    {"verify", (PyCFunction)int64column_verify, METH_NOARGS,
+        "verify()\n"
+        "Read the whole file and check the block checksums and min/max the\n"
+        "header records, raising ValueError on the first mismatch."},
+    {"close", (PyCFunction)int64column_close, METH_NOARGS,
+        "close()\n"
+        "Unmap the file. Fails with BufferError while buffers are exported."},
+    {"__enter__", int64column_enter, METH_NOARGS, NULL},
+    {"__exit__", (PyCFunction)int64column_exit, METH_VARARGS, NULL},
+    {NULL} /* sentinel */
+};
+
+static
+PyGetSetDef int64column_getset[] =
+{
+    {"path", (getter)int64column_get_path, NULL, "The path the column was opened with.", NULL},
+    {"byteorder", (getter)int64column_get_byteorder, NULL,
+        "'little' or 'big', the byte order of the values in the file.", NULL},
+    {"min", (getter)int64column_get_min, NULL,
+        "The smallest value as the header records it, None if it does not.", NULL},
+    {"max", (getter)int64column_get_max, NULL,
+        "The largest value as the header records it, None if it does not.", NULL},
+    {"block_size", (getter)int64column_get_block_size, NULL,
+        "Number of values per checksum block.", NULL},
+    {"checksums", (getter)int64column_get_checksums, NULL,
+        "Whether the file carries block checksums.", NULL},
+    {"writable", (getter)int64column_get_writable, NULL,
+        "Whether the mapping is writable.", NULL},
+    {"closed", (getter)int64column_get_closed, NULL, "Whether the column is closed.", NULL},
+    {NULL} /* sentinel */
+};
+
+static
+PyType_Slot int64column_slots[] =
+{
+    {Py_tp_doc, "Column(path, *, access=None, writable=False)\n"
+                "Memory mapping of an int64 column file written by ColumnWriter.\n"
+                "Values are paged in on first touch, so files larger than memory\n"
+                "work: the column exports an int64 buffer that every bulk function\n"
+                "and Int64Array.asarray use in place. access is passed to advise()\n"
+                "for the whole file. A writable mapping writes through to the file\n"
+                "(for sorting in place) and drops the min/max and checksums of the\n"
+                "header, which no longer hold once values change."},
+    {Py_tp_dealloc, int64column_dealloc},
+    {Py_tp_repr, int64column_repr},
+    {Py_tp_getattro, PyObject_GenericGetAttr},
+    {Py_tp_methods, int64column_methods},
+    {Py_tp_getset, int64column_getset},
+    {Py_tp_new, int64column_new},
+    {Py_sq_length, int64column_length},
+    {Py_sq_item, int64column_item},
+    {Py_bf_getbuffer, int64column_getbuffer},
+    {Py_bf_releasebuffer, int64column_releasebuffer},
+    {0, NULL}
+};
+
+PyType_Spec PyInt64Column_Spec =
+{
+    .name = "pyint64.Column",
+    .basicsize = sizeof(PyInt64ColumnObject),
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE | Py_TPFLAGS_SEQUENCE,
+    .slots = int64column_slots,
+};
+
+static
+PyMethodDef int64writer_methods[] =
+{
+    {"append", (PyCFunction)int64writer_append, METH_O,
+        "append(values)\n"
+        "Append an int64 buffer or iterable of integers to the file."},
+    {"flush", (PyCFunction)int64writer_flush, METH_NOARGS,
+        "flush()\n"
+        "Write the checksums and the header, after which the file is a\n"
+        "complete column. Appending again first marks the checksums invalid\n"
+        "in the header, so a file cut short by a crash still reads back\n"
+        "the values of the last flush."},
+    {"close", (PyCFunction)int64writer_close, METH_NOARGS,
+        "close()\n"
+        "Flush and close the file."},
+    {"__enter__", int64column_enter, METH_NOARGS, NULL},
+    {"__exit__", (PyCFunction)int64writer_exit, METH_VARARGS, NULL},
+    {NULL} /* sentinel */
+};
+
+static
+PyGetSetDef int64writer_getset[] =
+{
+    {"path", (getter)int64writer_get_path, NULL, "The path the writer was opened with.", NULL},
+    {"count", (getter)int64writer_get_count, NULL, "Number of values in the file.", NULL},
+    {"block_size", (getter)int64writer_get_block_size, NULL,
+        "Number of values per checksum block.", NULL},
+    {"checksums", (getter)int64writer_get_checksums, NULL,
+        "Whether block checksums are written.", NULL},
+    {"closed", (getter)int64writer_get_closed, NULL, "Whether the writer is closed.", NULL},
+    {NULL} /* sentinel */
+};
+
+static
+PyType_Slot int64writer_slots[] =
+{
+    {Py_tp_doc, "ColumnWriter(path, *, block_size=65536, checksums=True)\n"
+                "Append-only writer of an int64 column file in native byte order.\n"
+                "A missing file is created with the given checksum settings, an\n"
+                "existing one is appended to and keeps its own. The header records\n"
+                "count and min/max as of the last flush() or close()."},
+    {Py_tp_dealloc, int64writer_dealloc},
+    {Py_tp_repr, int64writer_repr},
+    {Py_tp_getattro, PyObject_GenericGetAttr},
+    {Py_tp_methods, int64writer_methods},
+    {Py_tp_getset, int64writer_getset},
+    {Py_tp_new, int64writer_new},
+    {0, NULL}
+};
+
+PyType_Spec PyInt64ColumnWriter_Spec =
+{
+    .name = "pyint64.ColumnWriter",
+    .basicsize = sizeof(PyInt64ColumnWriterObject),
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE,
+    .slots = int64writer_slots,
+};
+
+/* Block checksums, four interleaved lanes of xxHash64 rounds. */
+
+#define INT64COLUMN_PRIME1 UINT64_C(0x9e3779b185ebca87)
+#define INT64COLUMN_PRIME2 UINT64_C(0xc2b2ae3d27d4eb4f)
+#define INT64COLUMN_PRIME3 UINT64_C(0x165667b19e3779f9)
+
+static inline uint64_t
+int64column_rotl(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t
+int64column_round(uint64_t lane, int64_t value)
+{
+    return int64column_rotl(lane + (uint64_t)value * INT64COLUMN_PRIME2, 31) * INT64COLUMN_PRIME1;
+}
+
+static void
+int64column_hasher_reset(PyInt64ColumnHasher *hasher)
+{
+    hasher->lanes[0] = INT64COLUMN_PRIME1 + INT64COLUMN_PRIME2;
+    hasher->lanes[1] = INT64COLUMN_PRIME2;
+    hasher->lanes[2] = 0;
+    hasher->lanes[3] = 0 - INT64COLUMN_PRIME1;
+    hasher->length = 0;
+}
+
+// Feed n values, byte swapped first if swap is set. Value i goes to lane i % 4.
+static void
+int64column_hasher_update(PyInt64ColumnHasher *hasher, const int64_t *items,
+                          Py_ssize_t n, int swap)
+{
+    uint64_t lane0 = hasher->lanes[0];
+    uint64_t lane1 = hasher->lanes[1];
+    uint64_t lane2 = hasher->lanes[2];
+    uint64_t lane3 = hasher->lanes[3];
+    uint64_t* lanes[4] = {&lane0, &lane1, &lane2, &lane3};
+    Py_ssize_t index = 0;
+
+    for (; index < n && ((hasher->length + index) & 3) != 0; ++index)
+    {
+        uint64_t* lane = lanes[(hasher->length + index) & 3];
+        *lane = int64column_round(*lane, swap ? pyint64_op_bswap(items[index]) : items[index]);
+    }
+
+    if (swap)
+    {
+        for (; index + 4 <= n; index += 4)
+        {
+            lane0 = int64column_round(lane0, pyint64_op_bswap(items[index]));
+            lane1 = int64column_round(lane1, pyint64_op_bswap(items[index + 1]));
+            lane2 = int64column_round(lane2, pyint64_op_bswap(items[index + 2]));
+            lane3 = int64column_round(lane3, pyint64_op_bswap(items[index + 3]));
+        }
+    }
+    else
+    {
+        for (; index + 4 <= n; index += 4)
+        {
+            lane0 = int64column_round(lane0, items[index]);
+            lane1 = int64column_round(lane1, items[index + 1]);
+            lane2 = int64column_round(lane2, items[index + 2]);
+            lane3 = int64column_round(lane3, items[index + 3]);
+        }
+    }
+
+    for (; index < n; ++index)
+    {
+        uint64_t* lane = lanes[(hasher->length + index) & 3];
+        *lane = int64column_round(*lane, swap ? pyint64_op_bswap(items[index]) : items[index]);
+    }
+
+    hasher->lanes[0] = lane0;
+    hasher->lanes[1] = lane1;
+    hasher->lanes[2] = lane2;
+    hasher->lanes[3] = lane3;
+    hasher->length += n;
+}
+
+static uint64_t
+int64column_hasher_digest(const PyInt64ColumnHasher *hasher)
+{
+    uint64_t hash = int64column_rotl(hasher->lanes[0], 1) + int64column_rotl(hasher->lanes[1], 7)
+        + int64column_rotl(hasher->lanes[2], 12) + int64column_rotl(hasher->lanes[3], 18);
+    hash += (uint64_t)hasher->length * INT64COLUMN_PRIME3;
+    hash = (hash ^ (hash >> 33)) * INT64COLUMN_PRIME2;
+    hash = (hash ^ (hash >> 29)) * INT64COLUMN_PRIME3;
+    return hash ^ (hash >> 32);
+}
+
+/* Header. */
+
+static void
+int64column_put64(unsigned char *out, uint64_t value)
+{
+    for (int index = 0; index < 8; ++index)
+    {
+        out[index] = (unsigned char)(value >> (8 * index));
+    }
+}
+
+static uint64_t
+int64column_get64(const unsigned char *in)
+{
+    uint64_t value = 0;
+    for (int index = 7; index >= 0; --index)
+    {
+        value = (value << 8) | in[index];
+    }
+
+    return value;
+}
+
+static void
+int64column_header_pack(const int64column_header *header, unsigned char *out)
+{
+    memset(out, 0, PYINT64_COLUMN_HEADER_SIZE);
+    memcpy(out, PYINT64_COLUMN_MAGIC, sizeof(PYINT64_COLUMN_MAGIC));
+    out[8] = (unsigned char)header->version;
+    out[9] = (unsigned char)header->byteorder;
+    out[10] = sizeof(int64_t);
+    out[11] = (unsigned char)header->flags;
+    int64column_put64(out + 16, header->count);
+    int64column_put64(out + 24, (uint64_t)header->min);
+    int64column_put64(out + 32, (uint64_t)header->max);
+    int64column_put64(out + 40, header->block_size);
+}
+
+static Py_ssize_t
+int64column_blocks(uint64_t count, uint64_t block_size)
+{
+    return (Py_ssize_t)(count / block_size + (count % block_size != 0));
+}
+
+// Parse and validate the header of a file of file_size bytes.
+static int
+int64column_header_unpack(const unsigned char *in, uint64_t file_size, PyObject *path,
+                          int64column_header *header)
+{
+    if (file_size < PYINT64_COLUMN_HEADER_SIZE
+        || memcmp(in, PYINT64_COLUMN_MAGIC, sizeof(PYINT64_COLUMN_MAGIC)) != 0)
+    {
+        PyErr_Format(PyExc_ValueError, "%R is not a pyint64 column file", path);
+        return -1;
+    }
+
+    header->version = in[8];
+    header->byteorder = in[9];
+    header->flags = in[11];
+    header->count = int64column_get64(in + 16);
+    header->min = (int64_t)int64column_get64(in + 24);
+    header->max = (int64_t)int64column_get64(in + 32);
+    header->block_size = int64column_get64(in + 40);
+
+    if (header->version == 0 || header->version > PYINT64_COLUMN_VERSION)
+    {
+        PyErr_Format(PyExc_ValueError, "unsupported pyint64 column version %d in %R",
+                     header->version, path);
+        return -1;
+    }
+
+    if ((header->byteorder != '<' && header->byteorder != '>') || in[10] != sizeof(int64_t)
+        || header->block_size == 0 || header->block_size > PY_SSIZE_T_MAX / sizeof(int64_t))
+    {
+        PyErr_Format(PyExc_ValueError, "corrupt pyint64 column header in %R", path);
+        return -1;
+    }
+
+    const uint64_t payload = file_size - PYINT64_COLUMN_HEADER_SIZE;
+    const uint64_t checksums = (header->flags & PYINT64_COLUMN_CHECKSUMS)
+        ? (uint64_t)int64column_blocks(header->count, header->block_size) : 0;
+
+    if (header->count > payload / sizeof(int64_t)
+        || checksums > (payload / sizeof(int64_t)) - header->count
+        || header->count > (uint64_t)PY_SSIZE_T_MAX / sizeof(int64_t))
+    {
+        PyErr_Format(PyExc_ValueError,
+            "%R is truncated: it holds %llu bytes, the header records %llu values",
+            path, (unsigned long long)file_size, (unsigned long long)header->count);
+        return -1;
+    }
+
+    return 0;
+}
+
+/* File access.  Functions taking path raise an OSError naming it on failure. */
+
+int PyInt64File_Open(PyObject *path, int flags)
+{
+    int fd;
+#ifdef _WIN32
+    PyObject* decoded;
+    if (!PyUnicode_FSDecoder(path, &decoded))
+    {
+        return -1;
+    }
+
+    wchar_t* name = PyUnicode_AsWideCharString(decoded, NULL);
+    Py_DECREF(decoded);
+    if (!name)
+    {
+        return -1;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    fd = _wopen(name, flags | _O_BINARY | _O_NOINHERIT, _S_IREAD | _S_IWRITE);
+    Py_END_ALLOW_THREADS
+    PyMem_Free(name);
+#else
+    PyObject* encoded;
+    if (!PyUnicode_FSConverter(path, &encoded))
+    {
+        return -1;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    fd = open(PyBytes_AS_STRING(encoded), flags | O_CLOEXEC, 0666);
+    Py_END_ALLOW_THREADS
+    Py_DECREF(encoded);
+#endif
+
+    if (fd < 0)
+    {
+        PyErr_SetFromErrnoWithFilenameObject(PyExc_OSError, path);
+    }
+
+    return fd;
+}
+
+void PyInt64File_Close(int fd)
+{
+    Py_BEGIN_ALLOW_THREADS
+#ifdef _WIN32
+    _close(fd);
+#else
+    close(fd);
+#endif
+    Py_END_ALLOW_THREADS
+}
+
+Py_ssize_t PyInt64File_Read(int fd, char *out, Py_ssize_t size, int *error)
+{
+    Py_ssize_t done = 0;
+    while (done < size)
+    {
+        const size_t chunk = Py_MIN((size_t)(size - done), INT64COLUMN_IO_CHUNK);
+#ifdef _WIN32
+        const Py_ssize_t result = _read(fd, out + done, (unsigned int)chunk);
+#else
+        const Py_ssize_t result = read(fd, out + done, chunk);
+#endif
+        if (result < 0 && errno != EINTR)
+        {
+            *error = errno;
+            break;
+        }
+
+        if (result == 0)
+        {
+            break;
+        }
+
+        done += Py_MAX(result, 0);
+    }
+
+    return done;
+}
+
+static int
+int64column_file_size(int fd, PyObject *path, uint64_t *size)
+{
+#ifdef _WIN32
+    struct _stat64 st;
+    const int result = _fstat64(fd, &st);
+#else
+    struct stat st;
+    const int result = fstat(fd, &st);
+#endif
+    if (result < 0)
+    {
+        PyErr_SetFromErrnoWithFilenameObject(PyExc_OSError, path);
+        return -1;
+    }
+
+    *size = (uint64_t)st.st_size;
+    return 0;
+}
+
+// Read exactly size bytes from offset on; a short file is a corrupt column.
+static int
+int64column_read_at(int fd, PyObject *path, uint64_t offset, void *data, size_t size)
+{
+    char* out = data;
+    int error = 0;
+    int eof = 0;
+
+    Py_BEGIN_ALLOW_THREADS
+#ifdef _WIN32
+    if (_lseeki64(fd, (__int64)offset, SEEK_SET) < 0)
+    {
+        error = errno;
+    }
+#endif
+    while (size > 0 && !error)
+    {
+        const size_t chunk = Py_MIN(size, INT64COLUMN_IO_CHUNK);
+#ifdef _WIN32
+        const Py_ssize_t done = _read(fd, out, (unsigned int)chunk);
+#else
+        const Py_ssize_t done = pread(fd, out, chunk, (off_t)offset);
+#endif
+        if (done < 0)
+        {
+            error = errno == EINTR ? 0 : errno;
+        }
+        else if (done == 0)
+        {
+            eof = 1;
+            break;
+        }
+        else
+        {
+            out += done;
+            offset += (uint64_t)done;
+            size -= (size_t)done;
+        }
+    }
+    Py_END_ALLOW_THREADS
+
+    if (error)
+    {
+        errno = error;
+        PyErr_SetFromErrnoWithFilenameObject(PyExc_OSError, path);
+        return -1;
+    }
+
+    if (eof)
+    {
+        PyErr_Format(PyExc_ValueError, "%R is truncated", path);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int
+int64column_write_at(int fd, PyObject *path, uint64_t offset, const void *data, size_t size)
+{
+    const char* in = data;
+    int error = 0;
+
+    Py_BEGIN_ALLOW_THREADS
+#ifdef _WIN32
+    if (_lseeki64(fd, (__int64)offset, SEEK_SET) < 0)
+    {
+        error = errno;
+    }
+#endif
+    while (size > 0 && !error)
+    {
+        const size_t chunk = Py_MIN(size, INT64COLUMN_IO_CHUNK);
+#ifdef _WIN32
+        const Py_ssize_t done = _write(fd, in, (unsigned int)chunk);
+#else
+        const Py_ssize_t done = pwrite(fd, in, chunk, (off_t)offset);
+#endif
+        if (done < 0)
+        {
+            error = errno == EINTR ? 0 : errno;
+        }
+        else
+        {
+            in += done;
+            offset += (uint64_t)done;
+            size -= (size_t)done;
+        }
+    }
+    Py_END_ALLOW_THREADS
+
+    if (error)
+    {
+        errno = error;
+        PyErr_SetFromErrnoWithFilenameObject(PyExc_OSError, path);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int
+int64column_truncate(int fd, PyObject *path, uint64_t size)
+{
+    int result;
+    Py_BEGIN_ALLOW_THREADS
+#ifdef _WIN32
+    result = _chsize_s(fd, (__int64)size) == 0 ? 0 : -1;
+#else
+    do
+    {
+        result = ftruncate(fd, (off_t)size);
+    } while (result < 0 && errno == EINTR);
+#endif
+    Py_END_ALLOW_THREADS
+
+    if (result < 0)
+    {
+        PyErr_SetFromErrnoWithFilenameObject(PyExc_OSError, path);
+        return -1;
+    }
+
+    return 0;
+}
+
+// Map size bytes of the open file; the mapping outlives fd.
+static char *
+int64column_map(int fd, PyObject *path, size_t size, int writable)
+{
+#ifdef _WIN32
+    HANDLE mapping = CreateFileMappingW((HANDLE)_get_osfhandle(fd), NULL,
+        writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, NULL);
+    char* base = mapping
+        ? MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size)
+        : NULL;
+    if (!base)
+    {
+        PyErr_SetExcFromWindowsErrWithFilenameObject(PyExc_OSError, 0, path);
+    }
+
+    if (mapping)
+    {
+        CloseHandle(mapping);
+    }
+
+    return base;
+#else
+    void* base = mmap(NULL, size, writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                      MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED)
+    {
+        PyErr_SetFromErrnoWithFilenameObject(PyExc_OSError, path);
+        return NULL;
+    }
+
+    return base;
+#endif
+}
+
+static void
+int64column_unmap(char *base, size_t size)
+{
+#ifdef _WIN32
+    UnmapViewOfFile(base);
+#else
+    munmap(base, size);
+#endif
+}
+
+/* Column. */
+
+static PyObject *
+int64column_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"path", "access", "writable", NULL};
+    PyObject* path;
+    PyObject* access = Py_None;
+    int writable = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|$Op:Column", kwlist,
+                                     &path, &access, &writable))
+    {
+        return NULL;
+    }
+
+    const int fd = PyInt64File_Open(path, writable ? O_RDWR : O_RDONLY);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+
+    unsigned char raw[PYINT64_COLUMN_HEADER_SIZE];
+    int64column_header header;
+    uint64_t size;
+    if (int64column_file_size(fd, path, &size) < 0
+        || (size >= PYINT64_COLUMN_HEADER_SIZE
+            && int64column_read_at(fd, path, 0, raw, PYINT64_COLUMN_HEADER_SIZE) < 0)
+        || int64column_header_unpack(raw, size, path, &header) < 0)
+    {
+        PyInt64File_Close(fd);
+        return NULL;
+    }
+
+    if (size > (uint64_t)PY_SSIZE_T_MAX)
+    {
+        PyInt64File_Close(fd);
+        PyErr_Format(PyExc_OverflowError, "%R is too large to map", path);
+        return NULL;
+    }
+
+    char* base = int64column_map(fd, path, (size_t)size, writable);
+    PyInt64File_Close(fd);
+    if (!base)
+    {
+        return NULL;
+    }
+
+    PyInt64ColumnObject* self = (PyInt64ColumnObject*)type->tp_alloc(type, 0);
+    if (!self)
+    {
+        int64column_unmap(base, (size_t)size);
+        return NULL;
+    }
+
+    self->ob_map = base;
+    self->ob_map_size = (size_t)size;
+    self->ob_item = (int64_t*)(base + PYINT64_COLUMN_HEADER_SIZE);
+    self->ob_length = (Py_ssize_t)header.count;
+    self->ob_checksums = (const uint64_t*)(self->ob_item + self->ob_length);
+    self->ob_block_size = (Py_ssize_t)header.block_size;
+    self->ob_min = header.min;
+    self->ob_max = header.max;
+    self->ob_flags = header.flags;
+    self->ob_swapped = header.byteorder != (PY_LITTLE_ENDIAN ? '<' : '>');
+    self->ob_writable = writable;
+    self->ob_path = Py_NewRef(path);
+
+    if (writable && (header.flags & (PYINT64_COLUMN_MINMAX | PYINT64_COLUMN_CHECKSUMS)))
+    {
+        // Writes through the mapping would silently invalidate both.
+        self->ob_flags = 0;
+        base[11] = 0;
+    }
+
+    if (access != Py_None)
+    {
+        PyObject* advise_args = PyTuple_Pack(1, access);
+        PyObject* result = advise_args ? int64column_advise(self, advise_args, NULL) : NULL;
+        Py_XDECREF(advise_args);
+        if (!result)
+        {
+            Py_DECREF(self);
+            return NULL;
+        }
+
+        Py_DECREF(result);
+    }
+
+    return (PyObject*)self;
+}
+
+static void
+int64column_dealloc(PyInt64ColumnObject *self)
+{
+    PyTypeObject* type = Py_TYPE(self);
+    if (self->ob_map)
+    {
+        int64column_unmap(self->ob_map, self->ob_map_size);
+    }
+
+    Py_XDECREF(self->ob_path);
+    type->tp_free((PyObject*)self);
+    Py_DECREF(type);
+}
+
+static PyObject *
+int64column_repr(PyInt64ColumnObject *self)
+{
+    if (!self->ob_map)
+    {
+        return PyUnicode_FromFormat("<closed %s %R>", _PyType_Name(Py_TYPE(self)), self->ob_path);
+    }
+
+    return PyUnicode_FromFormat("%s(%R, length=%zd)", _PyType_Name(Py_TYPE(self)),
+                                self->ob_path, self->ob_length);
+}
+
+static Py_ssize_t
+int64column_length(PyInt64ColumnObject *self)
+{
+    CHECK_OPEN(self, -1);
+    return self->ob_length;
+}
+
+static PyObject *
+int64column_item(PyInt64ColumnObject *self, Py_ssize_t index)
+{
+    PyInt64State* state = PyInt64State_OfType(Py_TYPE(self));
+    CHECK_OPEN(self, NULL);
+    if (index < 0 || index >= self->ob_length)
+    {
+        PyErr_SetString(PyExc_IndexError, "Column index out of range");
+        return NULL;
+    }
+
+    const int64_t value = self->ob_item[index];
+    return PyInt64_FromInt64Ex(state, self->ob_swapped ? pyint64_op_bswap(value) : value);
+}
+
+static int
+int64column_getbuffer(PyInt64ColumnObject *self, Py_buffer *view, int flags)
+{
+    static Py_ssize_t stride = sizeof(int64_t);
+
+    CHECK_OPEN(self, -1);
+    if (!self->ob_writable && (flags & PyBUF_WRITABLE) == PyBUF_WRITABLE)
+    {
+        PyErr_SetString(PyExc_BufferError, "Column is not writable");
+        return -1;
+    }
+
+    view->obj = Py_NewRef(self);
+    view->buf = self->ob_item;
+    view->len = self->ob_length * (Py_ssize_t)sizeof(int64_t);
+    view->readonly = !self->ob_writable;
+    view->itemsize = sizeof(int64_t);
+    view->format = NULL;
+    if (flags & PyBUF_FORMAT)
+    {
+        view->format = !self->ob_swapped ? "q" : PY_LITTLE_ENDIAN ? ">q" : "<q";
+    }
+
+    view->ndim = 1;
+    view->shape = (flags & PyBUF_ND) ? &self->ob_length : NULL;
+    view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? &stride : NULL;
+    view->suboffsets = NULL;
+    view->internal = NULL;
+
+    ++self->ob_exports;
+    return 0;
+}
+
+static void
+int64column_releasebuffer(PyInt64ColumnObject *self, Py_buffer *view)
+{
+    --self->ob_exports;
+}
+
+static PyObject *
+int64column_advise(PyInt64ColumnObject *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"access", "start", "stop", NULL};
+    static const struct
+    {
+        const char* name;
+        int advice;
+    } accesses[] =
+    {
+        {"normal", INT64COLUMN_NORMAL},
+        {"sequential", INT64COLUMN_SEQUENTIAL},
+        {"random", INT64COLUMN_RANDOM},
+        {"willneed", INT64COLUMN_WILLNEED},
+        {"dontneed", INT64COLUMN_DONTNEED},
+    };
+    const char* access;
+    Py_ssize_t start = 0;
+    PyObject* stop_arg = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "s|nO:advise", kwlist,
+                                     &access, &start, &stop_arg))
+    {
+        return NULL;
+    }
+
+    CHECK_OPEN(self, NULL);
+
+    int advice = -2;
+    for (size_t index = 0; index < Py_ARRAY_LENGTH(accesses); ++index)
+    {
+        if (strcmp(access, accesses[index].name) == 0)
+        {
+            advice = accesses[index].advice;
+        }
+    }
+
+    if (advice == -2)
+    {
+        PyErr_Format(PyExc_ValueError,
+            "access must be 'normal', 'sequential', 'random', 'willneed' or 'dontneed', not '%s'",
+            access);
+        return NULL;
+    }
+
+    Py_ssize_t stop = self->ob_length;
+    if (stop_arg != Py_None)
+    {
+        stop = PyNumber_AsSsize_t(stop_arg, PyExc_OverflowError);
+        if (stop == -1 && PyErr_Occurred())
+        {
+            return NULL;
+        }
+    }
+
+    PySlice_AdjustIndices(self->ob_length, &start, &stop, 1);
+    if (advice < 0 || start >= stop)
+    {
+        Py_RETURN_NONE;
+    }
+
+#ifndef _WIN32
+    // madvise takes whole pages, the first one may hold the header.
+    const uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    const uintptr_t begin = (uintptr_t)(self->ob_item + start) & ~(page - 1);
+    const uintptr_t end = (uintptr_t)(self->ob_item + stop);
+    if (madvise((void*)begin, end - begin, advice) < 0)
+    {
+        PyErr_SetFromErrnoWithFilenameObject(PyExc_OSError, self->ob_path);
+        return NULL;
+    }
+#endif
+
+    Py_RETURN_NONE;
+}
+
+typedef struct
+{
+    const int64_t* items;
+    const uint64_t* checksums;  // NULL to skip them
+    int swap;
+    int64_t* mins;              // one per block
+    int64_t* maxs;
+} int64column_verify_job;
+
+// One chunk is one checksum block.
+static int
+int64column_verify_task(Py_ssize_t begin, Py_ssize_t end, Py_ssize_t chunk, void *arg)
+{
+    const int64column_verify_job* job = arg;
+    const int64_t* items = job->items + begin;
+    const Py_ssize_t n = end - begin;
+
+    if (job->swap)
+    {
+        int64_t low = INT64_MAX;
+        int64_t high = INT64_MIN;
+        for (Py_ssize_t index = 0; index < n; ++index)
+        {
+            const int64_t value = pyint64_op_bswap(items[index]);
+            low = value < low ? value : low;
+            high = value > high ? value : high;
+        }
+
+        job->mins[chunk] = low;
+        job->maxs[chunk] = high;
+    }
+    else
+    {
+        job->mins[chunk] = PyInt64Kernels_Get()->min(items, n, INT64_MAX);
+        job->maxs[chunk] = PyInt64Kernels_Get()->max(items, n, INT64_MIN);
+    }
+
+    if (!job->checksums)
+    {
+        return 0;
+    }
+
+    PyInt64ColumnHasher hasher;
+    int64column_hasher_reset(&hasher);
+    int64column_hasher_update(&hasher, items, n, job->swap);
+
+    const uint64_t expected = job->swap
+        ? (uint64_t)pyint64_op_bswap((int64_t)job->checksums[chunk]) : job->checksums[chunk];
+    return int64column_hasher_digest(&hasher) != expected;
+}
+
+static PyObject *
+int64column_verify(PyInt64ColumnObject *self, PyObject *unused)
+{
+    CHECK_OPEN(self, NULL);
+
+    const Py_ssize_t length = self->ob_length;
+    const Py_ssize_t block_size = self->ob_block_size;
+    const Py_ssize_t blocks = int64column_blocks((uint64_t)length, (uint64_t)block_size);
+
+    int64_t* bounds = PyMem_Malloc(Py_MAX(blocks, 1) * 2 * sizeof(int64_t));
+    if (!bounds)
+    {
+        return PyErr_NoMemory();
+    }
+
+    int64column_verify_job job = {
+        self->ob_item,
+        (self->ob_flags & PYINT64_COLUMN_CHECKSUMS) ? self->ob_checksums : NULL,
+        self->ob_swapped, bounds, bounds + blocks
+    };
+
+    // Held like a buffer export so that no thread unmaps the file meanwhile.
+    ++self->ob_exports;
+    const int failed = PyInt64Pool_For(length, block_size, int64column_verify_task, &job);
+    --self->ob_exports;
+
+    Py_ssize_t bad = -1;
+    for (Py_ssize_t block = 0; failed && block < blocks && bad < 0; ++block)
+    {
+        const Py_ssize_t begin = block * block_size;
+        if (int64column_verify_task(begin, Py_MIN(begin + block_size, length), block, &job))
+        {
+            bad = block;
+        }
+    }
+
+    int64_t low = INT64_MAX;
+    int64_t high = INT64_MIN;
+    for (Py_ssize_t block = 0; block < blocks; ++block)
+    {
+        low = Py_MIN(low, bounds[block]);
+        high = Py_MAX(high, bounds[block + blocks]);
+    }
+
+    PyMem_Free(bounds);
+
+    if (bad >= 0)
+    {
+        PyErr_Format(PyExc_ValueError, "%R: block %zd of %zd fails its checksum",
+                     self->ob_path, bad, blocks);
+        return NULL;
+    }
+
+    if ((self->ob_flags & PYINT64_COLUMN_MINMAX) && length > 0
+        && (low != self->ob_min || high != self->ob_max))
+    {
+        PyErr_Format(PyExc_ValueError,
+            "%R: values range over [%lld, %lld], the header records [%lld, %lld]",
+            self->ob_path, (long long)low, (long long)high,
+            (long long)self->ob_min, (long long)self->ob_max);
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+int64column_close(PyInt64ColumnObject *self, PyObject *unused)
+{
+    if (!self->ob_map)
+    {
+        Py_RETURN_NONE;
+    }
+
+    if (self->ob_exports > 0)
+    {
+        PyErr_SetString(PyExc_BufferError, "cannot close Column: exported buffers exist");
+        return NULL;
+    }
+
+    int64column_unmap(self->ob_map, self->ob_map_size);
+    self->ob_map = NULL;
+    self->ob_item = NULL;
+    self->ob_checksums = NULL;
+    self->ob_length = 0;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+int64column_enter(PyObject *self, PyObject *unused)
+{
+    return Py_NewRef(self);
+}
+
+static PyObject *
+int64column_exit(PyInt64ColumnObject *self, PyObject *args)
+{
+    return int64column_close(self, NULL);
+}
+
+static PyObject *
+int64column_get_path(PyInt64ColumnObject *self, void *closure)
+{
+    return Py_NewRef(self->ob_path);
+}
+
+static PyObject *
+int64column_get_byteorder(PyInt64ColumnObject *self, void *closure)
+{
+    return PyUnicode_FromString(PY_LITTLE_ENDIAN != self->ob_swapped ? "little" : "big");
+}
+
+static PyObject *
+int64column_get_min(PyInt64ColumnObject *self, void *closure)
+{
+    PyInt64State* state = PyInt64State_OfType(Py_TYPE(self));
+    if (!(self->ob_flags & PYINT64_COLUMN_MINMAX))
+    {
+        Py_RETURN_NONE;
+    }
+
+    return PyInt64_FromInt64Ex(state, self->ob_min);
+}
+
+static PyObject *
+int64column_get_max(PyInt64ColumnObject *self, void *closure)
+{
+    PyInt64State* state = PyInt64State_OfType(Py_TYPE(self));
+    if (!(self->ob_flags & PYINT64_COLUMN_MINMAX))
+    {
+        Py_RETURN_NONE;
+    }
+
+    return PyInt64_FromInt64Ex(state, self->ob_max);
+}
+
+static PyObject *
+int64column_get_block_size(PyInt64ColumnObject *self, void *closure)
+{
+    return PyLong_FromSsize_t(self->ob_block_size);
+}
+
+static PyObject *
+int64column_get_checksums(PyInt64ColumnObject *self, void *closure)
+{
+    return PyBool_FromLong(self->ob_flags & PYINT64_COLUMN_CHECKSUMS);
+}
+
+static PyObject *
+int64column_get_writable(PyInt64ColumnObject *self, void *closure)
+{
+    return PyBool_FromLong(self->ob_writable);
+}
+
+static PyObject *
+int64column_get_closed(PyInt64ColumnObject *self, void *closure)
+{
+    return PyBool_FromLong(!self->ob_map);
+}
+
+/* ColumnWriter. */
+
+static int
+int64writer_write_header(PyInt64ColumnWriterObject *self, int flags)
+{
+    int64column_header header = {
+        PYINT64_COLUMN_VERSION, PY_LITTLE_ENDIAN ? '<' : '>',
+        self->ob_length > 0 ? flags : flags & ~PYINT64_COLUMN_MINMAX,
+        (uint64_t)self->ob_length, self->ob_min, self->ob_max, (uint64_t)self->ob_block_size
+    };
+
+    unsigned char raw[PYINT64_COLUMN_HEADER_SIZE];
+    int64column_header_pack(&header, raw);
+    return int64column_write_at(self->fd, self->ob_path, 0, raw, sizeof(raw));
+}
+
+// Make room for the checksums of the blocks completed by count values.
+static int
+int64writer_reserve(PyInt64ColumnWriterObject *self, Py_ssize_t count)
+{
+    const Py_ssize_t blocks = count / self->ob_block_size;
+    if (blocks <= self->ob_checksums_allocated)
+    {
+        return 0;
+    }
+
+    const Py_ssize_t allocated = Py_MAX(blocks, self->ob_checksums_allocated * 2);
+    uint64_t* checksums = PyMem_Realloc(self->ob_checksums, allocated * sizeof(uint64_t));
+    if (!checksums)
+    {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    self->ob_checksums = checksums;
+    self->ob_checksums_allocated = allocated;
+    return 0;
+}
+
+// Feed n values that follow the first ob_length into the checksums and bounds.
+static void
+int64writer_account(PyInt64ColumnWriterObject *self, const int64_t *items, Py_ssize_t n)
+{
+    if (n == 0)
+    {
+        return;
+    }
+
+    if (self->ob_flags & PYINT64_COLUMN_MINMAX)
+    {
+        self->ob_min = PyInt64Kernels_Get()->min(items, n, self->ob_min);
+        self->ob_max = PyInt64Kernels_Get()->max(items, n, self->ob_max);
+    }
+
+    if (self->ob_flags & PYINT64_COLUMN_CHECKSUMS)
+    {
+        while (n > 0)
+        {
+            const Py_ssize_t take = Py_MIN(n, self->ob_block_size - self->hasher.length);
+            int64column_hasher_update(&self->hasher, items, take, 0);
+            if (self->hasher.length == self->ob_block_size)
+            {
+                self->ob_checksums[(self->ob_length + take) / self->ob_block_size - 1] =
+                    int64column_hasher_digest(&self->hasher);
+                int64column_hasher_reset(&self->hasher);
+            }
+
+            self->ob_length += take;
+            items += take;
+            n -= take;
+        }
+
+        return;
+    }
+
+    self->ob_length += n;
+}
+
+// Pick up the checksums of an existing file and rehash its last block.
+static int
+int64writer_resume(PyInt64ColumnWriterObject *self, const int64column_header *header)
+{
+    const Py_ssize_t length = (Py_ssize_t)header->count;
+    const Py_ssize_t full = length / self->ob_block_size;
+    const uint64_t trailer = PYINT64_COLUMN_HEADER_SIZE + (uint64_t)length * sizeof(int64_t);
+
+    if (int64writer_reserve(self, length) < 0
+        || (full > 0 && int64column_read_at(self->fd, self->ob_path, trailer,
+                                            self->ob_checksums, full * sizeof(uint64_t)) < 0))
+    {
+        return -1;
+    }
+
+    const Py_ssize_t tail = length - full * self->ob_block_size;
+    int64_t* items = PyMem_Malloc(Py_MIN(Py_MAX(tail, 1), INT64COLUMN_REHASH_CHUNK) * sizeof(int64_t));
+    if (!items)
+    {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    for (Py_ssize_t done = 0; done < tail; done += INT64COLUMN_REHASH_CHUNK)
+    {
+        const Py_ssize_t n = Py_MIN(tail - done, INT64COLUMN_REHASH_CHUNK);
+        const uint64_t offset = PYINT64_COLUMN_HEADER_SIZE
+            + (uint64_t)(full * self->ob_block_size + done) * sizeof(int64_t);
+        if (int64column_read_at(self->fd, self->ob_path, offset, items, n * sizeof(int64_t)) < 0)
+        {
+            PyMem_Free(items);
+            return -1;
+        }
+
+        int64column_hasher_update(&self->hasher, items, n, 0);
+    }
+
+    PyMem_Free(items);
+    return 0;
+}
+
+static PyObject *
+int64writer_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"path", "block_size", "checksums", NULL};
+    PyObject* path;
+    Py_ssize_t block_size = PYINT64_COLUMN_BLOCK_SIZE;
+    int checksums = 1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|$np:ColumnWriter", kwlist,
+                                     &path, &block_size, &checksums))
+    {
+        return NULL;
+    }
+
+    if (block_size <= 0 || (size_t)block_size > PY_SSIZE_T_MAX / sizeof(int64_t))
+    {
+        PyErr_SetString(PyExc_ValueError, "block_size must be positive");
+        return NULL;
+    }
+
+    PyInt64ColumnWriterObject* self = (PyInt64ColumnWriterObject*)type->tp_alloc(type, 0);
+    if (!self)
+    {
+        return NULL;
+    }
+
+    self->fd = -1;
+    self->ob_path = Py_NewRef(path);
+    self->ob_min = INT64_MAX;
+    self->ob_max = INT64_MIN;
+    int64column_hasher_reset(&self->hasher);
+
+    self->fd = PyInt64File_Open(path, O_RDWR | O_CREAT);
+    uint64_t size;
+    if (self->fd < 0 || int64column_file_size(self->fd, path, &size) < 0)
+    {
+        Py_DECREF(self);
+        return NULL;
+    }
+
+    unsigned char raw[PYINT64_COLUMN_HEADER_SIZE];
+    int64column_header header = {0};
+    if (size > 0
+        && (int64column_read_at(self->fd, path, 0, raw, PYINT64_COLUMN_HEADER_SIZE) < 0
+            || int64column_header_unpack(raw, size, path, &header) < 0))
+    {
+        Py_DECREF(self);
+        return NULL;
+    }
+
+    if (header.count == 0)
+    {
+        // A new or empty file takes the settings of the call.
+        self->ob_block_size = block_size;
+        self->ob_flags = PYINT64_COLUMN_MINMAX | (checksums ? PYINT64_COLUMN_CHECKSUMS : 0);
+        if (int64writer_write_header(self, self->ob_flags) < 0
+            || int64column_truncate(self->fd, path, PYINT64_COLUMN_HEADER_SIZE) < 0)
+        {
+            Py_DECREF(self);
+            return NULL;
+        }
+
+        self->ob_sealed = 1;
+        return (PyObject*)self;
+    }
+
+    if (header.byteorder != (PY_LITTLE_ENDIAN ? '<' : '>'))
+    {
+        PyErr_Format(PyExc_ValueError,
+                     "cannot append to %R, its values are in the other byte order", path);
+        Py_DECREF(self);
+        return NULL;
+    }
+
+    self->ob_block_size = (Py_ssize_t)header.block_size;
+    self->ob_flags = header.flags & (PYINT64_COLUMN_MINMAX | PYINT64_COLUMN_CHECKSUMS);
+    self->ob_min = header.min;
+    self->ob_max = header.max;
+    if ((self->ob_flags & PYINT64_COLUMN_CHECKSUMS) && int64writer_resume(self, &header) < 0)
+    {
+        Py_DECREF(self);
+        return NULL;
+    }
+
+    self->ob_length = (Py_ssize_t)header.count;
+    self->ob_sealed = 1;
+    return (PyObject*)self;
+}
+
+static void
+int64writer_dealloc(PyInt64ColumnWriterObject *self)
+{
+    PyTypeObject* type = Py_TYPE(self);
+    if (self->fd >= 0)
+    {
+        PyObject *error_type, *error_value, *error_traceback;
+        PyErr_Fetch(&error_type, &error_value, &error_traceback);
+
+        PyObject* result = int64writer_close(self, NULL);
+        if (!result)
+        {
+            PyErr_WriteUnraisable((PyObject*)self);
+        }
+
+        Py_XDECREF(result);
+        PyErr_Restore(error_type, error_value, error_traceback);
+    }
+
+    PyMem_Free(self->ob_checksums);
+    Py_XDECREF(self->ob_path);
+    type->tp_free((PyObject*)self);
+    Py_DECREF(type);
+}
+
+static PyObject *
+int64writer_repr(PyInt64ColumnWriterObject *self)
+{
+    if (self->fd < 0)
+    {
+        return PyUnicode_FromFormat("<closed %s %R>", _PyType_Name(Py_TYPE(self)), self->ob_path);
+    }
+
+    return PyUnicode_FromFormat("%s(%R, count=%zd)", _PyType_Name(Py_TYPE(self)),
+                                self->ob_path, self->ob_length);
+}
+
+static PyObject *
+int64writer_append(PyInt64ColumnWriterObject *self, PyObject *values)
+{
+    CHECK_WRITER_OPEN(self, NULL);
+
+    PyInt64Buffer buffer;
+    if (PyInt64Buffer_Get(values, &buffer) < 0)
+    {
+        return NULL;
+    }
+
+    const Py_ssize_t n = buffer.length;
+    if (n > ((PY_SSIZE_T_MAX - PYINT64_COLUMN_HEADER_SIZE) / (Py_ssize_t)sizeof(int64_t))
+            - self->ob_length)
+    {
+        PyInt64Buffer_Release(&buffer);
+        PyErr_SetString(PyExc_OverflowError, "column file too large");
+        return NULL;
+    }
+
+    if (n == 0)
+    {
+        PyInt64Buffer_Release(&buffer);
+        Py_RETURN_NONE;
+    }
+
+    if ((self->ob_flags & PYINT64_COLUMN_CHECKSUMS)
+        && int64writer_reserve(self, self->ob_length + n) < 0)
+    {
+        PyInt64Buffer_Release(&buffer);
+        return NULL;
+    }
+
+    // The values overwrite the checksums of the last flush.
+    if (self->ob_sealed && (self->ob_flags & PYINT64_COLUMN_CHECKSUMS)
+        && int64writer_write_header(self, self->ob_flags & ~PYINT64_COLUMN_CHECKSUMS) < 0)
+    {
+        PyInt64Buffer_Release(&buffer);
+        return NULL;
+    }
+
+    self->ob_sealed = 0;
+
+    const uint64_t offset = PYINT64_COLUMN_HEADER_SIZE + (uint64_t)self->ob_length * sizeof(int64_t);
+    if (int64column_write_at(self->fd, self->ob_path, offset, buffer.items,
+                             (size_t)n * sizeof(int64_t)) < 0)
+    {
+        PyInt64Buffer_Release(&buffer);
+        return NULL;
+    }
+
+    int64writer_account(self, buffer.items, n);
+    PyInt64Buffer_Release(&buffer);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+int64writer_flush(PyInt64ColumnWriterObject *self, PyObject *unused)
+{
+    CHECK_WRITER_OPEN(self, NULL);
+    if (self->ob_sealed)
+    {
+        Py_RETURN_NONE;
+    }
+
+    uint64_t end = PYINT64_COLUMN_HEADER_SIZE + (uint64_t)self->ob_length * sizeof(int64_t);
+    if (self->ob_flags & PYINT64_COLUMN_CHECKSUMS)
+    {
+        const Py_ssize_t full = self->ob_length / self->ob_block_size;
+        if (int64column_write_at(self->fd, self->ob_path, end, self->ob_checksums,
+                                 (size_t)full * sizeof(uint64_t)) < 0)
+        {
+            return NULL;
+        }
+
+        end += (uint64_t)full * sizeof(uint64_t);
+        if (self->hasher.length > 0)
+        {
+            const uint64_t last = int64column_hasher_digest(&self->hasher);
+            if (int64column_write_at(self->fd, self->ob_path, end, &last, sizeof(last)) < 0)
+            {
+                return NULL;
+            }
+
+            end += sizeof(last);
+        }
+    }
+
+    if (int64column_truncate(self->fd, self->ob_path, end) < 0
+        || int64writer_write_header(self, self->ob_flags) < 0)
+    {
+        return NULL;
+    }
+
+    self->ob_sealed = 1;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+int64writer_close(PyInt64ColumnWriterObject *self, PyObject *unused)
+{
+    if (self->fd < 0)
+    {
+        Py_RETURN_NONE;
+    }
+
+    PyObject* result = int64writer_flush(self, NULL);
+    PyInt64File_Close(self->fd);
+    self->fd = -1;
+    return result;
+}
+
+static PyObject *
+int64writer_exit(PyInt64ColumnWriterObject *self, PyObject *args)
+{
+    return int64writer_close(self, NULL);
+}
+
+static PyObject *
+int64writer_get_path(PyInt64ColumnWriterObject *self, void *closure)
+{
+    return Py_NewRef(self->ob_path);
+}
+
+static PyObject *
+int64writer_get_count(PyInt64ColumnWriterObject *self, void *closure)
+{
+    return PyLong_FromSsize_t(self->ob_length);
+}
+
+static PyObject *
+int64writer_get_block_size(PyInt64ColumnWriterObject *self, void *closure)
+{
+    return PyLong_FromSsize_t(self->ob_block_size);
+}
+
+static PyObject *
+int64writer_get_checksums(PyInt64ColumnWriterObject *self, void *closure)
+{
+    return PyBool_FromLong(self->ob_flags & PYINT64_COLUMN_CHECKSUMS);
+}
+
+static PyObject *
+int64writer_get_closed(PyInt64ColumnWriterObject *self, void *closure)
+{
+    return PyBool_FromLong(self->fd < 0);
+}
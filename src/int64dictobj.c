@@ -0,0 +1,1359 @@
+#include "pyint64obj.h"
+#include "int64arrayobj.h"
+#include "int64dictobj.h"
+#include "int64kernels.h"
+#include "int64ops.h"
+
+static PyObject *
+int64dict_new(PyTypeObject *type, PyObject *args, PyObject *kwds);
+
+static void
+int64dict_dealloc(PyInt64DictObject *self);
+
+static int
+int64dict_traverse(PyInt64DictObject *self, visitproc visit, void *arg);
+
+static int
+int64dict_clear(PyInt64DictObject *self);
+
+static PyObject *
+int64dict_repr(PyInt64DictObject *self);
+
+static Py_ssize_t
+int64dict_length(PyInt64DictObject *self);
+
+static int
+int64dict_contains(PyInt64DictObject *self, PyObject *key);
+
+static PyObject *
+int64dict_subscript(PyInt64DictObject *self, PyObject *key);
+
+static int
+int64dict_ass_subscript(PyInt64DictObject *self, PyObject *key, PyObject *value);
+
+static PyObject *
+int64dict_iter(PyInt64DictObject *self);
+
+static PyObject *
+int64dict_get(PyInt64DictObject *self, PyObject *args);
+
+static PyObject *
+int64dict_pop(PyInt64DictObject *self, PyObject *args);
+
+static PyObject *
+int64dict_clear_method(PyInt64DictObject *self, PyObject *unused);
+
+static PyObject *
+int64dict_reserve(PyInt64DictObject *self, PyObject *arg);
+
+static PyObject *
+int64dict_update(PyInt64DictObject *self, PyObject *other);
+
+static PyObject *
+int64dict_keys(PyInt64DictObject *self, PyObject *unused);
+
+static PyObject *
+int64dict_values(PyInt64DictObject *self, PyObject *unused);
+
+static PyObject *
+int64dict_items(PyInt64DictObject *self, PyObject *unused);
+
+static PyObject *
+int64dict_get_many(PyInt64DictObject *self, PyObject *args, PyObject *kwds);
+
+static PyObject *
+int64dict_set_many(PyInt64DictObject *self, PyObject *args);
+
+static PyObject *
+int64dict_richcompare(PyInt64DictObject *self, PyObject *other, int op);
+
+static PyObject *
+int64counter_new(PyTypeObject *type, PyObject *args, PyObject *kwds);
+
+static void
+int64counter_dealloc(PyInt64DictObject *self);
+
+static PyObject *
+int64counter_repr(PyInt64DictObject *self);
+
+static PyObject *
+int64counter_subscript(PyInt64DictObject *self, PyObject *key);
+
+static int
+int64counter_ass_subscript(PyInt64DictObject *self, PyObject *key, PyObject *value);
+
+static PyObject *
+int64counter_pop(PyInt64DictObject *self, PyObject *args);
+
+static PyObject *
+int64counter_clear_method(PyInt64DictObject *self, PyObject *unused);
+
+static PyObject *
+int64counter_values(PyInt64DictObject *self, PyObject *unused);
+
+static PyObject *
+int64counter_items(PyInt64DictObject *self, PyObject *unused);
+
+static PyObject *
+int64counter_add(PyInt64DictObject *self, PyObject *args, PyObject *kwds);
+
+static PyObject *
+int64counter_get_many(PyInt64DictObject *self, PyObject *keys);
+
+static PyObject *
+int64counter_richcompare(PyInt64DictObject *self, PyObject *other, int op);
+
+static
+PyMethodDef int64dict_methods[] =
+{
+    {"get", (PyCFunction)int64dict_get, METH_VARARGS,
+        "get(key, default=None)\n"
+        "Return the value for key if present, else default."},
+    {"pop", (PyCFunction)int64dict_pop, METH_VARARGS,
+        "pop(key[, default])\n"
+        "Remove key and return its value, or default if given and key is absent."},
+    {"clear", (PyCFunction)int64dict_clear_method, METH_NOARGS,
+        "Remove all entries and release the table."},
+    {"reserve", (PyCFunction)int64dict_reserve, METH_O,
+        "reserve(n)\n"
+        "Grow the table so that n keys fit without rehashing."},
+    {"update", (PyCFunction)int64dict_update, METH_O,
+        "update(other)\n"
+        "Add the entries of a mapping or of an iterable of (key, value) pairs."},
+    {"keys", (PyCFunction)int64dict_keys, METH_NOARGS,
+        "Return the keys as an Int64Array."},
+    {"values", (PyCFunction)int64dict_values, METH_NOARGS,
+        "Return the values as a list, in key order."},
+    {"items", (PyCFunction)int64dict_items, METH_NOARGS,
+        "Return a list of (key, value) tuples."},
+    {"get_many", (PyCFunction)(void(*)(void))int64dict_get_many, METH_VARARGS | METH_KEYWORDS,
+        "get_many(keys, default=None)\n"
+        "Look up every key of an int64 buffer or iterable, return a list."},
+    {"set_many", (PyCFunction)int64dict_set_many, METH_VARARGS,
+        "set_many(keys, values)\n"
+        "Set keys[i] to values[i] for an int64 buffer or iterable of keys\n"
+        "and a sequence of values of the same length."},
+    {NULL} /* sentinel */
+};
+
+static
+PyMethodDef int64counter_methods[] =
+{
+    {"pop", (PyCFunction)int64counter_pop, METH_VARARGS,
+        "pop(key[, default])\n"
+        "Remove key and return its count, or default if given and key is absent."},
+    {"clear", (PyCFunction)int64counter_clear_method, METH_NOARGS,
+        "Remove all entries and release the table."},
+    {"reserve", (PyCFunction)int64dict_reserve, METH_O,
+        "reserve(n)\n"
+        "Grow the table so that n keys fit without rehashing."},
+    {"keys", (PyCFunction)int64dict_keys, METH_NOARGS,
+        "Return the keys as an Int64Array."},
+    {"values", (PyCFunction)int64counter_values, METH_NOARGS,
+        "Return the counts as an Int64Array, in key order."},
+    {"items", (PyCFunction)int64counter_items, METH_NOARGS,
+        "Return a list of (key, count) tuples."},
+    {"add", (PyCFunction)(void(*)(void))int64counter_add, METH_VARARGS | METH_KEYWORDS,
+        "add(keys, counts=1)\n"
+        "Add counts (an int, or an int64 buffer or iterable as long as keys)\n"
+        "to the count of every key of an int64 buffer or iterable. Overflow\n"
+        "follows the overflow policy, 'promote' behaves like 'checked'."},
+    {"get_many", (PyCFunction)int64counter_get_many, METH_O,
+        "get_many(keys)\n"
+        "Return the counts of every key as an Int64Array, zero if absent."},
+    {NULL} /* sentinel */
+};
+
+// Type objects.
+static
+PyType_Slot int64dict_slots[] =
+{
+    {Py_tp_doc, "Int64Dict(other=(), /)\n"
+                "Mapping from int64 keys to objects, stored in a flat hash table\n"
+                "of unboxed keys."},
+    {Py_tp_dealloc, int64dict_dealloc},
+    {Py_tp_repr, int64dict_repr},
+    {Py_tp_hash, PyObject_HashNotImplemented},
+    {Py_tp_getattro, PyObject_GenericGetAttr},
+    {Py_tp_richcompare, int64dict_richcompare},
+    {Py_tp_traverse, int64dict_traverse},
+    {Py_tp_clear, int64dict_clear},
+    {Py_tp_iter, int64dict_iter},
+    {Py_tp_methods, int64dict_methods},
+    {Py_tp_new, int64dict_new},
+    {Py_sq_contains, int64dict_contains},
+    {Py_mp_length, int64dict_length},
+    {Py_mp_subscript, int64dict_subscript},
+    {Py_mp_ass_subscript, int64dict_ass_subscript},
+    {0, NULL}
+};
+
+PyType_Spec PyInt64Dict_Spec =
+{
+    .name = "pyint64.Int64Dict",
+    .basicsize = sizeof(PyInt64DictObject),
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE | Py_TPFLAGS_BASETYPE
+             | Py_TPFLAGS_HAVE_GC | Py_TPFLAGS_MAPPING,
+    .slots = int64dict_slots,
+};
+
+static
+PyType_Slot int64counter_slots[] =
+{
+    {Py_tp_doc, "Int64Counter(keys=(), /)\n"
+                "Mapping from int64 keys to int64 counts, missing keys count as\n"
+                "zero. A mapping argument copies its counts, anything else is\n"
+                "counted as keys."},
+    {Py_tp_dealloc, int64counter_dealloc},
+    {Py_tp_repr, int64counter_repr},
+    {Py_tp_hash, PyObject_HashNotImplemented},
+    {Py_tp_getattro, PyObject_GenericGetAttr},
+    {Py_tp_richcompare, int64counter_richcompare},
+    {Py_tp_iter, int64dict_iter},
+    {Py_tp_methods, int64counter_methods},
+    {Py_tp_new, int64counter_new},
+    {Py_sq_contains, int64dict_contains},
+    {Py_mp_length, int64dict_length},
+    {Py_mp_subscript, int64counter_subscript},
+    {Py_mp_ass_subscript, int64counter_ass_subscript},
+    {0, NULL}
+};
+
+PyType_Spec PyInt64Counter_Spec =
+{
+    .name = "pyint64.Int64Counter",
+    .basicsize = sizeof(PyInt64DictObject),
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_MAPPING,
+    .slots = int64counter_slots,
+};
+
+static inline int
+int64dict_key(PyObject *obj, int64_t *key)
+{
+    if (PyInt64_CheckExact(obj))
+    {
+        *key = PyInt64_GetValue(obj);
+        return 0;
+    }
+
+    *key = PyInt64_AsInt64(obj);
+    return (*key == -1 && PyErr_Occurred()) ? -1 : 0;
+}
+
+// Int64Dict
+
+static int
+int64dict_set(PyInt64DictObject *self, int64_t key, PyObject *value)
+{
+    int inserted;
+    const Py_ssize_t slot = PyInt64Table_Insert(&self->table, key, &inserted);
+    if (slot < 0)
+    {
+        return -1;
+    }
+
+    // Release the old value last, its finalizer may change the table.
+    PyObject* old = self->table.values[slot].object;
+    self->table.values[slot].object = Py_NewRef(value);
+    Py_XDECREF(old);
+    return 0;
+}
+
+static int
+int64dict_update_pairs(PyInt64DictObject *self, PyObject *iterable)
+{
+    PyObject* iterator = PyObject_GetIter(iterable);
+    if (!iterator)
+    {
+        return -1;
+    }
+
+    PyObject* item;
+    while ((item = PyIter_Next(iterator)))
+    {
+        PyObject* pair = PySequence_Fast(item, "Int64Dict update sequence element must be a pair");
+        Py_DECREF(item);
+        if (!pair)
+        {
+            Py_DECREF(iterator);
+            return -1;
+        }
+
+        int64_t key;
+        int failed = 1;
+        if (PySequence_Fast_GET_SIZE(pair) != 2)
+        {
+            PyErr_Format(PyExc_ValueError,
+                "Int64Dict update sequence element has length %zd; 2 is required",
+                PySequence_Fast_GET_SIZE(pair));
+        }
+        else
+        {
+            failed = int64dict_key(PySequence_Fast_GET_ITEM(pair, 0), &key) < 0
+                || int64dict_set(self, key, PySequence_Fast_GET_ITEM(pair, 1)) < 0;
+        }
+
+        Py_DECREF(pair);
+        if (failed)
+        {
+            Py_DECREF(iterator);
+            return -1;
+        }
+    }
+
+    Py_DECREF(iterator);
+    return PyErr_Occurred() ? -1 : 0;
+}
+
+static int
+int64dict_update_from(PyInt64DictObject *self, PyObject *other)
+{
+    if (PyDict_Check(other))
+    {
+        if (PyInt64Table_Reserve(&self->table, self->table.size + PyDict_GET_SIZE(other)) < 0)
+        {
+            return -1;
+        }
+
+        Py_ssize_t pos = 0;
+        PyObject* key_obj;
+        PyObject* value;
+        while (PyDict_Next(other, &pos, &key_obj, &value))
+        {
+            int64_t key;
+            if (int64dict_key(key_obj, &key) < 0 || int64dict_set(self, key, value) < 0)
+            {
+                return -1;
+            }
+        }
+
+        return 0;
+    }
+
+    if (PyInt64Dict_Check(other))
+    {
+        PyObject* items = int64dict_items((PyInt64DictObject*)other, NULL);
+        if (!items)
+        {
+            return -1;
+        }
+
+        const int result = int64dict_update_pairs(self, items);
+        Py_DECREF(items);
+        return result;
+    }
+
+    PyObject* keys_method = PyObject_GetAttrString(other, "keys");
+    if (!keys_method)
+    {
+        if (!PyErr_ExceptionMatches(PyExc_AttributeError))
+        {
+            return -1;
+        }
+
+        PyErr_Clear();
+        return int64dict_update_pairs(self, other);
+    }
+
+    // Any other mapping: other[k] for k in other.keys().
+    PyObject* keys = PyObject_CallNoArgs(keys_method);
+    Py_DECREF(keys_method);
+    if (!keys)
+    {
+        return -1;
+    }
+
+    PyObject* iterator = PyObject_GetIter(keys);
+    Py_DECREF(keys);
+    if (!iterator)
+    {
+        return -1;
+    }
+
+    PyObject* key_obj;
+    while ((key_obj = PyIter_Next(iterator)))
+    {
+        int64_t key;
+        PyObject* value = PyObject_GetItem(other, key_obj);
+        const int failed = !value
+            || int64dict_key(key_obj, &key) < 0
+            || int64dict_set(self, key, value) < 0;
+
+        Py_XDECREF(value);
+        Py_DECREF(key_obj);
+        if (failed)
+        {
+            Py_DECREF(iterator);
+            return -1;
+        }
+    }
+
+    Py_DECREF(iterator);
+    return PyErr_Occurred() ? -1 : 0;
+}
+
+static PyObject *
+int64dict_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    PyObject* initializer = NULL;
+
+    if (kwds && PyDict_GET_SIZE(kwds) != 0)
+    {
+        PyErr_SetString(PyExc_TypeError, "Int64Dict() takes no keyword arguments");
+        return NULL;
+    }
+
+    if (!PyArg_UnpackTuple(args, "Int64Dict", 0, 1, &initializer))
+    {
+        return NULL;
+    }
+
+    PyInt64DictObject* self = (PyInt64DictObject*)type->tp_alloc(type, 0);
+    if (!self)
+    {
+        return NULL;
+    }
+
+    PyInt64Table_Init(&self->table, 1);
+
+    if (initializer && int64dict_update_from(self, initializer) < 0)
+    {
+        Py_DECREF(self);
+        return NULL;
+    }
+
+    return (PyObject*)self;
+}
+
+static void
+int64dict_dealloc(PyInt64DictObject *self)
+{
+    PyTypeObject* type = Py_TYPE(self);
+    PyObject_GC_UnTrack(self);
+    int64dict_clear(self);
+    type->tp_free((PyObject*)self);
+    Py_DECREF(type);
+}
+
+static int
+int64dict_traverse(PyInt64DictObject *self, visitproc visit, void *arg)
+{
+    Py_VISIT(Py_TYPE(self));
+
+    const PyInt64Table* table = &self->table;
+    for (Py_ssize_t slot = 0; slot < table->capacity; ++slot)
+    {
+        if (PyInt64Table_SLOT_USED(table, slot))
+        {
+            Py_VISIT(table->values[slot].object);
+        }
+    }
+
+    return 0;
+}
+
+static int
+int64dict_clear(PyInt64DictObject *self)
+{
+    // Detach the table first, releasing values may re-enter self.
+    PyInt64Table table = self->table;
+    PyInt64Table_Init(&self->table, 1);
+
+    for (Py_ssize_t slot = 0; slot < table.capacity; ++slot)
+    {
+        if (PyInt64Table_SLOT_USED(&table, slot))
+        {
+            Py_DECREF(table.values[slot].object);
+        }
+    }
+
+    PyInt64Table_Free(&table);
+    return 0;
+}
+
+static PyObject *
+int64dict_repr(PyInt64DictObject *self)
+{
+    PyInt64State* state = PyInt64State_OfType(Py_TYPE(self));
+    if (self->table.size == 0)
+    {
+        return PyUnicode_FromFormat("%s()", _PyType_Name(Py_TYPE(self)));
+    }
+
+    const int status = Py_ReprEnter((PyObject*)self);
+    if (status != 0)
+    {
+        return status > 0
+            ? PyUnicode_FromFormat("%s(...)", _PyType_Name(Py_TYPE(self)))
+            : NULL;
+    }
+
+    PyObject* result = NULL;
+    PyObject* dict = PyDict_New();
+    if (!dict)
+    {
+        goto done;
+    }
+
+    const PyInt64Table* table = &self->table;
+    for (Py_ssize_t slot = 0; slot < table->capacity; ++slot)
+    {
+        if (!PyInt64Table_SLOT_USED(table, slot))
+        {
+            continue;
+        }
+
+        PyObject* key = PyInt64_FromInt64Ex(state, table->keys[slot]);
+        if (!key || PyDict_SetItem(dict, key, table->values[slot].object) < 0)
+        {
+            Py_XDECREF(key);
+            goto done;
+        }
+
+        Py_DECREF(key);
+    }
+
+    result = PyUnicode_FromFormat("%s(%R)", _PyType_Name(Py_TYPE(self)), dict);
+
+done:
+    Py_XDECREF(dict);
+    Py_ReprLeave((PyObject*)self);
+    return result;
+}
+
+static Py_ssize_t
+int64dict_length(PyInt64DictObject *self)
+{
+    return self->table.size;
+}
+
+static int
+int64dict_contains(PyInt64DictObject *self, PyObject *key_obj)
+{
+    int64_t key;
+    const int found = PyInt64Table_LookupKey(key_obj, &key);
+    if (found <= 0)
+    {
+        return found;
+    }
+
+    return PyInt64Table_Lookup(&self->table, key) >= 0;
+}
+
+// Slot of key_obj, or -1 with KeyError (or the conversion error) set.
+static Py_ssize_t
+int64dict_find(PyInt64DictObject *self, PyObject *key_obj)
+{
+    int64_t key;
+    const int found = PyInt64Table_LookupKey(key_obj, &key);
+    if (found < 0)
+    {
+        return -1;
+    }
+
+    const Py_ssize_t slot = found ? PyInt64Table_Lookup(&self->table, key) : -1;
+    if (slot < 0)
+    {
+        PyErr_SetObject(PyExc_KeyError, key_obj);
+    }
+
+    return slot;
+}
+
+static PyObject *
+int64dict_subscript(PyInt64DictObject *self, PyObject *key)
+{
+    const Py_ssize_t slot = int64dict_find(self, key);
+    if (slot < 0)
+    {
+        return NULL;
+    }
+
+    return Py_NewRef(self->table.values[slot].object);
+}
+
+static int
+int64dict_ass_subscript(PyInt64DictObject *self, PyObject *key_obj, PyObject *value)
+{
+    if (value)
+    {
+        int64_t key;
+        if (int64dict_key(key_obj, &key) < 0)
+        {
+            return -1;
+        }
+
+        return int64dict_set(self, key, value);
+    }
+
+    const Py_ssize_t slot = int64dict_find(self, key_obj);
+    if (slot < 0)
+    {
+        return -1;
+    }
+
+    PyObject* old = self->table.values[slot].object;
+    PyInt64Table_DeleteSlot(&self->table, slot);
+    Py_DECREF(old);
+    return 0;
+}
+
+static PyObject *
+int64dict_iter(PyInt64DictObject *self)
+{
+    // Iterate a snapshot of the keys, so the table may change meanwhile.
+    PyObject* keys = int64dict_keys(self, NULL);
+    if (!keys)
+    {
+        return NULL;
+    }
+
+    PyObject* iterator = PyObject_GetIter(keys);
+    Py_DECREF(keys);
+    return iterator;
+}
+
+static PyObject *
+int64dict_get(PyInt64DictObject *self, PyObject *args)
+{
+    PyObject* key_obj;
+    PyObject* default_value = Py_None;
+
+    if (!PyArg_UnpackTuple(args, "get", 1, 2, &key_obj, &default_value))
+    {
+        return NULL;
+    }
+
+    int64_t key;
+    const int found = PyInt64Table_LookupKey(key_obj, &key);
+    if (found < 0)
+    {
+        return NULL;
+    }
+
+    const Py_ssize_t slot = found ? PyInt64Table_Lookup(&self->table, key) : -1;
+    return Py_NewRef(slot >= 0 ? self->table.values[slot].object : default_value);
+}
+
+static PyObject *
+int64dict_pop(PyInt64DictObject *self, PyObject *args)
+{
+    PyObject* key_obj;
+    PyObject* default_value = NULL;
+
+    if (!PyArg_UnpackTuple(args, "pop", 1, 2, &key_obj, &default_value))
+    {
+        return NULL;
+    }
+
+    const Py_ssize_t slot = int64dict_find(self, key_obj);
+    if (slot < 0)
+    {
+        if (default_value && PyErr_ExceptionMatches(PyExc_KeyError))
+        {
+            PyErr_Clear();
+            return Py_NewRef(default_value);
+        }
+
+        return NULL;
+    }
+
+    // The table reference becomes the returned one.
+    PyObject* value = self->table.values[slot].object;
+    PyInt64Table_DeleteSlot(&self->table, slot);
+    return value;
+}
+
+static PyObject *
+int64dict_clear_method(PyInt64DictObject *self, PyObject *unused)
+{
+    int64dict_clear(self);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+int64dict_reserve(PyInt64DictObject *self, PyObject *arg)
+{
+    const Py_ssize_t n = PyNumber_AsSsize_t(arg, PyExc_OverflowError);
+    if (n == -1 && PyErr_Occurred())
+    {
+        return NULL;
+    }
+
+    if (n < 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "reserve() argument must not be negative");
+        return NULL;
+    }
+
+    if (PyInt64Table_Reserve(&self->table, n) < 0)
+    {
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+int64dict_update(PyInt64DictObject *self, PyObject *other)
+{
+    if (int64dict_update_from(self, other) < 0)
+    {
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+int64dict_keys(PyInt64DictObject *self, PyObject *unused)
+{
+    PyInt64State* state = PyInt64State_OfType(Py_TYPE(self));
+    const PyInt64Table* table = &self->table;
+    PyObject* result = PyInt64Array_NewEx(state, table->size);
+    if (!result)
+    {
+        return NULL;
+    }
+
+    int64_t* out = ((PyInt64ArrayObject*)result)->ob_item;
+    for (Py_ssize_t slot = 0; slot < table->capacity; ++slot)
+    {
+        if (PyInt64Table_SLOT_USED(table, slot))
+        {
+            *out++ = table->keys[slot];
+        }
+    }
+
+    return result;
+}
+
+static PyObject *
+int64dict_values(PyInt64DictObject *self, PyObject *unused)
+{
+    const PyInt64Table* table = &self->table;
+    PyObject* result = PyList_New(table->size);
+    if (!result)
+    {
+        return NULL;
+    }
+
+    Py_ssize_t index = 0;
+    for (Py_ssize_t slot = 0; slot < table->capacity; ++slot)
+    {
+        if (PyInt64Table_SLOT_USED(table, slot))
+        {
+            PyList_SET_ITEM(result, index++, Py_NewRef(table->values[slot].object));
+        }
+    }
+
+    return result;
+}
+
+static PyObject *
+int64dict_items(PyInt64DictObject *self, PyObject *unused)
+{
+    PyInt64State* state = PyInt64State_OfType(Py_TYPE(self));
+    const PyInt64Table* table = &self->table;
+    PyObject* result = PyList_New(table->size);
+    if (!result)
+    {
+        return NULL;
+    }
+
+    Py_ssize_t index = 0;
+    for (Py_ssize_t slot = 0; slot < table->capacity; ++slot)
+    {
+        if (!PyInt64Table_SLOT_USED(table, slot))
+        {
+            continue;
+        }
+
+        PyObject* key = PyInt64_FromInt64Ex(state, table->keys[slot]);
+        PyObject* item = key ? PyTuple_Pack(2, key, table->values[slot].object) : NULL;
+        Py_XDECREF(key);
+        if (!item)
+        {
+            Py_DECREF(result);
+            return NULL;
+        }
+
+        PyList_SET_ITEM(result, index++, item);
+    }
+
+    return result;
+}
+
+static PyObject *
+int64dict_get_many(PyInt64DictObject *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"keys", "default", NULL};
+    PyObject* keys;
+    PyObject* default_value = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O:get_many", kwlist, &keys, &default_value))
+    {
+        return NULL;
+    }
+
+    PyInt64Buffer buffer;
+    if (PyInt64Buffer_Get(keys, &buffer) < 0)
+    {
+        return NULL;
+    }
+
+    PyObject* result = PyList_New(buffer.length);
+    if (result)
+    {
+        for (Py_ssize_t index = 0; index < buffer.length; ++index)
+        {
+            const Py_ssize_t slot = PyInt64Table_Lookup(&self->table, buffer.items[index]);
+            PyList_SET_ITEM(result, index,
+                Py_NewRef(slot >= 0 ? self->table.values[slot].object : default_value));
+        }
+    }
+
+    PyInt64Buffer_Release(&buffer);
+    return result;
+}
+
+static PyObject *
+int64dict_set_many(PyInt64DictObject *self, PyObject *args)
+{
+    PyObject* keys;
+    PyObject* values;
+
+    if (!PyArg_UnpackTuple(args, "set_many", 2, 2, &keys, &values))
+    {
+        return NULL;
+    }
+
+    PyInt64Buffer buffer;
+    if (PyInt64Buffer_Get(keys, &buffer) < 0)
+    {
+        return NULL;
+    }
+
+    PyObject* sequence = PySequence_Fast(values, "set_many() values must be a sequence");
+    if (!sequence)
+    {
+        PyInt64Buffer_Release(&buffer);
+        return NULL;
+    }
+
+    if (PySequence_Fast_GET_SIZE(sequence) != buffer.length)
+    {
+        PyErr_Format(PyExc_ValueError,
+            "set_many() got %zd keys but %zd values",
+            buffer.length, PySequence_Fast_GET_SIZE(sequence));
+        goto error;
+    }
+
+    if (PyInt64Table_Reserve(&self->table, self->table.size + buffer.length) < 0)
+    {
+        goto error;
+    }
+
+    for (Py_ssize_t index = 0; index < buffer.length; ++index)
+    {
+        if (int64dict_set(self, buffer.items[index], PySequence_Fast_GET_ITEM(sequence, index)) < 0)
+        {
+            goto error;
+        }
+    }
+
+    Py_DECREF(sequence);
+    PyInt64Buffer_Release(&buffer);
+    Py_RETURN_NONE;
+
+error:
+    Py_DECREF(sequence);
+    PyInt64Buffer_Release(&buffer);
+    return NULL;
+}
+
+// Value in a slot of an Int64Dict (counts = 0) or Int64Counter, a new reference.
+static PyObject *
+int64dict_value(PyInt64DictObject *self, Py_ssize_t slot, int counts)
+{
+    return counts ? PyInt64_FromInt64Ex(PyInt64State_OfType(Py_TYPE(self)),
+                                        self->table.values[slot].value)
+                  : Py_NewRef(self->table.values[slot].object);
+}
+
+/*
+ * == and != against a mapping of the same type or a dict.  Comparing values
+ * can run code that changes either table, so every key is looked up anew.
+ */
+static PyObject *
+int64dict_compare(PyInt64DictObject *self, PyObject *other, int op, int counts)
+{
+    const int is_dict = PyDict_Check(other);
+    const int is_own = counts ? PyInt64Counter_Check(other) : PyInt64Dict_Check(other);
+    if ((op != Py_EQ && op != Py_NE) || !(is_dict || is_own))
+    {
+        Py_RETURN_NOTIMPLEMENTED;
+    }
+
+    const Py_ssize_t other_size =
+        is_dict ? PyDict_GET_SIZE(other) : ((PyInt64DictObject*)other)->table.size;
+    int equal = self->table.size == other_size;
+    for (Py_ssize_t slot = 0; equal > 0 && slot < self->table.capacity; ++slot)
+    {
+        if (!PyInt64Table_SLOT_USED(&self->table, slot))
+        {
+            continue;
+        }
+
+        const int64_t key = self->table.keys[slot];
+        PyObject* value = int64dict_value(self, slot, counts);
+        PyObject* other_value = NULL;
+        if (is_dict)
+        {
+            PyObject* key_obj = PyLong_FromLongLong(key);
+            other_value = key_obj ? Py_XNewRef(PyDict_GetItemWithError(other, key_obj)) : NULL;
+            Py_XDECREF(key_obj);
+        }
+        else
+        {
+            PyInt64DictObject* mapping = (PyInt64DictObject*)other;
+            const Py_ssize_t other_slot = PyInt64Table_Lookup(&mapping->table, key);
+            other_value = other_slot >= 0 ? int64dict_value(mapping, other_slot, counts) : NULL;
+        }
+
+        if (value && other_value)
+        {
+            equal = PyObject_RichCompareBool(value, other_value, Py_EQ);
+        }
+        else
+        {
+            equal = PyErr_Occurred() ? -1 : 0;
+        }
+
+        Py_XDECREF(value);
+        Py_XDECREF(other_value);
+    }
+
+    if (equal < 0)
+    {
+        return NULL;
+    }
+
+    return PyBool_FromLong(equal == (op == Py_EQ));
+}
+
+static PyObject *
+int64dict_richcompare(PyInt64DictObject *self, PyObject *other, int op)
+{
+    return int64dict_compare(self, other, op, 0);
+}
+
+// Int64Counter
+
+static int
+int64counter_set(PyInt64DictObject *self, int64_t key, int64_t count)
+{
+    int inserted;
+    const Py_ssize_t slot = PyInt64Table_Insert(&self->table, key, &inserted);
+    if (slot < 0)
+    {
+        return -1;
+    }
+
+    self->table.values[slot].value = count;
+    return 0;
+}
+
+// counts == NULL adds step to every key.
+static int
+int64counter_add_counts(PyInt64DictObject *self, const int64_t *keys,
+                        const int64_t *counts, int64_t step, Py_ssize_t n)
+{
+    const PyInt64KernelMode mode = PyInt64Kernels_Mode();
+
+    for (Py_ssize_t index = 0; index < n; ++index)
+    {
+        int inserted;
+        const Py_ssize_t slot = PyInt64Table_Insert(&self->table, keys[index], &inserted);
+        if (slot < 0)
+        {
+            return -1;
+        }
+
+        const int64_t count = counts ? counts[index] : step;
+        int64_t* value = &self->table.values[slot].value;
+
+        switch (mode)
+        {
+        case PYINT64_KERNEL_CHECKED:
+            if (pyint64_op_add_overflow(*value, count, value))
+            {
+                *value = pyint64_op_sub(*value, count);
+                PyErr_SetString(PyExc_OverflowError, "int64 addition overflow in Int64Counter");
+                return -1;
+            }
+            break;
+        case PYINT64_KERNEL_SATURATE:
+            *value = pyint64_op_add_sat(*value, count);
+            break;
+        default:
+            *value = pyint64_op_add(*value, count);
+            break;
+        }
+    }
+
+    return 0;
+}
+
+static int
+int64counter_add_impl(PyInt64DictObject *self, PyObject *keys, PyObject *counts)
+{
+    PyInt64Buffer key_buffer;
+    if (PyInt64Buffer_Get(keys, &key_buffer) < 0)
+    {
+        return -1;
+    }
+
+    int result = -1;
+    if (!counts || PyLong_Check(counts))
+    {
+        int64_t step = 1;
+        if (counts && int64dict_key(counts, &step) < 0)
+        {
+            goto done;
+        }
+
+        result = int64counter_add_counts(self, key_buffer.items, NULL, step, key_buffer.length);
+        goto done;
+    }
+
+    PyInt64Buffer count_buffer;
+    if (PyInt64Buffer_Get(counts, &count_buffer) < 0)
+    {
+        goto done;
+    }
+
+    if (count_buffer.length != key_buffer.length)
+    {
+        PyErr_Format(PyExc_ValueError,
+            "add() got %zd keys but %zd counts",
+            key_buffer.length, count_buffer.length);
+    }
+    else
+    {
+        result = int64counter_add_counts(self, key_buffer.items, count_buffer.items, 0,
+                                         key_buffer.length);
+    }
+
+    PyInt64Buffer_Release(&count_buffer);
+
+done:
+    PyInt64Buffer_Release(&key_buffer);
+    return result;
+}
+
+static PyObject *
+int64counter_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    PyObject* initializer = NULL;
+
+    if (kwds && PyDict_GET_SIZE(kwds) != 0)
+    {
+        PyErr_SetString(PyExc_TypeError, "Int64Counter() takes no keyword arguments");
+        return NULL;
+    }
+
+    if (!PyArg_UnpackTuple(args, "Int64Counter", 0, 1, &initializer))
+    {
+        return NULL;
+    }
+
+    PyInt64DictObject* self = (PyInt64DictObject*)type->tp_alloc(type, 0);
+    if (!self)
+    {
+        return NULL;
+    }
+
+    PyInt64Table_Init(&self->table, 1);
+
+    if (!initializer)
+    {
+        return (PyObject*)self;
+    }
+
+    if (PyDict_Check(initializer) || PyInt64Counter_Check(initializer))
+    {
+        PyObject* items = PyDict_Check(initializer)
+            ? PyDict_Items(initializer)
+            : int64counter_items((PyInt64DictObject*)initializer, NULL);
+        if (!items)
+        {
+            goto error;
+        }
+
+        for (Py_ssize_t index = 0; index < PyList_GET_SIZE(items); ++index)
+        {
+            PyObject* item = PyList_GET_ITEM(items, index);
+            int64_t key;
+            int64_t count;
+
+            if (int64dict_key(PyTuple_GET_ITEM(item, 0), &key) < 0
+                || int64dict_key(PyTuple_GET_ITEM(item, 1), &count) < 0
+                || int64counter_set(self, key, count) < 0)
+            {
+                Py_DECREF(items);
+                goto error;
+            }
+        }
+
+        Py_DECREF(items);
+        return (PyObject*)self;
+    }
+
+    if (int64counter_add_impl(self, initializer, NULL) < 0)
+    {
+        goto error;
+    }
+
+    return (PyObject*)self;
+
+error:
+    Py_DECREF(self);
+    return NULL;
+}
+
+static void
+int64counter_dealloc(PyInt64DictObject *self)
+{
+    PyTypeObject* type = Py_TYPE(self);
+    PyInt64Table_Free(&self->table);
+    type->tp_free((PyObject*)self);
+    Py_DECREF(type);
+}
+
+static PyObject *
+int64counter_repr(PyInt64DictObject *self)
+{
+    PyInt64State* state = PyInt64State_OfType(Py_TYPE(self));
+    if (self->table.size == 0)
+    {
+        return PyUnicode_FromFormat("%s()", _PyType_Name(Py_TYPE(self)));
+    }
+
+    PyObject* dict = PyDict_New();
+    if (!dict)
+    {
+        return NULL;
+    }
+
+    const PyInt64Table* table = &self->table;
+    for (Py_ssize_t slot = 0; slot < table->capacity; ++slot)
+    {
+        if (!PyInt64Table_SLOT_USED(table, slot))
+        {
+            continue;
+        }
+
+        PyObject* key = PyInt64_FromInt64Ex(state, table->keys[slot]);
+        PyObject* count = PyInt64_FromInt64Ex(state, table->values[slot].value);
+        const int failed = !key || !count || PyDict_SetItem(dict, key, count) < 0;
+
+        Py_XDECREF(key);
+        Py_XDECREF(count);
+        if (failed)
+        {
+            Py_DECREF(dict);
+            return NULL;
+        }
+    }
+
+    PyObject* result = PyUnicode_FromFormat("%s(%R)", _PyType_Name(Py_TYPE(self)), dict);
+    Py_DECREF(dict);
+    return result;
+}
+
+static PyObject *
+int64counter_subscript(PyInt64DictObject *self, PyObject *key_obj)
+{
+    PyInt64State* state = PyInt64State_OfType(Py_TYPE(self));
+    int64_t key;
+    const int found = PyInt64Table_LookupKey(key_obj, &key);
+    if (found < 0)
+    {
+        return NULL;
+    }
+
+    const Py_ssize_t slot = found ? PyInt64Table_Lookup(&self->table, key) : -1;
+    return PyInt64_FromInt64Ex(state, slot >= 0 ? self->table.values[slot].value : 0);
+}
+
+static int
+int64counter_ass_subscript(PyInt64DictObject *self, PyObject *key_obj, PyObject *value)
+{
+    if (value)
+    {
+        int64_t key;
+        int64_t count;
+        if (int64dict_key(key_obj, &key) < 0 || int64dict_key(value, &count) < 0)
+        {
+            return -1;
+        }
+
+        return int64counter_set(self, key, count);
+    }
+
+    const Py_ssize_t slot = int64dict_find(self, key_obj);
+    if (slot < 0)
+    {
+        return -1;
+    }
+
+    PyInt64Table_DeleteSlot(&self->table, slot);
+    return 0;
+}
+
+static PyObject *
+int64counter_pop(PyInt64DictObject *self, PyObject *args)
+{
+    PyInt64State* state = PyInt64State_OfType(Py_TYPE(self));
+    PyObject* key_obj;
+    PyObject* default_value = NULL;
+
+    if (!PyArg_UnpackTuple(args, "pop", 1, 2, &key_obj, &default_value))
+    {
+        return NULL;
+    }
+
+    const Py_ssize_t slot = int64dict_find(self, key_obj);
+    if (slot < 0)
+    {
+        if (default_value && PyErr_ExceptionMatches(PyExc_KeyError))
+        {
+            PyErr_Clear();
+            return Py_NewRef(default_value);
+        }
+
+        return NULL;
+    }
+
+    const int64_t count = self->table.values[slot].value;
+    PyInt64Table_DeleteSlot(&self->table, slot);
+    return PyInt64_FromInt64Ex(state, count);
+}
+
+static PyObject *
+int64counter_clear_method(PyInt64DictObject *self, PyObject *unused)
+{
+    PyInt64Table_Free(&self->table);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+int64counter_values(PyInt64DictObject *self, PyObject *unused)
+{
+    PyInt64State* state = PyInt64State_OfType(Py_TYPE(self));
+    const PyInt64Table* table = &self->table;
+    PyObject* result = PyInt64Array_NewEx(state, table->size);
+    if (!result)
+    {
+        return NULL;
+    }
+
+    int64_t* out = ((PyInt64ArrayObject*)result)->ob_item;
+    for (Py_ssize_t slot = 0; slot < table->capacity; ++slot)
+    {
+        if (PyInt64Table_SLOT_USED(table, slot))
+        {
+            *out++ = table->values[slot].value;
+        }
+    }
+
+    return result;
+}
+
+static PyObject *
+int64counter_items(PyInt64DictObject *self, PyObject *unused)
+{
+    PyInt64State* state = PyInt64State_OfType(Py_TYPE(self));
+    const PyInt64Table* table = &self->table;
+    PyObject* result = PyList_New(table->size);
+    if (!result)
+    {
+        return NULL;
+    }
+
+    Py_ssize_t index = 0;
+    for (Py_ssize_t slot = 0; slot < table->capacity; ++slot)
+    {
+        if (!PyInt64Table_SLOT_USED(table, slot))
+        {
+            continue;
+        }
+
+        PyObject* key = PyInt64_FromInt64Ex(state, table->keys[slot]);
+        PyObject* count = PyInt64_FromInt64Ex(state, table->values[slot].value);
+        PyObject* item = key && count ? PyTuple_Pack(2, key, count) : NULL;
+        Py_XDECREF(key);
+        Py_XDECREF(count);
+        if (!item)
+        {
+            Py_DECREF(result);
+            return NULL;
+        }
+
+        PyList_SET_ITEM(result, index++, item);
+    }
+
+    return result;
+}
+
+static PyObject *
+int64counter_add(PyInt64DictObject *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"keys", "counts", NULL};
+    PyObject* keys;
+    PyObject* counts = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O:add", kwlist, &keys, &counts))
+    {
+        return NULL;
+    }
+
+    if (int64counter_add_impl(self, keys, counts) < 0)
+    {
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+int64counter_get_many(PyInt64DictObject *self, PyObject *keys)
+{
+    PyInt64State* state = PyInt64State_OfType(Py_TYPE(self));
+    PyInt64Buffer buffer;
+    if (PyInt64Buffer_Get(keys, &buffer) < 0)
+    {
+        return NULL;
+    }
+
+    PyObject* result = PyInt64Array_NewEx(state, buffer.length);
+    if (result)
+    {
+        int64_t* out = ((PyInt64ArrayObject*)result)->ob_item;
+        for (Py_ssize_t index = 0; index < buffer.length; ++index)
+        {
+            const Py_ssize_t slot = PyInt64Table_Lookup(&self->table, buffer.items[index]);
+            out[index] = slot >= 0 ? self->table.values[slot].value : 0;
+        }
+    }
+
+    PyInt64Buffer_Release(&buffer);
+    return result;
+}
+
+static PyObject *
+int64counter_richcompare(PyInt64DictObject *self, PyObject *other, int op)
+{
+    return int64dict_compare(self, other, op, 1);
+}
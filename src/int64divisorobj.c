@@ -0,0 +1,386 @@
+#include "pyint64obj.h"
+#include "int64arrayobj.h"
+#include "int64kernels.h"
+#include "int64pool.h"
+#include "int64divisorobj.h"
+
+typedef enum
+{
+    INT64DIVISOR_FLOORDIV,
+    INT64DIVISOR_MOD,
+    INT64DIVISOR_DIVMOD,
+} int64divisor_op;
+
+static PyObject *
+int64divisor_new(PyTypeObject *type, PyObject *args, PyObject *kwds);
+
+static void
+int64divisor_dealloc(PyInt64DivisorObject *self);
+
+static PyObject *
+int64divisor_repr(PyInt64DivisorObject *self);
+
+static PyObject *
+int64divisor_floor_divide(PyObject *left, PyObject *right);
+
+static PyObject *
+int64divisor_remainder(PyObject *left, PyObject *right);
+
+static PyObject *
+int64divisor_divmod(PyObject *left, PyObject *right);
+
+static PyObject *
+int64divisor_floordiv_many(PyInt64DivisorObject *self, PyObject *values);
+
+static PyObject *
+int64divisor_mod_many(PyInt64DivisorObject *self, PyObject *values);
+
+static PyObject *
+int64divisor_divmod_many(PyInt64DivisorObject *self, PyObject *values);
+
+static PyObject *
+int64divisor_reduce(PyInt64DivisorObject *self, PyObject *unused);
+
+static PyObject *
+int64divisor_get_divisor(PyInt64DivisorObject *self, void *closure);
+
+static
+PyMethodDef int64divisor_methods[] =
+{
+    {"floordiv", (PyCFunction)int64divisor_floordiv_many, METH_O,
+        "floordiv(values)\n"
+        "Return values // divisor as an Int64Array."},
+    {"mod", (PyCFunction)int64divisor_mod_many, METH_O,
+        "mod(values)\n"
+        "Return values % divisor as an Int64Array."},
+    {"divmod", (PyCFunction)int64divisor_divmod_many, METH_O,
+        "divmod(values)\n"
+        "Return the tuple (values // divisor, values % divisor) of Int64Arrays."},
+    {"__reduce__", (PyCFunction)int64divisor_reduce, METH_NOARGS, NULL},
+    {NULL} /* sentinel */
+};
+
+static
+PyGetSetDef int64divisor_getset[] =
+{
+    {"divisor", (getter)int64divisor_get_divisor, NULL,
+        "The divisor as a Pyint64.", NULL},
+    {NULL} /* sentinel */
+};
+
+static
+PyType_Slot int64divisor_slots[] =
+{
+    {Py_tp_doc, "Divisor(d, /)\n"
+                "Nonzero int64 divisor with a precomputed reciprocal. x // Divisor(d),\n"
+                "x % Divisor(d) and divmod(x, Divisor(d)) equal the results for d, for\n"
+                "Pyint64, int and Int64Array x, but multiply and shift instead of\n"
+                "dividing. Worth it when the same d divides many values."},
+    {Py_tp_dealloc, int64divisor_dealloc},
+    {Py_tp_repr, int64divisor_repr},
+    {Py_tp_getattro, PyObject_GenericGetAttr},
+    {Py_tp_methods, int64divisor_methods},
+    {Py_tp_getset, int64divisor_getset},
+    {Py_tp_new, int64divisor_new},
+    {Py_nb_floor_divide, int64divisor_floor_divide},
+    {Py_nb_remainder, int64divisor_remainder},
+    {Py_nb_divmod, int64divisor_divmod},
+    {0, NULL}
+};
+
+PyType_Spec PyInt64Divisor_Spec =
+{
+    .name = "pyint64.Divisor",
+    .basicsize = sizeof(PyInt64DivisorObject),
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE,
+    .slots = int64divisor_slots,
+};
+
+static PyObject *
+int64divisor_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    PyInt64State* state = PyInt64State_OfType(type);
+    PyObject* value;
+
+    if (kwds && PyDict_GET_SIZE(kwds) != 0)
+    {
+        PyErr_SetString(PyExc_TypeError, "Divisor() takes no keyword arguments");
+        return NULL;
+    }
+
+    if (!PyArg_UnpackTuple(args, "Divisor", 1, 1, &value))
+    {
+        return NULL;
+    }
+
+    const int64_t divisor = PyInt64_AsInt64(value);
+    if (divisor == -1 && PyErr_Occurred())
+    {
+        return NULL;
+    }
+
+    if (divisor == 0)
+    {
+        PyErr_SetString(PyExc_ZeroDivisionError, "int64 division by zero");
+        return NULL;
+    }
+
+    PyInt64DivisorObject* self = (PyInt64DivisorObject*)type->tp_alloc(type, 0);
+    if (!self)
+    {
+        return NULL;
+    }
+
+    self->ob_value = PyInt64_FromInt64Ex(state, divisor);
+    if (!self->ob_value)
+    {
+        Py_DECREF(self);
+        return NULL;
+    }
+
+    pyint64_divider_init(&self->divider, divisor);
+    return (PyObject*)self;
+}
+
+static void
+int64divisor_dealloc(PyInt64DivisorObject *self)
+{
+    PyTypeObject* type = Py_TYPE(self);
+    Py_XDECREF(self->ob_value);
+    type->tp_free((PyObject*)self);
+    Py_DECREF(type);
+}
+
+static PyObject *
+int64divisor_repr(PyInt64DivisorObject *self)
+{
+    return PyUnicode_FromFormat("%s(%S)", _PyType_Name(Py_TYPE(self)), self->ob_value);
+}
+
+static PyObject *
+int64divisor_get_divisor(PyInt64DivisorObject *self, void *closure)
+{
+    return Py_NewRef(self->ob_value);
+}
+
+static PyObject *
+int64divisor_reduce(PyInt64DivisorObject *self, PyObject *unused)
+{
+    return Py_BuildValue("O(O)", Py_TYPE(self), self->ob_value);
+}
+
+// Steals both references.
+static PyObject *
+int64divisor_pair(PyObject *quotient, PyObject *remainder)
+{
+    PyObject* result = quotient && remainder ? PyTuple_Pack(2, quotient, remainder) : NULL;
+    Py_XDECREF(quotient);
+    Py_XDECREF(remainder);
+    return result;
+}
+
+typedef struct
+{
+    PyInt64DivideKernel divide;
+    const PyInt64Divider* divider;
+    const int64_t* items;
+    int64_t* quotient;
+    int64_t* remainder;
+} int64divisor_job;
+
+static int
+int64divisor_task(Py_ssize_t begin, Py_ssize_t end, Py_ssize_t chunk, void *arg)
+{
+    const int64divisor_job* job = arg;
+    job->divide(job->items + begin, job->divider,
+                job->quotient ? job->quotient + begin : NULL,
+                job->remainder ? job->remainder + begin : NULL,
+                end - begin);
+    return 0;
+}
+
+/*
+ * INT64_MIN // -1 is the only quotient that overflows. The kernel wraps it,
+ * the other overflow policies are applied here.
+ */
+static int
+int64divisor_check_overflow(const int64_t *items, int64_t *quotient, Py_ssize_t n)
+{
+    const PyInt64KernelMode mode = PyInt64Kernels_Mode();
+    if (mode == PYINT64_KERNEL_WRAP)
+    {
+        return 0;
+    }
+
+    for (Py_ssize_t index = 0; index < n; ++index)
+    {
+        if (items[index] != INT64_MIN)
+        {
+            continue;
+        }
+
+        if (mode == PYINT64_KERNEL_CHECKED)
+        {
+            PyErr_Format(PyExc_OverflowError, "int64 %s overflow in Int64Array",
+                PyInt64Kernels_BinaryOpName(PYINT64_OP_FLOORDIV));
+            return -1;
+        }
+
+        quotient[index] = INT64_MAX;
+    }
+
+    return 0;
+}
+
+static PyObject *
+int64divisor_apply(PyInt64DivisorObject *self, PyObject *values, int64divisor_op op)
+{
+    PyInt64State* state = PyInt64State_OfType(Py_TYPE(self));
+    PyInt64Buffer buffer;
+    if (PyInt64Buffer_Get(values, &buffer) < 0)
+    {
+        return NULL;
+    }
+
+    PyObject* quotient = NULL;
+    PyObject* remainder = NULL;
+
+    if ((op != INT64DIVISOR_MOD && !(quotient = PyInt64Array_NewEx(state, buffer.length)))
+        || (op != INT64DIVISOR_FLOORDIV && !(remainder = PyInt64Array_NewEx(state, buffer.length))))
+    {
+        goto error;
+    }
+
+    int64divisor_job job = {
+        PyInt64Kernels_Get()->divide, &self->divider, buffer.items,
+        quotient ? ((PyInt64ArrayObject*)quotient)->ob_item : NULL,
+        remainder ? ((PyInt64ArrayObject*)remainder)->ob_item : NULL
+    };
+    PyInt64Pool_For(buffer.length, PYINT64_POOL_GRAIN, int64divisor_task, &job);
+
+    if (quotient && self->divider.divisor == -1
+        && int64divisor_check_overflow(buffer.items, job.quotient, buffer.length) < 0)
+    {
+        goto error;
+    }
+
+    PyInt64Buffer_Release(&buffer);
+
+    switch (op)
+    {
+    case INT64DIVISOR_FLOORDIV:
+        return quotient;
+    case INT64DIVISOR_MOD:
+        return remainder;
+    default:
+        return int64divisor_pair(quotient, remainder);
+    }
+
+error:
+    Py_XDECREF(quotient);
+    Py_XDECREF(remainder);
+    PyInt64Buffer_Release(&buffer);
+    return NULL;
+}
+
+// Value of an exact Pyint64 or of an int in the int64 range.
+static int
+int64divisor_scalar(PyObject *object, int64_t *value)
+{
+    if (PyInt64_CheckExact(object))
+    {
+        *value = PyInt64_GetValue(object);
+        return 1;
+    }
+
+    if (PyLong_CheckExact(object))
+    {
+        int overflow;
+        *value = PyLong_AsLongLongAndOverflow(object, &overflow);
+        return !overflow;
+    }
+
+    return 0;
+}
+
+static PyObject *
+int64divisor_binary(PyObject *left, PyObject *right, int64divisor_op op)
+{
+    if (!PyInt64Divisor_Check(right))
+    {
+        Py_RETURN_NOTIMPLEMENTED;
+    }
+
+    PyInt64State* state = PyInt64State_OfType(Py_TYPE(right));
+
+    PyInt64DivisorObject* divisor = (PyInt64DivisorObject*)right;
+    if (PyInt64Array_Check(left))
+    {
+        return int64divisor_apply(divisor, left, op);
+    }
+
+    // INT64_MIN // -1 follows the overflow policy, -1 is left to Pyint64.
+    int64_t value;
+    if (divisor->divider.divisor != -1 && int64divisor_scalar(left, &value))
+    {
+        int64_t remainder;
+        const int64_t quotient = pyint64_divider_divmod(value, &divisor->divider, &remainder);
+
+        switch (op)
+        {
+        case INT64DIVISOR_FLOORDIV:
+            return PyInt64_FromInt64Ex(state, quotient);
+        case INT64DIVISOR_MOD:
+            return PyInt64_FromInt64Ex(state, remainder);
+        default:
+            return int64divisor_pair(PyInt64_FromInt64Ex(state, quotient),
+                                     PyInt64_FromInt64Ex(state, remainder));
+        }
+    }
+
+    switch (op)
+    {
+    case INT64DIVISOR_FLOORDIV:
+        return PyNumber_FloorDivide(left, divisor->ob_value);
+    case INT64DIVISOR_MOD:
+        return PyNumber_Remainder(left, divisor->ob_value);
+    default:
+        return PyNumber_Divmod(left, divisor->ob_value);
+    }
+}
+
+static PyObject *
+int64divisor_floor_divide(PyObject *left, PyObject *right)
+{
+    return int64divisor_binary(left, right, INT64DIVISOR_FLOORDIV);
+}
+
+static PyObject *
+int64divisor_remainder(PyObject *left, PyObject *right)
+{
+    return int64divisor_binary(left, right, INT64DIVISOR_MOD);
+}
+
+static PyObject *
+int64divisor_divmod(PyObject *left, PyObject *right)
+{
+    return int64divisor_binary(left, right, INT64DIVISOR_DIVMOD);
+}
+
+static PyObject *
+int64divisor_floordiv_many(PyInt64DivisorObject *self, PyObject *values)
+{
+    return int64divisor_apply(self, values, INT64DIVISOR_FLOORDIV);
+}
+
+static PyObject *
+int64divisor_mod_many(PyInt64DivisorObject *self, PyObject *values)
+{
+    return int64divisor_apply(self, values, INT64DIVISOR_MOD);
+}
+
+static PyObject *
+int64divisor_divmod_many(PyInt64DivisorObject *self, PyObject *values)
+{
+    return int64divisor_apply(self, values, INT64DIVISOR_DIVMOD);
+}
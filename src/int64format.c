@@ -0,0 +1,1218 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+
+#include "pyint64obj.h"
+#include "int64arrayobj.h"
+#include "int64column.h"
+#include "int64format.h"
+#include "int64pool.h"
+#include "string_unitily.h"
+
+// Bytes a TextReader reads at a time, and values per batch, by default.
+#define INT64READER_CHUNK_SIZE ((Py_ssize_t)1 << 22)
+#define INT64READER_BATCH_SIZE ((Py_ssize_t)1 << 16)
+
+static PyObject *
+int64format_join(PyObject *module, PyObject *args, PyObject *kwds);
+
+static PyObject *
+int64format_parse(PyObject *module, PyObject *args, PyObject *kwds);
+
+static PyObject *
+int64reader_new(PyTypeObject *type, PyObject *args, PyObject *kwds);
+
+static void
+int64reader_dealloc(PyObject *self);
+
+static PyObject *
+int64reader_next(PyObject *self);
+
+static PyObject *
+int64reader_close(PyObject *self, PyObject *unused);
+
+static PyObject *
+int64reader_enter(PyObject *self, PyObject *unused);
+
+static PyObject *
+int64reader_exit(PyObject *self, PyObject *args);
+
+static PyObject *
+int64reader_get_count(PyObject *self, void *closure);
+
+static PyObject *
+int64reader_get_offset(PyObject *self, void *closure);
+
+static PyObject *
+int64reader_get_closed(PyObject *self, void *closure);
+
+static
+PyMethodDef int64format_methods[] =
+{
+    {
+        "join", (PyCFunction)(void(*)(void))int64format_join,
+        METH_VARARGS | METH_KEYWORDS,
+        "join(values, sep=',')\n"
+        "Format every int64 in values (an int64 buffer or any iterable of\n"
+        "integers) as decimal text separated by sep, in one allocation.\n"
+        "Returns bytes if sep is bytes, otherwise str."
+    },
+    {
+        "parse", (PyCFunction)(void(*)(void))int64format_parse,
+        METH_VARARGS | METH_KEYWORDS,
+        "parse(data, sep=None)\n"
+        "Parse delimited ASCII integers from a bytes-like object or an ASCII\n"
+        "str into an Int64Array. With sep=None fields are separated by runs\n"
+        "of whitespace, otherwise by the single character sep (a trailing\n"
+        "sep is allowed). Raises ParseError, whose offset attribute is the\n"
+        "byte offset of the first malformed field."
+    },
+    {NULL} /* sentinel */
+};
+
+static
+PyMethodDef int64reader_methods[] =
+{
+    {"close", int64reader_close, METH_NOARGS,
+        "close()\n"
+        "Stop reading and close the file if the reader opened it."},
+    {"__enter__", int64reader_enter, METH_NOARGS, NULL},
+    {"__exit__", int64reader_exit, METH_VARARGS, NULL},
+    {NULL} /* sentinel */
+};
+
+static
+PyGetSetDef int64reader_getset[] =
+{
+    {"count", int64reader_get_count, NULL, "Number of values returned so far.", NULL},
+    {"offset", int64reader_get_offset, NULL,
+        "Number of bytes of the input parsed so far.", NULL},
+    {"closed", int64reader_get_closed, NULL, "Whether the reader is closed.", NULL},
+    {NULL} /* sentinel */
+};
+
+static
+PyType_Slot int64reader_slots[] =
+{
+    {Py_tp_doc, "TextReader(source, *, sep=None, batch_size=65536, chunk_size=4194304,\n"
+                "           background=False)\n"
+                "Iterator over the integers of a delimited text file in Int64Array\n"
+                "batches of batch_size values (the last one may be shorter), parsed\n"
+                "like parse(). source is a path, a binary file object with readinto()\n"
+                "or a bytes-like object such as an mmap, which is read in place.\n"
+                "Files are read chunk_size bytes at a time; background=True reads the\n"
+                "next chunk of a path on a thread of its own while the current one is\n"
+                "parsed. ParseError offsets count from the start of the input."},
+    {Py_tp_dealloc, int64reader_dealloc},
+    {Py_tp_getattro, PyObject_GenericGetAttr},
+    {Py_tp_iter, PyObject_SelfIter},
+    {Py_tp_iternext, int64reader_next},
+    {Py_tp_methods, int64reader_methods},
+    {Py_tp_getset, int64reader_getset},
+    {Py_tp_new, int64reader_new},
+    {0, NULL}
+};
+
+int PyInt64Format_Init(PyObject* module)
+{
+    PyInt64State* state = PyModule_GetState(module);
+    state->parse_error = PyErr_NewExceptionWithDoc(
+        "pyint64.ParseError",
+        "Malformed or out of range field in pyint64.parse input.",
+        PyExc_ValueError, NULL);
+    if (!state->parse_error
+        || PyModule_AddObjectRef(module, "ParseError", state->parse_error) < 0)
+    {
+        return -1;
+    }
+
+    state->text_reader_type =
+        (PyTypeObject*)PyType_FromModuleAndSpec(module, &PyInt64TextReader_Spec, NULL);
+    if (!state->text_reader_type || PyModule_AddType(module, state->text_reader_type) < 0)
+    {
+        return -1;
+    }
+
+    return PyModule_AddFunctions(module, int64format_methods);
+}
+
+static PyObject *
+int64format_join(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"values", "sep", NULL};
+    PyObject* values;
+    PyObject* sep = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O:join", kwlist, &values, &sep))
+    {
+        return NULL;
+    }
+
+    const char* sep_data = ",";
+    Py_ssize_t sep_len = 1;
+    const int as_bytes = sep && PyBytes_Check(sep);
+
+    if (as_bytes)
+    {
+        sep_data = PyBytes_AS_STRING(sep);
+        sep_len = PyBytes_GET_SIZE(sep);
+    }
+    else if (sep)
+    {
+        if (!PyUnicode_Check(sep))
+        {
+            PyErr_Format(PyExc_TypeError,
+                "sep must be str or bytes, not '%.200s'",
+                Py_TYPE(sep)->tp_name);
+            return NULL;
+        }
+
+        if (!PyUnicode_IS_ASCII(sep))
+        {
+            PyErr_SetString(PyExc_ValueError, "sep must be ASCII");
+            return NULL;
+        }
+
+        sep_data = (const char*)PyUnicode_1BYTE_DATA(sep);
+        sep_len = PyUnicode_GET_LENGTH(sep);
+    }
+
+    PyInt64Buffer buffer;
+    if (PyInt64Buffer_Get(values, &buffer) < 0)
+    {
+        return NULL;
+    }
+
+    // Size the output exactly so the digits are written only once.
+    Py_ssize_t total = 0;
+    for (Py_ssize_t index = 0; index < buffer.length; ++index)
+    {
+        total += signedDigitCount(buffer.items[index]);
+    }
+
+    if (buffer.length > 1)
+    {
+        if (sep_len > (PY_SSIZE_T_MAX - total) / (buffer.length - 1))
+        {
+            PyInt64Buffer_Release(&buffer);
+            return PyErr_NoMemory();
+        }
+
+        total += sep_len * (buffer.length - 1);
+    }
+
+    PyObject* result = as_bytes
+        ? PyBytes_FromStringAndSize(NULL, total)
+        : PyUnicode_New(total, 127);
+    if (!result)
+    {
+        PyInt64Buffer_Release(&buffer);
+        return NULL;
+    }
+
+    char* next = as_bytes
+        ? PyBytes_AS_STRING(result)
+        : (char*)PyUnicode_1BYTE_DATA(result);
+
+    for (Py_ssize_t index = 0; index < buffer.length; ++index)
+    {
+        if (index > 0)
+        {
+            if (sep_len == 1)
+            {
+                *next++ = *sep_data;
+            }
+            else
+            {
+                memcpy(next, sep_data, sep_len);
+                next += sep_len;
+            }
+        }
+
+        next = signedToChars(buffer.items[index], next);
+    }
+
+    PyInt64Buffer_Release(&buffer);
+    return result;
+}
+
+static void
+int64format_parse_error(PyObject *parse_error, ParseInt64Status status, Py_ssize_t offset)
+{
+    PyObject* error = PyObject_CallFunction(parse_error, "sn",
+        status == PARSE_INT64_OVERFLOW
+            ? "int64 field out of range"
+            : "malformed int64 field",
+        offset);
+    if (!error)
+    {
+        return;
+    }
+
+    PyObject* py_offset = PyLong_FromSsize_t(offset);
+    if (!py_offset || PyObject_SetAttrString(error, "offset", py_offset) < 0)
+    {
+        Py_XDECREF(py_offset);
+        Py_DECREF(error);
+        return;
+    }
+
+    Py_DECREF(py_offset);
+    PyErr_SetObject(parse_error, error);
+    Py_DECREF(error);
+}
+
+static inline int
+int64format_is_blank(char c, int sep)
+{
+    return c != sep
+        && (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f');
+}
+
+// Large inputs are parsed as independent pieces of about this many bytes.
+#define INT64FORMAT_PIECE_BYTES ((Py_ssize_t)1 << 18)
+
+// Values of [first, last), parsed into a raw buffer so no GIL is needed.
+typedef struct
+{
+    const char* first;
+    const char* last;
+    int64_t* items;
+    Py_ssize_t count;
+    ParseInt64Status status;
+    const char* error;
+    int no_memory;
+} int64format_piece;
+
+static void
+int64format_parse_piece(int64format_piece *piece, int sep)
+{
+    const char* last = piece->last;
+    const char* next = piece->first;
+
+    // Guess one value per eight bytes and grow from there.
+    Py_ssize_t capacity = (last - next) / 8 + 16;
+    piece->items = PyMem_RawMalloc(capacity * sizeof(int64_t));
+    piece->count = 0;
+    piece->status = PARSE_INT64_OK;
+    if (!piece->items)
+    {
+        piece->no_memory = 1;
+        return;
+    }
+
+    for (;;)
+    {
+        while (next < last && int64format_is_blank(*next, sep))
+        {
+            ++next;
+        }
+
+        // Empty input, trailing whitespace or a single trailing sep.
+        if (next == last)
+        {
+            break;
+        }
+
+        const char* field = next;
+        int64_t value;
+        ParseInt64Status status = parseInt64(next, last, &value, &next);
+
+        if (status == PARSE_INT64_OK)
+        {
+            const char* digits_end = next;
+            while (next < last && int64format_is_blank(*next, sep))
+            {
+                ++next;
+            }
+
+            if (next < last && (sep >= 0 ? *next != sep : next == digits_end))
+            {
+                status = PARSE_INT64_INVALID;
+            }
+        }
+
+        if (status != PARSE_INT64_OK)
+        {
+            piece->status = status;
+            piece->error = field;
+            return;
+        }
+
+        if (piece->count == capacity)
+        {
+            capacity *= 2;
+            int64_t* items = PyMem_RawRealloc(piece->items, capacity * sizeof(int64_t));
+            if (!items)
+            {
+                piece->no_memory = 1;
+                return;
+            }
+
+            piece->items = items;
+        }
+
+        piece->items[piece->count++] = value;
+
+        if (next == last)
+        {
+            break;
+        }
+
+        if (sep >= 0)
+        {
+            ++next;
+        }
+    }
+}
+
+/*
+ * Values of a parsed range, in pieces up to the first malformed field
+ * (used of piece_count).  On a malformed field count covers the values
+ * before it and error points at it.
+ */
+typedef struct
+{
+    int64format_piece single;
+    int64format_piece* pieces;
+    Py_ssize_t piece_count;
+    Py_ssize_t used;
+    Py_ssize_t count;
+    ParseInt64Status status;
+    const char* error;
+} int64format_range;
+
+/*
+ * Cut [first, last) just after separator characters (sep, or any
+ * whitespace for sep < 0). A field never spans such a cut, so parsing the
+ * pieces one by one gives the same values and errors as parsing the whole.
+ */
+static Py_ssize_t
+int64format_split(const char *first, const char *last, int sep, int64format_piece *pieces)
+{
+    Py_ssize_t count = 0;
+    while (first < last)
+    {
+        const char* cut = last;
+        if (last - first > INT64FORMAT_PIECE_BYTES)
+        {
+            cut = first + INT64FORMAT_PIECE_BYTES;
+            while (cut < last && (sep >= 0 ? *cut != sep : !int64format_is_blank(*cut, sep)))
+            {
+                ++cut;
+            }
+
+            cut += cut < last;
+        }
+
+        pieces[count++] = (int64format_piece){.first = first, .last = cut};
+        first = cut;
+    }
+
+    return count;
+}
+
+typedef struct
+{
+    int64format_piece* pieces;
+    int sep;
+} int64format_parse_job;
+
+static int
+int64format_parse_task(Py_ssize_t begin, Py_ssize_t end, Py_ssize_t chunk, void *arg)
+{
+    const int64format_parse_job* job = arg;
+    int64format_parse_piece(&job->pieces[begin], job->sep);
+    return 0;
+}
+
+static int
+int64format_range_parse(int64format_range *range, const char *first, const char *last, int sep)
+{
+    range->single = (int64format_piece){.first = first, .last = last};
+    range->pieces = &range->single;
+    range->piece_count = 1;
+    range->used = 0;
+    range->count = 0;
+    range->status = PARSE_INT64_OK;
+    range->error = NULL;
+
+    if (PyInt64Pool_Parallel((last - first) / 8))
+    {
+        range->pieces = PyMem_Malloc(
+            ((last - first) / INT64FORMAT_PIECE_BYTES + 1) * sizeof(int64format_piece));
+        if (!range->pieces)
+        {
+            range->pieces = &range->single;
+            range->piece_count = 0;
+            PyErr_NoMemory();
+            return -1;
+        }
+
+        range->piece_count = int64format_split(first, last, sep, range->pieces);
+        int64format_parse_job job = {range->pieces, sep};
+        PyInt64Pool_Run(range->piece_count, int64format_parse_task, &job);
+    }
+    else
+    {
+        int64format_parse_piece(&range->single, sep);
+    }
+
+    // The first malformed field of the earliest piece is the first overall.
+    while (range->used < range->piece_count)
+    {
+        const int64format_piece* piece = &range->pieces[range->used++];
+        if (piece->no_memory)
+        {
+            PyErr_NoMemory();
+            return -1;
+        }
+
+        range->count += piece->count;
+        if (piece->status != PARSE_INT64_OK)
+        {
+            range->status = piece->status;
+            range->error = piece->error;
+            break;
+        }
+    }
+
+    return 0;
+}
+
+static void
+int64format_range_copy(const int64format_range *range, int64_t *out)
+{
+    for (Py_ssize_t index = 0; index < range->used; ++index)
+    {
+        memcpy(out, range->pieces[index].items, range->pieces[index].count * sizeof(int64_t));
+        out += range->pieces[index].count;
+    }
+}
+
+static void
+int64format_range_free(int64format_range *range)
+{
+    for (Py_ssize_t index = 0; index < range->piece_count; ++index)
+    {
+        PyMem_RawFree(range->pieces[index].items);
+    }
+
+    if (range->pieces != &range->single)
+    {
+        PyMem_Free(range->pieces);
+    }
+
+    range->pieces = &range->single;
+    range->piece_count = 0;
+    range->used = 0;
+    range->count = 0;
+    range->status = PARSE_INT64_OK;
+}
+
+// sep of parse: -1 for None, meaning any run of whitespace, else the character.
+static int
+int64format_get_sep(PyObject *sep_obj, int *sep)
+{
+    *sep = -1;
+    if (Py_IsNone(sep_obj))
+    {
+        return 0;
+    }
+
+    if (PyBytes_Check(sep_obj) && PyBytes_GET_SIZE(sep_obj) == 1)
+    {
+        *sep = (unsigned char)PyBytes_AS_STRING(sep_obj)[0];
+    }
+    else if (PyUnicode_Check(sep_obj) && PyUnicode_IS_ASCII(sep_obj)
+             && PyUnicode_GET_LENGTH(sep_obj) == 1)
+    {
+        *sep = PyUnicode_1BYTE_DATA(sep_obj)[0];
+    }
+    else
+    {
+        PyErr_SetString(PyExc_ValueError, "sep must be None or a single ASCII character");
+        return -1;
+    }
+
+    if ((*sep >= '0' && *sep <= '9') || *sep == '-' || *sep == '+')
+    {
+        PyErr_SetString(PyExc_ValueError, "sep cannot be a digit or a sign");
+        return -1;
+    }
+
+    return 0;
+}
+
+static PyObject *
+int64format_parse(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"data", "sep", NULL};
+    PyInt64State* state = PyModule_GetState(module);
+    PyObject* data;
+    PyObject* sep_obj = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O:parse", kwlist, &data, &sep_obj))
+    {
+        return NULL;
+    }
+
+    int sep;
+    if (int64format_get_sep(sep_obj, &sep) < 0)
+    {
+        return NULL;
+    }
+
+    Py_buffer view = {0};
+    const char* first;
+    Py_ssize_t length;
+
+    if (PyUnicode_Check(data))
+    {
+        if (!PyUnicode_IS_ASCII(data))
+        {
+            PyErr_SetString(PyExc_ValueError, "str data must be ASCII");
+            return NULL;
+        }
+
+        first = (const char*)PyUnicode_1BYTE_DATA(data);
+        length = PyUnicode_GET_LENGTH(data);
+    }
+    else
+    {
+        if (PyObject_GetBuffer(data, &view, PyBUF_SIMPLE) < 0)
+        {
+            return NULL;
+        }
+
+        first = view.buf;
+        length = view.len;
+    }
+
+    PyObject* parse_error = ((PyInt64State*)PyModule_GetState(module))->parse_error;
+    PyObject* result = NULL;
+    int64format_range range;
+
+    if (int64format_range_parse(&range, first, first + length, sep) == 0)
+    {
+        if (range.status != PARSE_INT64_OK)
+        {
+            int64format_parse_error(parse_error, range.status, range.error - first);
+        }
+        else
+        {
+            result = PyInt64Array_NewEx(state, range.count);
+            if (result)
+            {
+                int64format_range_copy(&range, ((PyInt64ArrayObject*)result)->ob_item);
+            }
+        }
+    }
+
+    int64format_range_free(&range);
+    PyBuffer_Release(&view);
+    return result;
+}
+
+/*
+ * TextReader.  Text is read into a buffer a chunk at a time and parsed up
+ * to the last separator in it; the rest, possibly the start of a field, is
+ * moved to the front before the next read.  Each such range is parsed in
+ * pieces like parse() and handed out in batches.
+ */
+
+/*
+ * Background reads of a file: the thread fills slot whenever free is
+ * released and releases ready once done.  The reader takes each chunk
+ * under ready and releases free right away, so the next read overlaps the
+ * parsing.  The thread stops after an empty or failed read, or when it
+ * finds stop set; both locks strictly alternate, neither is released twice.
+ */
+typedef struct
+{
+    int fd;
+    char* slot;
+    Py_ssize_t size;
+    Py_ssize_t length;      // bytes in slot
+    int error;              // errno of a failed read
+    int stop;
+    PyThread_type_lock ready;
+    PyThread_type_lock free;
+} int64reader_prefetch;
+
+typedef struct
+{
+    PyObject_HEAD
+
+    int fd;                         // path source, opened by the reader
+    PyObject* file;                 // file object source
+    Py_buffer view;                 // bytes-like source, read in place
+    int64reader_prefetch* prefetch; // background reads of fd
+    int pending;                    // a background read is outstanding
+    int busy;                       // a thread is in next() without the GIL
+    int closed;
+    int eof;
+    int sep;
+    Py_ssize_t batch_size;
+    Py_ssize_t chunk_size;
+    PyObject* parse_error;
+
+    // Unparsed text is [data + begin, data + end), data is at input offset.
+    char* data;
+    Py_ssize_t capacity;
+    Py_ssize_t begin;
+    Py_ssize_t end;
+    long long offset;
+
+    // Parsed values not returned yet start at item of piece.
+    int64format_range range;
+    Py_ssize_t piece;
+    Py_ssize_t item;
+    long long error_offset;
+
+    long long count;
+} int64reader_object;
+
+PyType_Spec PyInt64TextReader_Spec =
+{
+    .name = "pyint64.TextReader",
+    .basicsize = sizeof(int64reader_object),
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE,
+    .slots = int64reader_slots,
+};
+
+static void
+int64reader_prefetch_main(void *arg)
+{
+    int64reader_prefetch* prefetch = arg;
+    for (;;)
+    {
+        PyThread_acquire_lock(prefetch->free, WAIT_LOCK);
+
+        int last = 1;
+        if (!prefetch->stop)
+        {
+            prefetch->length = PyInt64File_Read(prefetch->fd, prefetch->slot, prefetch->size,
+                                                &prefetch->error);
+            last = prefetch->length == 0 || prefetch->error;
+        }
+
+        // prefetch may be freed as soon as a last chunk is taken.
+        PyThread_release_lock(prefetch->ready);
+        if (last)
+        {
+            return;
+        }
+    }
+}
+
+static void
+int64reader_prefetch_free(int64reader_prefetch *prefetch)
+{
+    if (prefetch->ready)
+    {
+        PyThread_free_lock(prefetch->ready);
+    }
+
+    if (prefetch->free)
+    {
+        PyThread_free_lock(prefetch->free);
+    }
+
+    PyMem_Free(prefetch->slot);
+    PyMem_Free(prefetch);
+}
+
+static int
+int64reader_prefetch_start(int64reader_object *self)
+{
+    int64reader_prefetch* prefetch = PyMem_Calloc(1, sizeof(int64reader_prefetch));
+    if (!prefetch)
+    {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    prefetch->fd = self->fd;
+    prefetch->size = self->chunk_size;
+    prefetch->slot = PyMem_Malloc(self->chunk_size);
+    prefetch->ready = PyThread_allocate_lock();
+    prefetch->free = PyThread_allocate_lock();
+    if (!prefetch->slot || !prefetch->ready || !prefetch->free)
+    {
+        int64reader_prefetch_free(prefetch);
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    // ready starts taken, free starts released: the first read begins now.
+    PyThread_acquire_lock(prefetch->ready, NOWAIT_LOCK);
+    if (PyThread_start_new_thread(int64reader_prefetch_main, prefetch) == PYTHREAD_INVALID_THREAD_ID)
+    {
+        int64reader_prefetch_free(prefetch);
+        PyErr_SetString(PyExc_RuntimeError, "can't start the TextReader thread");
+        return -1;
+    }
+
+    self->prefetch = prefetch;
+    self->pending = 1;
+    return 0;
+}
+
+// Wait for the outstanding read, if any, and make the thread exit.
+static void
+int64reader_prefetch_stop(int64reader_object *self)
+{
+    int64reader_prefetch* prefetch = self->prefetch;
+    if (self->pending)
+    {
+        Py_BEGIN_ALLOW_THREADS
+        PyThread_acquire_lock(prefetch->ready, WAIT_LOCK);
+        if (prefetch->length > 0 && !prefetch->error)
+        {
+            prefetch->stop = 1;
+            PyThread_release_lock(prefetch->free);
+            PyThread_acquire_lock(prefetch->ready, WAIT_LOCK);
+        }
+        Py_END_ALLOW_THREADS
+        self->pending = 0;
+    }
+
+    int64reader_prefetch_free(prefetch);
+    self->prefetch = NULL;
+}
+
+static PyObject *
+int64reader_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"source", "sep", "batch_size", "chunk_size", "background", NULL};
+    PyObject* source;
+    PyObject* sep_obj = Py_None;
+    Py_ssize_t batch_size = INT64READER_BATCH_SIZE;
+    Py_ssize_t chunk_size = INT64READER_CHUNK_SIZE;
+    int background = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|$Onnp:TextReader", kwlist, &source,
+                                     &sep_obj, &batch_size, &chunk_size, &background))
+    {
+        return NULL;
+    }
+
+    int sep;
+    if (int64format_get_sep(sep_obj, &sep) < 0)
+    {
+        return NULL;
+    }
+
+    if (batch_size <= 0 || chunk_size <= 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "batch_size and chunk_size must be positive");
+        return NULL;
+    }
+
+    const PyInt64State* state = PyInt64State_OfType(type);
+    if (!state)
+    {
+        PyErr_SetString(PyExc_RuntimeError, "pyint64 is not initialized in this interpreter");
+        return NULL;
+    }
+
+    int64reader_object* self = (int64reader_object*)type->tp_alloc(type, 0);
+    if (!self)
+    {
+        return NULL;
+    }
+
+    self->fd = -1;
+    self->sep = sep;
+    self->batch_size = batch_size;
+    self->chunk_size = chunk_size;
+    self->range.pieces = &self->range.single;
+    self->parse_error = Py_NewRef(state->parse_error);
+
+    const int is_path = PyUnicode_Check(source)
+        || PyObject_HasAttrString(source, "__fspath__");
+    if (!is_path && background)
+    {
+        PyErr_SetString(PyExc_ValueError, "background reads need a path source");
+        Py_DECREF(self);
+        return NULL;
+    }
+
+    if (is_path)
+    {
+        self->fd = PyInt64File_Open(source, O_RDONLY);
+        if (self->fd < 0 || (background && int64reader_prefetch_start(self) < 0))
+        {
+            Py_DECREF(self);
+            return NULL;
+        }
+    }
+    else if (PyObject_CheckBuffer(source))
+    {
+        if (PyObject_GetBuffer(source, &self->view, PyBUF_SIMPLE) < 0)
+        {
+            Py_DECREF(self);
+            return NULL;
+        }
+
+        self->data = self->view.buf;
+        self->end = self->view.len;
+        self->eof = 1;
+    }
+    else if (PyObject_HasAttrString(source, "readinto"))
+    {
+        self->file = Py_NewRef(source);
+    }
+    else
+    {
+        PyErr_Format(PyExc_TypeError,
+            "TextReader() source must be a path, a binary file or a bytes-like object, not '%.200s'",
+            Py_TYPE(source)->tp_name);
+        Py_DECREF(self);
+        return NULL;
+    }
+
+    return (PyObject*)self;
+}
+
+// Drop the source and every buffer, the reader then is at its end.
+static void
+int64reader_finish(int64reader_object *self)
+{
+    if (self->prefetch)
+    {
+        int64reader_prefetch_stop(self);
+    }
+
+    if (self->fd >= 0)
+    {
+        PyInt64File_Close(self->fd);
+        self->fd = -1;
+    }
+
+    if (self->view.obj)
+    {
+        PyBuffer_Release(&self->view);
+    }
+    else
+    {
+        PyMem_Free(self->data);
+    }
+
+    self->data = NULL;
+    self->begin = self->end = self->capacity = 0;
+    self->eof = 1;
+    Py_CLEAR(self->file);
+    int64format_range_free(&self->range);
+}
+
+static void
+int64reader_dealloc(PyObject *self)
+{
+    PyTypeObject* type = Py_TYPE(self);
+    int64reader_finish((int64reader_object*)self);
+    Py_XDECREF(((int64reader_object*)self)->parse_error);
+    type->tp_free(self);
+    Py_DECREF(type);
+}
+
+// Read the next chunk behind the unparsed text, setting eof at the end.
+static int
+int64reader_read(int64reader_object *self)
+{
+    // Keep the unparsed tail, the start of a field cut by the last read.
+    const Py_ssize_t carry = self->end - self->begin;
+    if (carry > 0)
+    {
+        memmove(self->data, self->data + self->begin, carry);
+    }
+    self->offset += self->begin;
+    self->begin = 0;
+    self->end = carry;
+
+    if (self->capacity - carry < self->chunk_size)
+    {
+        if (carry > PY_SSIZE_T_MAX - self->chunk_size)
+        {
+            PyErr_NoMemory();
+            return -1;
+        }
+
+        char* data = PyMem_Realloc(self->data, carry + self->chunk_size);
+        if (!data)
+        {
+            PyErr_NoMemory();
+            return -1;
+        }
+
+        self->data = data;
+        self->capacity = carry + self->chunk_size;
+    }
+
+    char* out = self->data + carry;
+    Py_ssize_t length = 0;
+    int error = 0;
+
+    if (self->prefetch)
+    {
+        int64reader_prefetch* prefetch = self->prefetch;
+        Py_BEGIN_ALLOW_THREADS
+        PyThread_acquire_lock(prefetch->ready, WAIT_LOCK);
+        Py_END_ALLOW_THREADS
+        self->pending = 0;
+
+        length = prefetch->length;
+        error = prefetch->error;
+        memcpy(out, prefetch->slot, length);
+        if (length > 0 && !error)
+        {
+            PyThread_release_lock(prefetch->free);
+            self->pending = 1;
+        }
+    }
+    else if (self->fd >= 0)
+    {
+        Py_BEGIN_ALLOW_THREADS
+        length = PyInt64File_Read(self->fd, out, self->chunk_size, &error);
+        Py_END_ALLOW_THREADS
+    }
+    else
+    {
+        PyObject* view = PyMemoryView_FromMemory(out, self->chunk_size, PyBUF_WRITE);
+        if (!view)
+        {
+            return -1;
+        }
+
+        PyObject* result = PyObject_CallMethod(self->file, "readinto", "O", view);
+        PyObject* released = PyObject_CallMethod(view, "release", NULL);
+        Py_DECREF(view);
+        if (!result || !released)
+        {
+            Py_XDECREF(result);
+            Py_XDECREF(released);
+            return -1;
+        }
+
+        Py_DECREF(released);
+        length = PyLong_AsSsize_t(result);
+        Py_DECREF(result);
+        if (length == -1 && PyErr_Occurred())
+        {
+            return -1;
+        }
+
+        if (length < 0 || length > self->chunk_size)
+        {
+            PyErr_Format(PyExc_ValueError, "readinto() returned %zd outside [0, %zd]",
+                         length, self->chunk_size);
+            return -1;
+        }
+    }
+
+    if (error)
+    {
+        errno = error;
+        PyErr_SetFromErrno(PyExc_OSError);
+        self->eof = 1;
+        return -1;
+    }
+
+    self->end += length;
+    self->eof = length == 0;
+    return 0;
+}
+
+// Parse the next range of complete fields, reading as much as needed.
+static int
+int64reader_advance(int64reader_object *self)
+{
+    int64format_range_free(&self->range);
+    self->piece = 0;
+    self->item = 0;
+
+    for (;;)
+    {
+        Py_ssize_t cut = self->end;
+        if (!self->eof)
+        {
+            // Just after the last separator, no field crosses it.
+            const int sep = self->sep;
+            while (cut > self->begin)
+            {
+                const char c = self->data[cut - 1];
+                if (sep >= 0 ? c == sep : int64format_is_blank(c, sep))
+                {
+                    break;
+                }
+
+                --cut;
+            }
+        }
+
+        if (cut > self->begin)
+        {
+            const char* first = self->data + self->begin;
+            if (int64format_range_parse(&self->range, first, self->data + cut, self->sep) < 0)
+            {
+                return -1;
+            }
+
+            if (self->range.status != PARSE_INT64_OK)
+            {
+                self->error_offset = self->offset + (self->range.error - self->data);
+            }
+
+            self->begin = cut;
+            return 0;
+        }
+
+        if (self->eof)
+        {
+            return 0;
+        }
+
+        if (int64reader_read(self) < 0)
+        {
+            return -1;
+        }
+    }
+}
+
+static PyObject *
+int64reader_next(PyObject *op)
+{
+    int64reader_object* self = (int64reader_object*)op;
+    PyInt64State* state = PyInt64State_OfType(Py_TYPE(op));
+    if (self->closed)
+    {
+        PyErr_SetString(PyExc_ValueError, "I/O operation on closed TextReader");
+        return NULL;
+    }
+
+    if (self->busy)
+    {
+        PyErr_SetString(PyExc_RuntimeError, "TextReader is in use by another thread");
+        return NULL;
+    }
+
+    PyObject* batch = NULL;
+    Py_ssize_t filled = 0;
+    self->busy = 1;
+
+    while (filled < self->batch_size)
+    {
+        int64format_range* range = &self->range;
+        if (self->piece < range->used)
+        {
+            const int64format_piece* piece = &range->pieces[self->piece];
+            if (self->item == piece->count)
+            {
+                ++self->piece;
+                self->item = 0;
+                continue;
+            }
+
+            if (!batch)
+            {
+                batch = PyInt64Array_NewEx(state, self->batch_size);
+                if (!batch)
+                {
+                    break;
+                }
+            }
+
+            const Py_ssize_t take = Py_MIN(piece->count - self->item, self->batch_size - filled);
+            memcpy(((PyInt64ArrayObject*)batch)->ob_item + filled, piece->items + self->item,
+                   take * sizeof(int64_t));
+            self->item += take;
+            filled += take;
+            continue;
+        }
+
+        if (range->status != PARSE_INT64_OK)
+        {
+            // The values before the malformed field come first.
+            if (filled == 0)
+            {
+                int64format_parse_error(self->parse_error, range->status, self->error_offset);
+                int64reader_finish(self);
+            }
+
+            break;
+        }
+
+        if (self->eof && self->begin == self->end)
+        {
+            break;
+        }
+
+        if (int64reader_advance(self) < 0)
+        {
+            break;
+        }
+    }
+
+    self->busy = 0;
+    if (PyErr_Occurred() || filled == 0)
+    {
+        Py_XDECREF(batch);
+        return NULL;
+    }
+
+    if (filled < self->batch_size && PyInt64Array_Resize(batch, filled) < 0)
+    {
+        Py_DECREF(batch);
+        return NULL;
+    }
+
+    self->count += filled;
+    return batch;
+}
+
+static PyObject *
+int64reader_close(PyObject *op, PyObject *unused)
+{
+    int64reader_object* self = (int64reader_object*)op;
+    if (self->busy)
+    {
+        PyErr_SetString(PyExc_RuntimeError, "TextReader is in use by another thread");
+        return NULL;
+    }
+
+    int64reader_finish(self);
+    self->closed = 1;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+int64reader_enter(PyObject *self, PyObject *unused)
+{
+    return Py_NewRef(self);
+}
+
+static PyObject *
+int64reader_exit(PyObject *self, PyObject *args)
+{
+    return int64reader_close(self, NULL);
+}
+
+static PyObject *
+int64reader_get_count(PyObject *self, void *closure)
+{
+    return PyLong_FromLongLong(((int64reader_object*)self)->count);
+}
+
+static PyObject *
+int64reader_get_offset(PyObject *op, void *closure)
+{
+    int64reader_object* self = (int64reader_object*)op;
+    return PyLong_FromLongLong(self->offset + self->begin);
+}
+
+static PyObject *
+int64reader_get_closed(PyObject *self, void *closure)
+{
+    return PyBool_FromLong(((int64reader_object*)self)->closed);
+}
@@ -0,0 +1,753 @@
+#include <string.h>
+
+#include "int64kernels.h"
+#include "int64ops.h"
+
+#if !defined(__STDC_NO_ATOMICS__) && !defined(_MSC_VER)
+#include <stdatomic.h>
+#define PYINT64_KERNELS_ONCE 1
+#else
+#define PYINT64_KERNELS_ONCE 0
+#endif
+
+/*
+ * Every kernel is written once as a plain loop and instantiated per
+ * instruction set with a GCC/Clang target attribute, so the vectorizer
+ * emits SSE4.2, AVX2 or AVX-512 code from the same source and the
+ * results are identical by construction.  The scalar table is built with
+ * vectorization turned off and serves as the reference and the fallback
+ * on compilers or CPUs without runtime dispatch.
+ */
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define PYINT64_HAVE_DISPATCH 1
+#define PYINT64_TARGET_SSE42 __attribute__((target("sse4.2,popcnt")))
+#define PYINT64_TARGET_AVX2 __attribute__((target("avx2,bmi,bmi2,lzcnt,popcnt")))
+#define PYINT64_TARGET_AVX512 __attribute__((target("avx512f,avx512dq,avx512vl,avx512bw,popcnt")))
+#define PYINT64_TARGET_AVX512_BITS \
+    __attribute__((target("avx512f,avx512dq,avx512vl,avx512bw,avx512cd,avx512vpopcntdq,popcnt")))
+#else
+#define PYINT64_HAVE_DISPATCH 0
+#endif
+
+#if PYINT64_HAVE_DISPATCH
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) && !defined(__clang__)
+#define PYINT64_TARGET_SCALAR __attribute__((optimize("no-tree-vectorize")))
+#else
+#define PYINT64_TARGET_SCALAR
+#endif
+
+#define DEFINE_BINARY_KERNELS(isa, target, name)                                \
+    static target int                                                           \
+    name##_aa_wrap_##isa(const int64_t *a, const int64_t *b, int64_t *out,      \
+                         Py_ssize_t n)                                          \
+    {                                                                           \
+        for (Py_ssize_t i = 0; i < n; ++i)                                      \
+            out[i] = pyint64_op_##name(a[i], b[i]);                             \
+        return 0;                                                               \
+    }                                                                           \
+    static target int                                                           \
+    name##_as_wrap_##isa(const int64_t *a, int64_t b, int64_t *out,             \
+                         Py_ssize_t n)                                          \
+    {                                                                           \
+        for (Py_ssize_t i = 0; i < n; ++i)                                      \
+            out[i] = pyint64_op_##name(a[i], b);                                \
+        return 0;                                                               \
+    }                                                                           \
+    static target int                                                           \
+    name##_sa_wrap_##isa(int64_t a, const int64_t *b, int64_t *out,             \
+                         Py_ssize_t n)                                          \
+    {                                                                           \
+        for (Py_ssize_t i = 0; i < n; ++i)                                      \
+            out[i] = pyint64_op_##name(a, b[i]);                                \
+        return 0;                                                               \
+    }                                                                           \
+    static target int                                                           \
+    name##_aa_checked_##isa(const int64_t *a, const int64_t *b, int64_t *out,   \
+                            Py_ssize_t n)                                       \
+    {                                                                           \
+        int overflow = 0;                                                       \
+        for (Py_ssize_t i = 0; i < n; ++i)                                      \
+            overflow |= pyint64_op_##name##_overflow(a[i], b[i], &out[i]);      \
+        return overflow;                                                        \
+    }                                                                           \
+    static target int                                                           \
+    name##_as_checked_##isa(const int64_t *a, int64_t b, int64_t *out,          \
+                            Py_ssize_t n)                                       \
+    {                                                                           \
+        int overflow = 0;                                                       \
+        for (Py_ssize_t i = 0; i < n; ++i)                                      \
+            overflow |= pyint64_op_##name##_overflow(a[i], b, &out[i]);         \
+        return overflow;                                                        \
+    }                                                                           \
+    static target int                                                           \
+    name##_sa_checked_##isa(int64_t a, const int64_t *b, int64_t *out,          \
+                            Py_ssize_t n)                                       \
+    {                                                                           \
+        int overflow = 0;                                                       \
+        for (Py_ssize_t i = 0; i < n; ++i)                                      \
+            overflow |= pyint64_op_##name##_overflow(a, b[i], &out[i]);         \
+        return overflow;                                                        \
+    }                                                                           \
+    static target int                                                           \
+    name##_aa_sat_##isa(const int64_t *a, const int64_t *b, int64_t *out,       \
+                        Py_ssize_t n)                                           \
+    {                                                                           \
+        for (Py_ssize_t i = 0; i < n; ++i)                                      \
+            out[i] = pyint64_op_##name##_sat(a[i], b[i]);                       \
+        return 0;                                                               \
+    }                                                                           \
+    static target int                                                           \
+    name##_as_sat_##isa(const int64_t *a, int64_t b, int64_t *out,              \
+                        Py_ssize_t n)                                           \
+    {                                                                           \
+        for (Py_ssize_t i = 0; i < n; ++i)                                      \
+            out[i] = pyint64_op_##name##_sat(a[i], b);                          \
+        return 0;                                                               \
+    }                                                                           \
+    static target int                                                           \
+    name##_sa_sat_##isa(int64_t a, const int64_t *b, int64_t *out,              \
+                        Py_ssize_t n)                                           \
+    {                                                                           \
+        for (Py_ssize_t i = 0; i < n; ++i)                                      \
+            out[i] = pyint64_op_##name##_sat(a, b[i]);                          \
+        return 0;                                                               \
+    }
+
+#define DEFINE_UNARY_KERNEL(isa, target, name)                                  \
+    static target int                                                           \
+    name##_u_wrap_##isa(const int64_t *a, int64_t *out, Py_ssize_t n)           \
+    {                                                                           \
+        for (Py_ssize_t i = 0; i < n; ++i)                                      \
+            out[i] = pyint64_op_##name(a[i]);                                   \
+        return 0;                                                               \
+    }                                                                           \
+    static target int                                                           \
+    name##_u_checked_##isa(const int64_t *a, int64_t *out, Py_ssize_t n)        \
+    {                                                                           \
+        int overflow = 0;                                                       \
+        for (Py_ssize_t i = 0; i < n; ++i)                                      \
+            overflow |= pyint64_op_##name##_overflow(a[i], &out[i]);            \
+        return overflow;                                                        \
+    }                                                                           \
+    static target int                                                           \
+    name##_u_sat_##isa(const int64_t *a, int64_t *out, Py_ssize_t n)            \
+    {                                                                           \
+        for (Py_ssize_t i = 0; i < n; ++i)                                      \
+            out[i] = pyint64_op_##name##_sat(a[i]);                             \
+        return 0;                                                               \
+    }
+
+#define DEFINE_HASH_KERNEL(isa, target)                                         \
+    static target void                                                          \
+    hash_##isa(const int64_t *a, uint64_t seed, int64_t *out, Py_ssize_t n)     \
+    {                                                                           \
+        for (Py_ssize_t i = 0; i < n; ++i)                                      \
+            out[i] = pyint64_op_mix64(a[i], seed);                              \
+    }
+
+#define DEFINE_REDUCE_KERNELS(isa, target)                                      \
+    static target void                                                          \
+    sum_##isa(const int64_t *a, Py_ssize_t n, int64_t *hi, int64_t *lo)         \
+    {                                                                           \
+        int64_t high = 0;                                                       \
+        int64_t low = 0;                                                        \
+        for (Py_ssize_t i = 0; i < n; ++i)                                      \
+        {                                                                       \
+            high += a[i] >> 32;                                                 \
+            low += a[i] & 0xffffffff;                                           \
+        }                                                                       \
+        *hi = high;                                                             \
+        *lo = low;                                                              \
+    }                                                                           \
+    static target int64_t                                                       \
+    prod_##isa(const int64_t *a, Py_ssize_t n, int64_t init)                    \
+    {                                                                           \
+        for (Py_ssize_t i = 0; i < n; ++i)                                      \
+            init = pyint64_op_mul(init, a[i]);                                  \
+        return init;                                                            \
+    }                                                                           \
+    static target int64_t                                                       \
+    min_##isa(const int64_t *a, Py_ssize_t n, int64_t init)                     \
+    {                                                                           \
+        for (Py_ssize_t i = 0; i < n; ++i)                                      \
+            init = a[i] < init ? a[i] : init;                                   \
+        return init;                                                            \
+    }                                                                           \
+    static target int64_t                                                       \
+    max_##isa(const int64_t *a, Py_ssize_t n, int64_t init)                     \
+    {                                                                           \
+        for (Py_ssize_t i = 0; i < n; ++i)                                      \
+            init = a[i] > init ? a[i] : init;                                   \
+        return init;                                                            \
+    }
+
+#define DEFINE_BIT_KERNELS(isa, target)                                         \
+    DEFINE_BIT_KERNEL(isa, target, bit_length)                                  \
+    DEFINE_BIT_KERNEL(isa, target, bit_count)                                   \
+    DEFINE_BIT_KERNEL(isa, target, clz)                                         \
+    DEFINE_BIT_KERNEL(isa, target, ctz)                                         \
+    DEFINE_BIT_KERNEL(isa, target, bswap)                                       \
+    static target void                                                          \
+    rotl_##isa(const int64_t *a, int64_t b, int64_t *out, Py_ssize_t n)         \
+    {                                                                           \
+        for (Py_ssize_t i = 0; i < n; ++i)                                      \
+            out[i] = pyint64_op_rotl(a[i], b);                                  \
+    }
+
+#define DEFINE_DIVIDE_KERNEL(isa, target)                                       \
+    static target void                                                          \
+    divide_##isa(const int64_t *a, const PyInt64Divider *divider,               \
+                 int64_t *quotient, int64_t *remainder, Py_ssize_t n)           \
+    {                                                                           \
+        const PyInt64Divider d = *divider;                                      \
+        if (quotient && remainder)                                              \
+        {                                                                       \
+            for (Py_ssize_t i = 0; i < n; ++i)                                  \
+                quotient[i] = pyint64_divider_divmod(a[i], &d, &remainder[i]);  \
+        }                                                                       \
+        else if (quotient)                                                      \
+        {                                                                       \
+            for (Py_ssize_t i = 0; i < n; ++i)                                  \
+                quotient[i] = pyint64_divider_floordiv(a[i], &d);               \
+        }                                                                       \
+        else                                                                    \
+        {                                                                       \
+            for (Py_ssize_t i = 0; i < n; ++i)                                  \
+                remainder[i] = pyint64_divider_mod(a[i], &d);                   \
+        }                                                                       \
+    }
+
+// uint32 words of packed blocks are little-endian.
+static inline uint32_t
+kernels_le32(uint32_t word)
+{
+#if PY_LITTLE_ENDIAN
+    return word;
+#else
+    return (uint32_t)((uint64_t)pyint64_op_bswap((int64_t)word) >> 32);
+#endif
+}
+
+#define PACK_ROWS (PYINT64_PACK_BLOCK / PYINT64_PACK_LANES)
+
+/*
+ * Row r of a block holds values r * PYINT64_PACK_LANES + lane, at bit
+ * r * width of each stream; word k of a stream is word
+ * k * PYINT64_PACK_LANES + lane of the block.  A value spans up to three
+ * words, the same ones in every lane of a row.
+ */
+#define DEFINE_PACK_KERNELS(isa, target)                                        \
+    static target void                                                          \
+    pack_##isa(const int64_t *a, int64_t reference, int width,                  \
+               unsigned char *out)                                              \
+    {                                                                           \
+        uint32_t words[PYINT64_PACK_BLOCK * 2];                                 \
+        memset(words, 0, PYINT64_PACK_SIZE(width));                             \
+        for (int row = 0; row < PACK_ROWS && width; ++row)                      \
+        {                                                                       \
+            const int bit = row * width;                                        \
+            const int shift = bit & 31;                                         \
+            uint32_t* word = words + (bit >> 5) * PYINT64_PACK_LANES;           \
+            const uint64_t* v = (const uint64_t*)a + row * PYINT64_PACK_LANES;  \
+            for (int lane = 0; lane < PYINT64_PACK_LANES; ++lane)               \
+                word[lane] |= (uint32_t)((v[lane] - (uint64_t)reference)        \
+                                         << shift);                             \
+            if (shift + width > 32)                                             \
+            {                                                                   \
+                word += PYINT64_PACK_LANES;                                     \
+                for (int lane = 0; lane < PYINT64_PACK_LANES; ++lane)           \
+                    word[lane] |= (uint32_t)((v[lane] - (uint64_t)reference)    \
+                                             >> (32 - shift));                  \
+            }                                                                   \
+            if (shift + width > 64)                                             \
+            {                                                                   \
+                word += PYINT64_PACK_LANES;                                     \
+                for (int lane = 0; lane < PYINT64_PACK_LANES; ++lane)           \
+                    word[lane] |= (uint32_t)((v[lane] - (uint64_t)reference)    \
+                                             >> (64 - shift));                  \
+            }                                                                   \
+        }                                                                       \
+        for (int index = 0; index < 4 * width; ++index)                         \
+            words[index] = kernels_le32(words[index]);                          \
+        memcpy(out, words, PYINT64_PACK_SIZE(width));                           \
+    }                                                                           \
+    static target void                                                          \
+    unpack_##isa(const unsigned char *in, int64_t reference, int width,         \
+                 int64_t *out)                                                  \
+    {                                                                           \
+        if (!width)                                                             \
+        {                                                                       \
+            for (int index = 0; index < PYINT64_PACK_BLOCK; ++index)            \
+                out[index] = reference;                                         \
+            return;                                                             \
+        }                                                                       \
+        const uint64_t mask = ~(uint64_t)0 >> (64 - width);                     \
+        for (int row = 0; row < PACK_ROWS; ++row)                               \
+        {                                                                       \
+            const int bit = row * width;                                        \
+            const int shift = bit & 31;                                         \
+            uint32_t w[3][PYINT64_PACK_LANES];                                  \
+            const unsigned char* word = in + (bit >> 5) * sizeof(w[0]);         \
+            uint64_t v[PYINT64_PACK_LANES];                                     \
+            if (shift + width > 64)                                             \
+            {                                                                   \
+                memcpy(w, word, sizeof(w));                                     \
+                for (int lane = 0; lane < PYINT64_PACK_LANES; ++lane)           \
+                    v[lane] = ((kernels_le32(w[0][lane])                        \
+                                | (uint64_t)kernels_le32(w[1][lane]) << 32)     \
+                               >> shift)                                        \
+                              | (uint64_t)kernels_le32(w[2][lane])              \
+                                << (64 - shift);                                \
+            }                                                                   \
+            else if (shift + width > 32)                                        \
+            {                                                                   \
+                memcpy(w, word, 2 * sizeof(w[0]));                              \
+                for (int lane = 0; lane < PYINT64_PACK_LANES; ++lane)           \
+                    v[lane] = (kernels_le32(w[0][lane])                         \
+                               | (uint64_t)kernels_le32(w[1][lane]) << 32)      \
+                              >> shift;                                         \
+            }                                                                   \
+            else                                                                \
+            {                                                                   \
+                memcpy(w, word, sizeof(w[0]));                                  \
+                for (int lane = 0; lane < PYINT64_PACK_LANES; ++lane)           \
+                    v[lane] = (uint64_t)kernels_le32(w[0][lane]) >> shift;      \
+            }                                                                   \
+            for (int lane = 0; lane < PYINT64_PACK_LANES; ++lane)               \
+                out[row * PYINT64_PACK_LANES + lane] =                          \
+                    (int64_t)((v[lane] & mask) + (uint64_t)reference);          \
+        }                                                                       \
+    }
+
+#define DEFINE_SCAN_KERNEL(isa, target, name, step)                             \
+    static target void                                                          \
+    scan_##name##_##isa(const int64_t *a, int64_t *out, Py_ssize_t n,           \
+                        int64_t init)                                           \
+    {                                                                           \
+        uint64_t acc = (uint64_t)init;                                          \
+        for (Py_ssize_t i = 0; i < n; ++i)                                      \
+        {                                                                       \
+            const uint64_t value = (uint64_t)a[i];                              \
+            acc = step;                                                         \
+            out[i] = (int64_t)acc;                                              \
+        }                                                                       \
+    }
+
+#define DEFINE_SCAN_KERNELS(isa, target)                                        \
+    DEFINE_SCAN_KERNEL(isa, target, sum, acc + value)                           \
+    DEFINE_SCAN_KERNEL(isa, target, min,                                        \
+        (int64_t)value < (int64_t)acc ? value : acc)                            \
+    DEFINE_SCAN_KERNEL(isa, target, max,                                        \
+        (int64_t)value > (int64_t)acc ? value : acc)                            \
+    DEFINE_SCAN_KERNEL(isa, target, xor, acc ^ value)                           \
+    static target int                                                           \
+    scan_overflow_##isa(const int64_t *out, Py_ssize_t n, int64_t init)         \
+    {                                                                           \
+        /* x + y = r overflowed iff r differs in sign from both x and y */      \
+        const uint64_t* r = (const uint64_t*)out;                               \
+        uint64_t flags = 0;                                                     \
+        if (n > 0)                                                              \
+            flags = ((uint64_t)init ^ r[0]) & ((r[0] - (uint64_t)init) ^ r[0]); \
+        for (Py_ssize_t i = 1; i < n; ++i)                                      \
+            flags |= (r[i - 1] ^ r[i]) & ((r[i] - r[i - 1]) ^ r[i]);            \
+        return (int)(flags >> 63);                                              \
+    }
+
+#define SCAN_KERNELS(isa)                                                       \
+    {                                                                           \
+        [PYINT64_SCAN_SUM] = scan_sum_##isa,                                    \
+        [PYINT64_SCAN_MIN] = scan_min_##isa,                                    \
+        [PYINT64_SCAN_MAX] = scan_max_##isa,                                    \
+        [PYINT64_SCAN_XOR] = scan_xor_##isa,                                    \
+    }
+
+#define DEFINE_BIT_KERNEL(isa, target, name)                                    \
+    static target void                                                          \
+    name##_bit_##isa(const int64_t *a, int64_t *out, Py_ssize_t n)              \
+    {                                                                           \
+        for (Py_ssize_t i = 0; i < n; ++i)                                      \
+            out[i] = pyint64_op_##name(a[i]);                                   \
+    }
+
+#define BIT_KERNELS(isa)                                                        \
+    {                                                                           \
+        [PYINT64_OP_BIT_LENGTH] = bit_length_bit_##isa,                         \
+        [PYINT64_OP_BIT_COUNT] = bit_count_bit_##isa,                           \
+        [PYINT64_OP_CLZ] = clz_bit_##isa,                                       \
+        [PYINT64_OP_CTZ] = ctz_bit_##isa,                                       \
+        [PYINT64_OP_BSWAP] = bswap_bit_##isa,                                   \
+    }
+
+#define KERNEL_MODES(shape, isa)                                                \
+    [PYINT64_KERNEL_WRAP] = {                                                   \
+        PYINT64_##shape##_OPS(KERNEL_ENTRY_##shape, wrap, isa)                  \
+    },                                                                          \
+    [PYINT64_KERNEL_CHECKED] = {                                                \
+        PYINT64_##shape##_OPS(KERNEL_ENTRY_##shape, checked, isa)               \
+    },                                                                          \
+    [PYINT64_KERNEL_SATURATE] = {                                               \
+        PYINT64_##shape##_OPS(KERNEL_ENTRY_##shape, sat, isa)                   \
+    },
+
+#define DEFINE_KERNEL_TABLE(isa, target)                                        \
+    DEFINE_BINARY_KERNELS(isa, target, add)                                     \
+    DEFINE_BINARY_KERNELS(isa, target, sub)                                     \
+    DEFINE_BINARY_KERNELS(isa, target, mul)                                     \
+    DEFINE_BINARY_KERNELS(isa, target, floordiv)                                \
+    DEFINE_BINARY_KERNELS(isa, target, mod)                                     \
+    DEFINE_BINARY_KERNELS(isa, target, and)                                     \
+    DEFINE_BINARY_KERNELS(isa, target, or)                                      \
+    DEFINE_BINARY_KERNELS(isa, target, xor)                                     \
+    DEFINE_BINARY_KERNELS(isa, target, lshift)                                  \
+    DEFINE_BINARY_KERNELS(isa, target, rshift)                                  \
+    DEFINE_UNARY_KERNEL(isa, target, neg)                                       \
+    DEFINE_UNARY_KERNEL(isa, target, abs)                                       \
+    DEFINE_UNARY_KERNEL(isa, target, invert)                                    \
+    DEFINE_HASH_KERNEL(isa, target)                                             \
+    DEFINE_REDUCE_KERNELS(isa, target)                                          \
+    DEFINE_BIT_KERNELS(isa, target)                                             \
+    DEFINE_DIVIDE_KERNEL(isa, target)                                           \
+    DEFINE_PACK_KERNELS(isa, target)                                            \
+    DEFINE_SCAN_KERNELS(isa, target)                                            \
+    static PyInt64KernelTable kernels_##isa = {                                 \
+        .binary = { KERNEL_MODES(AA, isa) },                                    \
+        .binary_scalar = { KERNEL_MODES(AS, isa) },                             \
+        .scalar_binary = { KERNEL_MODES(SA, isa) },                             \
+        .unary = { KERNEL_MODES(U, isa) },                                      \
+        .hash = hash_##isa,                                                     \
+        .sum = sum_##isa,                                                       \
+        .prod = prod_##isa,                                                     \
+        .min = min_##isa,                                                       \
+        .max = max_##isa,                                                       \
+        .bits = BIT_KERNELS(isa),                                               \
+        .rotl = rotl_##isa,                                                     \
+        .divide = divide_##isa,                                                 \
+        .pack = pack_##isa,                                                     \
+        .unpack = unpack_##isa,                                                 \
+        .scan = SCAN_KERNELS(isa),                                              \
+        .scan_overflow = scan_overflow_##isa,                                   \
+    };
+
+#define PYINT64_AA_OPS(X, mode, isa) PYINT64_BINARY_OPS_EX(X, mode, isa)
+#define PYINT64_AS_OPS(X, mode, isa) PYINT64_BINARY_OPS_EX(X, mode, isa)
+#define PYINT64_SA_OPS(X, mode, isa) PYINT64_BINARY_OPS_EX(X, mode, isa)
+#define PYINT64_U_OPS(X, mode, isa) PYINT64_UNARY_OPS_EX(X, mode, isa)
+
+#define PYINT64_BINARY_OPS_EX(X, mode, isa)     \
+    X(PYINT64_OP_ADD, add, mode, isa)           \
+    X(PYINT64_OP_SUB, sub, mode, isa)           \
+    X(PYINT64_OP_MUL, mul, mode, isa)           \
+    X(PYINT64_OP_FLOORDIV, floordiv, mode, isa) \
+    X(PYINT64_OP_MOD, mod, mode, isa)           \
+    X(PYINT64_OP_AND, and, mode, isa)           \
+    X(PYINT64_OP_OR, or, mode, isa)             \
+    X(PYINT64_OP_XOR, xor, mode, isa)           \
+    X(PYINT64_OP_LSHIFT, lshift, mode, isa)     \
+    X(PYINT64_OP_RSHIFT, rshift, mode, isa)
+
+#define PYINT64_UNARY_OPS_EX(X, mode, isa)      \
+    X(PYINT64_OP_NEG, neg, mode, isa)           \
+    X(PYINT64_OP_ABS, abs, mode, isa)           \
+    X(PYINT64_OP_INVERT, invert, mode, isa)
+
+#define KERNEL_ENTRY_AA(op, name, mode, isa) [op] = name##_aa_##mode##_##isa,
+#define KERNEL_ENTRY_AS(op, name, mode, isa) [op] = name##_as_##mode##_##isa,
+#define KERNEL_ENTRY_SA(op, name, mode, isa) [op] = name##_sa_##mode##_##isa,
+#define KERNEL_ENTRY_U(op, name, mode, isa) [op] = name##_u_##mode##_##isa,
+
+DEFINE_KERNEL_TABLE(scalar, PYINT64_TARGET_SCALAR)
+
+#if PYINT64_HAVE_DISPATCH
+
+DEFINE_KERNEL_TABLE(sse42, PYINT64_TARGET_SSE42)
+DEFINE_KERNEL_TABLE(avx2, PYINT64_TARGET_AVX2)
+DEFINE_KERNEL_TABLE(avx512, PYINT64_TARGET_AVX512)
+
+/*
+ * VPOPCNTQ and VPLZCNTQ come with AVX512_VPOPCNTDQ and AVX512CD, which
+ * not every AVX-512 CPU has; the avx512 table takes these bit kernels
+ * when the CPU does.
+ */
+DEFINE_BIT_KERNELS(avx512bits, PYINT64_TARGET_AVX512_BITS)
+
+/*
+ * A scan carries a dependency through every element, which no loop
+ * vectorizes.  These add (or xor) a vector to copies of itself shifted by
+ * 1, 2, 4 lanes (filled with the identity), which leaves the prefix of the
+ * vector in every lane, then the carry broadcast from the last lane of the
+ * previous vector: one dependent step per vector instead of per element.
+ * AVX-512 also has 64-bit min and max for the same scheme.
+ */
+#define DEFINE_LANE_SCAN_AVX2(name, op)                                         \
+    static PYINT64_TARGET_AVX2 void                                             \
+    scan_##name##_lanes_avx2(const int64_t *a, int64_t *out, Py_ssize_t n,      \
+                             int64_t init)                                      \
+    {                                                                           \
+        const __m256i zero = _mm256_setzero_si256();                            \
+        __m256i carry = _mm256_set1_epi64x(init);                               \
+        Py_ssize_t i = 0;                                                       \
+        for (; i + 4 <= n; i += 4)                                              \
+        {                                                                       \
+            __m256i x = _mm256_loadu_si256((const __m256i*)(a + i));            \
+            /* lanes 0 x0 x1 x2, then 0 0 x0 x1 */                              \
+            x = op(x, _mm256_blend_epi32(_mm256_permute4x64_epi64(x, 0x90),     \
+                                         zero, 0x03));                          \
+            x = op(x, _mm256_blend_epi32(_mm256_permute4x64_epi64(x, 0x40),     \
+                                         zero, 0x0f));                          \
+            x = op(x, carry);                                                   \
+            _mm256_storeu_si256((__m256i*)(out + i), x);                        \
+            carry = _mm256_permute4x64_epi64(x, 0xff);                          \
+        }                                                                       \
+        scan_##name##_avx2(a + i, out + i, n - i, i ? out[i - 1] : init);       \
+    }
+
+#define DEFINE_LANE_SCAN_AVX512(name, op, identity)                             \
+    static PYINT64_TARGET_AVX512 void                                           \
+    scan_##name##_lanes_avx512(const int64_t *a, int64_t *out, Py_ssize_t n,    \
+                               int64_t init)                                    \
+    {                                                                           \
+        const __m512i fill = _mm512_set1_epi64(identity);                       \
+        const __m512i last = _mm512_set1_epi64(7);                              \
+        __m512i carry = _mm512_set1_epi64(init);                                \
+        Py_ssize_t i = 0;                                                       \
+        for (; i + 8 <= n; i += 8)                                              \
+        {                                                                       \
+            __m512i x = _mm512_loadu_si512(a + i);                              \
+            x = op(x, _mm512_alignr_epi64(x, fill, 7));                         \
+            x = op(x, _mm512_alignr_epi64(x, fill, 6));                         \
+            x = op(x, _mm512_alignr_epi64(x, fill, 4));                         \
+            x = op(x, carry);                                                   \
+            _mm512_storeu_si512(out + i, x);                                    \
+            carry = _mm512_permutexvar_epi64(last, x);                          \
+        }                                                                       \
+        scan_##name##_avx512(a + i, out + i, n - i, i ? out[i - 1] : init);     \
+    }
+
+DEFINE_LANE_SCAN_AVX2(sum, _mm256_add_epi64)
+DEFINE_LANE_SCAN_AVX2(xor, _mm256_xor_si256)
+DEFINE_LANE_SCAN_AVX512(sum, _mm512_add_epi64, 0)
+DEFINE_LANE_SCAN_AVX512(min, _mm512_min_epi64, INT64_MAX)
+DEFINE_LANE_SCAN_AVX512(max, _mm512_max_epi64, INT64_MIN)
+DEFINE_LANE_SCAN_AVX512(xor, _mm512_xor_si512, 0)
+
+#endif
+static const char* const isa_names[PYINT64_ISA_COUNT] = {
+    [PYINT64_ISA_SCALAR] = "scalar",
+    [PYINT64_ISA_SSE42] = "sse4.2",
+    [PYINT64_ISA_AVX2] = "avx2",
+    [PYINT64_ISA_AVX512] = "avx512",
+};
+
+PYINT64_SETTING(const PyInt64KernelTable*) PyInt64Kernels_Selected = &kernels_scalar;
+
+// Make table the selected one, after everything written to it.
+static void
+int64kernels_publish(const PyInt64KernelTable* table)
+{
+#if PYINT64_SETTINGS_ATOMICS
+    atomic_store_explicit(&PyInt64Kernels_Selected, table, memory_order_release);
+#else
+    PyInt64Kernels_Selected = table;
+#endif
+}
+
+PyInt64Isa PyInt64Kernels_Detect(void)
+{
+#if PYINT64_HAVE_DISPATCH
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")
+        && __builtin_cpu_supports("avx512vl") && __builtin_cpu_supports("avx512bw"))
+    {
+        return PYINT64_ISA_AVX512;
+    }
+
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return PYINT64_ISA_AVX2;
+    }
+
+    if (__builtin_cpu_supports("sse4.2"))
+    {
+        return PYINT64_ISA_SSE42;
+    }
+#endif
+
+    return PYINT64_ISA_SCALAR;
+}
+
+const PyInt64KernelTable* PyInt64Kernels_Table(PyInt64Isa isa)
+{
+    switch (isa)
+    {
+#if PYINT64_HAVE_DISPATCH
+    case PYINT64_ISA_SSE42:
+        return &kernels_sse42;
+    case PYINT64_ISA_AVX2:
+        return &kernels_avx2;
+    case PYINT64_ISA_AVX512:
+        return &kernels_avx512;
+#endif
+    case PYINT64_ISA_SCALAR:
+        return &kernels_scalar;
+    default:
+        return NULL;
+    }
+}
+
+void PyInt64Kernels_Init(void)
+{
+    // The selection is process-wide, imports by later interpreters keep it.
+#if PYINT64_KERNELS_ONCE
+    static atomic_flag initialized = ATOMIC_FLAG_INIT;
+    if (atomic_flag_test_and_set(&initialized))
+    {
+        return;
+    }
+#else
+    static int initialized = 0;
+    if (initialized)
+    {
+        return;
+    }
+    initialized = 1;
+#endif
+
+#if PYINT64_HAVE_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512cd") && __builtin_cpu_supports("avx512vpopcntdq"))
+    {
+        const PyInt64BitKernel bits[PYINT64_BIT_OP_COUNT] = BIT_KERNELS(avx512bits);
+        memcpy(kernels_avx512.bits, bits, sizeof(bits));
+        kernels_avx512.rotl = rotl_avx512bits;
+    }
+
+    kernels_avx2.scan[PYINT64_SCAN_SUM] = scan_sum_lanes_avx2;
+    kernels_avx2.scan[PYINT64_SCAN_XOR] = scan_xor_lanes_avx2;
+    kernels_avx512.scan[PYINT64_SCAN_SUM] = scan_sum_lanes_avx512;
+    kernels_avx512.scan[PYINT64_SCAN_MIN] = scan_min_lanes_avx512;
+    kernels_avx512.scan[PYINT64_SCAN_MAX] = scan_max_lanes_avx512;
+    kernels_avx512.scan[PYINT64_SCAN_XOR] = scan_xor_lanes_avx512;
+#endif
+
+    int64kernels_publish(PyInt64Kernels_Table(PyInt64Kernels_Detect()));
+}
+
+PyInt64Isa PyInt64Kernels_Current(void)
+{
+    // The table is the one setting, so a concurrent Select cannot split it.
+    const PyInt64KernelTable* table = PyInt64Kernels_Get();
+    for (int isa = PYINT64_ISA_COUNT - 1; isa > PYINT64_ISA_SCALAR; --isa)
+    {
+        if (PyInt64Kernels_Table((PyInt64Isa)isa) == table)
+        {
+            return (PyInt64Isa)isa;
+        }
+    }
+
+    return PYINT64_ISA_SCALAR;
+}
+
+int PyInt64Kernels_Select(PyInt64Isa isa)
+{
+    if (isa < 0 || isa >= PYINT64_ISA_COUNT || isa > PyInt64Kernels_Detect())
+    {
+        return -1;
+    }
+
+    const PyInt64KernelTable* table = PyInt64Kernels_Table(isa);
+    if (!table)
+    {
+        return -1;
+    }
+
+    int64kernels_publish(table);
+    return 0;
+}
+
+const char* PyInt64Kernels_IsaName(PyInt64Isa isa)
+{
+    if (isa < 0 || isa >= PYINT64_ISA_COUNT)
+    {
+        return NULL;
+    }
+
+    return isa_names[isa];
+}
+
+int PyInt64Kernels_CheckOperands(PyInt64BinaryOp op, const int64_t* right, Py_ssize_t n)
+{
+    switch (op)
+    {
+    case PYINT64_OP_FLOORDIV:
+    case PYINT64_OP_MOD:
+        for (Py_ssize_t i = 0; i < n; ++i)
+        {
+            if (right[i] == 0)
+            {
+                PyErr_SetString(PyExc_ZeroDivisionError, "int64 division by zero");
+                return -1;
+            }
+        }
+        return 0;
+    case PYINT64_OP_LSHIFT:
+    case PYINT64_OP_RSHIFT:
+        for (Py_ssize_t i = 0; i < n; ++i)
+        {
+            if (right[i] < 0)
+            {
+                PyErr_SetString(PyExc_ValueError, "Negative shift count");
+                return -1;
+            }
+        }
+        return 0;
+    default:
+        return 0;
+    }
+}
+
+PyInt64KernelMode PyInt64Kernels_Mode(void)
+{
+    switch (PYINT64_SETTING_LOAD(PyInt64_OverflowPolicy))
+    {
+    case PYINT64_OVERFLOW_CHECKED:
+    case PYINT64_OVERFLOW_PROMOTE:
+        return PYINT64_KERNEL_CHECKED;
+    case PYINT64_OVERFLOW_SATURATE:
+        return PYINT64_KERNEL_SATURATE;
+    default:
+        return PYINT64_KERNEL_WRAP;
+    }
+}
+
+static const char* const binary_op_names[PYINT64_BINARY_OP_COUNT] = {
+    [PYINT64_OP_ADD] = "addition",
+    [PYINT64_OP_SUB] = "subtraction",
+    [PYINT64_OP_MUL] = "multiplication",
+    [PYINT64_OP_FLOORDIV] = "division",
+    [PYINT64_OP_MOD] = "remainder",
+    [PYINT64_OP_AND] = "and",
+    [PYINT64_OP_OR] = "or",
+    [PYINT64_OP_XOR] = "xor",
+    [PYINT64_OP_LSHIFT] = "left shift",
+    [PYINT64_OP_RSHIFT] = "right shift",
+};
+
+static const char* const unary_op_names[PYINT64_UNARY_OP_COUNT] = {
+    [PYINT64_OP_NEG] = "negation",
+    [PYINT64_OP_ABS] = "absolute value",
+    [PYINT64_OP_INVERT] = "invert",
+};
+
+const char* PyInt64Kernels_BinaryOpName(PyInt64BinaryOp op)
+{
+    return binary_op_names[op];
+}
+
+const char* PyInt64Kernels_UnaryOpName(PyInt64UnaryOp op)
+{
+    return unary_op_names[op];
+}
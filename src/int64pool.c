@@ -0,0 +1,427 @@
+#include <stdlib.h>
+
+#include "int64ops.h"
+#include "int64pool.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+// Without C11 atomics every job runs on the calling thread.
+#if !defined(__STDC_NO_ATOMICS__) && !defined(_MSC_VER)
+#include <stdatomic.h>
+#define PYINT64_POOL_THREADS 1
+#else
+#define PYINT64_POOL_THREADS 0
+#endif
+
+// Upper bound on num_threads, the calling thread included.
+#define PYINT64_POOL_MAX_THREADS 256
+
+static PyObject *
+int64pool_configure_threads(PyObject *module, PyObject *args, PyObject *kwds);
+
+static PyObject *
+int64pool_thread_info(PyObject *module, PyObject *unused);
+
+static
+PyMethodDef int64pool_methods[] =
+{
+    {
+        "configure_threads", (PyCFunction)(void(*)(void))int64pool_configure_threads,
+        METH_VARARGS | METH_KEYWORDS,
+        "configure_threads(*, num_threads=None, threshold=None)\n"
+        "Set the number of threads bulk operations may use (1 runs everything\n"
+        "on the calling thread) and the element count from which they release\n"
+        "the GIL and split the work. Omitted settings are left as is. The\n"
+        "default thread count is the number of CPUs, or PYINT64_NUM_THREADS\n"
+        "from the environment."
+    },
+    {
+        "thread_info", int64pool_thread_info, METH_NOARGS,
+        "thread_info()\n"
+        "Return a dict with the thread pool settings."
+    },
+    {NULL} /* sentinel */
+};
+
+// Threads used by a job, including the calling thread.
+static PYINT64_SETTING(int) pool_num_threads = 1;
+
+// Smallest job that is worth releasing the GIL for.
+static PYINT64_SETTING(Py_ssize_t) pool_threshold = (Py_ssize_t)1 << 17;
+
+static int
+int64pool_cpu_count(void)
+{
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    const long count = (long)info.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+#else
+    const long count = 1;
+#endif
+    return (int)Py_MAX(1, Py_MIN(count, PYINT64_POOL_MAX_THREADS));
+}
+
+static int
+int64pool_serial(Py_ssize_t n, Py_ssize_t grain, PyInt64PoolTask task, void *arg)
+{
+    int flags = 0;
+    Py_ssize_t chunk = 0;
+    for (Py_ssize_t begin = 0; begin < n; begin += grain, ++chunk)
+    {
+        flags |= task(begin, Py_MIN(begin + grain, n), chunk, arg);
+    }
+
+    return flags;
+}
+
+#if PYINT64_POOL_THREADS
+
+// Chunks [next, end) of one thread, padded to a cache line of its own.
+typedef struct
+{
+    _Alignas(64) _Atomic(Py_ssize_t) next;
+    Py_ssize_t end;
+} int64pool_run;
+
+static struct
+{
+    long pid;                   // process that started the workers
+    int workers;                // worker threads started, ids 1..workers
+    PyThread_type_lock busy;    // held by the thread running a job
+    PyThread_type_lock done;    // released by the last worker of a job
+    PyThread_type_lock wake[PYINT64_POOL_MAX_THREADS];
+
+    // The job, written before the workers are woken.
+    PyInt64PoolTask task;
+    void *arg;
+    Py_ssize_t n;
+    Py_ssize_t grain;
+    int threads;
+
+    _Atomic(int) pending;
+    _Atomic(int) flags;
+    int64pool_run runs[PYINT64_POOL_MAX_THREADS];
+} pool;
+
+static long
+int64pool_getpid(void)
+{
+#ifdef _WIN32
+    return (long)GetCurrentProcessId();
+#else
+    return (long)getpid();
+#endif
+}
+
+// Work off the own run of chunks, then steal from the following ones.
+static int
+int64pool_work(int id)
+{
+    int flags = 0;
+    for (int offset = 0; offset < pool.threads; ++offset)
+    {
+        int64pool_run* run = &pool.runs[(id + offset) % pool.threads];
+        for (;;)
+        {
+            const Py_ssize_t chunk = atomic_fetch_add(&run->next, 1);
+            if (chunk >= run->end)
+            {
+                break;
+            }
+
+            const Py_ssize_t begin = chunk * pool.grain;
+            flags |= pool.task(begin, Py_MIN(begin + pool.grain, pool.n), chunk, pool.arg);
+        }
+    }
+
+    return flags;
+}
+
+static void
+int64pool_worker(void *arg)
+{
+    const int id = (int)(intptr_t)arg;
+    for (;;)
+    {
+        PyThread_acquire_lock(pool.wake[id], WAIT_LOCK);
+
+        const int flags = int64pool_work(id);
+        if (flags)
+        {
+            atomic_fetch_or(&pool.flags, flags);
+        }
+
+        if (atomic_fetch_sub(&pool.pending, 1) == 1)
+        {
+            PyThread_release_lock(pool.done);
+        }
+    }
+}
+
+/*
+ * Start workers up to the given count, return how many are running.
+ * Called with the GIL held and pool_starting set. A forked child inherits
+ * none of the threads and locks in an unknown state, so it starts over
+ * with fresh ones.
+ */
+static int
+int64pool_start_workers(int workers)
+{
+    const long pid = int64pool_getpid();
+    if (pool.busy && pool.pid != pid)
+    {
+        pool.busy = NULL;
+        pool.workers = 0;
+    }
+
+    if (!pool.busy)
+    {
+        PyThread_type_lock busy = PyThread_allocate_lock();
+        PyThread_type_lock done = PyThread_allocate_lock();
+        if (!busy || !done)
+        {
+            if (busy) PyThread_free_lock(busy);
+            if (done) PyThread_free_lock(done);
+            return 0;
+        }
+
+        // done is kept locked between jobs.
+        PyThread_acquire_lock(done, WAIT_LOCK);
+        pool.busy = busy;
+        pool.done = done;
+        pool.pid = pid;
+    }
+
+    while (pool.workers < workers)
+    {
+        const int id = pool.workers + 1;
+        PyThread_type_lock wake = PyThread_allocate_lock();
+        if (!wake)
+        {
+            break;
+        }
+
+        // A worker sleeps on its wake lock until a job releases it.
+        PyThread_acquire_lock(wake, WAIT_LOCK);
+        pool.wake[id] = wake;
+        if (PyThread_start_new_thread(int64pool_worker, (void*)(intptr_t)id)
+            == PYTHREAD_INVALID_THREAD_ID)
+        {
+            PyThread_free_lock(wake);
+            break;
+        }
+
+        pool.workers = id;
+    }
+
+    return pool.workers;
+}
+
+// Interpreters with a GIL of their own share the pool and may start it at once.
+static atomic_flag pool_starting = ATOMIC_FLAG_INIT;
+
+static int
+int64pool_start(int workers)
+{
+    while (atomic_flag_test_and_set_explicit(&pool_starting, memory_order_acquire))
+    {
+    }
+
+    const int running = int64pool_start_workers(workers);
+    atomic_flag_clear_explicit(&pool_starting, memory_order_release);
+    return running;
+}
+
+// Called without the GIL while holding pool.busy.
+static int
+int64pool_dispatch(Py_ssize_t n, Py_ssize_t grain, PyInt64PoolTask task, void *arg,
+                   int threads)
+{
+    const Py_ssize_t chunks = PyInt64Pool_CHUNKS(n, grain);
+
+    pool.task = task;
+    pool.arg = arg;
+    pool.n = n;
+    pool.grain = grain;
+    pool.threads = threads;
+    for (int id = 0; id < threads; ++id)
+    {
+        atomic_store(&pool.runs[id].next, chunks * id / threads);
+        pool.runs[id].end = chunks * (id + 1) / threads;
+    }
+
+    atomic_store(&pool.flags, 0);
+    atomic_store(&pool.pending, threads - 1);
+    for (int id = 1; id < threads; ++id)
+    {
+        PyThread_release_lock(pool.wake[id]);
+    }
+
+    int flags = int64pool_work(0);
+    PyThread_acquire_lock(pool.done, WAIT_LOCK);
+    return flags | atomic_load(&pool.flags);
+}
+
+#endif // PYINT64_POOL_THREADS
+
+// Run every chunk without the GIL, on the pool when it is free.
+static int
+int64pool_run_chunks(Py_ssize_t n, Py_ssize_t grain, PyInt64PoolTask task, void *arg)
+{
+    const int num_threads = PYINT64_SETTING_LOAD(pool_num_threads);
+    int threads = (int)Py_MIN(num_threads, PyInt64Pool_CHUNKS(n, grain));
+#if PYINT64_POOL_THREADS
+    if (threads > 1)
+    {
+        threads = 1 + Py_MIN(threads - 1, int64pool_start(threads - 1));
+    }
+#else
+    threads = 1;
+#endif
+
+    int flags;
+    Py_BEGIN_ALLOW_THREADS
+#if PYINT64_POOL_THREADS
+    // Another thread running a job keeps the pool, this one runs alone.
+    if (threads > 1 && PyThread_acquire_lock(pool.busy, NOWAIT_LOCK))
+    {
+        flags = int64pool_dispatch(n, grain, task, arg, threads);
+        PyThread_release_lock(pool.busy);
+    }
+    else
+#endif
+    {
+        flags = int64pool_serial(n, grain, task, arg);
+    }
+    Py_END_ALLOW_THREADS
+
+    return flags;
+}
+
+int PyInt64Pool_Parallel(Py_ssize_t n)
+{
+    return n >= PYINT64_SETTING_LOAD(pool_threshold);
+}
+
+int PyInt64Pool_For(Py_ssize_t n, Py_ssize_t grain, PyInt64PoolTask task, void *arg)
+{
+    if (n <= 0)
+    {
+        return 0;
+    }
+
+    if (!PyInt64Pool_Parallel(n))
+    {
+        return int64pool_serial(n, grain, task, arg);
+    }
+
+    return int64pool_run_chunks(n, grain, task, arg);
+}
+
+int PyInt64Pool_Run(Py_ssize_t tasks, PyInt64PoolTask task, void *arg)
+{
+    if (tasks <= 0)
+    {
+        return 0;
+    }
+
+    return int64pool_run_chunks(tasks, 1, task, arg);
+}
+
+int PyInt64Pool_Init(PyObject* module)
+{
+    int threads = int64pool_cpu_count();
+
+    const char* env = getenv("PYINT64_NUM_THREADS");
+    if (env && *env)
+    {
+        char* end;
+        const long count = strtol(env, &end, 10);
+        if (*end == '\0' && count > 0)
+        {
+            threads = (int)Py_MIN(count, PYINT64_POOL_MAX_THREADS);
+        }
+    }
+
+    PYINT64_SETTING_STORE(pool_num_threads, threads);
+
+    return PyModule_AddFunctions(module, int64pool_methods);
+}
+
+static PyObject *
+int64pool_configure_threads(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"num_threads", "threshold", NULL};
+    PyObject* num_threads = Py_None;
+    PyObject* threshold = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|$OO:configure_threads", kwlist,
+                                     &num_threads, &threshold))
+    {
+        return NULL;
+    }
+
+    if (!Py_IsNone(num_threads))
+    {
+        const Py_ssize_t count = PyNumber_AsSsize_t(num_threads, PyExc_OverflowError);
+        if (count == -1 && PyErr_Occurred())
+        {
+            return NULL;
+        }
+
+        if (count < 1 || count > PYINT64_POOL_MAX_THREADS)
+        {
+            PyErr_Format(PyExc_ValueError, "num_threads must be in 1..%d",
+                         PYINT64_POOL_MAX_THREADS);
+            return NULL;
+        }
+
+        PYINT64_SETTING_STORE(pool_num_threads, (int)count);
+    }
+
+    if (!Py_IsNone(threshold))
+    {
+        const Py_ssize_t size = PyNumber_AsSsize_t(threshold, PyExc_OverflowError);
+        if (size == -1 && PyErr_Occurred())
+        {
+            return NULL;
+        }
+
+        if (size < 0)
+        {
+            PyErr_SetString(PyExc_ValueError, "threshold must be >= 0");
+            return NULL;
+        }
+
+        PYINT64_SETTING_STORE(pool_threshold, size);
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+int64pool_thread_info(PyObject *module, PyObject *unused)
+{
+#if PYINT64_POOL_THREADS
+    const int workers = pool.busy && pool.pid == int64pool_getpid() ? pool.workers : 0;
+#else
+    const int workers = 0;
+#endif
+
+    return Py_BuildValue(
+        "{s:i,s:n,s:n,s:i,s:i,s:O}",
+        "num_threads", PYINT64_SETTING_LOAD(pool_num_threads),
+        "threshold", PYINT64_SETTING_LOAD(pool_threshold),
+        "grain", PYINT64_POOL_GRAIN,
+        "cpu_count", int64pool_cpu_count(),
+        "workers", workers,
+        "threaded", PYINT64_POOL_THREADS ? Py_True : Py_False
+    );
+}
@@ -0,0 +1,652 @@
+#include <string.h>
+
+#include "pyint64obj.h"
+#include "int64arrayobj.h"
+#include "int64kernels.h"
+#include "int64ops.h"
+#include "int64pool.h"
+#include "int64scan.h"
+
+static PyObject *
+int64scan_scan(PyObject *module, PyObject *args, PyObject *kwds);
+
+static PyObject *
+int64scan_rolling(PyObject *module, PyObject *args, PyObject *kwds);
+
+static
+PyMethodDef int64scan_methods[] =
+{
+    {
+        "scan", (PyCFunction)(void(*)(void))int64scan_scan,
+        METH_VARARGS | METH_KEYWORDS,
+        "scan(values, op='sum', exclusive=False, out=None)\n"
+        "Running sum, min, max or xor of an int64 buffer or iterable of\n"
+        "integers: element i combines values[0] to values[i], or, exclusive,\n"
+        "values[0] to values[i - 1] starting from 0 (sum, xor), the largest\n"
+        "int64 (min) or the smallest (max). Sums follow the overflow policy\n"
+        "like Int64Array arithmetic: wrap, raise OverflowError (checked and\n"
+        "promote, leaving out partly written) or clamp the exact running sum.\n"
+        "Returns a new Int64Array, or out (a writable int64 buffer of the same\n"
+        "length, values itself is fine)."
+    },
+    {
+        "rolling", (PyCFunction)(void(*)(void))int64scan_rolling,
+        METH_VARARGS | METH_KEYWORDS,
+        "rolling(values, window, op='sum', out=None)\n"
+        "Sum, min or max of every run of window consecutive values, n - window\n"
+        "+ 1 results for n values (none when the window is longer). Sums\n"
+        "follow the overflow policy like scan(). Returns a new Int64Array, or\n"
+        "out (a writable int64 buffer of that length, not overlapping values)."
+    },
+    {NULL} /* sentinel */
+};
+
+int PyInt64Scan_Init(PyObject* module)
+{
+    return PyModule_AddFunctions(module, int64scan_methods);
+}
+
+static const char* const int64scan_op_names[PYINT64_SCAN_OP_COUNT] =
+{
+    [PYINT64_SCAN_SUM] = "sum",
+    [PYINT64_SCAN_MIN] = "min",
+    [PYINT64_SCAN_MAX] = "max",
+    [PYINT64_SCAN_XOR] = "xor",
+};
+
+// What an exclusive scan starts from.
+static const int64_t int64scan_identity[PYINT64_SCAN_OP_COUNT] =
+{
+    [PYINT64_SCAN_SUM] = 0,
+    [PYINT64_SCAN_MIN] = INT64_MAX,
+    [PYINT64_SCAN_MAX] = INT64_MIN,
+    [PYINT64_SCAN_XOR] = 0,
+};
+
+static int
+int64scan_get_op(const char *name, const char *op, int rolling, PyInt64ScanOp *result)
+{
+    for (int index = 0; index < PYINT64_SCAN_OP_COUNT; ++index)
+    {
+        if (strcmp(op, int64scan_op_names[index]) == 0 && !(rolling && index == PYINT64_SCAN_XOR))
+        {
+            *result = index;
+            return 0;
+        }
+    }
+
+    PyErr_Format(PyExc_ValueError, "%s() op must be %s, not '%s'",
+        name, rolling ? "'sum', 'min' or 'max'" : "'sum', 'min', 'max' or 'xor'", op);
+    return -1;
+}
+
+/*
+ * 128-bit two's complement accumulator: exact running sums, whatever the
+ * overflow policy does with them afterwards.
+ */
+typedef struct
+{
+    uint64_t lo;
+    int64_t hi;
+} int64scan_wide;
+
+static inline void
+int64scan_wide_add(int64scan_wide *acc, int64_t hi, uint64_t lo)
+{
+    const uint64_t low = acc->lo + lo;
+    acc->hi = pyint64_op_add(acc->hi, pyint64_op_add(hi, low < lo));
+    acc->lo = low;
+}
+
+static inline void
+int64scan_wide_add_value(int64scan_wide *acc, int64_t value)
+{
+    int64scan_wide_add(acc, value >> 63, (uint64_t)value);
+}
+
+static inline void
+int64scan_wide_sub_value(int64scan_wide *acc, int64_t value)
+{
+    // The negation of (value >> 63, value) in two's complement.
+    const uint64_t lo = (uint64_t)value;
+    int64scan_wide_add(acc, ~(value >> 63) + (lo == 0), 0 - lo);
+}
+
+static inline int
+int64scan_wide_fits(const int64scan_wide *acc)
+{
+    return acc->hi == ((int64_t)acc->lo >> 63);
+}
+
+static inline int64_t
+int64scan_wide_clamp(const int64scan_wide *acc)
+{
+    if (int64scan_wide_fits(acc))
+    {
+        return (int64_t)acc->lo;
+    }
+
+    return acc->hi < 0 ? INT64_MIN : INT64_MAX;
+}
+
+// Exact sum of items with the kernel, in blocks it cannot overflow.
+static int64scan_wide
+int64scan_sum(const PyInt64KernelTable *kernels, const int64_t *items, Py_ssize_t length)
+{
+    int64scan_wide acc = {0, 0};
+    for (Py_ssize_t first = 0; first < length; first += PYINT64_SUM_BLOCK)
+    {
+        int64_t hi;
+        int64_t lo;
+        kernels->sum(items + first, Py_MIN(length - first, PYINT64_SUM_BLOCK), &hi, &lo);
+
+        // hi * 2**32 + lo, lo is never negative.
+        int64scan_wide_add(&acc, hi >> 32, (uint64_t)hi << 32);
+        int64scan_wide_add(&acc, 0, (uint64_t)lo);
+    }
+
+    return acc;
+}
+
+/*
+ * Parallel jobs cut their output into at most this many chunks, each at
+ * least least elements long; small ones run as a single chunk.
+ */
+#define INT64SCAN_MAX_CHUNKS 1024
+
+static inline Py_ssize_t
+int64scan_grain(Py_ssize_t length, Py_ssize_t least)
+{
+    if (!PyInt64Pool_Parallel(length))
+    {
+        return Py_MAX(length, 1);
+    }
+
+    const Py_ssize_t grain =
+        Py_MAX(PYINT64_POOL_GRAIN, PyInt64Pool_CHUNKS(length, INT64SCAN_MAX_CHUNKS));
+    return Py_MAX(grain, least);
+}
+
+// Output of a function: a new Int64Array, or out when the caller passed one.
+typedef struct
+{
+    PyObject* result;
+    Py_buffer view;
+    int64_t* items;
+} int64scan_output;
+
+static int
+int64scan_output_open(PyObject *module, const char *name, PyObject *out, Py_ssize_t length,
+                      int64scan_output *output)
+{
+    output->view.obj = NULL;
+    if (out == Py_None)
+    {
+        output->result = PyInt64Array_NewEx(PyModule_GetState(module), length);
+        if (!output->result)
+        {
+            return -1;
+        }
+
+        output->items = ((PyInt64ArrayObject*)output->result)->ob_item;
+        return 0;
+    }
+
+    if (PyInt64Buffer_GetWritable(out, name, &output->view) < 0)
+    {
+        return -1;
+    }
+
+    const Py_ssize_t out_length = output->view.len / (Py_ssize_t)sizeof(int64_t);
+    if (out_length != length)
+    {
+        PyErr_Format(PyExc_ValueError, "%s() out holds %zd values, expected %zd",
+            name, out_length, length);
+        PyBuffer_Release(&output->view);
+        return -1;
+    }
+
+    output->result = Py_NewRef(out);
+    output->items = output->view.buf;
+    return 0;
+}
+
+// Release the destination, return the result, NULL if failed.
+static PyObject *
+int64scan_output_close(int64scan_output *output, int failed)
+{
+    if (output->view.obj)
+    {
+        PyBuffer_Release(&output->view);
+    }
+
+    if (failed)
+    {
+        Py_CLEAR(output->result);
+    }
+
+    return output->result;
+}
+
+/*
+ * Scans of large inputs take two passes over the pool: the first reduces
+ * every chunk but the last to its total, the totals are scanned serially
+ * into the carry each chunk starts from, and the second pass scans every
+ * chunk from its carry.
+ */
+typedef struct
+{
+    const int64_t* items;
+    int64_t* out;
+    const PyInt64KernelTable* kernels;
+    PyInt64ScanOp op;
+    PyInt64KernelMode mode;
+    int exclusive;
+    int64scan_wide* sums;   // sum: exact total, then carry, of every chunk
+    int64_t* folds;         // min, max and xor
+} int64scan_job;
+
+static int
+int64scan_total_task(Py_ssize_t begin, Py_ssize_t end, Py_ssize_t chunk, void *arg)
+{
+    const int64scan_job* job = arg;
+    const int64_t* items = job->items + begin;
+    const Py_ssize_t length = end - begin;
+
+    switch (job->op)
+    {
+    case PYINT64_SCAN_SUM:
+        job->sums[chunk] = int64scan_sum(job->kernels, items, length);
+        break;
+    case PYINT64_SCAN_MIN:
+        job->folds[chunk] = job->kernels->min(items, length, INT64_MAX);
+        break;
+    case PYINT64_SCAN_MAX:
+        job->folds[chunk] = job->kernels->max(items, length, INT64_MIN);
+        break;
+    default:
+    {
+        uint64_t total = 0;
+        for (Py_ssize_t index = 0; index < length; ++index)
+        {
+            total ^= (uint64_t)items[index];
+        }
+        job->folds[chunk] = (int64_t)total;
+        break;
+    }
+    }
+
+    return 0;
+}
+
+/*
+ * Scan a chunk whose exact prefix so far is carry, policy applied.  The
+ * wrapped kernel runs first; when it overflowed, the exact sums are
+ * rebuilt from its output, whose differences are the inputs (out may be
+ * the input itself, so they are not read again).  Returns 1 for an
+ * overflow in checked mode.
+ */
+static int
+int64scan_sum_chunk(const int64scan_job *job, const int64_t *items, int64_t *out,
+                    Py_ssize_t length, int64scan_wide carry)
+{
+    const int64_t init = (int64_t)carry.lo;
+    job->kernels->scan[PYINT64_SCAN_SUM](items, out, length, init);
+
+    if (job->mode == PYINT64_KERNEL_WRAP
+        || (int64scan_wide_fits(&carry) && !job->kernels->scan_overflow(out, length, init)))
+    {
+        return 0;
+    }
+
+    if (job->mode == PYINT64_KERNEL_CHECKED)
+    {
+        return 1;
+    }
+
+    uint64_t previous = (uint64_t)init;
+    for (Py_ssize_t index = 0; index < length; ++index)
+    {
+        const uint64_t wrapped = (uint64_t)out[index];
+        int64scan_wide_add_value(&carry, (int64_t)(wrapped - previous));
+        previous = wrapped;
+        out[index] = int64scan_wide_clamp(&carry);
+    }
+
+    return 0;
+}
+
+static int
+int64scan_scan_task(Py_ssize_t begin, Py_ssize_t end, Py_ssize_t chunk, void *arg)
+{
+    const int64scan_job* job = arg;
+    const int64_t* items = job->items + begin;
+    int64_t* out = job->out + begin;
+
+    // Exclusive chunks scan all but their last value, then shift by one.
+    const Py_ssize_t length = end - begin - job->exclusive;
+    int64_t first;
+
+    if (job->op == PYINT64_SCAN_SUM)
+    {
+        const int64scan_wide carry = job->sums[chunk];
+        if (int64scan_sum_chunk(job, items, out, length, carry))
+        {
+            return 1;
+        }
+
+        // Checked chunks get here only with a carry that fits.
+        first = job->mode == PYINT64_KERNEL_SATURATE ?
+            int64scan_wide_clamp(&carry) : (int64_t)carry.lo;
+    }
+    else
+    {
+        first = job->folds[chunk];
+        job->kernels->scan[job->op](items, out, length, first);
+    }
+
+    if (job->exclusive)
+    {
+        memmove(out + 1, out, length * sizeof(int64_t));
+        out[0] = first;
+    }
+
+    return 0;
+}
+
+// Turn the totals of all chunks but the last into the carry of every chunk.
+static void
+int64scan_carries(int64scan_job *job, Py_ssize_t chunks)
+{
+    if (job->op == PYINT64_SCAN_SUM)
+    {
+        int64scan_wide carry = {0, 0};
+        for (Py_ssize_t chunk = 0; chunk + 1 < chunks; ++chunk)
+        {
+            const int64scan_wide total = job->sums[chunk];
+            job->sums[chunk] = carry;
+            int64scan_wide_add(&carry, total.hi, total.lo);
+        }
+        job->sums[chunks - 1] = carry;
+        return;
+    }
+
+    int64_t carry = int64scan_identity[job->op];
+    for (Py_ssize_t chunk = 0; chunk + 1 < chunks; ++chunk)
+    {
+        const int64_t total = job->folds[chunk];
+        job->folds[chunk] = carry;
+        switch (job->op)
+        {
+        case PYINT64_SCAN_MIN:
+            carry = Py_MIN(carry, total);
+            break;
+        case PYINT64_SCAN_MAX:
+            carry = Py_MAX(carry, total);
+            break;
+        default:
+            carry ^= total;
+            break;
+        }
+    }
+    job->folds[chunks - 1] = carry;
+}
+
+static PyObject *
+int64scan_scan(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"values", "op", "exclusive", "out", NULL};
+    PyObject* values;
+    const char* op_name = "sum";
+    int exclusive = 0;
+    PyObject* out = Py_None;
+    PyInt64ScanOp op;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|spO:scan", kwlist,
+                                     &values, &op_name, &exclusive, &out)
+        || int64scan_get_op("scan", op_name, 0, &op) < 0)
+    {
+        return NULL;
+    }
+
+    PyInt64Buffer buffer;
+    if (PyInt64Buffer_Get(values, &buffer) < 0)
+    {
+        return NULL;
+    }
+
+    int64scan_output output;
+    if (int64scan_output_open(module, "scan", out, buffer.length, &output) < 0)
+    {
+        PyInt64Buffer_Release(&buffer);
+        return NULL;
+    }
+
+    const Py_ssize_t n = buffer.length;
+    const Py_ssize_t grain = int64scan_grain(n, 0);
+    const Py_ssize_t chunks = PyInt64Pool_CHUNKS(n, grain);
+    int64scan_wide sums[INT64SCAN_MAX_CHUNKS];
+    int64_t folds[INT64SCAN_MAX_CHUNKS];
+    int64scan_job job =
+    {
+        .items = buffer.items,
+        .out = output.items,
+        .kernels = PyInt64Kernels_Get(),
+        .op = op,
+        .mode = PyInt64Kernels_Mode(),
+        .exclusive = exclusive,
+        .sums = sums,
+        .folds = folds,
+    };
+
+    int overflow = 0;
+    if (n > 0)
+    {
+        // The last chunk's total carries into nothing.
+        PyInt64Pool_For((chunks - 1) * grain, grain, int64scan_total_task, &job);
+        int64scan_carries(&job, chunks);
+        overflow = PyInt64Pool_For(n, grain, int64scan_scan_task, &job);
+    }
+
+    PyInt64Buffer_Release(&buffer);
+    if (overflow)
+    {
+        PyErr_SetString(PyExc_OverflowError, "int64 sum overflow in scan()");
+    }
+
+    return int64scan_output_close(&output, overflow);
+}
+
+/*
+ * Sliding windows, chunked by output: chunk [begin, end) reads the values
+ * [begin, end + window - 1), so chunks are at least a window long to keep
+ * the overlap they read twice below half the work.
+ */
+typedef struct
+{
+    const int64_t* items;
+    int64_t* out;
+    Py_ssize_t window;
+    const PyInt64KernelTable* kernels;
+    PyInt64ScanOp op;
+    PyInt64KernelMode mode;
+    Py_ssize_t* deques;     // min and max, window slots per chunk
+} int64scan_rolling_job;
+
+static int
+int64scan_rolling_sum_task(Py_ssize_t begin, Py_ssize_t end, Py_ssize_t chunk, void *arg)
+{
+    const int64scan_rolling_job* job = arg;
+    const int64_t* items = job->items;
+    int64_t* out = job->out;
+    const Py_ssize_t window = job->window;
+
+    if (job->mode == PYINT64_KERNEL_WRAP)
+    {
+        uint64_t sum = int64scan_sum(job->kernels, items + begin, window).lo;
+        out[begin] = (int64_t)sum;
+        for (Py_ssize_t index = begin + 1; index < end; ++index)
+        {
+            sum += (uint64_t)items[index + window - 1] - (uint64_t)items[index - 1];
+            out[index] = (int64_t)sum;
+        }
+        return 0;
+    }
+
+    int64scan_wide sum = int64scan_sum(job->kernels, items + begin, window);
+    for (Py_ssize_t index = begin; index < end; ++index)
+    {
+        if (index > begin)
+        {
+            int64scan_wide_add_value(&sum, items[index + window - 1]);
+            int64scan_wide_sub_value(&sum, items[index - 1]);
+        }
+
+        if (!int64scan_wide_fits(&sum) && job->mode == PYINT64_KERNEL_CHECKED)
+        {
+            return 1;
+        }
+        out[index] = int64scan_wide_clamp(&sum);
+    }
+
+    return 0;
+}
+
+/*
+ * Monotonic deque: indices of the window whose values only grow (min) or
+ * shrink (max) from front to back, so the front is the extreme of the
+ * window.  Every index is pushed and popped once, amortized O(1) per
+ * value whatever the window.
+ */
+static int
+int64scan_rolling_extreme_task(Py_ssize_t begin, Py_ssize_t end, Py_ssize_t chunk, void *arg)
+{
+    const int64scan_rolling_job* job = arg;
+    const int64_t* items = job->items;
+    const Py_ssize_t window = job->window;
+    const int largest = job->op == PYINT64_SCAN_MAX;
+    Py_ssize_t* deque = job->deques + chunk * window;
+    Py_ssize_t front = 0;
+    Py_ssize_t size = 0;
+
+    for (Py_ssize_t index = begin; index < end + window - 1; ++index)
+    {
+        const int64_t value = items[index];
+        if (size && deque[front] <= index - window)
+        {
+            front = front + 1 == window ? 0 : front + 1;
+            --size;
+        }
+
+        while (size)
+        {
+            Py_ssize_t back = front + size - 1;
+            back -= back >= window ? window : 0;
+            const int64_t last = items[deque[back]];
+            if (largest ? last > value : last < value)
+            {
+                break;
+            }
+            --size;
+        }
+
+        Py_ssize_t slot = front + size;
+        slot -= slot >= window ? window : 0;
+        deque[slot] = index;
+        ++size;
+
+        if (index >= begin + window - 1)
+        {
+            job->out[index - window + 1] = items[deque[front]];
+        }
+    }
+
+    return 0;
+}
+
+static PyObject *
+int64scan_rolling(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"values", "window", "op", "out", NULL};
+    PyObject* values;
+    Py_ssize_t window;
+    const char* op_name = "sum";
+    PyObject* out = Py_None;
+    PyInt64ScanOp op;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "On|sO:rolling", kwlist,
+                                     &values, &window, &op_name, &out)
+        || int64scan_get_op("rolling", op_name, 1, &op) < 0)
+    {
+        return NULL;
+    }
+
+    if (window < 1)
+    {
+        PyErr_Format(PyExc_ValueError, "rolling() window must be >= 1, not %zd", window);
+        return NULL;
+    }
+
+    PyInt64Buffer buffer;
+    if (PyInt64Buffer_Get(values, &buffer) < 0)
+    {
+        return NULL;
+    }
+
+    const Py_ssize_t n = buffer.length;
+    const Py_ssize_t count = window <= n ? n - window + 1 : 0;
+    int64scan_output output;
+    if (int64scan_output_open(module, "rolling", out, count, &output) < 0)
+    {
+        PyInt64Buffer_Release(&buffer);
+        return NULL;
+    }
+
+    // Windows read values after the outputs before them are written.
+    if (count > 0 && output.items < buffer.items + n && buffer.items < output.items + count)
+    {
+        PyErr_SetString(PyExc_ValueError, "rolling() out must not overlap values");
+        PyInt64Buffer_Release(&buffer);
+        return int64scan_output_close(&output, 1);
+    }
+
+    const Py_ssize_t grain = int64scan_grain(count, window);
+    const Py_ssize_t chunks = PyInt64Pool_CHUNKS(count, grain);
+    int64scan_rolling_job job =
+    {
+        .items = buffer.items,
+        .out = output.items,
+        .window = window,
+        .kernels = PyInt64Kernels_Get(),
+        .op = op,
+        .mode = PyInt64Kernels_Mode(),
+    };
+
+    int failed = 0;
+    if (count > 0 && op == PYINT64_SCAN_SUM)
+    {
+        failed = PyInt64Pool_For(count, grain, int64scan_rolling_sum_task, &job);
+        if (failed)
+        {
+            PyErr_SetString(PyExc_OverflowError, "int64 sum overflow in rolling()");
+        }
+    }
+    else if (count > 0)
+    {
+        // Chunks are at least a window long: no more than n + 1 slots.
+        job.deques = PyMem_Malloc(chunks * window * sizeof(Py_ssize_t));
+        if (!job.deques)
+        {
+            PyErr_NoMemory();
+            failed = 1;
+        }
+        else
+        {
+            PyInt64Pool_For(count, grain, int64scan_rolling_extreme_task, &job);
+            PyMem_Free(job.deques);
+        }
+    }
+
+    PyInt64Buffer_Release(&buffer);
+    return int64scan_output_close(&output, failed);
+}
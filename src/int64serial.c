@@ -0,0 +1,158 @@
+#include <string.h>
+
+#include "pyint64obj.h"
+#include "int64arrayobj.h"
+#include "int64ops.h"
+#include "int64serial.h"
+
+static PyObject *
+int64serial_dumps(PyObject *module, PyObject *values);
+
+static PyObject *
+int64serial_loads(PyObject *module, PyObject *args, PyObject *kwds);
+
+static
+PyMethodDef int64serial_methods[] =
+{
+    {
+        "dumps", (PyCFunction)int64serial_dumps, METH_O,
+        "dumps(values)\n"
+        "Serialize an int64 buffer or iterable of integers to bytes: a 16 byte\n"
+        "header (magic, version, byte order, count) followed by the raw\n"
+        "little-endian values."
+    },
+    {
+        "loads", (PyCFunction)(void(*)(void))int64serial_loads,
+        METH_VARARGS | METH_KEYWORDS,
+        "loads(data, copy=False)\n"
+        "Load the output of dumps from a bytes-like object into an Int64Array.\n"
+        "The payload is used in place when it is aligned and in native byte\n"
+        "order, unless copy is true; the array is then read-only if data is."
+    },
+    {NULL} /* sentinel */
+};
+
+int PyInt64Serial_Init(PyObject* module)
+{
+    if (PyModule_AddIntConstant(module, "SERIAL_VERSION", PYINT64_SERIAL_VERSION) < 0)
+    {
+        return -1;
+    }
+
+    return PyModule_AddFunctions(module, int64serial_methods);
+}
+
+static PyObject *
+int64serial_dumps(PyObject *module, PyObject *values)
+{
+    PyInt64Buffer buffer;
+    if (PyInt64Buffer_Get(values, &buffer) < 0)
+    {
+        return NULL;
+    }
+
+    if (buffer.length > (PY_SSIZE_T_MAX - PYINT64_SERIAL_HEADER_SIZE) / (Py_ssize_t)sizeof(int64_t))
+    {
+        PyInt64Buffer_Release(&buffer);
+        return PyErr_NoMemory();
+    }
+
+    PyObject* result = PyBytes_FromStringAndSize(NULL,
+        PYINT64_SERIAL_HEADER_SIZE + buffer.length * (Py_ssize_t)sizeof(int64_t));
+    if (!result)
+    {
+        PyInt64Buffer_Release(&buffer);
+        return NULL;
+    }
+
+    unsigned char* header = (unsigned char*)PyBytes_AS_STRING(result);
+    memcpy(header, PYINT64_SERIAL_MAGIC, 4);
+    header[4] = PYINT64_SERIAL_VERSION;
+    header[5] = '<';
+    header[6] = sizeof(int64_t);
+    header[7] = 0;
+
+    const uint64_t count = (uint64_t)buffer.length;
+    for (int index = 0; index < 8; ++index)
+    {
+        header[8 + index] = (unsigned char)(count >> (8 * index));
+    }
+
+    char* payload = (char*)header + PYINT64_SERIAL_HEADER_SIZE;
+#if PY_LITTLE_ENDIAN
+    memcpy(payload, buffer.items, buffer.length * sizeof(int64_t));
+#else
+    for (Py_ssize_t index = 0; index < buffer.length; ++index)
+    {
+        const int64_t value = pyint64_op_bswap(buffer.items[index]);
+        memcpy(payload + index * sizeof(int64_t), &value, sizeof(int64_t));
+    }
+#endif
+
+    PyInt64Buffer_Release(&buffer);
+    return result;
+}
+
+static PyObject *
+int64serial_loads(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"data", "copy", NULL};
+    PyObject* data;
+    int copy = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|p:loads", kwlist, &data, &copy))
+    {
+        return NULL;
+    }
+
+    Py_buffer view;
+    if (PyObject_GetBuffer(data, &view, PyBUF_SIMPLE) < 0)
+    {
+        return NULL;
+    }
+
+    unsigned char header[PYINT64_SERIAL_HEADER_SIZE];
+    const Py_ssize_t length = view.len;
+    if (length >= PYINT64_SERIAL_HEADER_SIZE)
+    {
+        memcpy(header, view.buf, PYINT64_SERIAL_HEADER_SIZE);
+    }
+
+    PyBuffer_Release(&view);
+
+    if (length < PYINT64_SERIAL_HEADER_SIZE || memcmp(header, PYINT64_SERIAL_MAGIC, 4) != 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "not pyint64 serialized data");
+        return NULL;
+    }
+
+    if (header[4] == 0 || header[4] > PYINT64_SERIAL_VERSION)
+    {
+        PyErr_Format(PyExc_ValueError, "unsupported pyint64 format version %d", header[4]);
+        return NULL;
+    }
+
+    if ((header[5] != '<' && header[5] != '>') || header[6] != sizeof(int64_t))
+    {
+        PyErr_SetString(PyExc_ValueError, "corrupt pyint64 serialized header");
+        return NULL;
+    }
+
+    uint64_t count = 0;
+    for (int index = 7; index >= 0; --index)
+    {
+        count = (count << 8) | header[8 + index];
+    }
+
+    const uint64_t payload = (uint64_t)(length - PYINT64_SERIAL_HEADER_SIZE);
+    if (payload % sizeof(int64_t) != 0 || payload / sizeof(int64_t) != count)
+    {
+        PyErr_Format(PyExc_ValueError,
+            "pyint64 serialized data holds %zd bytes of payload, expected %llu values",
+            (Py_ssize_t)payload, (unsigned long long)count);
+        return NULL;
+    }
+
+    return PyInt64Array_FromRaw(data, PYINT64_SERIAL_HEADER_SIZE, (Py_ssize_t)count,
+                                header[5] == '<', copy);
+}
@@ -0,0 +1,804 @@
+#include "pyint64obj.h"
+#include "int64arrayobj.h"
+#include "int64setobj.h"
+
+static PyObject *
+int64set_new(PyTypeObject *type, PyObject *args, PyObject *kwds);
+
+static void
+int64set_dealloc(PyInt64SetObject *self);
+
+static PyObject *
+int64set_repr(PyInt64SetObject *self);
+
+static Py_ssize_t
+int64set_length(PyInt64SetObject *self);
+
+static int
+int64set_contains(PyInt64SetObject *self, PyObject *key);
+
+static PyObject *
+int64set_iter(PyInt64SetObject *self);
+
+static PyObject *
+int64set_add(PyInt64SetObject *self, PyObject *key);
+
+static PyObject *
+int64set_discard(PyInt64SetObject *self, PyObject *key);
+
+static PyObject *
+int64set_remove(PyInt64SetObject *self, PyObject *key);
+
+static PyObject *
+int64set_pop(PyInt64SetObject *self, PyObject *unused);
+
+static PyObject *
+int64set_clear(PyInt64SetObject *self, PyObject *unused);
+
+static PyObject *
+int64set_reserve(PyInt64SetObject *self, PyObject *arg);
+
+static PyObject *
+int64set_update(PyInt64SetObject *self, PyObject *values);
+
+static PyObject *
+int64set_contains_many(PyInt64SetObject *self, PyObject *values);
+
+static PyObject *
+int64set_toarray(PyInt64SetObject *self, PyObject *unused);
+
+static PyObject *
+int64set_richcompare(PyInt64SetObject *self, PyObject *other, int op);
+
+static PyObject *
+int64set_or(PyObject *left, PyObject *right);
+
+static PyObject *
+int64set_and(PyObject *left, PyObject *right);
+
+static PyObject *
+int64set_sub(PyObject *left, PyObject *right);
+
+static PyObject *
+int64set_xor(PyObject *left, PyObject *right);
+
+static PyObject *
+int64set_inplace_or(PyInt64SetObject *self, PyObject *other);
+
+static PyObject *
+int64set_inplace_and(PyInt64SetObject *self, PyObject *other);
+
+static PyObject *
+int64set_inplace_sub(PyInt64SetObject *self, PyObject *other);
+
+static PyObject *
+int64set_inplace_xor(PyInt64SetObject *self, PyObject *other);
+
+static
+PyMethodDef int64set_methods[] =
+{
+    {"add", (PyCFunction)int64set_add, METH_O,
+        "Add an int64 key."},
+    {"discard", (PyCFunction)int64set_discard, METH_O,
+        "Remove a key if present."},
+    {"remove", (PyCFunction)int64set_remove, METH_O,
+        "Remove a key, raise KeyError if absent."},
+    {"pop", (PyCFunction)int64set_pop, METH_NOARGS,
+        "Remove and return an arbitrary key, raise KeyError if empty."},
+    {"clear", (PyCFunction)int64set_clear, METH_NOARGS,
+        "Remove all keys and release the table."},
+    {"reserve", (PyCFunction)int64set_reserve, METH_O,
+        "reserve(n)\n"
+        "Grow the table so that n keys fit without rehashing."},
+    {"update", (PyCFunction)int64set_update, METH_O,
+        "update(values)\n"
+        "Add every key of an int64 buffer or iterable."},
+    {"contains_many", (PyCFunction)int64set_contains_many, METH_O,
+        "contains_many(values)\n"
+        "Return an Int64Array holding 1 where values[i] is in the set, else 0."},
+    {"toarray", (PyCFunction)int64set_toarray, METH_NOARGS,
+        "Return the keys as an Int64Array."},
+    {NULL} /* sentinel */
+};
+
+// Type object.
+static
+PyType_Slot int64set_slots[] =
+{
+    {Py_tp_doc, "Int64Set(values=(), /)\n"
+                "Set of int64 keys stored unboxed in a flat hash table."},
+    {Py_tp_dealloc, int64set_dealloc},
+    {Py_tp_repr, int64set_repr},
+    {Py_tp_hash, PyObject_HashNotImplemented},
+    {Py_tp_getattro, PyObject_GenericGetAttr},
+    {Py_tp_richcompare, int64set_richcompare},
+    {Py_tp_iter, int64set_iter},
+    {Py_tp_methods, int64set_methods},
+    {Py_tp_new, int64set_new},
+    {Py_sq_length, int64set_length},
+    {Py_sq_contains, int64set_contains},
+    {Py_nb_or, int64set_or},
+    {Py_nb_and, int64set_and},
+    {Py_nb_subtract, int64set_sub},
+    {Py_nb_xor, int64set_xor},
+    {Py_nb_inplace_or, int64set_inplace_or},
+    {Py_nb_inplace_and, int64set_inplace_and},
+    {Py_nb_inplace_subtract, int64set_inplace_sub},
+    {Py_nb_inplace_xor, int64set_inplace_xor},
+    {0, NULL}
+};
+
+PyType_Spec PyInt64Set_Spec =
+{
+    .name = "pyint64.Int64Set",
+    .basicsize = sizeof(PyInt64SetObject),
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE | Py_TPFLAGS_BASETYPE,
+    .slots = int64set_slots,
+};
+
+static int
+int64set_update_impl(PyInt64SetObject *self, PyObject *values)
+{
+    PyInt64Buffer buffer;
+    if (PyInt64Buffer_Get(values, &buffer) < 0)
+    {
+        return -1;
+    }
+
+    int result = PyInt64Table_Reserve(&self->table, self->table.size + buffer.length);
+    for (Py_ssize_t index = 0; result == 0 && index < buffer.length; ++index)
+    {
+        int inserted;
+        if (PyInt64Table_Insert(&self->table, buffer.items[index], &inserted) < 0)
+        {
+            result = -1;
+        }
+    }
+
+    PyInt64Buffer_Release(&buffer);
+    return result;
+}
+
+static PyObject *
+int64set_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    PyObject* initializer = NULL;
+
+    if (kwds && PyDict_GET_SIZE(kwds) != 0)
+    {
+        PyErr_SetString(PyExc_TypeError, "Int64Set() takes no keyword arguments");
+        return NULL;
+    }
+
+    if (!PyArg_UnpackTuple(args, "Int64Set", 0, 1, &initializer))
+    {
+        return NULL;
+    }
+
+    PyInt64SetObject* self = (PyInt64SetObject*)type->tp_alloc(type, 0);
+    if (!self)
+    {
+        return NULL;
+    }
+
+    PyInt64Table_Init(&self->table, 0);
+
+    if (initializer && int64set_update_impl(self, initializer) < 0)
+    {
+        Py_DECREF(self);
+        return NULL;
+    }
+
+    return (PyObject*)self;
+}
+
+static void
+int64set_dealloc(PyInt64SetObject *self)
+{
+    PyTypeObject* type = Py_TYPE(self);
+    PyInt64Table_Free(&self->table);
+    type->tp_free((PyObject*)self);
+    Py_DECREF(type);
+}
+
+static PyObject *
+int64set_repr(PyInt64SetObject *self)
+{
+    if (self->table.size == 0)
+    {
+        return PyUnicode_FromFormat("%s()", _PyType_Name(Py_TYPE(self)));
+    }
+
+    PyObject* keys = int64set_toarray(self, NULL);
+    if (!keys)
+    {
+        return NULL;
+    }
+
+    PyObject* list = PySequence_List(keys);
+    Py_DECREF(keys);
+    if (!list)
+    {
+        return NULL;
+    }
+
+    PyObject* result = PyUnicode_FromFormat("%s(%R)", _PyType_Name(Py_TYPE(self)), list);
+    Py_DECREF(list);
+    return result;
+}
+
+static Py_ssize_t
+int64set_length(PyInt64SetObject *self)
+{
+    return self->table.size;
+}
+
+static int
+int64set_contains(PyInt64SetObject *self, PyObject *key_obj)
+{
+    int64_t key;
+    const int found = PyInt64Table_LookupKey(key_obj, &key);
+    if (found <= 0)
+    {
+        return found;
+    }
+
+    return PyInt64Table_Lookup(&self->table, key) >= 0;
+}
+
+static PyObject *
+int64set_iter(PyInt64SetObject *self)
+{
+    // Iterate a snapshot of the keys, so the set may change meanwhile.
+    PyObject* keys = int64set_toarray(self, NULL);
+    if (!keys)
+    {
+        return NULL;
+    }
+
+    PyObject* iterator = PyObject_GetIter(keys);
+    Py_DECREF(keys);
+    return iterator;
+}
+
+static PyObject *
+int64set_add(PyInt64SetObject *self, PyObject *key_obj)
+{
+    const int64_t key = PyInt64_AsInt64(key_obj);
+    if (key == -1 && PyErr_Occurred())
+    {
+        return NULL;
+    }
+
+    int inserted;
+    if (PyInt64Table_Insert(&self->table, key, &inserted) < 0)
+    {
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+// 1 if removed, 0 if absent, -1 on error.
+static int
+int64set_discard_impl(PyInt64SetObject *self, PyObject *key_obj)
+{
+    int64_t key;
+    const int found = PyInt64Table_LookupKey(key_obj, &key);
+    if (found <= 0)
+    {
+        return found;
+    }
+
+    const Py_ssize_t slot = PyInt64Table_Lookup(&self->table, key);
+    if (slot < 0)
+    {
+        return 0;
+    }
+
+    PyInt64Table_DeleteSlot(&self->table, slot);
+    return 1;
+}
+
+static PyObject *
+int64set_discard(PyInt64SetObject *self, PyObject *key)
+{
+    if (int64set_discard_impl(self, key) < 0)
+    {
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+int64set_remove(PyInt64SetObject *self, PyObject *key)
+{
+    const int removed = int64set_discard_impl(self, key);
+    if (removed < 0)
+    {
+        return NULL;
+    }
+
+    if (!removed)
+    {
+        PyErr_SetObject(PyExc_KeyError, key);
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+int64set_pop(PyInt64SetObject *self, PyObject *unused)
+{
+    PyInt64State* state = PyInt64State_OfType(Py_TYPE(self));
+    PyInt64Table* table = &self->table;
+    if (table->size == 0)
+    {
+        PyErr_SetString(PyExc_KeyError, "pop from an empty Int64Set");
+        return NULL;
+    }
+
+    for (Py_ssize_t slot = 0; slot < table->capacity; ++slot)
+    {
+        if (PyInt64Table_SLOT_USED(table, slot))
+        {
+            const int64_t key = table->keys[slot];
+            PyInt64Table_DeleteSlot(table, slot);
+            return PyInt64_FromInt64Ex(state, key);
+        }
+    }
+
+    Py_UNREACHABLE();
+}
+
+static PyObject *
+int64set_clear(PyInt64SetObject *self, PyObject *unused)
+{
+    PyInt64Table_Free(&self->table);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+int64set_reserve(PyInt64SetObject *self, PyObject *arg)
+{
+    const Py_ssize_t n = PyNumber_AsSsize_t(arg, PyExc_OverflowError);
+    if (n == -1 && PyErr_Occurred())
+    {
+        return NULL;
+    }
+
+    if (n < 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "reserve() argument must not be negative");
+        return NULL;
+    }
+
+    if (PyInt64Table_Reserve(&self->table, n) < 0)
+    {
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+int64set_update(PyInt64SetObject *self, PyObject *values)
+{
+    if (int64set_update_impl(self, values) < 0)
+    {
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+int64set_contains_many(PyInt64SetObject *self, PyObject *values)
+{
+    PyInt64State* state = PyInt64State_OfType(Py_TYPE(self));
+    PyInt64Buffer buffer;
+    if (PyInt64Buffer_Get(values, &buffer) < 0)
+    {
+        return NULL;
+    }
+
+    PyObject* result = PyInt64Array_NewEx(state, buffer.length);
+    if (result)
+    {
+        int64_t* out = ((PyInt64ArrayObject*)result)->ob_item;
+        for (Py_ssize_t index = 0; index < buffer.length; ++index)
+        {
+            out[index] = PyInt64Table_Lookup(&self->table, buffer.items[index]) >= 0;
+        }
+    }
+
+    PyInt64Buffer_Release(&buffer);
+    return result;
+}
+
+static PyObject *
+int64set_toarray(PyInt64SetObject *self, PyObject *unused)
+{
+    PyInt64State* state = PyInt64State_OfType(Py_TYPE(self));
+    const PyInt64Table* table = &self->table;
+    PyObject* result = PyInt64Array_NewEx(state, table->size);
+    if (!result)
+    {
+        return NULL;
+    }
+
+    int64_t* out = ((PyInt64ArrayObject*)result)->ob_item;
+    for (Py_ssize_t slot = 0; slot < table->capacity; ++slot)
+    {
+        if (PyInt64Table_SLOT_USED(table, slot))
+        {
+            *out++ = table->keys[slot];
+        }
+    }
+
+    return result;
+}
+
+/*
+ * Set algebra and comparisons take another Int64Set, a set or a frozenset
+ * on either side, and return plain Int64Sets like set does for subclasses.
+ */
+static PyInt64SetObject *
+int64set_alloc(PyTypeObject *owner)
+{
+    const PyInt64State* state = PyInt64State_OfType(owner);
+    if (!state || !state->set_type)
+    {
+        PyErr_SetString(PyExc_RuntimeError, "pyint64 is not initialized in this interpreter");
+        return NULL;
+    }
+
+    PyTypeObject* type = state->set_type;
+    PyInt64SetObject* self = (PyInt64SetObject*)type->tp_alloc(type, 0);
+    if (self)
+    {
+        PyInt64Table_Init(&self->table, 0);
+    }
+
+    return self;
+}
+
+static int
+int64set_insert_all(PyInt64Table *table, const PyInt64Table *from)
+{
+    if (PyInt64Table_Reserve(table, table->size + from->size) < 0)
+    {
+        return -1;
+    }
+
+    for (Py_ssize_t slot = 0; slot < from->capacity; ++slot)
+    {
+        int inserted;
+        if (PyInt64Table_SLOT_USED(from, slot)
+            && PyInt64Table_Insert(table, from->keys[slot], &inserted) < 0)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+// Keys of an operand, a table of its own for a set or frozenset.
+typedef struct
+{
+    const PyInt64Table* table;
+    PyInt64SetObject* temp;
+    Py_ssize_t foreign;     // elements left out, that can be no int64 key
+} int64set_operand;
+
+/*
+ * Set up the keys of obj: 1 on success, 0 if obj is no set type, -1 on
+ * error.  With skip_foreign, elements that cannot equal an int64 key are
+ * only counted, otherwise they raise like add() does.  A set or frozenset
+ * is copied into an Int64Set of the module of owner.
+ */
+static int
+int64set_operand_get(PyTypeObject *owner, PyObject *obj, int skip_foreign,
+                     int64set_operand *operand)
+{
+    operand->temp = NULL;
+    operand->foreign = 0;
+
+    if (PyInt64Set_Check(obj))
+    {
+        operand->table = &((PyInt64SetObject*)obj)->table;
+        return 1;
+    }
+
+    if (!PyAnySet_Check(obj))
+    {
+        return 0;
+    }
+
+    PyInt64SetObject* temp = int64set_alloc(owner);
+    if (!temp || PyInt64Table_Reserve(&temp->table, PySet_GET_SIZE(obj)) < 0)
+    {
+        Py_XDECREF(temp);
+        return -1;
+    }
+
+    PyObject* iterator = PyObject_GetIter(obj);
+    PyObject* item;
+    while (iterator && (item = PyIter_Next(iterator)))
+    {
+        int64_t key;
+        int found = PyInt64Table_LookupKey(item, &key);
+        if (found == 0 && !skip_foreign)
+        {
+            // Raise the error add() would.
+            key = PyInt64_AsInt64(item);
+            found = (key == -1 && PyErr_Occurred()) ? -1 : 1;
+        }
+
+        int inserted;
+        Py_DECREF(item);
+        if (found < 0 || (found && PyInt64Table_Insert(&temp->table, key, &inserted) < 0))
+        {
+            break;
+        }
+
+        operand->foreign += !found;
+    }
+
+    Py_XDECREF(iterator);
+    if (PyErr_Occurred())
+    {
+        Py_DECREF(temp);
+        return -1;
+    }
+
+    operand->table = &temp->table;
+    operand->temp = temp;
+    return 1;
+}
+
+typedef enum
+{
+    INT64SET_OR,
+    INT64SET_AND,
+    INT64SET_SUB,
+    INT64SET_XOR,
+} int64set_algebra_op;
+
+// Keys of a that are (keep = 1) or are not (keep = 0) in b go to table.
+static int
+int64set_filter(PyInt64Table *table, const PyInt64Table *a, const PyInt64Table *b, int keep)
+{
+    for (Py_ssize_t slot = 0; slot < a->capacity; ++slot)
+    {
+        int inserted;
+        if (PyInt64Table_SLOT_USED(a, slot)
+            && (PyInt64Table_Lookup(b, a->keys[slot]) >= 0) == keep
+            && PyInt64Table_Insert(table, a->keys[slot], &inserted) < 0)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static PyObject *
+int64set_algebra(PyObject *left, PyObject *right, int64set_algebra_op op)
+{
+    // Only the keys of both (and of the left for -) can make it into &, -.
+    PyTypeObject* owner = Py_TYPE(PyInt64Set_Check(left) ? left : right);
+    int64set_operand a;
+    int64set_operand b;
+    const int found = int64set_operand_get(owner, left, op == INT64SET_AND, &a);
+    if (found <= 0)
+    {
+        return found < 0 ? NULL : Py_NewRef(Py_NotImplemented);
+    }
+
+    const int found_right =
+        int64set_operand_get(owner, right, op == INT64SET_AND || op == INT64SET_SUB, &b);
+    if (found_right <= 0)
+    {
+        Py_XDECREF(a.temp);
+        return found_right < 0 ? NULL : Py_NewRef(Py_NotImplemented);
+    }
+
+    PyInt64SetObject* result = int64set_alloc(owner);
+    int status = result ? 0 : -1;
+    if (status == 0)
+    {
+        PyInt64Table* table = &result->table;
+        switch (op)
+        {
+        case INT64SET_OR:
+            status = int64set_insert_all(table, a.table) < 0
+                || int64set_insert_all(table, b.table) < 0 ? -1 : 0;
+            break;
+        case INT64SET_AND:
+            // Probe the larger table with the keys of the smaller.
+            status = a.table->size <= b.table->size ?
+                int64set_filter(table, a.table, b.table, 1) :
+                int64set_filter(table, b.table, a.table, 1);
+            break;
+        case INT64SET_SUB:
+            status = int64set_filter(table, a.table, b.table, 0);
+            break;
+        default:
+            status = int64set_filter(table, a.table, b.table, 0) < 0
+                || int64set_filter(table, b.table, a.table, 0) < 0 ? -1 : 0;
+            break;
+        }
+    }
+
+    Py_XDECREF(a.temp);
+    Py_XDECREF(b.temp);
+    if (status < 0)
+    {
+        Py_XDECREF(result);
+        return NULL;
+    }
+
+    return (PyObject*)result;
+}
+
+static PyObject *
+int64set_or(PyObject *left, PyObject *right)
+{
+    return int64set_algebra(left, right, INT64SET_OR);
+}
+
+static PyObject *
+int64set_and(PyObject *left, PyObject *right)
+{
+    return int64set_algebra(left, right, INT64SET_AND);
+}
+
+static PyObject *
+int64set_sub(PyObject *left, PyObject *right)
+{
+    return int64set_algebra(left, right, INT64SET_SUB);
+}
+
+static PyObject *
+int64set_xor(PyObject *left, PyObject *right)
+{
+    return int64set_algebra(left, right, INT64SET_XOR);
+}
+
+// Replace the keys of self with those of a new set from int64set_algebra.
+static PyObject *
+int64set_inplace_swap(PyInt64SetObject *self, PyObject *result)
+{
+    if (!result || result == Py_NotImplemented)
+    {
+        return result;
+    }
+
+    PyInt64Table table = self->table;
+    self->table = ((PyInt64SetObject*)result)->table;
+    ((PyInt64SetObject*)result)->table = table;
+    Py_DECREF(result);
+    return Py_NewRef(self);
+}
+
+static PyObject *
+int64set_inplace_or(PyInt64SetObject *self, PyObject *other)
+{
+    int64set_operand b;
+    const int found = int64set_operand_get(Py_TYPE(self), other, 0, &b);
+    if (found <= 0)
+    {
+        return found < 0 ? NULL : Py_NewRef(Py_NotImplemented);
+    }
+
+    // Inserting a table into itself could rehash it under the loop.
+    const int status = b.table == &self->table ? 0 : int64set_insert_all(&self->table, b.table);
+    Py_XDECREF(b.temp);
+    return status < 0 ? NULL : Py_NewRef(self);
+}
+
+static PyObject *
+int64set_inplace_and(PyInt64SetObject *self, PyObject *other)
+{
+    return int64set_inplace_swap(self, int64set_algebra((PyObject*)self, other, INT64SET_AND));
+}
+
+static PyObject *
+int64set_inplace_sub(PyInt64SetObject *self, PyObject *other)
+{
+    int64set_operand b;
+    const int found = int64set_operand_get(Py_TYPE(self), other, 1, &b);
+    if (found <= 0)
+    {
+        return found < 0 ? NULL : Py_NewRef(Py_NotImplemented);
+    }
+
+    if (b.table == &self->table)
+    {
+        PyInt64Table_Free(&self->table);
+        return Py_NewRef(self);
+    }
+
+    for (Py_ssize_t slot = 0; slot < b.table->capacity; ++slot)
+    {
+        const Py_ssize_t found_slot = PyInt64Table_SLOT_USED(b.table, slot) ?
+            PyInt64Table_Lookup(&self->table, b.table->keys[slot]) : -1;
+        if (found_slot >= 0)
+        {
+            PyInt64Table_DeleteSlot(&self->table, found_slot);
+        }
+    }
+
+    Py_XDECREF(b.temp);
+    return Py_NewRef(self);
+}
+
+static PyObject *
+int64set_inplace_xor(PyInt64SetObject *self, PyObject *other)
+{
+    return int64set_inplace_swap(self, int64set_algebra((PyObject*)self, other, INT64SET_XOR));
+}
+
+// Whether every key of a is in b.
+static int
+int64set_issubset(const PyInt64Table *a, const PyInt64Table *b)
+{
+    if (a->size > b->size)
+    {
+        return 0;
+    }
+
+    for (Py_ssize_t slot = 0; slot < a->capacity; ++slot)
+    {
+        if (PyInt64Table_SLOT_USED(a, slot) && PyInt64Table_Lookup(b, a->keys[slot]) < 0)
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static PyObject *
+int64set_richcompare(PyInt64SetObject *self, PyObject *other, int op)
+{
+    int64set_operand b;
+    const int found = int64set_operand_get(Py_TYPE(self), other, 1, &b);
+    if (found <= 0)
+    {
+        return found < 0 ? NULL : Py_NewRef(Py_NotImplemented);
+    }
+
+    // Elements of other that are no int64 are in other only.
+    const PyInt64Table* a = &self->table;
+    const Py_ssize_t a_size = a->size;
+    const Py_ssize_t b_size = b.table->size + b.foreign;
+    int result;
+
+    switch (op)
+    {
+    case Py_EQ:
+    case Py_NE:
+        result = (a_size == b_size && int64set_issubset(a, b.table)) == (op == Py_EQ);
+        break;
+    case Py_LE:
+        result = int64set_issubset(a, b.table);
+        break;
+    case Py_LT:
+        result = a_size < b_size && int64set_issubset(a, b.table);
+        break;
+    case Py_GE:
+        result = b.foreign == 0 && int64set_issubset(b.table, a);
+        break;
+    default:
+        result = a_size > b_size && b.foreign == 0 && int64set_issubset(b.table, a);
+        break;
+    }
+
+    Py_XDECREF(b.temp);
+    return PyBool_FromLong(result);
+}
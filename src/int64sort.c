@@ -0,0 +1,570 @@
+#include <string.h>
+
+#include "pyint64obj.h"
+#include "int64arrayobj.h"
+#include "int64pool.h"
+#include "int64sort.h"
+
+static PyObject *
+int64sort_sort(PyObject *module, PyObject *values);
+
+static PyObject *
+int64sort_argsort(PyObject *module, PyObject *values);
+
+static
+PyMethodDef int64sort_methods[] =
+{
+    {
+        "sort", (PyCFunction)int64sort_sort, METH_O,
+        "sort(values)\n"
+        "Sort a writable int64 buffer (an Int64Array, array('q'), ...) in\n"
+        "place with a radix sort on the raw values. Input made of a few\n"
+        "ascending or descending runs is merged instead."
+    },
+    {
+        "argsort", (PyCFunction)int64sort_argsort, METH_O,
+        "argsort(values)\n"
+        "Return an Int64Array of the indices that sort values (an int64\n"
+        "buffer or any iterable of integers). The sort is stable: equal\n"
+        "values keep their original order."
+    },
+    {NULL} /* sentinel */
+};
+
+int PyInt64Sort_Init(PyObject* module)
+{
+    return PyModule_AddFunctions(module, int64sort_methods);
+}
+
+// 11-bit digits, six passes cover 64 bits (the last digit has 9).
+#define INT64SORT_BITS 11
+#define INT64SORT_RADIX ((Py_ssize_t)1 << INT64SORT_BITS)
+#define INT64SORT_PASSES ((64 + INT64SORT_BITS - 1) / INT64SORT_BITS)
+
+// Inputs up to this length are insertion sorted.
+#define INT64SORT_SMALL 64
+
+// A parallel pass keeps one histogram per chunk.
+#define INT64SORT_MAX_CHUNKS 64
+
+// Inputs of at most this many natural runs are merged instead.
+#define INT64SORT_MAX_RUNS 16
+
+// Flags of the run detection.
+#define INT64SORT_NOT_ASCENDING 1
+#define INT64SORT_NOT_DESCENDING 2
+
+static inline Py_ssize_t
+int64sort_digit(int64_t key, int shift)
+{
+    // Flipping the sign bit orders negative keys before the others.
+    return (Py_ssize_t)(((((uint64_t)key) ^ ((uint64_t)1 << 63)) >> shift)
+                        & (INT64SORT_RADIX - 1));
+}
+
+typedef struct
+{
+    const int64_t* keys;
+    const int64_t* index;
+    int64_t* keys_out;
+    int64_t* index_out;
+    int shift;
+    Py_ssize_t* counts;     // INT64SORT_RADIX per chunk
+} int64sort_job;
+
+static int
+int64sort_runs_task(Py_ssize_t begin, Py_ssize_t end, Py_ssize_t chunk, void *arg)
+{
+    const int64_t* keys = ((const int64sort_job*)arg)->keys;
+    const int unsorted = INT64SORT_NOT_ASCENDING | INT64SORT_NOT_DESCENDING;
+    int flags = 0;
+
+    // Each chunk also compares its first key with the one before it.
+    for (Py_ssize_t index = Py_MAX(begin, 1); index < end && flags != unsorted; ++index)
+    {
+        flags |= keys[index - 1] > keys[index] ? INT64SORT_NOT_ASCENDING : 0;
+        flags |= keys[index - 1] <= keys[index] ? INT64SORT_NOT_DESCENDING : 0;
+    }
+
+    return flags;
+}
+
+static int
+int64sort_count_task(Py_ssize_t begin, Py_ssize_t end, Py_ssize_t chunk, void *arg)
+{
+    const int64sort_job* job = arg;
+    Py_ssize_t* counts = job->counts + chunk * INT64SORT_RADIX;
+
+    memset(counts, 0, INT64SORT_RADIX * sizeof(Py_ssize_t));
+    for (Py_ssize_t index = begin; index < end; ++index)
+    {
+        ++counts[int64sort_digit(job->keys[index], job->shift)];
+    }
+
+    return 0;
+}
+
+static int
+int64sort_scatter_task(Py_ssize_t begin, Py_ssize_t end, Py_ssize_t chunk, void *arg)
+{
+    const int64sort_job* job = arg;
+    Py_ssize_t* offsets = job->counts + chunk * INT64SORT_RADIX;
+
+    if (job->index)
+    {
+        for (Py_ssize_t index = begin; index < end; ++index)
+        {
+            const int64_t key = job->keys[index];
+            const Py_ssize_t position = offsets[int64sort_digit(key, job->shift)]++;
+            job->keys_out[position] = key;
+            job->index_out[position] = job->index[index];
+        }
+    }
+    else
+    {
+        for (Py_ssize_t index = begin; index < end; ++index)
+        {
+            const int64_t key = job->keys[index];
+            job->keys_out[offsets[int64sort_digit(key, job->shift)]++] = key;
+        }
+    }
+
+    return 0;
+}
+
+// Histograms of every digit in one read of the keys.
+static void
+int64sort_histograms(const int64_t *keys, Py_ssize_t n, Py_ssize_t *counts)
+{
+    memset(counts, 0, INT64SORT_PASSES * INT64SORT_RADIX * sizeof(Py_ssize_t));
+    for (Py_ssize_t index = 0; index < n; ++index)
+    {
+        for (int pass = 0; pass < INT64SORT_PASSES; ++pass)
+        {
+            ++counts[pass * INT64SORT_RADIX + int64sort_digit(keys[index], pass * INT64SORT_BITS)];
+        }
+    }
+}
+
+/*
+ * Turn per-chunk digit counts into scatter offsets. Within a digit the
+ * chunks keep their order, which makes every pass stable. Returns 0 when
+ * all keys share the digit, the pass would not move anything.
+ */
+static int
+int64sort_offsets(Py_ssize_t *counts, Py_ssize_t chunks, Py_ssize_t n)
+{
+    Py_ssize_t total = 0;
+    for (Py_ssize_t digit = 0; digit < INT64SORT_RADIX; ++digit)
+    {
+        const Py_ssize_t start = total;
+        for (Py_ssize_t chunk = 0; chunk < chunks; ++chunk)
+        {
+            Py_ssize_t* count = &counts[chunk * INT64SORT_RADIX + digit];
+            const Py_ssize_t size = *count;
+            *count = total;
+            total += size;
+        }
+
+        if (total - start == n)
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static void
+int64sort_insertion(int64_t *keys, int64_t *index, Py_ssize_t n)
+{
+    for (Py_ssize_t next = 1; next < n; ++next)
+    {
+        const int64_t key = keys[next];
+        const int64_t payload = index ? index[next] : 0;
+        Py_ssize_t position = next;
+
+        for (; position > 0 && keys[position - 1] > key; --position)
+        {
+            keys[position] = keys[position - 1];
+            if (index)
+            {
+                index[position] = index[position - 1];
+            }
+        }
+
+        keys[position] = key;
+        if (index)
+        {
+            index[position] = payload;
+        }
+    }
+}
+
+static void
+int64sort_reverse(int64_t *items, Py_ssize_t n)
+{
+    for (Py_ssize_t low = 0, high = n - 1; low < high; ++low, --high)
+    {
+        const int64_t item = items[low];
+        items[low] = items[high];
+        items[high] = item;
+    }
+}
+
+/*
+ * Split keys into maximal non-descending or strictly descending runs.
+ * Returns their number with the first position of every run in starts
+ * (and n after the last), or 0 past INT64SORT_MAX_RUNS runs, which random
+ * input reaches within a few dozen keys.
+ */
+static Py_ssize_t
+int64sort_find_runs(const int64_t *keys, Py_ssize_t n, Py_ssize_t *starts, int *descending)
+{
+    Py_ssize_t runs = 0;
+    for (Py_ssize_t begin = 0, end; begin < n; begin = end)
+    {
+        if (runs == INT64SORT_MAX_RUNS)
+        {
+            return 0;
+        }
+
+        end = begin + 1;
+        descending[runs] = end < n && keys[begin] > keys[end];
+        if (descending[runs])
+        {
+            for (; end < n && keys[end - 1] > keys[end]; ++end);
+        }
+        else
+        {
+            for (; end < n && keys[end - 1] <= keys[end]; ++end);
+        }
+
+        starts[runs++] = begin;
+    }
+
+    starts[runs] = n;
+    return runs;
+}
+
+// Merge the sorted ranges [begin, middle) and [middle, end), ties from the left.
+static void
+int64sort_merge(const int64_t *keys, const int64_t *index, int64_t *keys_out, int64_t *index_out,
+                Py_ssize_t begin, Py_ssize_t middle, Py_ssize_t end)
+{
+    Py_ssize_t left = begin;
+    Py_ssize_t right = middle;
+    Py_ssize_t out = begin;
+
+    while (left < middle && right < end)
+    {
+        const Py_ssize_t from = keys[right] < keys[left] ? right++ : left++;
+        keys_out[out] = keys[from];
+        if (index)
+        {
+            index_out[out] = index[from];
+        }
+
+        ++out;
+    }
+
+    // One side is used up, the rest of the other follows as is.
+    const Py_ssize_t from = left < middle ? left : right;
+    const Py_ssize_t count = end - out;
+    memcpy(&keys_out[out], &keys[from], count * sizeof(int64_t));
+    if (index)
+    {
+        memcpy(&index_out[out], &index[from], count * sizeof(int64_t));
+    }
+}
+
+/*
+ * Sort input made of a few runs: reverse the strictly descending ones (no
+ * ties, so that is stable), then merge neighbouring runs pairwise, between
+ * keys and the temporaries, until one is left.
+ */
+static void
+int64sort_merge_runs(int64_t *keys, int64_t *index, int64_t *keys_temp, int64_t *index_temp,
+                     Py_ssize_t *starts, const int *descending, Py_ssize_t runs)
+{
+    for (Py_ssize_t run = 0; run < runs; ++run)
+    {
+        if (descending[run])
+        {
+            int64sort_reverse(&keys[starts[run]], starts[run + 1] - starts[run]);
+            if (index)
+            {
+                int64sort_reverse(&index[starts[run]], starts[run + 1] - starts[run]);
+            }
+        }
+    }
+
+    const Py_ssize_t n = starts[runs];
+    int64_t* source = keys;
+    int64_t* target = keys_temp;
+    int64_t* index_source = index;
+    int64_t* index_target = index_temp;
+
+    while (runs > 1)
+    {
+        Py_ssize_t merged = 0;
+        for (Py_ssize_t run = 0; run < runs; run += 2, ++merged)
+        {
+            const Py_ssize_t begin = starts[run];
+            const Py_ssize_t end = starts[Py_MIN(run + 2, runs)];
+            const Py_ssize_t middle = run + 1 < runs ? starts[run + 1] : end;
+            int64sort_merge(source, index_source, target, index_target, begin, middle, end);
+            starts[merged] = begin;
+        }
+
+        starts[merged] = n;
+        runs = merged;
+
+        int64_t* swap = source;
+        source = target;
+        target = swap;
+        swap = index_source;
+        index_source = index_target;
+        index_target = swap;
+    }
+
+    if (source != keys)
+    {
+        memcpy(keys, source, n * sizeof(int64_t));
+        if (index)
+        {
+            memcpy(index, index_source, n * sizeof(int64_t));
+        }
+    }
+}
+
+int PyInt64Sort_Sort(int64_t *keys, int64_t *index, Py_ssize_t n)
+{
+    if (n <= INT64SORT_SMALL)
+    {
+        int64sort_insertion(keys, index, n);
+        return 0;
+    }
+
+    // Sorted input is left alone, strictly descending input (no ties, so
+    // reversing is stable) is reversed.
+    int64sort_job job = {.keys = keys};
+    const int runs = PyInt64Pool_For(n, PYINT64_POOL_GRAIN, int64sort_runs_task, &job);
+    if (!(runs & INT64SORT_NOT_ASCENDING))
+    {
+        return 0;
+    }
+
+    if (!(runs & INT64SORT_NOT_DESCENDING))
+    {
+        int64sort_reverse(keys, n);
+        if (index)
+        {
+            int64sort_reverse(index, n);
+        }
+
+        return 0;
+    }
+
+    // A few runs (appended sorted batches, say) take log2(runs) merge passes.
+    Py_ssize_t starts[INT64SORT_MAX_RUNS + 1];
+    int descending[INT64SORT_MAX_RUNS];
+    const Py_ssize_t runs_found = int64sort_find_runs(keys, n, starts, descending);
+
+    /*
+     * Serial: count every digit up front in one pass. Parallel: each pass
+     * counts its digit per chunk, then the chunks scatter concurrently.
+     */
+    const int parallel = PyInt64Pool_Parallel(n);
+    const Py_ssize_t grain = parallel
+        ? Py_MAX(PYINT64_POOL_GRAIN, PyInt64Pool_CHUNKS(n, INT64SORT_MAX_CHUNKS))
+        : n;
+    const Py_ssize_t chunks = PyInt64Pool_CHUNKS(n, grain);
+
+    int64_t* keys_temp = PyMem_Malloc(n * sizeof(int64_t));
+    int64_t* index_temp = index ? PyMem_Malloc(n * sizeof(int64_t)) : NULL;
+    Py_ssize_t* counts = runs_found ? NULL : PyMem_Malloc(
+        (parallel ? chunks : INT64SORT_PASSES) * INT64SORT_RADIX * sizeof(Py_ssize_t));
+    if (!keys_temp || (index && !index_temp) || (!runs_found && !counts))
+    {
+        PyMem_Free(keys_temp);
+        PyMem_Free(index_temp);
+        PyMem_Free(counts);
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    if (runs_found)
+    {
+        int64sort_merge_runs(keys, index, keys_temp, index_temp, starts, descending, runs_found);
+        PyMem_Free(keys_temp);
+        PyMem_Free(index_temp);
+        return 0;
+    }
+
+    if (!parallel)
+    {
+        int64sort_histograms(keys, n, counts);
+    }
+
+    int64_t* source = keys;
+    int64_t* target = keys_temp;
+    int64_t* index_source = index;
+    int64_t* index_target = index_temp;
+
+    for (int pass = 0; pass < INT64SORT_PASSES; ++pass)
+    {
+        job = (int64sort_job){
+            .keys = source,
+            .index = index_source,
+            .keys_out = target,
+            .index_out = index_target,
+            .shift = pass * INT64SORT_BITS,
+            .counts = parallel ? counts : counts + pass * INT64SORT_RADIX,
+        };
+
+        if (parallel)
+        {
+            PyInt64Pool_For(n, grain, int64sort_count_task, &job);
+        }
+
+        if (!int64sort_offsets(job.counts, chunks, n))
+        {
+            continue;
+        }
+
+        PyInt64Pool_For(n, grain, int64sort_scatter_task, &job);
+
+        int64_t* swap = source;
+        source = target;
+        target = swap;
+        swap = index_source;
+        index_source = index_target;
+        index_target = swap;
+    }
+
+    if (source != keys)
+    {
+        memcpy(keys, source, n * sizeof(int64_t));
+        if (index)
+        {
+            memcpy(index, index_source, n * sizeof(int64_t));
+        }
+    }
+
+    PyMem_Free(keys_temp);
+    PyMem_Free(index_temp);
+    PyMem_Free(counts);
+    return 0;
+}
+
+static PyObject *
+int64sort_sort(PyObject *module, PyObject *values)
+{
+    if (!PyObject_CheckBuffer(values))
+    {
+        PyErr_Format(PyExc_TypeError,
+            "sort() argument must be a writable int64 buffer, not '%.200s'",
+            Py_TYPE(values)->tp_name);
+        return NULL;
+    }
+
+    Py_buffer view;
+    if (PyObject_GetBuffer(values, &view, PyBUF_WRITABLE | PyBUF_FORMAT | PyBUF_STRIDES) < 0)
+    {
+        return NULL;
+    }
+
+    if (!PyInt64_IsInt64Format(&view))
+    {
+        PyErr_Format(PyExc_TypeError, "sort() requires an int64 buffer, not format '%s'",
+            view.format ? view.format : "B");
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+
+    const Py_ssize_t n = view.len / (Py_ssize_t)sizeof(int64_t);
+    int result = -1;
+
+    if (PyBuffer_IsContiguous(&view, 'C'))
+    {
+        result = PyInt64Sort_Sort(view.buf, NULL, n);
+    }
+    else if (view.ndim == 1)
+    {
+        // Strided, sort a packed copy and write it back.
+        int64_t* items = PyMem_Malloc(Py_MAX(n, 1) * sizeof(int64_t));
+        if (!items)
+        {
+            PyErr_NoMemory();
+        }
+        else
+        {
+            const char* source = view.buf;
+            for (Py_ssize_t index = 0; index < n; ++index, source += view.strides[0])
+            {
+                memcpy(&items[index], source, sizeof(int64_t));
+            }
+
+            result = PyInt64Sort_Sort(items, NULL, n);
+
+            char* target = view.buf;
+            for (Py_ssize_t index = 0; result == 0 && index < n; ++index, target += view.strides[0])
+            {
+                memcpy(target, &items[index], sizeof(int64_t));
+            }
+
+            PyMem_Free(items);
+        }
+    }
+    else
+    {
+        PyErr_SetString(PyExc_ValueError,
+            "sort() requires a one-dimensional or C-contiguous buffer");
+    }
+
+    PyBuffer_Release(&view);
+    if (result < 0)
+    {
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+int64sort_argsort(PyObject *module, PyObject *values)
+{
+    PyInt64State* state = PyModule_GetState(module);
+    PyInt64Buffer buffer;
+    if (PyInt64Buffer_Get(values, &buffer) < 0)
+    {
+        return NULL;
+    }
+
+    const Py_ssize_t n = buffer.length;
+    int64_t* keys = PyMem_Malloc(Py_MAX(n, 1) * sizeof(int64_t));
+    PyObject* result = keys ? PyInt64Array_NewEx(state, n) : PyErr_NoMemory();
+    if (result)
+    {
+        if (n > 0)
+        {
+            memcpy(keys, buffer.items, n * sizeof(int64_t));
+        }
+
+        int64_t* index = ((PyInt64ArrayObject*)result)->ob_item;
+        for (Py_ssize_t position = 0; position < n; ++position)
+        {
+            index[position] = position;
+        }
+
+        if (PyInt64Sort_Sort(keys, index, n) < 0)
+        {
+            Py_CLEAR(result);
+        }
+    }
+
+    PyMem_Free(keys);
+    PyInt64Buffer_Release(&buffer);
+    return result;
+}
@@ -0,0 +1,138 @@
+#include "int64state.h"
+
+PYINT64_THREAD_LOCAL PyInt64StateCache PyInt64State_Cache = {NULL, 0, NULL};
+
+PyInt64StateGeneration PyInt64State_Generation = 0;
+
+PyInt64StatePointer PyInt64State_Only = NULL;
+
+/*
+ * States of every interpreter that executed the module, newest first, so
+ * a reimported module shadows the one it replaced.  The list is only
+ * touched on import, on module teardown and on a cache miss; a spin lock
+ * keeps interpreters with a GIL of their own off each other.
+ */
+static PyInt64State *registry = NULL;
+
+#if PYINT64_STATE_ATOMICS
+static atomic_flag registry_lock = ATOMIC_FLAG_INIT;
+
+static void
+int64state_lock(void)
+{
+    while (atomic_flag_test_and_set_explicit(&registry_lock, memory_order_acquire))
+    {
+    }
+}
+
+static void
+int64state_unlock(void)
+{
+    atomic_flag_clear_explicit(&registry_lock, memory_order_release);
+}
+
+// Called under the lock after every change of the registry.
+static void
+int64state_bump(void)
+{
+    atomic_fetch_add_explicit(&PyInt64State_Generation, 1, memory_order_acq_rel);
+    atomic_store_explicit(&PyInt64State_Only,
+        registry && !registry->next ? registry : NULL, memory_order_release);
+}
+#else
+static void
+int64state_lock(void)
+{
+}
+
+static void
+int64state_unlock(void)
+{
+}
+
+static void
+int64state_bump(void)
+{
+    ++PyInt64State_Generation;
+    PyInt64State_Only = registry && !registry->next ? registry : NULL;
+}
+#endif
+
+void PyInt64State_Register(PyInt64State* state)
+{
+    state->interp = PyInterpreterState_Get();
+
+    int64state_lock();
+    state->next = registry;
+    registry = state;
+    int64state_bump();
+    int64state_unlock();
+}
+
+void PyInt64State_Unregister(PyInt64State* state)
+{
+    int64state_lock();
+    for (PyInt64State** link = &registry; *link; link = &(*link)->next)
+    {
+        if (*link == state)
+        {
+            *link = state->next;
+            state->next = NULL;
+            int64state_bump();
+            break;
+        }
+    }
+    int64state_unlock();
+}
+
+PyInt64State* PyInt64State_LookupType(PyTypeObject* type)
+{
+    // Heap types of the module carry it, Python subclasses inherit from one.
+    PyObject* mro = type->tp_mro;
+    const Py_ssize_t count = mro ? PyTuple_GET_SIZE(mro) : 0;
+    for (Py_ssize_t index = 0; index < count; ++index)
+    {
+        PyTypeObject* base = (PyTypeObject*)PyTuple_GET_ITEM(mro, index);
+        PyObject* module = (base->tp_flags & Py_TPFLAGS_HEAPTYPE)
+            ? ((PyHeapTypeObject*)base)->ht_module : NULL;
+        if (module && PyModule_GetDef(module) == &PyInt64_ModuleDef)
+        {
+            return PyModule_GetState(module);
+        }
+    }
+
+    return PyInt64_State();
+}
+
+PyInt64State* PyInt64State_Lookup(void)
+{
+    PyInterpreterState* interp = PyInterpreterState_Get();
+    PyInt64StateCache* cache = &PyInt64State_Cache;
+
+    int64state_lock();
+#if PYINT64_STATE_ATOMICS
+    // Read under the lock: a later registration invalidates this answer.
+    const uint64_t generation =
+        atomic_load_explicit(&PyInt64State_Generation, memory_order_relaxed);
+#else
+    const uint64_t generation = PyInt64State_Generation;
+#endif
+
+    PyInt64State* state = registry;
+    while (state && state->interp != interp)
+    {
+        state = state->next;
+    }
+    int64state_unlock();
+
+    if (!state)
+    {
+        // Not imported here, or torn down under objects still alive.
+        return NULL;
+    }
+
+    cache->interp = interp;
+    cache->generation = generation;
+    cache->state = state;
+    return state;
+}
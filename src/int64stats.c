@@ -0,0 +1,246 @@
+#include "int64stats.h"
+
+static PyObject *
+int64stats_stats(PyObject *module, PyObject *unused);
+
+static PyObject *
+int64stats_reset(PyObject *module, PyObject *unused);
+
+static
+PyMethodDef int64stats_methods[] =
+{
+    {
+        "stats", int64stats_stats, METH_NOARGS,
+        "stats()\n"
+        "Return a dict of hot-path event counts summed over all threads since\n"
+        "the last stats_reset(): allocs, frees, slow-path operand conversions\n"
+        "(convert_int, convert_float, convert_subclass), not_implemented,\n"
+        "overflows and errors. 'enabled' is False, and every count 0, unless\n"
+        "the module was built with PYINT64_STATS."
+    },
+    {
+        "stats_reset", int64stats_reset, METH_NOARGS,
+        "stats_reset()\n"
+        "Start the counts of stats() over from zero."
+    },
+    {NULL} /* sentinel */
+};
+
+static const char* const stat_names[PYINT64_STAT_COUNT] = {
+    [PYINT64_STAT_ALLOC] = "allocs",
+    [PYINT64_STAT_FREE] = "frees",
+    [PYINT64_STAT_CONVERT_INT] = "convert_int",
+    [PYINT64_STAT_CONVERT_FLOAT] = "convert_float",
+    [PYINT64_STAT_CONVERT_SUBCLASS] = "convert_subclass",
+    [PYINT64_STAT_NOT_IMPLEMENTED] = "not_implemented",
+    [PYINT64_STAT_OVERFLOW] = "overflows",
+    [PYINT64_STAT_ERROR] = "errors",
+};
+
+#if PYINT64_STATS
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+PYINT64_THREAD_LOCAL PyInt64StatsBlock *PyInt64Stats_Local = NULL;
+
+/*
+ * Every block ever allocated, newest first, and the counts of threads that
+ * exited.  Registration, thread exit and stats() take the lock; counting
+ * does not.  It is a spin lock like the state registry's, held for a walk
+ * over one block per live thread.
+ */
+static PyInt64StatsBlock *stats_blocks = NULL;
+static uint64_t stats_retired[PYINT64_STAT_COUNT];
+
+#if PYINT64_STATS_ATOMICS
+static atomic_flag stats_lock = ATOMIC_FLAG_INIT;
+
+static void
+int64stats_lock(void)
+{
+    while (atomic_flag_test_and_set_explicit(&stats_lock, memory_order_acquire))
+    {
+    }
+}
+
+static void
+int64stats_unlock(void)
+{
+    atomic_flag_clear_explicit(&stats_lock, memory_order_release);
+}
+#elif defined(_WIN32)
+static SRWLOCK stats_lock = SRWLOCK_INIT;
+
+static void
+int64stats_lock(void)
+{
+    AcquireSRWLockExclusive(&stats_lock);
+}
+
+static void
+int64stats_unlock(void)
+{
+    ReleaseSRWLockExclusive(&stats_lock);
+}
+#else
+static void
+int64stats_lock(void)
+{
+}
+
+static void
+int64stats_unlock(void)
+{
+}
+#endif
+
+// Thread exit callback, called with the block of the exiting thread.
+#ifdef _WIN32
+static DWORD stats_exit_key = FLS_OUT_OF_INDEXES;
+
+static void WINAPI
+int64stats_thread_exit(void *arg)
+#else
+static pthread_key_t stats_exit_key;
+static int stats_exit_key_created = 0;
+
+static void
+int64stats_thread_exit(void *arg)
+#endif
+{
+    PyInt64StatsBlock* block = arg;
+    if (!block)
+    {
+        return;
+    }
+
+    // The thread counts nothing more, so nothing races with the fold.
+    int64stats_lock();
+    for (int stat = 0; stat < PYINT64_STAT_COUNT; ++stat)
+    {
+        stats_retired[stat] += PYINT64_STAT_LOAD(block->counts[stat]);
+        PYINT64_STAT_STORE(block->counts[stat], 0);
+    }
+
+    block->in_use = 0;
+    int64stats_unlock();
+
+    if (PyInt64Stats_Local == block)
+    {
+        PyInt64Stats_Local = NULL;
+    }
+}
+
+// Under the lock: arrange for int64stats_thread_exit(block) when the thread exits.
+static void
+int64stats_watch_thread(PyInt64StatsBlock *block)
+{
+#ifdef _WIN32
+    if (stats_exit_key == FLS_OUT_OF_INDEXES)
+    {
+        stats_exit_key = FlsAlloc(int64stats_thread_exit);
+    }
+
+    if (stats_exit_key != FLS_OUT_OF_INDEXES)
+    {
+        FlsSetValue(stats_exit_key, block);
+    }
+#else
+    if (!stats_exit_key_created)
+    {
+        stats_exit_key_created = pthread_key_create(&stats_exit_key, int64stats_thread_exit) == 0;
+    }
+
+    if (stats_exit_key_created)
+    {
+        pthread_setspecific(stats_exit_key, block);
+    }
+#endif
+}
+
+PyInt64StatsBlock* PyInt64Stats_Register(void)
+{
+    int64stats_lock();
+
+    PyInt64StatsBlock* block = stats_blocks;
+    for (; block && block->in_use; block = block->next)
+    {
+    }
+
+    if (!block && (block = PyMem_RawCalloc(1, sizeof(PyInt64StatsBlock))))
+    {
+        block->next = stats_blocks;
+        stats_blocks = block;
+    }
+
+    if (block)
+    {
+        block->in_use = 1;
+        int64stats_watch_thread(block);
+    }
+
+    int64stats_unlock();
+
+    PyInt64Stats_Local = block;
+    return block;
+}
+
+#endif // PYINT64_STATS
+
+static void
+int64stats_totals(uint64_t *totals)
+{
+    memset(totals, 0, PYINT64_STAT_COUNT * sizeof(uint64_t));
+
+#if PYINT64_STATS
+    int64stats_lock();
+    memcpy(totals, stats_retired, PYINT64_STAT_COUNT * sizeof(uint64_t));
+    for (PyInt64StatsBlock* block = stats_blocks; block; block = block->next)
+    {
+        for (int stat = 0; stat < PYINT64_STAT_COUNT; ++stat)
+        {
+            totals[stat] += PYINT64_STAT_LOAD(block->counts[stat]);
+        }
+    }
+    int64stats_unlock();
+#endif
+}
+
+int PyInt64Stats_Init(PyObject* module)
+{
+    Py_BUILD_ASSERT(PYINT64_STAT_COUNT == PYINT64_STAT_SLOTS);
+    return PyModule_AddFunctions(module, int64stats_methods);
+}
+
+static PyObject *
+int64stats_stats(PyObject *module, PyObject *unused)
+{
+    PyInt64State* state = PyModule_GetState(module);
+    uint64_t totals[PYINT64_STAT_COUNT];
+    int64stats_totals(totals);
+
+    PyObject* result = Py_BuildValue("{s:O}", "enabled", PYINT64_STATS ? Py_True : Py_False);
+    for (int stat = 0; result && stat < PYINT64_STAT_COUNT; ++stat)
+    {
+        PyObject* count = PyLong_FromUnsignedLongLong(totals[stat] - state->stats_baseline[stat]);
+        if (!count || PyDict_SetItemString(result, stat_names[stat], count) < 0)
+        {
+            Py_CLEAR(result);
+        }
+        Py_XDECREF(count);
+    }
+
+    return result;
+}
+
+static PyObject *
+int64stats_reset(PyObject *module, PyObject *unused)
+{
+    PyInt64State* state = PyModule_GetState(module);
+    int64stats_totals(state->stats_baseline);
+    Py_RETURN_NONE;
+}
@@ -0,0 +1,304 @@
+#include <string.h>
+
+#include "pyint64obj.h"
+#include "int64table.h"
+#include "int64ops.h"
+
+#define TABLE_MIN_CAPACITY 8
+
+// Grow once more than 3/4 of the slots would be used.
+#define TABLE_USABLE(capacity) ((capacity) - (capacity) / 4)
+
+/*
+ * Keys are mixed with a per-process seed drawn from os.urandom() by the
+ * first import, so a fixed list of colliding ids cannot be prepared in
+ * advance.  It never changes afterwards: tables of every interpreter and
+ * of an earlier import of the module share it.
+ */
+static PYINT64_SETTING(uint64_t) table_seed = 0;
+
+static inline uint64_t
+int64table_hash(int64_t key)
+{
+    return (uint64_t)pyint64_op_mix64(key, PYINT64_SETTING_LOAD(table_seed));
+}
+
+static inline uint8_t
+int64table_tag(uint64_t hash)
+{
+    return (uint8_t)(0x80 | (hash >> 57));
+}
+
+int PyInt64Table_Seed(void)
+{
+    if (PYINT64_SETTING_LOAD(table_seed))
+    {
+        return 0;
+    }
+
+    PyObject* os = PyImport_ImportModule("os");
+    if (!os)
+    {
+        return -1;
+    }
+    PyObject* random = PyObject_CallMethod(os, "urandom", "n", (Py_ssize_t)sizeof(uint64_t));
+    Py_DECREF(os);
+    if (!random)
+    {
+        return -1;
+    }
+
+    uint64_t seed;
+    memcpy(&seed, PyBytes_AS_STRING(random), sizeof(seed));
+    Py_DECREF(random);
+    // Zero means unseeded.
+    seed |= 1;
+
+    // Another interpreter may have seeded meanwhile, its seed wins.
+#if PYINT64_SETTINGS_ATOMICS
+    uint64_t unseeded = 0;
+    atomic_compare_exchange_strong(&table_seed, &unseeded, seed);
+#else
+    if (!table_seed)
+    {
+        table_seed = seed;
+    }
+#endif
+    return 0;
+}
+
+void PyInt64Table_Init(PyInt64Table* table, int has_values)
+{
+    memset(table, 0, sizeof(*table));
+    table->has_values = has_values;
+}
+
+void PyInt64Table_Free(PyInt64Table* table)
+{
+    PyMem_Free(table->ctrl);
+    PyMem_Free(table->keys);
+    PyMem_Free(table->values);
+    table->ctrl = NULL;
+    table->keys = NULL;
+    table->values = NULL;
+    table->size = 0;
+    table->capacity = 0;
+}
+
+// Place a key known to be absent into a table with a free slot.
+static inline Py_ssize_t
+int64table_place(PyInt64Table* table, int64_t key)
+{
+    const size_t mask = (size_t)table->capacity - 1;
+    const uint64_t hash = int64table_hash(key);
+    size_t slot = (size_t)hash & mask;
+
+    while (table->ctrl[slot])
+    {
+        slot = (slot + 1) & mask;
+    }
+
+    table->ctrl[slot] = int64table_tag(hash);
+    table->keys[slot] = key;
+    return (Py_ssize_t)slot;
+}
+
+static int
+int64table_rehash(PyInt64Table* table, Py_ssize_t capacity)
+{
+    uint8_t* ctrl = PyMem_Calloc(capacity, sizeof(uint8_t));
+    int64_t* keys = PyMem_Malloc(capacity * sizeof(int64_t));
+    PyInt64TableValue* values = table->has_values
+        ? PyMem_Malloc(capacity * sizeof(PyInt64TableValue))
+        : NULL;
+
+    if (!ctrl || !keys || (table->has_values && !values))
+    {
+        PyMem_Free(ctrl);
+        PyMem_Free(keys);
+        PyMem_Free(values);
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    PyInt64Table old = *table;
+    table->ctrl = ctrl;
+    table->keys = keys;
+    table->values = values;
+    table->capacity = capacity;
+
+    for (Py_ssize_t index = 0; index < old.capacity; ++index)
+    {
+        if (old.ctrl[index])
+        {
+            const Py_ssize_t slot = int64table_place(table, old.keys[index]);
+            if (values)
+            {
+                values[slot] = old.values[index];
+            }
+        }
+    }
+
+    PyMem_Free(old.ctrl);
+    PyMem_Free(old.keys);
+    PyMem_Free(old.values);
+    return 0;
+}
+
+int PyInt64Table_Reserve(PyInt64Table* table, Py_ssize_t n)
+{
+    if (n <= TABLE_USABLE(table->capacity))
+    {
+        return 0;
+    }
+
+    Py_ssize_t capacity = TABLE_MIN_CAPACITY;
+    while (TABLE_USABLE(capacity) < n)
+    {
+        if (capacity > PY_SSIZE_T_MAX / 2 / (Py_ssize_t)(sizeof(int64_t) * 2 + 1))
+        {
+            PyErr_NoMemory();
+            return -1;
+        }
+
+        capacity *= 2;
+    }
+
+    return int64table_rehash(table, capacity);
+}
+
+Py_ssize_t PyInt64Table_Lookup(const PyInt64Table* table, int64_t key)
+{
+    if (table->size == 0)
+    {
+        return -1;
+    }
+
+    const size_t mask = (size_t)table->capacity - 1;
+    const uint64_t hash = int64table_hash(key);
+    const uint8_t tag = int64table_tag(hash);
+    size_t slot = (size_t)hash & mask;
+
+    for (;;)
+    {
+        const uint8_t ctrl = table->ctrl[slot];
+        if (ctrl == tag && table->keys[slot] == key)
+        {
+            return (Py_ssize_t)slot;
+        }
+
+        if (!ctrl)
+        {
+            return -1;
+        }
+
+        slot = (slot + 1) & mask;
+    }
+}
+
+Py_ssize_t PyInt64Table_Insert(PyInt64Table* table, int64_t key, int *inserted)
+{
+    Py_ssize_t slot = PyInt64Table_Lookup(table, key);
+    if (slot >= 0)
+    {
+        *inserted = 0;
+        return slot;
+    }
+
+    if (PyInt64Table_Reserve(table, table->size + 1) < 0)
+    {
+        return -1;
+    }
+
+    slot = int64table_place(table, key);
+    if (table->values)
+    {
+        memset(&table->values[slot], 0, sizeof(PyInt64TableValue));
+    }
+
+    ++table->size;
+    *inserted = 1;
+    return slot;
+}
+
+void PyInt64Table_DeleteSlot(PyInt64Table* table, Py_ssize_t slot)
+{
+    const size_t mask = (size_t)table->capacity - 1;
+    size_t hole = (size_t)slot;
+    size_t next = hole;
+
+    // Pull back every entry of the cluster whose home is not between the
+    // hole and its current slot, so no probe sequence crosses an empty slot.
+    for (;;)
+    {
+        next = (next + 1) & mask;
+        if (!table->ctrl[next])
+        {
+            break;
+        }
+
+        const size_t home = (size_t)int64table_hash(table->keys[next]) & mask;
+        const int stays = hole <= next
+            ? (hole < home && home <= next)
+            : (hole < home || home <= next);
+        if (stays)
+        {
+            continue;
+        }
+
+        table->ctrl[hole] = table->ctrl[next];
+        table->keys[hole] = table->keys[next];
+        if (table->values)
+        {
+            table->values[hole] = table->values[next];
+        }
+
+        hole = next;
+    }
+
+    table->ctrl[hole] = 0;
+    --table->size;
+}
+
+int PyInt64Table_LookupKey(PyObject *obj, int64_t *key)
+{
+    if (PyInt64_CheckExact(obj))
+    {
+        *key = PyInt64_GetValue(obj);
+        return 1;
+    }
+
+    // A float equal to an int64 finds it, like 1.0 finds 1 in a dict.
+    if (PyFloat_Check(obj))
+    {
+        const double value = PyFloat_AS_DOUBLE(obj);
+        if (value >= -0x1p63 && value < 0x1p63 && value == (double)(int64_t)value)
+        {
+            *key = (int64_t)value;
+            return 1;
+        }
+
+        return 0;
+    }
+
+    *key = PyInt64_AsInt64(obj);
+    if (*key == -1 && PyErr_Occurred())
+    {
+        if (PyErr_ExceptionMatches(PyExc_OverflowError))
+        {
+            PyErr_Clear();
+            return 0;
+        }
+
+        // Any other hashable object is just never equal to a key.
+        if (PyErr_ExceptionMatches(PyExc_TypeError))
+        {
+            PyErr_Clear();
+            return PyObject_Hash(obj) == -1 ? -1 : 0;
+        }
+
+        return -1;
+    }
+
+    return 1;
+}
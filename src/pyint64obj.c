@@ -1,6 +1,23 @@
 #include <stdbool.h>
 
 #include "pyint64obj.h"
+#include "int64arrayobj.h"
+#include "int64dictobj.h"
+#include "int64setobj.h"
+#include "int64table.h"
+#include "int64divisorobj.h"
+#include "int64column.h"
+#include "int64kernels.h"
+#include "int64format.h"
+#include "int64bulk.h"
+#include "int64serial.h"
+#include "int64codec.h"
+#include "int64scan.h"
+#include "int64pool.h"
+#include "int64sort.h"
+#include "int64stats.h"
+#include "int64ops.h"
+#include "int64modpow.h"
 #include "string_unitily.h"
 
 /* 
@@ -11,20 +28,129 @@
  *  stored in obj, and returned from the function invoking this macro.
  */
 #define CONVERT_TO_INT64(obj, int64_val)             \
-    if (PyInt64_Check(obj))                          \
-        int64_val = PyInt64_AsInt64(obj);            \
-    else if (convert_to_int64(&obj, &int64_val) < 0) \
+    if (pyint64_unpack(&obj, &int64_val) < 0)        \
         return obj;
 
-#define CHECK_BINOP(v,w)                                \
-    do {                                                \
-        if (!PyInt64_Check(v) || !PyInt64_Check(w))     \
-            Py_RETURN_NOTIMPLEMENTED;                   \
-    } while(0)
+/*
+ * Both operands of a binary slot.  (Pyint64, Pyint64) is settled with
+ * two exact type checks, (Pyint64, int) and (int, Pyint64) hit the exact
+ * checks at the top of pyint64_unpack, everything else falls through to
+ * the MRO walking checks and convert_to_int64.
+ */
+#define CONVERT_BINOP(left, right, a, b)                            \
+    if (PyInt64_CheckExact(left) && PyInt64_CheckExact(right))      \
+    {                                                               \
+        a = PyInt64_GetValue(left);                                 \
+        b = PyInt64_GetValue(right);                                \
+    }                                                               \
+    else                                                            \
+    {                                                               \
+        CONVERT_TO_INT64(left, a);                                  \
+        CONVERT_TO_INT64(right, b);                                 \
+    }
+
+/*
+ * Small value cache and freelist, both in the module state of each
+ * interpreter (int64state.h).
+ *
+ * Values in [-PYINT64_NSMALLNEGINTS, PYINT64_NSMALLPOSINTS) are served
+ * from a table of preallocated objects that the module keeps alive for
+ * its whole lifetime.  Everything else is recycled through a bounded
+ * singly linked freelist of PyInt64Object blocks, chained through ob_type
+ * the same way CPython's float freelist does it.  Blocks on the freelist
+ * hold no reference to the type.
+ */
+PYINT64_SETTING(PyInt64OverflowPolicy) PyInt64_OverflowPolicy = PYINT64_OVERFLOW_WRAP;
+
+static const char* const overflow_policy_names[PYINT64_OVERFLOW_POLICY_COUNT] = {
+    [PYINT64_OVERFLOW_WRAP] = "wrap",
+    [PYINT64_OVERFLOW_CHECKED] = "checked",
+    [PYINT64_OVERFLOW_SATURATE] = "saturate",
+    [PYINT64_OVERFLOW_PROMOTE] = "promote",
+};
+
+#define IS_SMALL_VALUE(value) \
+    (-PYINT64_NSMALLNEGINTS <= (value) && (value) < PYINT64_NSMALLPOSINTS)
 
+// The free-threaded build has no freelist and leaves the counters alone.
+#if PYINT64_FREELIST
+#define CACHE_STAT_INC(state, counter) (++(state)->cache_stats.counter)
+#else
+#define CACHE_STAT_INC(state, counter) ((void)0)
+#endif
 
 // Method.
 
+/*
+ * Read an exact int that fits in one or two digits straight from its
+ * representation.  Returns 0 if obj needs PyLong_AsLongLong instead.
+ */
+static inline int
+pyint64_read_compact_long(PyObject *obj, int64_t *val)
+{
+#if PY_VERSION_HEX >= 0x030C0000
+    if (PyUnstable_Long_IsCompact((PyLongObject*)obj))
+    {
+        *val = PyUnstable_Long_CompactValue((PyLongObject*)obj);
+        return 1;
+    }
+
+    return 0;
+#else
+    const digit* digits = ((PyLongObject*)obj)->ob_digit;
+
+    switch (Py_SIZE(obj))
+    {
+    case 0:
+        *val = 0;
+        return 1;
+    case 1:
+        *val = (int64_t)digits[0];
+        return 1;
+    case -1:
+        *val = -(int64_t)digits[0];
+        return 1;
+    case 2:
+        *val = ((int64_t)digits[1] << PyLong_SHIFT) | digits[0];
+        return 1;
+    case -2:
+        *val = -(((int64_t)digits[1] << PyLong_SHIFT) | digits[0]);
+        return 1;
+    default:
+        return 0;
+    }
+#endif
+}
+
+static int
+convert_to_int64(PyObject **v, int64_t *val);
+
+static inline int
+pyint64_unpack(PyObject **v, int64_t *val)
+{
+    PyObject* obj = *v;
+
+    if (PyInt64_CheckExact(obj))
+    {
+        *val = PyInt64_GetValue(obj);
+        return 0;
+    }
+
+    if (PyLong_CheckExact(obj) && pyint64_read_compact_long(obj, val))
+    {
+        return 0;
+    }
+
+    if (PyInt64_Check(obj))
+    {
+        PYINT64_STAT_INC(PYINT64_STAT_CONVERT_SUBCLASS);
+        *val = PyInt64_GetValue(obj);
+        return 0;
+    }
+
+    return convert_to_int64(v, val);
+}
+
 static int
 convert_to_int64(PyObject **v, int64_t *val)
 {
@@ -32,18 +158,22 @@ convert_to_int64(PyObject **v, int64_t *val)
 
     if (PyLong_Check(obj))
     {
+        PYINT64_STAT_INC(PYINT64_STAT_CONVERT_INT);
         *val = PyLong_AsLongLong(obj);
         if (*val == -1 && PyErr_Occurred())
         {
+            PYINT64_STAT_INC(PYINT64_STAT_ERROR);
             *v = NULL;
             return -1;
         }
     }
     else if (PyFloat_Check(obj))
     {
+        PYINT64_STAT_INC(PYINT64_STAT_CONVERT_FLOAT);
         const double d_value = PyFloat_AsDouble(obj);
         if (d_value == -1.0 && PyErr_Occurred())
         {
+            PYINT64_STAT_INC(PYINT64_STAT_ERROR);
             *v = NULL;
             return -1;
         }
@@ -52,6 +182,7 @@ convert_to_int64(PyObject **v, int64_t *val)
     }
     else
     {
+        PYINT64_STAT_INC(PYINT64_STAT_NOT_IMPLEMENTED);
         Py_INCREF(Py_NotImplemented);
         *v = Py_NotImplemented;
         return -1;
@@ -60,9 +191,6 @@ convert_to_int64(PyObject **v, int64_t *val)
     return 0;
 }
 
-static PyObject *
-pyint64_subtype_new(PyTypeObject *type, PyObject *x);
-
 // static PyObject*
 // pyint64_new_impl(PyTypeObject *type, PyObject *x);
 
@@ -74,10 +202,10 @@ static int
 pyint64__init__(PyInt64Object *self, PyObject *args, PyObject *kwds);
 
 static PyObject *
-pyint64_repr(PyInt64Object *v);
+pyint64_vectorcall(PyObject *type, PyObject *const *args, size_t nargsf, PyObject *kwnames);
 
-static void
-pyint64_dealloc(PyInt64Object *obj);
+static PyObject *
+pyint64_repr(PyInt64Object *v);
 
 PyObject*
 pyint64_richcompare(PyObject *self, PyObject *other, int op);
@@ -85,6 +213,39 @@ pyint64_richcompare(PyObject *self, PyObject *other, int op);
 static Py_hash_t
 pyint64_hash(PyInt64Object *v);
 
+static PyObject *
+pyint64_reduce(PyInt64Object *self, PyObject *unused);
+
+static PyObject *
+pyint64_reduce_ex(PyInt64Object *self, PyObject *protocol);
+
+static PyObject *
+pyint64_bit_length(PyInt64Object *self, PyObject *unused);
+
+static PyObject *
+pyint64_bit_count(PyInt64Object *self, PyObject *unused);
+
+static PyObject *
+pyint64_clz(PyInt64Object *self, PyObject *unused);
+
+static PyObject *
+pyint64_ctz(PyInt64Object *self, PyObject *unused);
+
+static PyObject *
+pyint64_byteswap(PyInt64Object *self, PyObject *unused);
+
+static PyObject *
+pyint64_rotl(PyInt64Object *self, PyObject *count);
+
+static PyObject *
+pyint64_rotr(PyInt64Object *self, PyObject *count);
+
+static PyObject *
+pyint64_to_bytes(PyInt64Object *self, PyObject *args, PyObject *kwds);
+
+static PyObject *
+pyint64_from_bytes(PyTypeObject *type, PyObject *args, PyObject *kwds);
+
 
 // START Number operations.
 static PyObject*
@@ -96,9 +257,6 @@ pyint64_sub(PyObject *left, PyObject *right);
 static PyObject*
 pyint64_mul(PyObject *left, PyObject *right);
 
-static PyObject*
-pyint64_div(PyObject *left, PyObject *right);
-
 static PyObject*
 pyint64_remainder(PyObject *left, PyObject *right);
 
@@ -155,70 +313,275 @@ pyint64__str__(PyObject *self);
 
 // END Number operations
 
-static PyModuleDef pyint64_module = 
+static int
+pyint64_small_values_init(PyInt64State *state);
+
+static void
+pyint64_small_values_clear(PyInt64State *state);
+
+static void
+pyint64_free_list_trim(PyInt64State *state, Py_ssize_t keep);
+
+static PyObject *
+pyint64_configure_cache(PyObject *module, PyObject *args, PyObject *kwds);
+
+static PyObject *
+pyint64_cache_info(PyObject *module, PyObject *unused);
+
+static PyObject *
+pyint64_simd_isa(PyObject *module, PyObject *unused);
+
+static PyObject *
+pyint64_set_simd_isa(PyObject *module, PyObject *name);
+
+static PyObject *
+pyint64_get_overflow_policy(PyObject *module, PyObject *unused);
+
+static PyObject *
+pyint64_set_overflow_policy(PyObject *module, PyObject *name);
+
+static
+PyMethodDef pyint64_module_methods[] =
+{
+    {
+        "configure_cache", (PyCFunction)(void(*)(void))pyint64_configure_cache,
+        METH_VARARGS | METH_KEYWORDS,
+        "configure_cache(*, freelist_size=None, small_ints=None)\n"
+        "Set the maximum freelist length (0 disables it) and enable or\n"
+        "disable the small value cache. Omitted settings are left as is."
+    },
+    {
+        "cache_info", pyint64_cache_info, METH_NOARGS,
+        "cache_info()\n"
+        "Return a dict with the cache settings and hit/miss counters."
+    },
+    {
+        "simd_isa", pyint64_simd_isa, METH_NOARGS,
+        "simd_isa()\n"
+        "Return a tuple (selected, best) of the instruction set names used\n"
+        "by the Int64Array kernels."
+    },
+    {
+        "set_simd_isa", pyint64_set_simd_isa, METH_O,
+        "set_simd_isa(name)\n"
+        "Force the Int64Array kernels onto 'scalar', 'sse4.2', 'avx2' or\n"
+        "'avx512'. Raises ValueError if the CPU does not support it."
+    },
+    {
+        "get_overflow_policy", pyint64_get_overflow_policy, METH_NOARGS,
+        "get_overflow_policy()\n"
+        "Return the name of the current overflow policy."
+    },
+    {
+        "set_overflow_policy", pyint64_set_overflow_policy, METH_O,
+        "set_overflow_policy(name)\n"
+        "Choose what Pyint64 and Int64Array arithmetic does on overflow:\n"
+        "'wrap' (two's complement, the default), 'checked' (raise\n"
+        "OverflowError), 'saturate' (clamp to the int64 range) or 'promote'\n"
+        "(return a Python int; Int64Array raises OverflowError instead)."
+    },
+    {NULL} /* sentinel */
+};
+
+static int
+pyint64_module_exec(PyObject *module);
+
+static int
+pyint64_module_traverse(PyObject *module, visitproc visit, void *arg);
+
+static int
+pyint64_module_clear(PyObject *module);
+
+static void
+pyint64_module_free(void *module);
+
+static
+PyModuleDef_Slot pyint64_module_slots[] =
+{
+    {Py_mod_exec, pyint64_module_exec},
+#if PY_VERSION_HEX >= 0x030C0000
+    {Py_mod_multiple_interpreters, Py_MOD_PER_INTERPRETER_GIL_SUPPORTED},
+#endif
+#if PY_VERSION_HEX >= 0x030D0000
+    // Running without the GIL is not supported yet: the containers, arrays
+    // and cache settings take no per-object locks (critical sections), so
+    // the free-threaded build keeps the GIL enabled for this module.
+    {Py_mod_gil, Py_MOD_GIL_USED},
+#endif
+    {0, NULL}
+};
+
+PyModuleDef PyInt64_ModuleDef =
 {
     PyModuleDef_HEAD_INIT,
     .m_name = "pyint64",
     .m_doc = "A int64 object module.",
-    .m_size = -1,
+    .m_size = sizeof(PyInt64State),
+    .m_methods = pyint64_module_methods,
+    .m_slots = pyint64_module_slots,
+    .m_traverse = pyint64_module_traverse,
+    .m_clear = pyint64_module_clear,
+    .m_free = pyint64_module_free,
 };
 
 PyMODINIT_FUNC
 PyInit_pyint64()
 {
-    PyObject *this_module;
-    if (PyType_Ready(&PyInt64_Type) < 0)
+    return PyModuleDef_Init(&PyInt64_ModuleDef);
+}
+
+// Create a heap type of the module, store it in *type and add it by name.
+static int
+pyint64_module_add_type(PyObject *module, PyType_Spec *spec, PyTypeObject **type)
+{
+    *type = (PyTypeObject*)PyType_FromModuleAndSpec(module, spec, NULL);
+    if (!*type)
     {
-        return NULL;
+        return -1;
     }
 
-    this_module = PyModule_Create(&pyint64_module);
-    if (this_module == NULL)
+    return PyModule_AddType(module, *type);
+}
+
+static int
+pyint64_module_exec(PyObject *module)
+{
+    PyInt64State* state = PyModule_GetState(module);
+    state->free_list_max = PYINT64_FREELIST ? PYINT64_MAXFREELIST : 0;
+
+    PyInt64Kernels_Init();
+
+    if (PyInt64Table_Seed() < 0)
     {
-        return NULL;
+        return -1;
     }
 
-    Py_INCREF(&pyint64_module);
+    if (pyint64_module_add_type(module, &PyInt64_Spec, &state->int64_type) < 0)
+    {
+        return -1;
+    }
 
-    if (PyModule_AddObject(this_module, "Pyint64", (PyObject*)&PyInt64_Type) < 0) 
+    // Py_tp_vectorcall only exists from 3.14 on, the field is there before.
+    state->int64_type->tp_vectorcall = pyint64_vectorcall;
+
+    if (pyint64_module_add_type(module, &PyInt64Array_Spec, &state->array_type) < 0
+        || pyint64_module_add_type(module, &PyInt64Dict_Spec, &state->dict_type) < 0
+        || pyint64_module_add_type(module, &PyInt64Counter_Spec, &state->counter_type) < 0
+        || pyint64_module_add_type(module, &PyInt64Set_Spec, &state->set_type) < 0
+        || pyint64_module_add_type(module, &PyInt64Divisor_Spec, &state->divisor_type) < 0
+        || pyint64_module_add_type(module, &PyInt64Column_Spec, &state->column_type) < 0
+        || pyint64_module_add_type(module, &PyInt64ColumnWriter_Spec, &state->column_writer_type) < 0)
     {
-        Py_DECREF(&PyInt64_Type);
-        Py_DECREF(this_module);
-        return NULL;
+        return -1;
     }
 
-    return this_module;
+    // Registered before anything below allocates a Pyint64.
+    PyInt64State_Register(state);
+
+    if (pyint64_small_values_init(state) < 0
+        || PyInt64Format_Init(module) < 0
+        || PyInt64Bulk_Init(module) < 0
+        || PyInt64Serial_Init(module) < 0
+        || PyInt64Codec_Init(module) < 0
+        || PyInt64Scan_Init(module) < 0
+        || PyInt64Pool_Init(module) < 0
+        || PyInt64Sort_Init(module) < 0
+        || PyInt64Stats_Init(module) < 0)
+    {
+        return -1;
+    }
+
+    return 0;
 }
 
-// Number methods.
-static 
-PyNumberMethods pyint64_as_number = {
-    .nb_add = pyint64_add,
-    .nb_subtract = pyint64_sub,
-    .nb_multiply = pyint64_mul,
-    .nb_remainder = pyint64_remainder,
-    .nb_divmod = pyint64_divmod,
-    .nb_power = (ternaryfunc)pyint64_power,
-    .nb_negative = (unaryfunc)pyint64_negative,
-    .nb_positive = pyint64_positive,
-    .nb_absolute = pyint64_absolute,
-    .nb_bool = (inquiry)pyint64_bool,
-    .nb_invert = pyint64_invert,
-    .nb_lshift = pyint64_lshift,
-    .nb_rshift = pyint64_rshift,
-    .nb_and = pyint64_and,
-    .nb_xor = pyint64_xor,
-    .nb_or = pyint64_or,
-    .nb_floor_divide = pyint64_floor_divide,
-    .nb_true_divide = pyint64_true_divide,
-    .nb_int = pyint64_int,
-    .nb_float = pyint64_float,
-};
+static int
+pyint64_module_traverse(PyObject *module, visitproc visit, void *arg)
+{
+    PyInt64State* state = PyModule_GetState(module);
+    Py_VISIT(state->int64_type);
+    Py_VISIT(state->array_type);
+    Py_VISIT(state->dict_type);
+    Py_VISIT(state->counter_type);
+    Py_VISIT(state->set_type);
+    Py_VISIT(state->divisor_type);
+    Py_VISIT(state->column_type);
+    Py_VISIT(state->column_writer_type);
+    Py_VISIT(state->text_reader_type);
+    Py_VISIT(state->parse_error);
+
+    // Small values are not tracked, the type references of those only the
+    // table holds close the cycle back to the module.
+    for (Py_ssize_t index = 0; index < (Py_ssize_t)Py_ARRAY_LENGTH(state->small_values); ++index)
+    {
+        PyObject* obj = state->small_values[index];
+        if (obj && Py_REFCNT(obj) == 1)
+        {
+            Py_VISIT(Py_TYPE(obj));
+        }
+    }
+
+    return 0;
+}
+
+static int
+pyint64_module_clear(PyObject *module)
+{
+    PyInt64State* state = PyModule_GetState(module);
+    PyInt64State_Unregister(state);
+    pyint64_small_values_clear(state);
+    Py_CLEAR(state->int64_type);
+    Py_CLEAR(state->array_type);
+    Py_CLEAR(state->dict_type);
+    Py_CLEAR(state->counter_type);
+    Py_CLEAR(state->set_type);
+    Py_CLEAR(state->divisor_type);
+    Py_CLEAR(state->column_type);
+    Py_CLEAR(state->column_writer_type);
+    Py_CLEAR(state->text_reader_type);
+    Py_CLEAR(state->parse_error);
+    return 0;
+}
+
+static void
+pyint64_module_free(void *module)
+{
+    PyInt64State* state = PyModule_GetState((PyObject*)module);
+    pyint64_module_clear((PyObject*)module);
+    pyint64_free_list_trim(state, 0);
+}
 
 static 
 PyMethodDef pyint64_methods[] = 
 {
-
+    {"__reduce__", (PyCFunction)pyint64_reduce, METH_NOARGS,
+        "Pickle support."},
+    {"__reduce_ex__", (PyCFunction)pyint64_reduce_ex, METH_O,
+        "Pickle support, without going through object.__reduce_ex__."},
+    {"bit_length", (PyCFunction)pyint64_bit_length, METH_NOARGS,
+        "Number of bits needed to represent abs(self), like int.bit_length()."},
+    {"bit_count", (PyCFunction)pyint64_bit_count, METH_NOARGS,
+        "Number of ones in abs(self), like int.bit_count()."},
+    {"clz", (PyCFunction)pyint64_clz, METH_NOARGS,
+        "Leading zero bits of the 64-bit two's complement value, 64 for 0."},
+    {"ctz", (PyCFunction)pyint64_ctz, METH_NOARGS,
+        "Trailing zero bits of the 64-bit two's complement value, 64 for 0."},
+    {"byteswap", (PyCFunction)pyint64_byteswap, METH_NOARGS,
+        "Return the value with the order of its 8 bytes reversed."},
+    {"rotl", (PyCFunction)pyint64_rotl, METH_O,
+        "rotl(n)\n"
+        "Rotate the 64-bit two's complement value left by n mod 64 bits."},
+    {"rotr", (PyCFunction)pyint64_rotr, METH_O,
+        "rotr(n)\n"
+        "Rotate the 64-bit two's complement value right by n mod 64 bits."},
+    {"to_bytes", (PyCFunction)(void(*)(void))pyint64_to_bytes,
+        METH_VARARGS | METH_KEYWORDS,
+        "to_bytes(length=1, byteorder='big', *, signed=False)\n"
+        "Return the value as length bytes, like int.to_bytes()."},
+    {"from_bytes", (PyCFunction)(void(*)(void))pyint64_from_bytes,
+        METH_VARARGS | METH_KEYWORDS | METH_CLASS,
+        "from_bytes(bytes, byteorder='big', *, signed=False)\n"
+        "Value of a bytes-like object, like int.from_bytes(). Raises\n"
+        "OverflowError if it does not fit int64."},
     {NULL} /* sentinel */
 };
 
@@ -229,24 +592,49 @@ PyGetSetDef pyint64_getset[] =
 };
 
 // Type object.
-PyTypeObject PyInt64_Type = 
-{
-    PyVarObject_HEAD_INIT(NULL, 0)
-    .tp_name = "pyint64.Pyint64",
-    .tp_basicsize = sizeof(PyInt64Object),
-    .tp_doc = "Python Int64 object",
-    .tp_dealloc = (destructor)pyint64_dealloc,
-    .tp_str = pyint64__str__,
-    .tp_repr = (reprfunc)pyint64_repr,
-    .tp_as_number = &pyint64_as_number,
-    .tp_hash = (hashfunc)pyint64_hash,
-    .tp_getattro = PyObject_GenericGetAttr,
-    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
-    .tp_richcompare = pyint64_richcompare,
-    .tp_methods = pyint64_methods,
-    .tp_getset = pyint64_getset,
-    .tp_init = (initproc)pyint64__init__,
-    .tp_new = PyType_GenericNew,
+static
+PyType_Slot pyint64_slots[] =
+{
+    {Py_tp_doc, "Python Int64 object"},
+    {Py_tp_dealloc, PyInt64_Dealloc},
+    {Py_tp_str, pyint64__str__},
+    {Py_tp_repr, pyint64_repr},
+    {Py_tp_hash, pyint64_hash},
+    {Py_tp_getattro, PyObject_GenericGetAttr},
+    {Py_tp_richcompare, pyint64_richcompare},
+    {Py_tp_methods, pyint64_methods},
+    {Py_tp_getset, pyint64_getset},
+    {Py_tp_init, pyint64__init__},
+    {Py_tp_new, PyType_GenericNew},
+    {Py_nb_add, pyint64_add},
+    {Py_nb_subtract, pyint64_sub},
+    {Py_nb_multiply, pyint64_mul},
+    {Py_nb_remainder, pyint64_remainder},
+    {Py_nb_divmod, pyint64_divmod},
+    {Py_nb_power, pyint64_power},
+    {Py_nb_negative, pyint64_negative},
+    {Py_nb_positive, pyint64_positive},
+    {Py_nb_absolute, pyint64_absolute},
+    {Py_nb_bool, pyint64_bool},
+    {Py_nb_invert, pyint64_invert},
+    {Py_nb_lshift, pyint64_lshift},
+    {Py_nb_rshift, pyint64_rshift},
+    {Py_nb_and, pyint64_and},
+    {Py_nb_xor, pyint64_xor},
+    {Py_nb_or, pyint64_or},
+    {Py_nb_floor_divide, pyint64_floor_divide},
+    {Py_nb_true_divide, pyint64_true_divide},
+    {Py_nb_int, pyint64_int},
+    {Py_nb_float, pyint64_float},
+    {0, NULL}
+};
+
+PyType_Spec PyInt64_Spec =
+{
+    .name = "pyint64.Pyint64",
+    .basicsize = sizeof(PyInt64Object),
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE | Py_TPFLAGS_BASETYPE,
+    .slots = pyint64_slots,
 };
 
 int64_t PyInt64_AsInt64(PyObject* object)
@@ -269,11 +657,6 @@ int64_t PyInt64_AsInt64(PyObject* object)
     }
 
     int64_t ret = PyLong_AsLongLong((PyObject*)value);
-    if (ret == -1 && PyErr_Occurred())
-    {
-        return -1;
-    }
-
     Py_DECREF(value);
     return ret;
 }
@@ -281,17 +664,240 @@ int64_t PyInt64_AsInt64(PyObject* object)
 PyObject*
 PyInt64_FromInt64(int64_t value)
 {
-    PyInt64Object* obj = PyObject_Malloc(sizeof(PyInt64Object));
-    if (!obj)
+    return PyInt64_FromInt64Ex(PyInt64_State(), value);
+}
+
+PyObject*
+PyInt64_FromInt64Ex(PyInt64State *state, int64_t value)
+{
+    PyInt64Object* obj;
+
+    // No module in this interpreter, or one torn down under live objects.
+    if (!state || !state->int64_type)
     {
-        return PyErr_NoMemory();
+        PyErr_SetString(PyExc_RuntimeError, "pyint64 is not initialized in this interpreter");
+        return NULL;
     }
 
-    PyObject_Init((PyObject*)obj, &PyInt64_Type);
+    if (state->small_values_enabled && IS_SMALL_VALUE(value))
+    {
+        CACHE_STAT_INC(state, small_hits);
+        return Py_NewRef(state->small_values[value + PYINT64_NSMALLNEGINTS]);
+    }
+
+    obj = (PyInt64Object*)state->free_list;
+    if (obj)
+    {
+        CACHE_STAT_INC(state, freelist_hits);
+        state->free_list = (PyObject*)Py_TYPE(obj);
+        --state->free_list_len;
+    }
+    else
+    {
+        CACHE_STAT_INC(state, freelist_misses);
+        obj = PyObject_Malloc(sizeof(PyInt64Object));
+        if (!obj)
+        {
+            return PyErr_NoMemory();
+        }
+    }
+
+    PYINT64_STAT_INC(PYINT64_STAT_ALLOC);
+    PyObject_Init((PyObject*)obj, state->int64_type);
     obj->ob_int64val = value;
     return (PyObject*)obj;
 }
 
+static int
+pyint64_small_values_init(PyInt64State *state)
+{
+    if (state->small_values_enabled)
+    {
+        return 0;
+    }
+
+    for (Py_ssize_t index = 0; index < (Py_ssize_t)Py_ARRAY_LENGTH(state->small_values); ++index)
+    {
+        PyInt64Object* obj = PyObject_Malloc(sizeof(PyInt64Object));
+        if (!obj)
+        {
+            state->small_values_enabled = true;
+            pyint64_small_values_clear(state);
+            PyErr_NoMemory();
+            return -1;
+        }
+
+        PyObject_Init((PyObject*)obj, state->int64_type);
+        obj->ob_int64val = (int64_t)index - PYINT64_NSMALLNEGINTS;
+        state->small_values[index] = (PyObject*)obj;
+    }
+
+    state->small_values_enabled = true;
+    return 0;
+}
+
+static void
+pyint64_small_values_clear(PyInt64State *state)
+{
+    // Objects still referenced elsewhere stay alive and are recycled
+    // through the freelist once their last reference goes away.
+    if (!state->small_values_enabled)
+    {
+        return;
+    }
+
+    state->small_values_enabled = false;
+    for (Py_ssize_t index = 0; index < (Py_ssize_t)Py_ARRAY_LENGTH(state->small_values); ++index)
+    {
+        Py_CLEAR(state->small_values[index]);
+    }
+}
+
+static void
+pyint64_free_list_trim(PyInt64State *state, Py_ssize_t keep)
+{
+    while (state->free_list_len > keep)
+    {
+        PyObject* obj = state->free_list;
+        state->free_list = (PyObject*)Py_TYPE(obj);
+        --state->free_list_len;
+        PyObject_Free(obj);
+    }
+}
+
+static PyObject *
+pyint64_configure_cache(PyObject *module, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"freelist_size", "small_ints", NULL};
+    PyInt64State* state = PyModule_GetState(module);
+    PyObject* freelist_size = Py_None;
+    int small_ints = -1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|$Op:configure_cache", kwlist,
+                                     &freelist_size, &small_ints))
+    {
+        return NULL;
+    }
+
+    if (!Py_IsNone(freelist_size))
+    {
+        const Py_ssize_t size = PyNumber_AsSsize_t(freelist_size, PyExc_OverflowError);
+        if (size == -1 && PyErr_Occurred())
+        {
+            return NULL;
+        }
+
+        if (size < 0)
+        {
+            PyErr_SetString(PyExc_ValueError, "freelist_size must be >= 0");
+            return NULL;
+        }
+
+        state->free_list_max = PYINT64_FREELIST ? size : 0;
+        pyint64_free_list_trim(state, state->free_list_max);
+    }
+
+    if (small_ints == 1)
+    {
+        if (pyint64_small_values_init(state) < 0)
+        {
+            return NULL;
+        }
+    }
+    else if (small_ints == 0)
+    {
+        pyint64_small_values_clear(state);
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+pyint64_cache_info(PyObject *module, PyObject *unused)
+{
+    const PyInt64State* state = PyModule_GetState(module);
+    return Py_BuildValue(
+        "{s:n,s:n,s:O,s:K,s:K,s:K,s:K,s:K}",
+        "freelist_size", state->free_list_max,
+        "freelist_len", state->free_list_len,
+        "small_ints", state->small_values_enabled ? Py_True : Py_False,
+        "small_hits", (unsigned long long)state->cache_stats.small_hits,
+        "freelist_hits", (unsigned long long)state->cache_stats.freelist_hits,
+        "freelist_misses", (unsigned long long)state->cache_stats.freelist_misses,
+        "freelist_returns", (unsigned long long)state->cache_stats.freelist_returns,
+        "freelist_overflows", (unsigned long long)state->cache_stats.freelist_overflows
+    );
+}
+
+static PyObject *
+pyint64_simd_isa(PyObject *module, PyObject *unused)
+{
+    return Py_BuildValue("(ss)",
+        PyInt64Kernels_IsaName(PyInt64Kernels_Current()),
+        PyInt64Kernels_IsaName(PyInt64Kernels_Detect()));
+}
+
+static PyObject *
+pyint64_set_simd_isa(PyObject *module, PyObject *name)
+{
+    if (!PyUnicode_Check(name))
+    {
+        PyErr_Format(PyExc_TypeError,
+            "The type must be str, not '%.200s'",
+            Py_TYPE(name)->tp_name);
+        return NULL;
+    }
+
+    for (int isa = 0; isa < PYINT64_ISA_COUNT; ++isa)
+    {
+        if (PyUnicode_CompareWithASCIIString(name, PyInt64Kernels_IsaName(isa)) == 0)
+        {
+            if (PyInt64Kernels_Select(isa) < 0)
+            {
+                PyErr_Format(PyExc_ValueError,
+                    "instruction set '%U' is not supported by this CPU", name);
+                return NULL;
+            }
+
+            Py_RETURN_NONE;
+        }
+    }
+
+    PyErr_Format(PyExc_ValueError, "unknown instruction set '%U'", name);
+    return NULL;
+}
+
+static PyObject *
+pyint64_get_overflow_policy(PyObject *module, PyObject *unused)
+{
+    const PyInt64OverflowPolicy policy = PYINT64_SETTING_LOAD(PyInt64_OverflowPolicy);
+    return PyUnicode_FromString(overflow_policy_names[policy]);
+}
+
+static PyObject *
+pyint64_set_overflow_policy(PyObject *module, PyObject *name)
+{
+    if (!PyUnicode_Check(name))
+    {
+        PyErr_Format(PyExc_TypeError,
+            "The type must be str, not '%.200s'",
+            Py_TYPE(name)->tp_name);
+        return NULL;
+    }
+
+    for (int policy = 0; policy < PYINT64_OVERFLOW_POLICY_COUNT; ++policy)
+    {
+        if (PyUnicode_CompareWithASCIIString(name, overflow_policy_names[policy]) == 0)
+        {
+            PYINT64_SETTING_STORE(PyInt64_OverflowPolicy, (PyInt64OverflowPolicy)policy);
+            Py_RETURN_NONE;
+        }
+    }
+
+    PyErr_Format(PyExc_ValueError, "unknown overflow policy '%U'", name);
+    return NULL;
+}
+
 PyObject* 
 PyInt64_FromPyInt64(PyObject* pyint64)
 {
@@ -307,91 +913,120 @@ PyInt64_FromPyInt64(PyObject* pyint64)
     return pyint64;
 }
 
-PyObject* PyInt64_FromString(PyObject* string)
+/*
+ * Parse an ASCII str of an optionally signed decimal integer natively.
+ * Other strs (non-ASCII digits) keep going through int's parser.
+ */
+static int
+pyint64_parse_str(PyObject *string, int64_t *value)
 {
-    if (!PyUnicode_Check(string))
+    if (!PyUnicode_IS_ASCII(string))
     {
-        PyErr_Format(PyExc_TypeError, 
-            "The type must be str, not '%.200s'",
-            Py_TYPE(string)->tp_name);
-        return NULL;
+        PyObject* py_int = PyLong_FromUnicodeObject(string, 10);
+        if (!py_int)
+        {
+            return -1;
+        }
+
+        *value = PyLong_AsLongLong(py_int);
+        Py_DECREF(py_int);
+        return (*value == -1 && PyErr_Occurred()) ? -1 : 0;
     }
 
-    // Call is str.digit
-    if (!Py_IsTrue(PyObject_CallMethod(string, "isdigit", NULL)))
+    const char* first = (const char*)PyUnicode_1BYTE_DATA(string);
+    const char* last = first + PyUnicode_GET_LENGTH(string);
+    const char* end;
+
+    switch (parseInt64(first, last, value, &end))
     {
-        PyErr_Format(PyExc_ValueError, 
-            "The str value must be digit, not '%.200S'",
-            string);
-        return NULL;
+    case PARSE_INT64_OK:
+        if (end == last)
+        {
+            return 0;
+        }
+        break;
+    case PARSE_INT64_OVERFLOW:
+        if (end == last)
+        {
+            PyErr_Format(PyExc_OverflowError,
+                "The str value is out of int64 range, '%.200S'",
+                string);
+            return -1;
+        }
+        break;
+    default:
+        break;
     }
 
-    PyObject* py_int = PyLong_FromUnicodeObject(string, 10);
-    if (!py_int)
+    PyErr_Format(PyExc_ValueError, 
+        "The str value must be digit, not '%.200S'",
+        string);
+    return -1;
+}
+
+PyObject* PyInt64_FromString(PyObject* string)
+{
+    if (!PyUnicode_Check(string))
     {
-        return PyErr_NoMemory();
+        PyErr_Format(PyExc_TypeError, 
+            "The type must be str, not '%.200s'",
+            Py_TYPE(string)->tp_name);
+        return NULL;
     }
 
-    int64_t value = PyLong_AsLongLong(py_int);
-    if (value == -1 && PyErr_Occurred())
+    int64_t value;
+    if (pyint64_parse_str(string, &value) < 0)
     {
-        Py_DECREF(py_int);
         return NULL;
     }
 
-    Py_DECREF(py_int);
     return PyInt64_FromInt64(value);
 }
 
+/*
+ * Convert the single constructor argument to a C int64.  Shared by the
+ * vectorcall fast path of the exact type and tp_init of subclasses.
+ */
 static int
-pyint64_parseUnicode(PyInt64Object *self, PyObject *arg)
-{
-    return 0;
-}
-
-static int
-pyint64__init__impl__(PyInt64Object *self, PyObject *arg)
+pyint64_value_from_arg(PyObject *arg, int64_t *value)
 {
     if (!arg)
     {
-        self->ob_int64val = 0;
+        *value = 0;
         return 0;
     }
 
-    if (PyUnicode_Check(arg))
+    if (PyInt64_Check(arg))
     {
-         if (!Py_IsTrue(PyObject_CallMethod(arg, "isdigit", NULL)))
-        {
-            PyErr_Format(PyExc_ValueError, 
-                "The str value must be digit, not '%.200S'",
-                    arg);
-            return -1;
-        }
+        *value = PyInt64_GetValue(arg);
+        return 0;
+    }
 
-        return pyint64_parseUnicode(self, arg);
+    if (PyUnicode_Check(arg))
+    {
+        return pyint64_parse_str(arg, value);
     }
 
     if (PyLong_Check(arg))
     {
-        const int64_t value = PyLong_AsLongLong(arg);
-        if (value == -1 && PyErr_Occurred())
+        *value = PyLong_AsLongLong(arg);
+        if (*value == -1 && PyErr_Occurred())
         {
             return -1;
         }
 
-        self->ob_int64val = value;
         return 0;
     }
 
     if (PyFloat_Check(arg))
     {
-        const double value = PyFloat_AsDouble(arg);
-        if (value == -1.0 && PyErr_Occurred())
+        const double d_value = PyFloat_AsDouble(arg);
+        if (d_value == -1.0 && PyErr_Occurred())
         {
             return -1;
         }
 
-        self->ob_int64val = (int64_t)value;
+        *value = (int64_t)d_value;
         return 0;
     }
 
@@ -399,6 +1034,34 @@ pyint64__init__impl__(PyInt64Object *self, PyObject *arg)
     return -1;
 }
 
+static int
+pyint64__init__impl__(PyInt64Object *self, PyObject *arg)
+{
+    // Shared small values must never change under their other owners.
+    const PyInt64State* state = PyInt64State_OfType(Py_TYPE(self));
+    if (!state)
+    {
+        PyErr_SetString(PyExc_RuntimeError, "pyint64 is not initialized in this interpreter");
+        return -1;
+    }
+
+    if (state->small_values_enabled && IS_SMALL_VALUE(self->ob_int64val)
+        && state->small_values[self->ob_int64val + PYINT64_NSMALLNEGINTS] == (PyObject*)self)
+    {
+        PyErr_SetString(PyExc_TypeError, "cannot re-initialize a cached Pyint64");
+        return -1;
+    }
+
+    int64_t value;
+    if (pyint64_value_from_arg(arg, &value) < 0)
+    {
+        return -1;
+    }
+
+    self->ob_int64val = value;
+    return 0;
+}
+
 static int
 pyint64__init__(PyInt64Object *self, PyObject *args, PyObject *kwds)
 {
@@ -422,10 +1085,73 @@ pyint64__init__(PyInt64Object *self, PyObject *args, PyObject *kwds)
     return pyint64__init__impl__(self, arg1);
 }
 
-static void
-pyint64_dealloc(PyInt64Object *obj)
+/*
+ * PEP 590 constructor for the exact type.  tp_vectorcall is not
+ * inherited, so subclasses keep going through tp_new and tp_init.
+ */
+static PyObject *
+pyint64_vectorcall(PyObject *type, PyObject *const *args, size_t nargsf, PyObject *kwnames)
 {
-    Py_TYPE(obj)->tp_free((PyObject*)obj);
+    const Py_ssize_t nargs = PyVectorcall_NARGS(nargsf);
+
+    if (kwnames && PyTuple_GET_SIZE(kwnames) != 0)
+    {
+        PyErr_SetString(PyExc_TypeError, "Pyint64() takes no keyword arguments");
+        return NULL;
+    }
+
+    if (nargs > 1)
+    {
+        PyErr_Format(PyExc_TypeError, 
+            "Pyint64() takes at most 1 arguments (%zd given)", 
+            nargs
+        );
+        return NULL;
+    }
+
+    PyObject* arg = nargs == 1 ? args[0] : NULL;
+
+    /*
+     * Even an exact Pyint64 argument gets a new object (or a cached small
+     * value): tp_init can still re-initialize the result, which must not
+     * change the argument under its other owners.
+     */
+    int64_t value;
+    if (pyint64_value_from_arg(arg, &value) < 0)
+    {
+        return NULL;
+    }
+
+    return PyInt64_FromInt64Ex(PyInt64State_OfType((PyTypeObject*)type), value);
+}
+
+void
+PyInt64_Dealloc(PyObject *obj)
+{
+    PyTypeObject* type = Py_TYPE(obj);
+    PYINT64_STAT_INC(PYINT64_STAT_FREE);
+
+    // Subclass instances may be larger and carry a dict, never recycle them.
+    // The state of the module that made the type lives as long as the type,
+    // it is out of reach once the garbage collector cleared the type.
+    PyInt64State* state = PyInt64_CheckExact(obj) ? PyInt64State_FromType(type) : NULL;
+    if (state)
+    {
+        if (state->free_list_len < state->free_list_max)
+        {
+            CACHE_STAT_INC(state, freelist_returns);
+            Py_SET_TYPE(obj, (PyTypeObject*)state->free_list);
+            state->free_list = obj;
+            ++state->free_list_len;
+            Py_DECREF(type);
+            return;
+        }
+
+        CACHE_STAT_INC(state, freelist_overflows);
+    }
+
+    type->tp_free(obj);
+    Py_DECREF(type);
 }
 
 static PyObject*
@@ -437,109 +1163,238 @@ pyint64_repr(PyInt64Object *self)
 static PyObject*
 pyint64__str__(PyObject* self)
 {
-    char buffer[21];
     const int64_t value = PyInt64_GetValue(self);
-    char* bufferEnd = buffer + 21;
-    char* next = signedToString(value, buffer);
 
-    PyObject* result = PyUnicode_FromStringAndSize(next, bufferEnd - next);
+    // Size the str up front and write the digits straight into it.
+    PyObject* result = PyUnicode_New(signedDigitCount(value), 127);
     if (!result)
     {
-        return PyErr_NoMemory();
+        return NULL;
     }
 
+    signedToChars(value, (char*)PyUnicode_1BYTE_DATA(result));
     return result;
 }
 
 
-/* Pyint64 Number Methods */
+/* Pyint64 Number Methods */
+
+/*
+ * State of the module whose Pyint64 type runs a slot: that of left if it
+ * is a Pyint64, else that of right, so results keep the type of their
+ * operands after the module was imported again.  Taken before
+ * CONVERT_BINOP, which replaces the operands on failure.
+ */
+static inline PyInt64State*
+pyint64_slot_state(PyObject *left, PyObject *right)
+{
+    PyInt64State* only = PyInt64State_Single();
+    if (only)
+    {
+        return only;
+    }
+
+    return PyInt64State_LookupType(Py_TYPE(!right || PyInt64_Check(left) ? left : right));
+}
+
+/*
+ * Slow path of a binary slot whose result did not fit in an int64,
+ * resolved by the current overflow policy.
+ */
+static PyObject*
+pyint64_binary_overflow(PyInt64State *state, PyInt64BinaryOp op, int64_t a, int64_t b,
+                        int64_t wrapped)
+{
+    PYINT64_STAT_INC(PYINT64_STAT_OVERFLOW);
+
+    switch (PYINT64_SETTING_LOAD(PyInt64_OverflowPolicy))
+    {
+    case PYINT64_OVERFLOW_CHECKED:
+        PYINT64_STAT_INC(PYINT64_STAT_ERROR);
+        PyErr_Format(PyExc_OverflowError, "int64 %s overflow",
+            PyInt64Kernels_BinaryOpName(op));
+        return NULL;
+    case PYINT64_OVERFLOW_SATURATE:
+        switch (op)
+        {
+        case PYINT64_OP_ADD:
+            return PyInt64_FromInt64Ex(state, pyint64_op_add_sat(a, b));
+        case PYINT64_OP_SUB:
+            return PyInt64_FromInt64Ex(state, pyint64_op_sub_sat(a, b));
+        case PYINT64_OP_MUL:
+            return PyInt64_FromInt64Ex(state, pyint64_op_mul_sat(a, b));
+        case PYINT64_OP_FLOORDIV:
+            return PyInt64_FromInt64Ex(state, pyint64_op_floordiv_sat(a, b));
+        case PYINT64_OP_LSHIFT:
+            return PyInt64_FromInt64Ex(state, pyint64_op_lshift_sat(a, b));
+        default:
+            break;
+        }
+        break;
+    case PYINT64_OVERFLOW_PROMOTE:
+    {
+        PyObject* x = PyLong_FromLongLong(a);
+        PyObject* y = PyLong_FromLongLong(b);
+        PyObject* result = NULL;
+
+        if (x && y)
+        {
+            switch (op)
+            {
+            case PYINT64_OP_ADD:
+                result = PyNumber_Add(x, y);
+                break;
+            case PYINT64_OP_SUB:
+                result = PyNumber_Subtract(x, y);
+                break;
+            case PYINT64_OP_MUL:
+                result = PyNumber_Multiply(x, y);
+                break;
+            case PYINT64_OP_FLOORDIV:
+                result = PyNumber_FloorDivide(x, y);
+                break;
+            case PYINT64_OP_LSHIFT:
+                result = PyNumber_Lshift(x, y);
+                break;
+            default:
+                PyErr_BadInternalCall();
+                break;
+            }
+        }
+
+        Py_XDECREF(x);
+        Py_XDECREF(y);
+        return result;
+    }
+    default:
+        break;
+    }
+
+    return PyInt64_FromInt64Ex(state, wrapped);
+}
+
+static PyObject*
+pyint64_unary_overflow(PyInt64State *state, PyInt64UnaryOp op, int64_t a, int64_t wrapped)
+{
+    PYINT64_STAT_INC(PYINT64_STAT_OVERFLOW);
+
+    switch (PYINT64_SETTING_LOAD(PyInt64_OverflowPolicy))
+    {
+    case PYINT64_OVERFLOW_CHECKED:
+        PYINT64_STAT_INC(PYINT64_STAT_ERROR);
+        PyErr_Format(PyExc_OverflowError, "int64 %s overflow",
+            PyInt64Kernels_UnaryOpName(op));
+        return NULL;
+    case PYINT64_OVERFLOW_SATURATE:
+        return PyInt64_FromInt64Ex(state, INT64_MAX);
+    case PYINT64_OVERFLOW_PROMOTE:
+    {
+        PyObject* x = PyLong_FromLongLong(a);
+        if (!x)
+        {
+            return NULL;
+        }
+
+        PyObject* result = op == PYINT64_OP_ABS ? PyNumber_Absolute(x) : PyNumber_Negative(x);
+        Py_DECREF(x);
+        return result;
+    }
+    default:
+        return PyInt64_FromInt64Ex(state, wrapped);
+    }
+}
+
+#define RETURN_CHECKED_BINARY(state, op, name, a, b)                   \
+    do {                                                               \
+        int64_t result_;                                               \
+        if (pyint64_op_##name##_overflow(a, b, &result_))              \
+            return pyint64_binary_overflow(state, op, a, b, result_);  \
+        return PyInt64_FromInt64Ex(state, result_);                    \
+    } while (0)
+
+#define RETURN_CHECKED_UNARY(state, op, name, a)                       \
+    do {                                                               \
+        int64_t result_;                                               \
+        if (pyint64_op_##name##_overflow(a, &result_))                 \
+            return pyint64_unary_overflow(state, op, a, result_);      \
+        return PyInt64_FromInt64Ex(state, result_);                    \
+    } while (0)
 
 static PyObject*
 pyint64_add(PyObject *left, PyObject *right)
 {
+    PyInt64State* state = pyint64_slot_state(left, right);
     int64_t a;
     int64_t b;
-    CONVERT_TO_INT64(left, a);
-    CONVERT_TO_INT64(right, b);
-    return PyInt64_FromInt64(a + b);
+    CONVERT_BINOP(left, right, a, b);
+    RETURN_CHECKED_BINARY(state, PYINT64_OP_ADD, add, a, b);
 }
 
 static PyObject*
 pyint64_sub(PyObject *left, PyObject *right)
 {
+    PyInt64State* state = pyint64_slot_state(left, right);
     int64_t a;
     int64_t b;
-    CONVERT_TO_INT64(left, a);
-    CONVERT_TO_INT64(right, b);
-    return PyInt64_FromInt64(a - b);
+    CONVERT_BINOP(left, right, a, b);
+    RETURN_CHECKED_BINARY(state, PYINT64_OP_SUB, sub, a, b);
 }
 
 static PyObject*
 pyint64_mul(PyObject *left, PyObject *right)
 {
+    PyInt64State* state = pyint64_slot_state(left, right);
     int64_t a;
     int64_t b;
-    CONVERT_TO_INT64(left, a);
-    CONVERT_TO_INT64(right, b);
-    return PyInt64_FromInt64(a * b);
-}
-
-static PyObject*
-pyint64_div(PyObject *left, PyObject *right)
-{
-    int64_t a;
-    int64_t b;
-    CONVERT_TO_INT64(left, a);
-    CONVERT_TO_INT64(right, b);
-
-    if (b == 0) 
-    {
-        PyErr_SetString(PyExc_ZeroDivisionError, "int64 division by zero");
-        return NULL;
-    }
-
-    return PyInt64_FromInt64(a / b);
+    CONVERT_BINOP(left, right, a, b);
+    RETURN_CHECKED_BINARY(state, PYINT64_OP_MUL, mul, a, b);
 }
 
 static PyObject*
 pyint64_remainder(PyObject *left, PyObject *right)
 {
+    PyInt64State* state = pyint64_slot_state(left, right);
     int64_t a;
     int64_t b;
-    CONVERT_TO_INT64(left, a);
-    CONVERT_TO_INT64(right, b);
+    CONVERT_BINOP(left, right, a, b);
 
     if (b == 0) 
     {
+        PYINT64_STAT_INC(PYINT64_STAT_ERROR);
         PyErr_SetString(PyExc_ZeroDivisionError, "int64 division by zero");
         return NULL;
     }
 
-    return PyInt64_FromInt64(a % b);
+    return PyInt64_FromInt64Ex(state, pyint64_op_mod(a, b));
 }
 
 static PyObject*
 pyint64_divmod(PyObject *left, PyObject *right)
 {
+    PyInt64State* state = pyint64_slot_state(left, right);
     int64_t a;
     int64_t b;
-    CONVERT_TO_INT64(left, a);
-    CONVERT_TO_INT64(right, b);
+    CONVERT_BINOP(left, right, a, b);
 
     if (b == 0) 
     {
+        PYINT64_STAT_INC(PYINT64_STAT_ERROR);
         PyErr_SetString(PyExc_ZeroDivisionError, "int64 division by zero");
         return NULL;
     }
 
-    PyObject* div = PyInt64_FromInt64(a / b);
-    PyObject* mod = PyInt64_FromInt64(a % b);
+    int64_t quotient;
+    PyObject* div = pyint64_op_floordiv_overflow(a, b, &quotient)
+        ? pyint64_binary_overflow(state, PYINT64_OP_FLOORDIV, a, b, quotient)
+        : PyInt64_FromInt64Ex(state, quotient);
+    PyObject* mod = div ? PyInt64_FromInt64Ex(state, pyint64_op_mod(a, b)) : NULL;
     PyObject* ret = PyTuple_New(2);
 
-    if (!ret) 
+    if (!div || !mod || !ret) 
     {
-        Py_DECREF(div);
-        Py_DECREF(mod);
+        Py_XDECREF(div);
+        Py_XDECREF(mod);
+        Py_XDECREF(ret);
         return NULL;
     }
 
@@ -548,132 +1403,88 @@ pyint64_divmod(PyObject *left, PyObject *right)
     return ret;
 }
 
-static int64_t
-pyint64_pow_impl(const int64_t src, const int64_t n)
-{
-    if (n == 0)
-    {
-        return 1;
-    }
-
-    if (n == 1)
-    {
-        return src;
-    }
-
-    if (n & 1)
-    {
-        const int64_t temp = pyint64_pow_impl(src, (n - 1) / 2);
-        return temp * temp * src;
-    }
-
-    const int64_t temp = pyint64_pow_impl(src, n / 2);
-    return temp * temp;
-}
-
+// Python int power for results int64 cannot hold, a float for b < 0.
 static PyObject*
-pyint64_power_pylong(PyObject *v, PyObject *w, PyObject *x)
+pyint64_power_pylong(int64_t a, int64_t b)
 {
-    PyObject* a;
-    PyObject* b;
-    PyObject* c;
-
-    if (PyLong_Check(v))
-    {
-
-    }
-    else
-    {
-        
-    }
-
-    if (PyLong_Check(w))
-    {
-
-    }
-    else
-    {
-        
-    }
-
-    if (PyLong_Check(x))
-    {
-
-    }
-    else
-    {
-        
-    }
-
+    PyObject* x = PyLong_FromLongLong(a);
+    PyObject* y = PyLong_FromLongLong(b);
+    PyObject* result = x && y ? PyNumber_Power(x, y, Py_None) : NULL;
 
-
-    Py_XDECREF(a);
-    Py_XDECREF(b);
-    Py_XDECREF(c);
-    return PyErr_NoMemory();
+    Py_XDECREF(x);
+    Py_XDECREF(y);
+    return result;
 }
 
 static PyObject*
 pyint64_power(PyObject *v, PyObject *w, PyObject *x)
 {
+    PyInt64State* state = pyint64_slot_state(v, w);
     int64_t a;
     int64_t b;
-    int64_t c;
+    CONVERT_BINOP(v, w, a, b);
 
-    const bool has_x = Py_IsNone(x);
-
-    if (PyLong_Check(v))
+    if (!Py_IsNone(x))
     {
-        a = PyLong_AsLongLong(v);
-        if (a == -1 && PyErr_Occurred())
+        int64_t c;
+        CONVERT_TO_INT64(x, c);
+
+        if (c == 0)
         {
+            PYINT64_STAT_INC(PYINT64_STAT_ERROR);
+            PyErr_SetString(PyExc_ValueError, "pow() 3rd argument cannot be 0");
             return NULL;
         }
-    }
-    else
-    {
-        CONVERT_TO_INT64(v, a);
-    }
 
-    if (PyLong_Check(w))
-    {
-        b = PyLong_AsLongLong(w);
-        if (b == -1 && PyErr_Occurred())
+        PyInt64Modulus modulus;
+        pyint64_modulus_init(&modulus, c);
+
+        int64_t result;
+        if (!pyint64_modulus_pow(a, b, &modulus, &result))
         {
+            PYINT64_STAT_INC(PYINT64_STAT_ERROR);
+            PyErr_SetString(PyExc_ValueError, "base is not invertible for the given modulus");
             return NULL;
         }
-    }
-    else
-    {
-        CONVERT_TO_INT64(w, b);
+
+        return PyInt64_FromInt64Ex(state, result);
     }
 
-    if (!has_x)
+    if (b < 0)
     {
-        return PyInt64_FromInt64(pyint64_pow_impl(a, b));
+        return pyint64_power_pylong(a, b);
     }
-    else
+
+    int64_t result;
+    if (pyint64_op_pow_overflow(a, b, &result))
     {
-        if (PyLong_Check(v))
+        PYINT64_STAT_INC(PYINT64_STAT_OVERFLOW);
+
+        switch (PYINT64_SETTING_LOAD(PyInt64_OverflowPolicy))
         {
-            c = PyLong_AsLongLong(v);
-            if (c == -1 && PyErr_Occurred())
-            {
-                return NULL;
-            }
+        case PYINT64_OVERFLOW_CHECKED:
+            PYINT64_STAT_INC(PYINT64_STAT_ERROR);
+            PyErr_SetString(PyExc_OverflowError, "int64 power overflow");
+            return NULL;
+        case PYINT64_OVERFLOW_SATURATE:
+            return PyInt64_FromInt64Ex(state, pyint64_op_pow_sat(a, b));
+        case PYINT64_OVERFLOW_PROMOTE:
+            return pyint64_power_pylong(a, b);
+        default:
+            break;
         }
-
-        return PyInt64_FromInt64(pyint64_pow_impl(a, b) % c);
     }
 
+    return PyInt64_FromInt64Ex(state, result);
 }
 
 static PyObject*
 pyint64_negative(PyObject *v)
 {
+    PyInt64State* state = pyint64_slot_state(v, NULL);
     int64_t a;
     CONVERT_TO_INT64(v, a);
-    return PyInt64_FromInt64(-a);
+    RETURN_CHECKED_UNARY(state, PYINT64_OP_NEG, neg, a);
 }
 
 static PyObject*
@@ -685,101 +1496,94 @@ pyint64_positive(PyObject *v)
 static PyObject*
 pyint64_absolute(PyObject *v)
 {
+    PyInt64State* state = pyint64_slot_state(v, NULL);
     int64_t a;
     CONVERT_TO_INT64(v, a);
-    return PyInt64_FromInt64(a >= 0 ? a : -a);
+    RETURN_CHECKED_UNARY(state, PYINT64_OP_ABS, abs, a);
 }
 
 static int
 pyint64_bool(PyObject *v)
 {
-    int64_t a;
     return ((PyInt64Object*)v)->ob_int64val != 0;
 }
 
 static PyObject*
 pyint64_invert(PyObject *v)
 {
+    PyInt64State* state = pyint64_slot_state(v, NULL);
     int64_t a;
     CONVERT_TO_INT64(v, a)
-    return PyInt64_FromInt64(~a);
+    return PyInt64_FromInt64Ex(state, ~a);
 }
 
 static PyObject*
 pyint64_lshift(PyObject *left, PyObject *right)
 {
+    PyInt64State* state = pyint64_slot_state(left, right);
     int64_t a;
     int64_t b;
-    CONVERT_TO_INT64(left, a);
-    CONVERT_TO_INT64(right, b);
+    CONVERT_BINOP(left, right, a, b);
 
     if (b < 0) 
     {
+        PYINT64_STAT_INC(PYINT64_STAT_ERROR);
         PyErr_SetString(PyExc_ValueError, "Negative shift count");
         return NULL;
     }
 
-    if (b == 0) 
-    {
-        return PyInt64_FromInt64(0);
-    }
-
-    return PyInt64_FromInt64(a << b);
+    RETURN_CHECKED_BINARY(state, PYINT64_OP_LSHIFT, lshift, a, b);
 }
 
 static PyObject*
 pyint64_rshift(PyObject *left, PyObject *right)
 {
+    PyInt64State* state = pyint64_slot_state(left, right);
     int64_t a;
     int64_t b;
-    CONVERT_TO_INT64(left, a);
-    CONVERT_TO_INT64(right, b);
+    CONVERT_BINOP(left, right, a, b);
 
     if (b < 0) 
     {
+        PYINT64_STAT_INC(PYINT64_STAT_ERROR);
         PyErr_SetString(PyExc_ValueError, "Negative shift count");
         return NULL;
     }
 
-    if (b == 0) 
-    {
-        return PyInt64_FromInt64(0);
-    }
-
-    return PyInt64_FromInt64(a >> b);
+    return PyInt64_FromInt64Ex(state, pyint64_op_rshift(a, b));
 }
 
 static PyObject*
 pyint64_and(PyObject *left, PyObject *right)
 {
+    PyInt64State* state = pyint64_slot_state(left, right);
     int64_t a;
     int64_t b;
-    CONVERT_TO_INT64(left, a);
-    CONVERT_TO_INT64(right, b);
+    CONVERT_BINOP(left, right, a, b);
 
-    return PyInt64_FromInt64(a & b);
+    return PyInt64_FromInt64Ex(state, a & b);
 }
 
 static PyObject*
 pyint64_xor(PyObject *left, PyObject *right)
 {
+    PyInt64State* state = pyint64_slot_state(left, right);
     int64_t a;
     int64_t b;
-    CONVERT_TO_INT64(left, a);
-    CONVERT_TO_INT64(right, b);
+    CONVERT_BINOP(left, right, a, b);
 
-    return PyInt64_FromInt64(a ^ b);
+    return PyInt64_FromInt64Ex(state, a ^ b);
 }
 
 static PyObject*
 pyint64_or(PyObject *left, PyObject *right)
 {
+    PyInt64State* state = pyint64_slot_state(left, right);
     int64_t a;
     int64_t b;
-    CONVERT_TO_INT64(left, a);
-    CONVERT_TO_INT64(right, b);
+    CONVERT_BINOP(left, right, a, b);
 
-    return PyInt64_FromInt64(a | b);
+    return PyInt64_FromInt64Ex(state, a | b);
 }
 
 static PyObject*
@@ -797,18 +1601,19 @@ pyint64_float(PyObject *v)
 static PyObject*
 pyint64_floor_divide(PyObject *left, PyObject *right)
 {
+    PyInt64State* state = pyint64_slot_state(left, right);
     int64_t a;
     int64_t b;
-    CONVERT_TO_INT64(left, a);
-    CONVERT_TO_INT64(right, b);
+    CONVERT_BINOP(left, right, a, b);
 
     if (b == 0)
     {
+        PYINT64_STAT_INC(PYINT64_STAT_ERROR);
         PyErr_SetString(PyExc_ZeroDivisionError, "Divide by zero.");
         return NULL;
     }
 
-    return PyInt64_FromInt64(a / b);
+    RETURN_CHECKED_BINARY(state, PYINT64_OP_FLOORDIV, floordiv, a, b);
 }
 
 static PyObject*
@@ -867,7 +1672,7 @@ pyint64_true_divide(PyObject *left, PyObject *right)
     CONVERT_TO_INT64(left, b);
     if (PyLong_Check(right))
     {
-        PyObject* b_l = PyLong_FromLongLong(a);
+        PyObject* b_l = PyLong_FromLongLong(b);
         if (!b_l)
        {
             return PyErr_NoMemory();
@@ -906,31 +1711,341 @@ pyint64_true_divide(PyObject *left, PyObject *right)
 
 /* Pyint64 Number Methods End */
 
+/*
+ * Three way comparison of an int64 with a double, exact for every pair
+ * of values (no rounding of a to double).  NaN is handled by the caller.
+ */
+static int
+pyint64_compare_double(int64_t a, double d)
+{
+    if (d >= 9223372036854775808.0)
+    {
+        return -1;
+    }
+
+    if (d < -9223372036854775808.0)
+    {
+        return 1;
+    }
+
+    // |d| < 2**63 here, so truncation is exact and so is d - t.
+    const int64_t t = (int64_t)d;
+    if (a != t)
+    {
+        return a < t ? -1 : 1;
+    }
+
+    const double fraction = d - (double)t;
+    return fraction > 0.0 ? -1 : (fraction < 0.0 ? 1 : 0);
+}
+
 PyObject*
 pyint64_richcompare(PyObject *self, PyObject *other, int op)
 {
-    CHECK_BINOP(self, other);
-
-    int64_t a;
+    // Reflected comparisons arrive with the Pyint64 in self too.
+    const int64_t a = PyInt64_GetValue(self);
     int64_t b;
-    CONVERT_TO_INT64(self, a);
-    CONVERT_TO_INT64(other, b);
-   
-    Py_RETURN_RICHCOMPARE(a, b, op);
+
+    if (PyInt64_CheckExact(other) || PyInt64_Check(other))
+    {
+        b = PyInt64_GetValue(other);
+        Py_RETURN_RICHCOMPARE(a, b, op);
+    }
+
+    if (PyLong_Check(other))
+    {
+        if (PyLong_CheckExact(other) && pyint64_read_compact_long(other, &b))
+        {
+            Py_RETURN_RICHCOMPARE(a, b, op);
+        }
+
+        int overflow;
+        b = PyLong_AsLongLongAndOverflow(other, &overflow);
+        if (b == -1 && PyErr_Occurred())
+        {
+            return NULL;
+        }
+
+        if (overflow)
+        {
+            // other is beyond the int64 range on the side of its sign.
+            Py_RETURN_RICHCOMPARE(0, overflow, op);
+        }
+
+        Py_RETURN_RICHCOMPARE(a, b, op);
+    }
+
+    if (PyFloat_Check(other))
+    {
+        const double d = PyFloat_AS_DOUBLE(other);
+        if (Py_IS_NAN(d))
+        {
+            if (op == Py_NE)
+            {
+                Py_RETURN_TRUE;
+            }
+
+            Py_RETURN_FALSE;
+        }
+
+        const int cmp = pyint64_compare_double(a, d);
+        Py_RETURN_RICHCOMPARE(cmp, 0, op);
+    }
+
+    Py_RETURN_NOTIMPLEMENTED;
 }
 
 static Py_hash_t
 pyint64_hash(PyInt64Object *v)
 {
-    int64_t value = PyInt64_GetValue(v);
-    unsigned char* first = (unsigned char*) &value;
-    uint64_t offsetBit = 14695981039346656037ULL;
+    // Same value as hash(int(v)): |v| mod _PyHASH_MODULUS with the sign of v,
+    // using two Mersenne folds instead of a division.
+    const int64_t value = PyInt64_GetValue(v);
+    const uint64_t modulus = _PyHASH_MODULUS;
+    uint64_t magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+
+    magnitude = (magnitude & modulus) + (magnitude >> _PyHASH_BITS);
+    magnitude = (magnitude & modulus) + (magnitude >> _PyHASH_BITS);
+    if (magnitude >= modulus)
+    {
+        magnitude -= modulus;
+    }
+
+    Py_hash_t hash = value < 0 ? -(Py_hash_t)magnitude : (Py_hash_t)magnitude;
+    return hash == -1 ? -2 : hash;
+}
+
+static PyObject *
+pyint64_reduce(PyInt64Object *self, PyObject *unused)
+{
+    // Pyint64(int): pickle stores the int in at most 9 bytes on protocol 2+.
+    return Py_BuildValue("(O(L))", Py_TYPE(self), (long long)PyInt64_GetValue(self));
+}
+
+static PyObject *
+pyint64_reduce_ex(PyInt64Object *self, PyObject *protocol)
+{
+    /*
+     * Every protocol gets the __reduce__ value.  object.__reduce_ex__ would
+     * look __reduce__ up by name first, which cost more than the pickling
+     * itself; subclasses still take that way, they may override __reduce__.
+     */
+    if (!PyInt64_CheckExact(self))
+    {
+        return PyObject_CallMethod((PyObject*)self, "__reduce__", NULL);
+    }
+
+    return pyint64_reduce(self, NULL);
+}
+
+static PyObject *
+pyint64_bit_length(PyInt64Object *self, PyObject *unused)
+{
+    return PyLong_FromLongLong(pyint64_op_bit_length(PyInt64_GetValue(self)));
+}
+
+static PyObject *
+pyint64_bit_count(PyInt64Object *self, PyObject *unused)
+{
+    return PyLong_FromLongLong(pyint64_op_bit_count(PyInt64_GetValue(self)));
+}
+
+static PyObject *
+pyint64_clz(PyInt64Object *self, PyObject *unused)
+{
+    return PyLong_FromLongLong(pyint64_op_clz(PyInt64_GetValue(self)));
+}
+
+static PyObject *
+pyint64_ctz(PyInt64Object *self, PyObject *unused)
+{
+    return PyLong_FromLongLong(pyint64_op_ctz(PyInt64_GetValue(self)));
+}
+
+static PyObject *
+pyint64_byteswap(PyInt64Object *self, PyObject *unused)
+{
+    PyInt64State* state = PyInt64State_OfType(Py_TYPE(self));
+    return PyInt64_FromInt64Ex(state, pyint64_op_bswap(PyInt64_GetValue(self)));
+}
+
+static PyObject *
+pyint64_rotate(PyInt64Object *self, PyObject *count, int right)
+{
+    PyInt64State* state = PyInt64State_OfType(Py_TYPE(self));
+    const int64_t shift = PyInt64_AsInt64(count);
+    if (shift == -1 && PyErr_Occurred())
+    {
+        return NULL;
+    }
+
+    // Only shift mod 64 matters, so negating INT64_MIN is harmless.
+    return PyInt64_FromInt64Ex(state, pyint64_op_rotl(PyInt64_GetValue(self),
+                                             right ? pyint64_op_neg(shift) : shift));
+}
+
+static PyObject *
+pyint64_rotl(PyInt64Object *self, PyObject *count)
+{
+    return pyint64_rotate(self, count, 0);
+}
+
+static PyObject *
+pyint64_rotr(PyInt64Object *self, PyObject *count)
+{
+    return pyint64_rotate(self, count, 1);
+}
+
+// Parse 'little' or 'big', store 1 for little endian.
+static int
+pyint64_byteorder(PyObject *byteorder, int *little)
+{
+    if (!PyUnicode_Check(byteorder))
+    {
+        PyErr_Format(PyExc_TypeError,
+            "byteorder must be str, not '%.200s'",
+            Py_TYPE(byteorder)->tp_name);
+        return -1;
+    }
+
+    if (PyUnicode_CompareWithASCIIString(byteorder, "little") == 0)
+    {
+        *little = 1;
+    }
+    else if (PyUnicode_CompareWithASCIIString(byteorder, "big") == 0)
+    {
+        *little = 0;
+    }
+    else
+    {
+        PyErr_SetString(PyExc_ValueError, "byteorder must be either 'little' or 'big'");
+        return -1;
+    }
+
+    return 0;
+}
+
+static PyObject *
+pyint64_to_bytes(PyInt64Object *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"length", "byteorder", "signed", NULL};
+    Py_ssize_t length = 1;
+    PyObject* byteorder = NULL;
+    int is_signed = 0;
+    int little = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|nO$p:to_bytes", kwlist,
+                                     &length, &byteorder, &is_signed)
+        || (byteorder && pyint64_byteorder(byteorder, &little) < 0))
+    {
+        return NULL;
+    }
+
+    if (length < 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "length argument must be non-negative");
+        return NULL;
+    }
+
+    const int64_t value = PyInt64_GetValue(self);
+    if (value < 0 && !is_signed)
+    {
+        PyErr_SetString(PyExc_OverflowError, "can't convert negative int to unsigned");
+        return NULL;
+    }
+
+    // Below 8 bytes the dropped bits must all be sign bits. int lets -1
+    // become zero signed bytes too.
+    if (length < 8)
+    {
+        const int bits = (int)length * 8;
+        const int fits = is_signed
+            ? (value >> Py_MAX(bits - 1, 0)) == (value < 0 ? -1 : 0)
+            : ((uint64_t)value >> bits) == 0;
+        if (!fits)
+        {
+            PyErr_SetString(PyExc_OverflowError, "int too big to convert");
+            return NULL;
+        }
+    }
+
+    PyObject* result = PyBytes_FromStringAndSize(NULL, length);
+    if (!result)
+    {
+        return NULL;
+    }
+
+    unsigned char* data = (unsigned char*)PyBytes_AS_STRING(result);
+    for (Py_ssize_t index = 0; index < length; ++index)
+    {
+        const unsigned char byte = index < 8
+            ? (unsigned char)((uint64_t)value >> (index * 8))
+            : (value < 0 ? 0xff : 0);
+        data[little ? index : length - 1 - index] = byte;
+    }
+
+    return result;
+}
+
+static PyObject *
+pyint64_from_bytes(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"bytes", "byteorder", "signed", NULL};
+    PyObject* bytes;
+    PyObject* byteorder = NULL;
+    int is_signed = 0;
+    int little = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O$p:from_bytes", kwlist,
+                                     &bytes, &byteorder, &is_signed)
+        || (byteorder && pyint64_byteorder(byteorder, &little) < 0))
+    {
+        return NULL;
+    }
+
+    Py_buffer view;
+    if (PyObject_GetBuffer(bytes, &view, PyBUF_SIMPLE) < 0)
+    {
+        return NULL;
+    }
+
+    const unsigned char* data = view.buf;
+    const Py_ssize_t length = view.len;
+#define BYTE(index) (data[little ? (index) : length - 1 - (index)])
+
+    // Start from all sign bits and overwrite the low bytes.
+    const int negative = is_signed && length > 0 && (BYTE(length - 1) & 0x80);
+    uint64_t bits = negative ? UINT64_MAX : 0;
+    int fits = 1;
+
+    for (Py_ssize_t index = 0; index < length; ++index)
+    {
+        if (index < 8)
+        {
+            bits &= ~((uint64_t)0xff << (index * 8));
+            bits |= (uint64_t)BYTE(index) << (index * 8);
+        }
+        else if (BYTE(index) != (negative ? 0xff : 0))
+        {
+            fits = 0;
+        }
+    }
+#undef BYTE
+
+    PyBuffer_Release(&view);
+
+    // Bit 63 must agree with the sign of the exact value.
+    if (!fits || ((int64_t)bits < 0) != negative)
+    {
+        PyErr_SetString(PyExc_OverflowError, "int too big to convert to int64");
+        return NULL;
+    }
 
-    for (size_t index = 0; index < sizeof(int64_t); ++index) 
+    PyInt64State* state = PyInt64State_OfType(type);
+    if (state && type == state->int64_type)
     {
-        offsetBit ^= (size_t)(first[index]);
-        offsetBit *= (uint64_t)1099511628211;
+        return PyInt64_FromInt64Ex(state, (int64_t)bits);
     }
 
-    return (Py_hash_t)offsetBit;
+    return PyObject_CallFunction((PyObject*)type, "L", (long long)(int64_t)bits);
 }
\ No newline at end of file
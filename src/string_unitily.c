@@ -1,17 +1,89 @@
+#include <string.h>
+
 #include "string_unitily.h"
 
+#if (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) \
+    || defined(_M_X64) || defined(_M_IX86) || defined(_M_ARM64)
+#define STRING_UNITILY_SWAR 1
+#else
+#define STRING_UNITILY_SWAR 0
+#endif
+
+static const char digitPairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// Write the digits of value backwards, two at a time, ending at buffer.
 static char* 
 toString(uint64_t value, char* buffer)
 {
-    do
+    while (value >= 100)
+    {
+        const unsigned index = (unsigned)(value % 100) * 2;
+        value /= 100;
+        *--buffer = digitPairs[index + 1];
+        *--buffer = digitPairs[index];
+    }
+
+    if (value >= 10)
+    {
+        const unsigned index = (unsigned)value * 2;
+        *--buffer = digitPairs[index + 1];
+        *--buffer = digitPairs[index];
+    }
+    else
     {
-        *--buffer = (char)('0' + value % 10);
-        value /= 10;
-    } while (value != 0);
+        *--buffer = (char)('0' + value);
+    }
     
     return buffer;
 }
 
+int unsignedDigitCount(uint64_t value)
+{
+    int count = 1;
+    for (;;)
+    {
+        if (value < 10)
+        {
+            return count;
+        }
+
+        if (value < 100)
+        {
+            return count + 1;
+        }
+
+        if (value < 1000)
+        {
+            return count + 2;
+        }
+
+        if (value < 10000)
+        {
+            return count + 3;
+        }
+
+        value /= 10000u;
+        count += 4;
+    }
+}
+
+int signedDigitCount(int64_t value)
+{
+    return value < 0 
+        ? 1 + unsignedDigitCount(0 - (uint64_t)value) 
+        : unsignedDigitCount((uint64_t)value);
+}
+
 char* unsignedToString(uint64_t value, char* buffer)
 {
     return toString(value, buffer);
@@ -24,7 +96,7 @@ char* signedToString(int64_t value, char* buffer)
 
     if (value < 0)
     {
-        next = unsignedToString(0 - value, next);
+        next = unsignedToString(0 - (uint64_t)value, next);
         *--next = '-';
     }
     else
@@ -33,4 +105,116 @@ char* signedToString(int64_t value, char* buffer)
     }
 
     return next;
-}
\ No newline at end of file
+}
+
+char* signedToChars(int64_t value, char* first)
+{
+    if (value < 0)
+    {
+        const uint64_t magnitude = 0 - (uint64_t)value;
+        char* last = first + 1 + unsignedDigitCount(magnitude);
+        toString(magnitude, last);
+        *first = '-';
+        return last;
+    }
+
+    char* last = first + unsignedDigitCount((uint64_t)value);
+    toString((uint64_t)value, last);
+    return last;
+}
+
+#if STRING_UNITILY_SWAR
+
+static inline uint64_t
+loadEightChars(const char* first)
+{
+    uint64_t chunk;
+    memcpy(&chunk, first, sizeof(chunk));
+    return chunk;
+}
+
+// True if all eight bytes are in '0'..'9'.
+static inline int
+isEightDigits(uint64_t chunk)
+{
+    return (((chunk & 0xF0F0F0F0F0F0F0F0ULL)
+        | (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4))
+        == 0x3333333333333333ULL);
+}
+
+// Combine eight little endian digit bytes in three multiplies.
+static inline uint32_t
+parseEightDigits(uint64_t chunk)
+{
+    const uint64_t mask = 0x000000FF000000FFULL;
+    const uint64_t mul1 = 100 + (1000000ULL << 32);
+    const uint64_t mul2 = 1 + (10000ULL << 32);
+
+    chunk -= 0x3030303030303030ULL;
+    chunk = (chunk * 10) + (chunk >> 8);
+    chunk = (((chunk & mask) * mul1) + (((chunk >> 16) & mask) * mul2)) >> 32;
+    return (uint32_t)chunk;
+}
+
+#endif
+
+ParseInt64Status parseInt64(const char* first, const char* last, int64_t* value, const char** end)
+{
+    const char* next = first;
+    int negative = 0;
+
+    if (next < last && (*next == '-' || *next == '+'))
+    {
+        negative = *next == '-';
+        ++next;
+    }
+
+    const char* digits = next;
+    uint64_t result = 0;
+
+#if STRING_UNITILY_SWAR
+    // Below 1e11 another eight digits cannot overflow the accumulator,
+    // which covers 8 and 16 digit runs entirely.
+    while (last - next >= 8 && result < 100000000000ULL)
+    {
+        const uint64_t chunk = loadEightChars(next);
+        if (!isEightDigits(chunk))
+        {
+            break;
+        }
+
+        result = result * 100000000ULL + parseEightDigits(chunk);
+        next += 8;
+    }
+#endif
+
+    int overflow = 0;
+    for (; next < last && (unsigned char)(*next - '0') < 10; ++next)
+    {
+        // From 1e18 on one more digit is past any int64.
+        if (result >= 1000000000000000000ULL)
+        {
+            overflow = 1;
+            continue;
+        }
+
+        result = result * 10 + (unsigned)(*next - '0');
+    }
+
+    *end = next;
+
+    if (next == digits)
+    {
+        *end = first;
+        return PARSE_INT64_INVALID;
+    }
+
+    const uint64_t limit = negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+    if (overflow || result > limit)
+    {
+        return PARSE_INT64_OVERFLOW;
+    }
+
+    *value = negative ? (int64_t)(0 - result) : (int64_t)result;
+    return PARSE_INT64_OK;
+}
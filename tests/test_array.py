@@ -0,0 +1,90 @@
+"""
+Int64Array construction from buffers and pickling.
+"""
+import array
+import mmap
+import pickle
+import sys
+import unittest
+
+from pyint64 import Int64Array
+
+VALUES = [0, 1, -1, 2**63 - 1, -2**63, 12345]
+RAW = array.array('q', VALUES).tobytes()
+
+
+class AsArrayTest(unittest.TestCase):
+    def test_int64_formats(self):
+        source = array.array('q', VALUES)
+        view = Int64Array.asarray(source)
+        self.assertEqual(view.tolist(), VALUES)
+        source[0] = 9
+        self.assertEqual(int(view[0]), 9)
+
+    def test_bytes(self):
+        view = Int64Array.asarray(RAW)
+        self.assertEqual(view.tolist(), VALUES)
+        with self.assertRaises(TypeError):
+            view[0] = 1
+
+        data = bytearray(RAW)
+        view = Int64Array.asarray(data)
+        data[:8] = (5).to_bytes(8, sys.byteorder)
+        self.assertEqual(int(view[0]), 5)
+
+        copy = Int64Array.asarray(data, copy=True)
+        data[:8] = bytes(8)
+        self.assertEqual(int(copy[0]), 5)
+
+    def test_mmap(self):
+        with mmap.mmap(-1, len(RAW)) as buffer:
+            buffer.write(RAW)
+            view = Int64Array.asarray(buffer)
+            self.assertEqual(view.tolist(), VALUES)
+            del view
+
+    def test_misaligned_bytes_are_copied(self):
+        data = bytearray(b'x' + RAW)
+        copy = Int64Array.asarray(memoryview(data)[1:])
+        self.assertEqual(copy.tolist(), VALUES)
+        data[1:9] = bytes(8)
+        self.assertEqual(copy.tolist(), VALUES)
+
+    def test_strided_bytes_are_copied(self):
+        data = bytes(b for pair in zip(RAW, bytes(len(RAW))) for b in pair)
+        self.assertEqual(Int64Array.asarray(memoryview(data)[::2]).tolist(), VALUES)
+
+    def test_rejected_buffers(self):
+        with self.assertRaises(ValueError):
+            Int64Array.asarray(RAW[:-1])
+        with self.assertRaises(TypeError):
+            Int64Array.asarray(array.array('i', [1, 2]))
+
+
+class PickleTest(unittest.TestCase):
+    def test_round_trip(self):
+        for protocol in range(pickle.HIGHEST_PROTOCOL + 1):
+            for source in (Int64Array(VALUES), Int64Array(VALUES)[::2], Int64Array()):
+                copy = pickle.loads(pickle.dumps(source, protocol=protocol))
+                self.assertIs(type(copy), Int64Array)
+                self.assertEqual(copy.tolist(), source.tolist())
+
+    def test_loaded_array_is_resizable(self):
+        for protocol in range(pickle.HIGHEST_PROTOCOL + 1):
+            copy = pickle.loads(pickle.dumps(Int64Array(VALUES), protocol=protocol))
+            copy.append(7)
+            copy.extend([8, 9])
+            copy[0] = 5
+            self.assertEqual(copy.tolist(), [5] + VALUES[1:] + [7, 8, 9])
+
+    def test_out_of_band_is_shared(self):
+        array = Int64Array(VALUES)
+        buffers = []
+        data = pickle.dumps(array, protocol=5, buffer_callback=buffers.append)
+        copy = pickle.loads(data, buffers=buffers)
+        copy[0] = 42
+        self.assertEqual(int(array[0]), 42)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,177 @@
+"""
+zigzag, delta, varint and bit-packing codecs: round trips on every
+instruction set the CPU supports, against Python references, out= buffers
+and corrupt input.
+"""
+import array
+import random
+import unittest
+
+import pyint64
+from pyint64 import Int64Array
+
+INT64_MIN = -2**63
+INT64_MAX = 2**63 - 1
+
+ISAS = ('scalar', 'sse4.2', 'avx2', 'avx512')
+
+
+def wrap(value):
+    return (value - INT64_MIN) % 2**64 + INT64_MIN
+
+
+def zigzag(value):
+    return wrap((value << 1) ^ (value >> 63))
+
+
+def delta(values):
+    return [wrap(value - previous) for previous, value in zip([0] + values, values)]
+
+
+def varint(value):
+    value %= 2**64
+    out = bytearray()
+    while value >= 0x80:
+        out.append(value & 0x7f | 0x80)
+        value >>= 7
+    out.append(value)
+    return bytes(out)
+
+
+class CodecTestCase(unittest.TestCase):
+    def setUp(self):
+        self.random = random.Random(4242)
+        self.saved_isa = pyint64.simd_isa()[0]
+
+    def tearDown(self):
+        pyint64.set_simd_isa(self.saved_isa)
+
+    def isas(self):
+        for isa in ISAS:
+            try:
+                pyint64.set_simd_isa(isa)
+            except ValueError:
+                continue
+            yield isa
+
+    def inputs(self):
+        rng = self.random
+        yield []
+        yield [0]
+        yield [INT64_MIN, INT64_MAX, -1, 0, 1, INT64_MIN, INT64_MAX]
+        yield [rng.randint(INT64_MIN, INT64_MAX) for _ in range(1000)]
+        # Lengths either side of a bit-packed block.
+        for n in (127, 128, 129, 777):
+            yield [rng.randint(-100, 100) for _ in range(n)]
+        # Sorted ids and timestamps, what delta and bit-packing are for.
+        start = rng.randint(0, 2**40)
+        yield sorted(start + rng.randint(0, 10**6) for _ in range(1000))
+        yield [start + 1000 * i + rng.randint(-3, 3) for i in range(1000)]
+        for bits in (0, 1, 7, 8, 31, 32, 33, 63, 64):
+            low = rng.randint(INT64_MIN, INT64_MAX - 2**bits + 1) if bits < 64 else INT64_MIN
+            yield [low + rng.randint(0, 2**bits - 1) for _ in range(300)]
+
+
+class TransformTest(CodecTestCase):
+    def test_zigzag(self):
+        for isa in self.isas():
+            for values in self.inputs():
+                with self.subTest(isa=isa, n=len(values)):
+                    encoded = pyint64.zigzag_encode(Int64Array(values))
+                    self.assertEqual(encoded.tolist(), [zigzag(value) for value in values])
+                    self.assertEqual(pyint64.zigzag_decode(encoded).tolist(), values)
+
+    def test_delta(self):
+        for isa in self.isas():
+            for values in self.inputs():
+                with self.subTest(isa=isa, n=len(values)):
+                    encoded = pyint64.delta_encode(values)
+                    self.assertEqual(encoded.tolist(), delta(values))
+                    self.assertEqual(pyint64.delta_decode(encoded).tolist(), values)
+                    twice = pyint64.delta_encode(values, order=2)
+                    self.assertEqual(twice.tolist(), delta(delta(values)))
+                    self.assertEqual(pyint64.delta_decode(twice, order=2).tolist(), values)
+
+    def test_in_place(self):
+        values = [self.random.randint(INT64_MIN, INT64_MAX) for _ in range(100)]
+        buffer = array.array('q', values)
+        self.assertIs(pyint64.delta_encode(buffer, order=2, out=buffer), buffer)
+        self.assertIs(pyint64.zigzag_encode(buffer, out=buffer), buffer)
+        pyint64.zigzag_decode(buffer, out=buffer)
+        pyint64.delta_decode(buffer, order=2, out=buffer)
+        self.assertEqual(buffer.tolist(), values)
+
+    def test_invalid(self):
+        with self.assertRaises(ValueError):
+            pyint64.delta_encode([1, 2], order=3)
+        with self.assertRaises(ValueError):
+            pyint64.zigzag_encode([1, 2], out=array.array('q', [0]))
+        with self.assertRaises((BufferError, TypeError)):
+            pyint64.zigzag_encode([1, 2], out=bytes(16))
+
+
+class VarintTest(CodecTestCase):
+    def test_round_trip(self):
+        for values in self.inputs():
+            with self.subTest(n=len(values)):
+                data = pyint64.varint_encode(values)
+                self.assertEqual(data, b''.join(map(varint, values)))
+                self.assertEqual(pyint64.varint_decode(data).tolist(), values)
+
+                data = pyint64.varint_encode(values, zigzag=True)
+                self.assertEqual(data, b''.join(varint(zigzag(value)) for value in values))
+                self.assertEqual(pyint64.varint_decode(data, zigzag=True).tolist(), values)
+
+    def test_out(self):
+        values = [3, -7, 2**40, INT64_MIN]
+        data = pyint64.varint_encode(values)
+        out = array.array('q', [99] * 6)
+        self.assertEqual(pyint64.varint_decode(data, out=out), len(values))
+        self.assertEqual(out.tolist(), values + [99, 99])
+        with self.assertRaises(ValueError):
+            pyint64.varint_decode(data, out=array.array('q', [0] * 3))
+
+    def test_corrupt(self):
+        truncated = (b'\x80', b'\x01\x80', b'\xff' * 11, pyint64.varint_encode([-1])[:-1])
+        for data in truncated:
+            with self.subTest(data=data):
+                with self.assertRaisesRegex(ValueError, 'truncated'):
+                    pyint64.varint_decode(data)
+
+        for data in (b'\xff' * 9 + b'\x02', b'\xff' * 10 + b'\x01', b'\x05' + b'\x80' * 10 + b'\x00'):
+            with self.subTest(data=data):
+                with self.assertRaisesRegex(ValueError, '64 bits'):
+                    pyint64.varint_decode(data)
+
+
+class BitpackTest(CodecTestCase):
+    def test_round_trip(self):
+        for isa in self.isas():
+            for values in self.inputs():
+                with self.subTest(isa=isa, n=len(values)):
+                    data = pyint64.bitpack_encode(values)
+                    self.assertEqual(pyint64.bitpack_decode(data).tolist(), values)
+
+    def test_narrow_blocks_are_small(self):
+        values = list(range(10 * pyint64.BITPACK_BLOCK))
+        self.assertLess(len(pyint64.bitpack_encode(values)), len(values))
+
+    def test_out(self):
+        values = list(range(-300, 300, 3))
+        data = pyint64.bitpack_encode(values)
+        out = array.array('q', bytes(8 * (len(values) + 1)))
+        self.assertEqual(pyint64.bitpack_decode(data, out=out), len(values))
+        self.assertEqual(out.tolist()[:-1], values)
+        with self.assertRaises(ValueError):
+            pyint64.bitpack_decode(data, out=array.array('q', [0]))
+
+    def test_corrupt(self):
+        data = pyint64.bitpack_encode([self.random.randint(0, 2**20) for _ in range(300)])
+        for bad in (b'', data[:5], data[:-1], data + b'\0', bytes(len(data))):
+            with self.subTest(size=len(bad)):
+                with self.assertRaises(ValueError):
+                    pyint64.bitpack_decode(bad)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,155 @@
+"""
+Column files: round trips through ColumnWriter and Column, appends to an
+existing file, files in the other byte order, and truncated or corrupt files.
+"""
+import array
+import os
+import struct
+import sys
+import tempfile
+import unittest
+
+import pyint64
+from pyint64 import Column, ColumnWriter, Int64Array
+
+INT64_MIN = -2**63
+INT64_MAX = 2**63 - 1
+
+HEADER_SIZE = 64
+VALUES = list(range(-20, 20)) + [INT64_MIN, INT64_MAX, 12345]
+
+
+class ColumnTestCase(unittest.TestCase):
+    def setUp(self):
+        directory = tempfile.TemporaryDirectory()
+        self.addCleanup(directory.cleanup)
+        self.path = os.path.join(directory.name, 'values.col')
+
+    def write(self, *chunks, **options):
+        with ColumnWriter(self.path, **options) as writer:
+            for chunk in chunks:
+                writer.append(chunk)
+        with open(self.path, 'rb') as file:
+            return file.read()
+
+    def open_bytes(self, data):
+        path = self.path + '.bad'
+        with open(path, 'wb') as file:
+            file.write(data)
+        return Column(path)
+
+
+class RoundTripTest(ColumnTestCase):
+    def test_round_trip(self):
+        self.write(VALUES[:10], Int64Array(VALUES[10:30]), array.array('q', VALUES[30:]),
+                   block_size=8)
+        with Column(self.path) as column:
+            self.assertEqual(len(column), len(VALUES))
+            self.assertEqual([int(value) for value in column], VALUES)
+            self.assertEqual(int(column[-1]), VALUES[-1])
+            self.assertEqual(int(column.min), INT64_MIN)
+            self.assertEqual(int(column.max), INT64_MAX)
+            self.assertEqual(column.block_size, 8)
+            self.assertTrue(column.checksums)
+            self.assertFalse(column.writable)
+            self.assertEqual(column.byteorder, sys.byteorder)
+            self.assertIsNone(column.verify())
+            self.assertEqual(int(pyint64.sum(column)), sum(VALUES))
+            self.assertEqual(Int64Array.asarray(column).tolist(), VALUES)
+            with self.assertRaises(IndexError):
+                column[len(VALUES)]
+        self.assertTrue(column.closed)
+        with self.assertRaises(ValueError):
+            column[0]
+
+    def test_empty(self):
+        self.write()
+        with Column(self.path) as column:
+            self.assertEqual(len(column), 0)
+            self.assertIsNone(column.verify())
+
+    def test_append_to_existing(self):
+        self.write(VALUES[:5], block_size=4)
+        with ColumnWriter(self.path) as writer:
+            self.assertEqual(writer.count, 5)
+            self.assertEqual(writer.block_size, 4)
+            writer.append(VALUES[5:])
+        with Column(self.path) as column:
+            self.assertEqual([int(value) for value in column], VALUES)
+            self.assertIsNone(column.verify())
+
+    def test_flush_leaves_a_valid_file(self):
+        with ColumnWriter(self.path, block_size=4) as writer:
+            writer.append(VALUES[:6])
+            writer.flush()
+            with Column(self.path) as column:
+                self.assertEqual([int(value) for value in column], VALUES[:6])
+                self.assertIsNone(column.verify())
+            writer.append(VALUES[6:])
+        with Column(self.path) as column:
+            self.assertEqual(len(column), len(VALUES))
+
+    def test_sort_in_place(self):
+        self.write(VALUES[::-1])
+        with self.assertRaises(BufferError):
+            with Column(self.path) as column:
+                pyint64.sort(column)
+        with Column(self.path, writable=True) as column:
+            pyint64.sort(column)
+        with Column(self.path) as column:
+            self.assertEqual([int(value) for value in column], sorted(VALUES))
+            self.assertIsNone(column.verify())
+
+    def test_other_byte_order(self):
+        order = '>' if sys.byteorder == 'little' else '<'
+        header = struct.pack('<8sBcBB4xQqqQ16x', b'PI64COL\0', 1, order.encode(), 8, 0,
+                             len(VALUES), 0, 0, 65536)
+        payload = struct.pack(order + '%dq' % len(VALUES), *VALUES)
+        with self.open_bytes(header + payload) as column:
+            self.assertEqual(column.byteorder, 'big' if order == '>' else 'little')
+            self.assertEqual([int(value) for value in column], VALUES)
+            self.assertEqual(Int64Array.asarray(column).tolist(), VALUES)
+            self.assertEqual(int(pyint64.sum(column)), sum(VALUES))
+
+
+class CorruptFileTest(ColumnTestCase):
+    def setUp(self):
+        super().setUp()
+        self.data = self.write(VALUES, block_size=8)
+
+    def assertRejected(self, data, message):
+        with self.assertRaisesRegex(ValueError, message):
+            with self.open_bytes(data) as column:
+                column.verify()
+
+    def test_truncated(self):
+        self.assertRejected(self.data[:-8], 'truncated')
+        self.assertRejected(self.data[:HEADER_SIZE + 8], 'truncated')
+        self.assertRejected(self.data[:HEADER_SIZE // 2], 'not a pyint64 column')
+        self.assertRejected(b'', 'not a pyint64 column')
+
+    def test_bad_header(self):
+        self.assertRejected(b'NOTACOL\0' + self.data[8:], 'not a pyint64 column')
+        data = bytearray(self.data)
+        data[8] = 99
+        self.assertRejected(bytes(data), 'version')
+
+    def test_corrupt_payload(self):
+        for offset in (HEADER_SIZE, HEADER_SIZE + 8 * len(VALUES) - 1):
+            data = bytearray(self.data)
+            data[offset] ^= 0x10
+            self.assertRejected(bytes(data), 'checksum')
+
+    def test_corrupt_checksum(self):
+        data = bytearray(self.data)
+        data[-1] ^= 0x01
+        self.assertRejected(bytes(data), 'checksum')
+
+    def test_corrupt_min_max(self):
+        data = bytearray(self.data)
+        data[24] ^= 0x01
+        self.assertRejected(bytes(data), 'header records')
+
+
+if __name__ == '__main__':
+    unittest.main()
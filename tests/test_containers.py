@@ -0,0 +1,166 @@
+"""
+Int64Dict, Int64Counter and Int64Set against the dict and set protocols.
+"""
+import unittest
+
+from pyint64 import Int64Counter, Int64Dict, Int64Set, Pyint64
+
+FOREIGN = ('x', None, 1.5, float('nan'), 2**70, -2**70, (1,), b'1')
+
+
+class LookupTest(unittest.TestCase):
+    def test_foreign_keys_are_absent(self):
+        s = Int64Set([1, 2])
+        d = Int64Dict({1: 'a'})
+        c = Int64Counter([1, 1])
+        for key in FOREIGN:
+            self.assertNotIn(key, s)
+            self.assertNotIn(key, d)
+            self.assertNotIn(key, c)
+            self.assertIsNone(d.get(key))
+            self.assertEqual(d.get(key, 5), 5)
+            self.assertEqual(c[key], 0)
+            with self.assertRaises(KeyError):
+                d[key]
+            with self.assertRaises(KeyError):
+                del d[key]
+            with self.assertRaises(KeyError):
+                s.remove(key)
+            s.discard(key)
+
+        self.assertEqual(sorted(s), [1, 2])
+        self.assertEqual(len(d), 1)
+
+    def test_equal_keys(self):
+        s = Int64Set([1, 2])
+        d = Int64Dict({1: 'a'})
+        for key in (1, 1.0, True, Pyint64(1)):
+            self.assertIn(key, s)
+            self.assertIn(key, d)
+            self.assertEqual(d[key], 'a')
+
+    def test_unhashable_keys_raise(self):
+        for container in (Int64Set([1]), Int64Dict({1: 'a'}), Int64Counter([1])):
+            with self.assertRaises(TypeError):
+                [] in container
+
+        with self.assertRaises(TypeError):
+            Int64Dict()[[]]
+
+
+class SetAlgebraTest(unittest.TestCase):
+    A = {-2**63, -1, 0, 1, 5, 2**63 - 1}
+    B = {0, 1, 2, 3, 2**62}
+
+    def check(self, result, expected):
+        self.assertIs(type(result), Int64Set)
+        self.assertEqual(sorted(result), sorted(expected))
+
+    def test_operators(self):
+        ops = (
+            lambda x, y: x | y, lambda x, y: x & y,
+            lambda x, y: x - y, lambda x, y: x ^ y,
+        )
+        for op in ops:
+            expected = op(self.A, self.B)
+            self.check(op(Int64Set(self.A), Int64Set(self.B)), expected)
+            self.check(op(Int64Set(self.A), self.B), expected)
+            self.check(op(self.A, Int64Set(self.B)), expected)
+            self.check(op(Int64Set(self.A), frozenset(self.B)), expected)
+            self.check(op(Int64Set(), Int64Set(self.B)), op(set(), self.B))
+
+    def test_inplace(self):
+        ops = (
+            lambda x, y: x.__ior__(y), lambda x, y: x.__iand__(y),
+            lambda x, y: x.__isub__(y), lambda x, y: x.__ixor__(y),
+        )
+        for op in ops:
+            for other in (Int64Set(self.B), self.B):
+                s = Int64Set(self.A)
+                self.assertIs(op(s, other), s)
+                self.assertEqual(sorted(s), sorted(op(set(self.A), self.B)))
+
+            s = Int64Set(self.A)
+            op(s, s)
+            self.assertEqual(sorted(s), sorted(op(set(self.A), set(self.A))))
+
+    def test_foreign_elements(self):
+        s = Int64Set([1, 2])
+        self.check(s & {1, 'x', 2**70}, {1})
+        self.check(s - {1, 'x'}, {2})
+        s &= {2, None}
+        self.check(s, {2})
+        for op in (lambda: s | {'x'}, lambda: s ^ {'x'}, lambda: {2**70} | s):
+            with self.assertRaises((TypeError, OverflowError)):
+                op()
+
+    def test_other_types(self):
+        s = Int64Set([1])
+        for other in ([1], (1,), {1: 2}, 1):
+            with self.assertRaises(TypeError):
+                s | other
+            with self.assertRaises(TypeError):
+                other - s
+
+
+class ComparisonTest(unittest.TestCase):
+    def test_set_equality(self):
+        s = Int64Set([1, 2, 3])
+        for other in (Int64Set([3, 2, 1]), {1, 2, 3}, frozenset({1, 2, 3})):
+            self.assertTrue(s == other)
+            self.assertTrue(other == s)
+            self.assertFalse(s != other)
+        for other in (Int64Set([1, 2]), {1, 2, 3, 'x'}, {1, 2, 4}, set()):
+            self.assertFalse(s == other)
+            self.assertTrue(s != other)
+        self.assertFalse(s == [1, 2, 3])
+        self.assertEqual(Int64Set(), set())
+
+    def test_set_ordering(self):
+        pairs = [
+            ({1}, {1, 2}), ({1, 2}, {1, 2}), ({1, 2}, {1}),
+            ({1}, {2}), (set(), {1}), ({1}, {1, 'x'}),
+        ]
+        ops = (
+            lambda x, y: x < y, lambda x, y: x <= y,
+            lambda x, y: x > y, lambda x, y: x >= y,
+        )
+        for a, b in pairs:
+            for op in ops:
+                expected = op(a, b)
+                ints = {v for v in a if isinstance(v, int)}
+                if ints == a:
+                    self.assertEqual(op(Int64Set(a), b), expected, (a, b))
+                    self.assertEqual(op(Int64Set(a), frozenset(b)), expected)
+                if {v for v in b if isinstance(v, int)} == b:
+                    self.assertEqual(op(a, Int64Set(b)), expected, (a, b))
+                    if ints == a:
+                        self.assertEqual(op(Int64Set(a), Int64Set(b)), expected)
+
+        with self.assertRaises(TypeError):
+            Int64Set() < [1]
+
+    def test_dict_equality(self):
+        d = Int64Dict({1: 'a', -2**63: [1]})
+        for other in (Int64Dict({-2**63: [1], 1: 'a'}), {1: 'a', -2**63: [1]}):
+            self.assertTrue(d == other)
+            self.assertTrue(other == d)
+            self.assertFalse(d != other)
+        for other in (Int64Dict({1: 'a'}), {1: 'b', -2**63: [1]},
+                      {1: 'a', 2: [1]}, {1: 'a', -2**63: [1], 'x': 0}):
+            self.assertFalse(d == other)
+            self.assertTrue(d != other)
+        self.assertFalse(d == Int64Set([1, -2**63]))
+        with self.assertRaises(TypeError):
+            d < d
+
+    def test_counter_equality(self):
+        c = Int64Counter([1, 1, 2])
+        self.assertEqual(c, Int64Counter([2, 1, 1]))
+        self.assertEqual(c, {1: 2, 2: 1})
+        self.assertNotEqual(c, {1: 2, 2: 2})
+        self.assertNotEqual(c, Int64Counter([1, 2]))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,112 @@
+"""
+Divisor against Python int floor division on every instruction set the CPU
+supports, for Pyint64, int and Int64Array dividends.
+"""
+import pickle
+import random
+import unittest
+
+import pyint64
+from pyint64 import Divisor, Int64Array, Pyint64
+
+INT64_MIN = -2**63
+INT64_MAX = 2**63 - 1
+
+ISAS = ('scalar', 'sse4.2', 'avx2', 'avx512')
+
+DIVISORS = (1, -1, 2, -2, 3, 7, -7, 10, 641, 2**31, 2**32 + 1, 2**62, -2**62,
+            INT64_MAX, INT64_MIN, INT64_MIN + 1)
+
+
+class DivisorTest(unittest.TestCase):
+    def setUp(self):
+        self.random = random.Random(1609)
+        self.saved_isa = pyint64.simd_isa()[0]
+        self.saved_policy = pyint64.get_overflow_policy()
+
+    def tearDown(self):
+        pyint64.set_simd_isa(self.saved_isa)
+        pyint64.set_overflow_policy(self.saved_policy)
+
+    def isas(self):
+        for isa in ISAS:
+            try:
+                pyint64.set_simd_isa(isa)
+            except ValueError:
+                continue
+            yield isa
+
+    def divisors(self):
+        return DIVISORS + tuple(self.random.randint(INT64_MIN, INT64_MAX) or 5
+                                for _ in range(20))
+
+    def dividends(self, divisor):
+        values = [0, 1, -1, INT64_MAX, INT64_MIN + 1, divisor, -divisor,
+                  divisor - 1, divisor + 1]
+        values += [self.random.randint(INT64_MIN + 1, INT64_MAX) for _ in range(300)]
+        values += [self.random.randint(-1000, 1000) for _ in range(100)]
+        # INT64_MIN // -1 overflows, it has a test of its own.
+        if divisor != -1:
+            values.append(INT64_MIN)
+        return [value for value in values if INT64_MIN <= value <= INT64_MAX]
+
+    def test_scalars(self):
+        for d in self.divisors():
+            divisor = Divisor(d)
+            self.assertEqual(int(divisor.divisor), d)
+            for value in self.dividends(d):
+                for x in (value, Pyint64(value)):
+                    with self.subTest(d=d, x=value, type=type(x).__name__):
+                        self.assertEqual(int(x // divisor), value // d)
+                        self.assertEqual(int(x % divisor), value % d)
+                        quotient, remainder = divmod(x, divisor)
+                        self.assertEqual((int(quotient), int(remainder)), divmod(value, d))
+
+    def test_arrays(self):
+        for isa in self.isas():
+            for d in self.divisors():
+                divisor = Divisor(d)
+                values = self.dividends(d)
+                array = Int64Array(values)
+                with self.subTest(isa=isa, d=d):
+                    self.assertEqual((array // divisor).tolist(), [v // d for v in values])
+                    self.assertEqual((array % divisor).tolist(), [v % d for v in values])
+                    self.assertEqual(divisor.floordiv(array).tolist(), [v // d for v in values])
+                    self.assertEqual(divisor.mod(values).tolist(), [v % d for v in values])
+                    quotient, remainder = divisor.divmod(array[::2])
+                    self.assertEqual(quotient.tolist(), [v // d for v in values[::2]])
+                    self.assertEqual(remainder.tolist(), [v % d for v in values[::2]])
+
+    def test_min_by_minus_one(self):
+        divisor = Divisor(-1)
+        for policy, result in (('wrap', INT64_MIN), ('saturate', INT64_MAX)):
+            pyint64.set_overflow_policy(policy)
+            self.assertEqual((Int64Array([INT64_MIN]) // divisor).tolist(), [result])
+            self.assertEqual(int(Pyint64(INT64_MIN) // divisor), result)
+
+        pyint64.set_overflow_policy('checked')
+        with self.assertRaises(OverflowError):
+            Int64Array([INT64_MIN]) // divisor
+        with self.assertRaises(OverflowError):
+            Pyint64(INT64_MIN) // divisor
+
+    def test_invalid(self):
+        with self.assertRaises(ZeroDivisionError):
+            Divisor(0)
+        with self.assertRaises(OverflowError):
+            Divisor(2**63)
+        with self.assertRaises(TypeError):
+            Divisor(7) // 2
+        with self.assertRaises(TypeError):
+            Divisor('7')
+
+    def test_pickle(self):
+        for protocol in range(pickle.HIGHEST_PROTOCOL + 1):
+            copy = pickle.loads(pickle.dumps(Divisor(-641), protocol=protocol))
+            self.assertIs(type(copy), Divisor)
+            self.assertEqual(int(copy.divisor), -641)
+            self.assertEqual(int(1000 // copy), 1000 // -641)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,405 @@
+"""
+Element-wise Int64Array kernels and the scan kernels on every instruction
+set the CPU supports, against Python int arithmetic and the scalar table.
+
+Build the extension and put it on the path first, e.g.
+
+    python setup.py build_ext --inplace
+    python -m unittest discover -s tests
+"""
+import operator
+import random
+import unittest
+
+import pyint64
+from pyint64 import Int64Array
+
+INT64_MIN = -2**63
+INT64_MAX = 2**63 - 1
+
+ISAS = ('scalar', 'sse4.2', 'avx2', 'avx512')
+POLICIES = ('wrap', 'checked', 'saturate', 'promote')
+
+BINARY = {
+    'add': operator.add,
+    'sub': operator.sub,
+    'mul': operator.mul,
+    'floordiv': operator.floordiv,
+    'mod': operator.mod,
+    'and': operator.and_,
+    'or': operator.or_,
+    'xor': operator.xor,
+    'lshift': operator.lshift,
+    'rshift': operator.rshift,
+}
+
+INPLACE = {
+    'add': operator.iadd,
+    'sub': operator.isub,
+    'mul': operator.imul,
+    'floordiv': operator.ifloordiv,
+    'mod': operator.imod,
+    'and': operator.iand,
+    'or': operator.ior,
+    'xor': operator.ixor,
+    'lshift': operator.ilshift,
+    'rshift': operator.irshift,
+}
+
+UNARY = {
+    'neg': operator.neg,
+    'abs': operator.abs,
+    'invert': operator.invert,
+}
+
+# Lengths around every vector width, plus one that takes the thread pool.
+LENGTHS = (0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33, 64, 100)
+POOL_LENGTH = 200003
+
+EDGES = (INT64_MIN, INT64_MIN + 1, -2**32, -2**31, -3, -2, -1, 0, 1, 2, 3,
+         2**31, 2**32, INT64_MAX - 1, INT64_MAX)
+
+
+def wrap(value):
+    return (value - INT64_MIN) % 2**64 + INT64_MIN
+
+
+def clamp(value):
+    return max(INT64_MIN, min(INT64_MAX, value))
+
+
+def expected(values, policy):
+    """Exact results as the policy leaves them, OverflowError if it raises."""
+    if policy == 'wrap':
+        return [wrap(value) for value in values]
+
+    if policy == 'saturate':
+        return [clamp(value) for value in values]
+
+    if any(value != clamp(value) for value in values):
+        return OverflowError
+
+    return list(values)
+
+
+def supported_isas():
+    current = pyint64.simd_isa()[0]
+    isas = []
+    for isa in ISAS:
+        try:
+            pyint64.set_simd_isa(isa)
+        except ValueError:
+            continue
+        isas.append(isa)
+
+    pyint64.set_simd_isa(current)
+    return isas
+
+
+class KernelTestCase(unittest.TestCase):
+    def setUp(self):
+        self.random = random.Random(20240611)
+        self.saved_isa = pyint64.simd_isa()[0]
+        self.saved_policy = pyint64.get_overflow_policy()
+
+    def tearDown(self):
+        pyint64.set_simd_isa(self.saved_isa)
+        pyint64.set_overflow_policy(self.saved_policy)
+
+    def values(self, length, low=INT64_MIN, high=INT64_MAX):
+        kinds = (
+            lambda: self.random.choice(EDGES),
+            lambda: self.random.randint(-1000, 1000),
+            lambda: self.random.randint(-2**31, 2**31),
+            lambda: self.random.randint(INT64_MIN, INT64_MAX),
+        )
+        result = []
+        for _ in range(length):
+            value = self.random.choice(kinds)()
+            result.append(value if low <= value <= high else self.random.randint(low, high))
+        return result
+
+    def divisors(self, length):
+        return [value or 1 for value in self.values(length)]
+
+    def shifts(self, length):
+        return [self.random.choice((0, 1, 31, 32, 62, 63, 64, 65, 100))
+                if self.random.random() < 0.3 else self.random.randint(0, 70)
+                for _ in range(length)]
+
+    def operands(self, name, length):
+        if name in ('floordiv', 'mod'):
+            return self.values(length), self.divisors(length)
+        if name in ('lshift', 'rshift'):
+            return self.values(length), self.shifts(length)
+        return self.values(length), self.values(length)
+
+    def isas(self):
+        for isa in supported_isas():
+            pyint64.set_simd_isa(isa)
+            yield isa
+
+    def run_op(self, function, *args):
+        try:
+            return function(*args).tolist()
+        except OverflowError:
+            return OverflowError
+
+
+class BinaryKernelTest(KernelTestCase):
+    def check(self, name, a, b, policy, isa):
+        function = BINARY[name]
+        pyint64.set_overflow_policy(policy)
+        want = expected([function(x, y) for x, y in zip(a, b)], policy)
+        got = self.run_op(function, Int64Array(a), Int64Array(b))
+        self.assertEqual(got, want, (isa, policy, name, 'array-array', len(a)))
+
+        if a:
+            scalar = b[0]
+            want = expected([function(x, scalar) for x in a], policy)
+            got = self.run_op(function, Int64Array(a), scalar)
+            self.assertEqual(got, want, (isa, policy, name, 'array-scalar', len(a)))
+
+            got = self.run_op(function, Int64Array(a), pyint64.Pyint64(scalar))
+            self.assertEqual(got, want, (isa, policy, name, 'array-Pyint64', len(a)))
+
+        if name not in ('floordiv', 'mod', 'lshift', 'rshift') and b:
+            scalar = a[0]
+            want = expected([function(scalar, y) for y in b], policy)
+            got = self.run_op(function, scalar, Int64Array(b))
+            self.assertEqual(got, want, (isa, policy, name, 'scalar-array', len(b)))
+
+    def test_against_int(self):
+        for isa in self.isas():
+            for policy in POLICIES:
+                for name in BINARY:
+                    for length in LENGTHS:
+                        a, b = self.operands(name, length)
+                        self.check(name, a, b, policy, isa)
+
+    def test_scalar_array_divide(self):
+        for isa in self.isas():
+            for policy in POLICIES:
+                pyint64.set_overflow_policy(policy)
+                for name in ('floordiv', 'mod'):
+                    function = BINARY[name]
+                    b = self.divisors(33)
+                    for scalar in (INT64_MIN, -7, 0, 7, INT64_MAX):
+                        want = expected([function(scalar, y) for y in b], policy)
+                        got = self.run_op(function, scalar, Int64Array(b))
+                        self.assertEqual(got, want, (isa, policy, name, scalar))
+
+    def test_scalar_array_shift(self):
+        for isa in self.isas():
+            for policy in POLICIES:
+                pyint64.set_overflow_policy(policy)
+                for name in ('lshift', 'rshift'):
+                    function = BINARY[name]
+                    b = self.shifts(33)
+                    for scalar in (INT64_MIN, -1, 0, 1, 5, INT64_MAX):
+                        want = expected([function(scalar, y) for y in b], policy)
+                        got = self.run_op(function, scalar, Int64Array(b))
+                        self.assertEqual(got, want, (isa, policy, name, scalar))
+
+    def test_inplace(self):
+        for isa in self.isas():
+            for policy in POLICIES:
+                pyint64.set_overflow_policy(policy)
+                for name, function in INPLACE.items():
+                    a, b = self.operands(name, 33)
+                    want = expected([BINARY[name](x, y) for x, y in zip(a, b)], policy)
+                    array = Int64Array(a)
+                    try:
+                        result = function(array, Int64Array(b))
+                    except OverflowError:
+                        self.assertIs(want, OverflowError, (isa, policy, name))
+                        # Checked results never land half-way.
+                        self.assertEqual(array.tolist(), a, (isa, policy, name))
+                        continue
+
+                    self.assertIs(result, array)
+                    self.assertEqual(array.tolist(), want, (isa, policy, name))
+
+    def test_inplace_overlapping_view(self):
+        for isa in self.isas():
+            for policy in POLICIES:
+                pyint64.set_overflow_policy(policy)
+                for shift in (1, 3, 40):
+                    values = list(range(1, 101))
+                    array = Int64Array(values)
+                    view = array[shift:]
+                    view += array[:-shift]
+                    want = values[:shift] + [x + y for x, y in zip(values[shift:], values)]
+                    self.assertEqual(array.tolist(), want, (isa, policy, shift))
+
+                    array = Int64Array(values)
+                    view = array[:-shift]
+                    view -= array[shift:]
+                    want = [x - y for x, y in zip(values, values[shift:])] + values[-shift:]
+                    self.assertEqual(array.tolist(), want, (isa, policy, shift))
+
+                array = Int64Array(values)
+                array *= array
+                self.assertEqual(array.tolist(), [x * x for x in values], (isa, policy))
+
+    def test_strided(self):
+        for isa in self.isas():
+            for policy in POLICIES:
+                pyint64.set_overflow_policy(policy)
+                for name, function in BINARY.items():
+                    a, b = self.operands(name, 99)
+                    left = Int64Array(a)[::3]
+                    right = Int64Array(b)[1::3]
+                    want = expected([function(x, y) for x, y in zip(a[::3], b[1::3])], policy)
+                    self.assertEqual(self.run_op(function, left, right), want,
+                                     (isa, policy, name))
+
+                    base = Int64Array(a)
+                    view = base[2::2]
+                    right = Int64Array(b[2::2])
+                    want = expected([function(x, y) for x, y in zip(a[2::2], b[2::2])], policy)
+                    try:
+                        INPLACE[name](view, right)
+                    except OverflowError:
+                        self.assertIs(want, OverflowError, (isa, policy, name))
+                        continue
+
+                    self.assertEqual(base.tolist()[2::2], want, (isa, policy, name))
+                    self.assertEqual(base.tolist()[1::2], a[1::2], (isa, policy, name))
+
+    def test_against_scalar_table(self):
+        arrays = {}
+        for name in BINARY:
+            a, b = self.operands(name, POOL_LENGTH)
+            arrays[name] = (Int64Array(a), Int64Array(b))
+
+        for policy in POLICIES:
+            pyint64.set_overflow_policy(policy)
+            pyint64.set_simd_isa('scalar')
+            reference = {name: self.run_op(BINARY[name], *arrays[name]) for name in BINARY}
+            reference_scalar = {name: self.run_op(BINARY[name], arrays[name][0], 3)
+                                for name in BINARY}
+            for isa in self.isas():
+                for name, function in BINARY.items():
+                    self.assertEqual(self.run_op(function, *arrays[name]), reference[name],
+                                     (isa, policy, name))
+                    self.assertEqual(self.run_op(function, arrays[name][0], 3),
+                                     reference_scalar[name], (isa, policy, name))
+
+    def test_zero_division(self):
+        for isa in self.isas():
+            for policy in POLICIES:
+                pyint64.set_overflow_policy(policy)
+                for function in (operator.floordiv, operator.mod):
+                    a = Int64Array(self.values(17))
+                    b = self.divisors(17)
+                    b[11] = 0
+                    with self.assertRaises(ZeroDivisionError, msg=(isa, policy)):
+                        function(a, Int64Array(b))
+                    with self.assertRaises(ZeroDivisionError, msg=(isa, policy)):
+                        function(a, 0)
+                    with self.assertRaises(ZeroDivisionError, msg=(isa, policy)):
+                        function(5, Int64Array(b))
+
+                    array = Int64Array(a)
+                    with self.assertRaises(ZeroDivisionError, msg=(isa, policy)):
+                        INPLACE['floordiv'](array, Int64Array(b))
+                    self.assertEqual(array.tolist(), a.tolist())
+
+    def test_negative_shift(self):
+        for isa in self.isas():
+            for function in (operator.lshift, operator.rshift):
+                b = self.shifts(17)
+                b[5] = -1
+                with self.assertRaises(ValueError, msg=isa):
+                    function(Int64Array(self.values(17)), Int64Array(b))
+                with self.assertRaises(ValueError, msg=isa):
+                    function(Int64Array(self.values(17)), -1)
+
+    def test_length_mismatch(self):
+        for isa in self.isas():
+            with self.assertRaises(ValueError, msg=isa):
+                Int64Array([1, 2, 3]) + Int64Array([1, 2])
+
+
+class UnaryKernelTest(KernelTestCase):
+    def test_against_int(self):
+        for isa in self.isas():
+            for policy in POLICIES:
+                pyint64.set_overflow_policy(policy)
+                for name, function in UNARY.items():
+                    for length in LENGTHS:
+                        a = self.values(length)
+                        want = expected([function(x) for x in a], policy)
+                        self.assertEqual(self.run_op(function, Int64Array(a)), want,
+                                         (isa, policy, name, length))
+
+                    a = self.values(99)
+                    want = expected([function(x) for x in a[1::2]], policy)
+                    self.assertEqual(self.run_op(function, Int64Array(a)[1::2]), want,
+                                     (isa, policy, name, 'strided'))
+
+    def test_against_scalar_table(self):
+        array = Int64Array(self.values(POOL_LENGTH))
+        for policy in POLICIES:
+            pyint64.set_overflow_policy(policy)
+            pyint64.set_simd_isa('scalar')
+            reference = {name: self.run_op(function, array) for name, function in UNARY.items()}
+            for isa in self.isas():
+                for name, function in UNARY.items():
+                    self.assertEqual(self.run_op(function, array), reference[name],
+                                     (isa, policy, name))
+
+
+class ScanKernelTest(KernelTestCase):
+    OPS = {
+        'sum': operator.add,
+        'min': min,
+        'max': max,
+        'xor': operator.xor,
+    }
+
+    IDENTITY = {'sum': 0, 'min': INT64_MAX, 'max': INT64_MIN, 'xor': 0}
+
+    def reference(self, values, op, exclusive, policy):
+        function = self.OPS[op]
+        running = self.IDENTITY[op]
+        result = []
+        for value in values:
+            if exclusive:
+                result.append(running)
+            running = function(running, value)
+            if not exclusive:
+                result.append(running)
+
+        return expected(result, policy) if op == 'sum' else result
+
+    def test_against_int(self):
+        for isa in self.isas():
+            for policy in POLICIES:
+                pyint64.set_overflow_policy(policy)
+                for length in LENGTHS:
+                    for bound in (1000, INT64_MAX // 4, INT64_MAX):
+                        a = self.values(length, -bound, bound)
+                        for op in self.OPS:
+                            for exclusive in (False, True):
+                                want = self.reference(a, op, exclusive, policy)
+                                got = self.run_op(pyint64.scan, a, op, exclusive)
+                                self.assertEqual(got, want, (isa, policy, op, exclusive, length))
+
+    def test_against_scalar_table(self):
+        arrays = [Int64Array(self.values(POOL_LENGTH, -bound, bound))
+                  for bound in (10**6, INT64_MAX // 2**20)]
+        for policy in POLICIES:
+            pyint64.set_overflow_policy(policy)
+            pyint64.set_simd_isa('scalar')
+            reference = [self.run_op(pyint64.scan, array, op, exclusive)
+                         for array in arrays for op in self.OPS for exclusive in (False, True)]
+            for isa in self.isas():
+                got = [self.run_op(pyint64.scan, array, op, exclusive)
+                       for array in arrays for op in self.OPS for exclusive in (False, True)]
+                self.assertEqual(got, reference, (isa, policy))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,152 @@
+"""
+pow() of Pyint64 and Int64Array and pyint64.pow() against Python int, with
+odd (Montgomery), even and negative moduli, modular inverses and the
+overflow policies.
+"""
+import random
+import unittest
+
+import pyint64
+from pyint64 import Int64Array, Pyint64
+
+INT64_MIN = -2**63
+INT64_MAX = 2**63 - 1
+
+MODULI = (1, -1, 2, 3, -3, 7, 10, 2**31 - 1, 2**32, 2**61 - 1, -(2**61 - 1),
+          2**62, INT64_MAX, INT64_MIN, INT64_MIN + 1)
+
+
+def invertible(base, modulus):
+    try:
+        pow(base, -1, modulus)
+    except ValueError:
+        return False
+    return True
+
+
+class PowTestCase(unittest.TestCase):
+    def setUp(self):
+        self.random = random.Random(1729)
+        self.saved_policy = pyint64.get_overflow_policy()
+
+    def tearDown(self):
+        pyint64.set_overflow_policy(self.saved_policy)
+
+    def moduli(self):
+        return MODULI + tuple(self.random.randint(INT64_MIN, INT64_MAX) or 11
+                              for _ in range(20))
+
+    def bases(self):
+        return [0, 1, -1, 2, INT64_MAX, INT64_MIN] + [
+            self.random.randint(INT64_MIN, INT64_MAX) for _ in range(20)]
+
+
+class ScalarPowTest(PowTestCase):
+    def test_modular(self):
+        for m in self.moduli():
+            for base in self.bases():
+                exponent = self.random.choice((0, 1, 2, 63, self.random.randint(0, INT64_MAX)))
+                with self.subTest(base=base, exponent=exponent, m=m):
+                    result = pow(Pyint64(base), Pyint64(exponent), Pyint64(m))
+                    self.assertIs(type(result), Pyint64)
+                    self.assertEqual(int(result), pow(base, exponent, m))
+                    self.assertEqual(int(pow(Pyint64(base), exponent, m)), pow(base, exponent, m))
+
+    def test_inverse(self):
+        for m in self.moduli():
+            for base in self.bases():
+                exponent = -self.random.randint(1, 1000)
+                with self.subTest(base=base, exponent=exponent, m=m):
+                    if invertible(base, m):
+                        self.assertEqual(int(pow(Pyint64(base), exponent, m)),
+                                         pow(base, exponent, m))
+                    else:
+                        with self.assertRaises(ValueError):
+                            pow(Pyint64(base), exponent, m)
+
+    def test_zero_modulus(self):
+        with self.assertRaises(ValueError):
+            pow(Pyint64(3), 5, 0)
+
+    def test_policies(self):
+        cases = [(3, 39), (2, 62), (-2, 63), (2, 63), (-3, 40), (7, 100)]
+        for policy in ('wrap', 'checked', 'saturate', 'promote'):
+            pyint64.set_overflow_policy(policy)
+            for base, exponent in cases:
+                exact = base ** exponent
+                with self.subTest(policy=policy, base=base, exponent=exponent):
+                    if INT64_MIN <= exact <= INT64_MAX:
+                        self.assertEqual(int(pow(Pyint64(base), exponent)), exact)
+                    elif policy == 'wrap':
+                        self.assertEqual(int(pow(Pyint64(base), exponent)),
+                                         (exact - INT64_MIN) % 2**64 + INT64_MIN)
+                    elif policy == 'saturate':
+                        self.assertEqual(int(pow(Pyint64(base), exponent)),
+                                         INT64_MAX if exact > 0 else INT64_MIN)
+                    elif policy == 'promote':
+                        self.assertEqual(pow(Pyint64(base), exponent), exact)
+                    else:
+                        with self.assertRaises(OverflowError):
+                            pow(Pyint64(base), exponent)
+
+    def test_negative_exponent_without_modulus(self):
+        self.assertEqual(pow(Pyint64(2), -1), 0.5)
+        self.assertEqual(pow(Pyint64(-4), -2), 0.0625)
+
+
+class ArrayPowTest(PowTestCase):
+    def setUp(self):
+        super().setUp()
+        self.saved_threshold = pyint64.thread_info()['threshold']
+
+    def tearDown(self):
+        pyint64.configure_threads(threshold=self.saved_threshold)
+        super().tearDown()
+
+    def check(self, bases, exponents, m):
+        if isinstance(exponents, int):
+            exponents = [exponents] * len(bases)
+        expected = [pow(b, e, m) for b, e in zip(bases, exponents)]
+        result = pyint64.pow(Int64Array(bases), Int64Array(exponents), m)
+        self.assertEqual(result.tolist(), expected)
+
+    def test_modular(self):
+        # A threshold of 0 puts even short arrays on the thread pool.
+        for threshold in (self.saved_threshold, 0):
+            pyint64.configure_threads(threshold=threshold)
+            for m in self.moduli():
+                bases = self.bases() * 3
+                exponents = [self.random.randint(0, INT64_MAX) for _ in bases]
+                with self.subTest(m=m, threshold=threshold):
+                    self.check(bases, exponents, m)
+                    # A shared exponent takes the interleaved path.
+                    self.check(bases, self.random.randint(0, INT64_MAX), m)
+                    shared = pyint64.pow(bases[0], Int64Array(exponents), m)
+                    self.assertEqual(shared.tolist(), [pow(bases[0], e, m) for e in exponents])
+
+    def test_inverse(self):
+        m = 2**61 - 1
+        bases = [value for value in self.bases() if value % m]
+        self.check(bases, -1, m)
+        with self.assertRaises(ValueError):
+            pyint64.pow(Int64Array([2, 4]), -1, 4)
+
+    def test_operator(self):
+        base = Int64Array([2, 3, -5])
+        self.assertEqual((base ** 3).tolist(), [8, 27, -125])
+        self.assertEqual(pow(base, Int64Array([0, 1, 2]), 7).tolist(), [1, 3, 4])
+        pyint64.set_overflow_policy('checked')
+        with self.assertRaises(OverflowError):
+            Int64Array([2]) ** 63
+
+    def test_invalid(self):
+        with self.assertRaises(ValueError):
+            pyint64.pow(Int64Array([1, 2]), Int64Array([1]))
+        with self.assertRaises(ValueError):
+            pyint64.pow(Int64Array([1]), 1, 0)
+        with self.assertRaises(TypeError):
+            pyint64.pow(Int64Array([2]), Int64Array([4]), Int64Array([3]))
+
+
+if __name__ == '__main__':
+    unittest.main()
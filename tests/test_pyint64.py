@@ -0,0 +1,113 @@
+"""
+Pyint64 construction, through the vectorcall path of the exact type and
+through tp_new and tp_init of subclasses, pickling, and objects of a module
+that was imported again.
+"""
+import gc
+import importlib
+import pickle
+import sys
+import unittest
+
+import pyint64
+from pyint64 import Pyint64
+
+
+class Sub(Pyint64):
+    pass
+
+
+class ConstructionTest(unittest.TestCase):
+    def test_arguments(self):
+        for cls in (Pyint64, Sub):
+            self.assertEqual(int(cls()), 0)
+            self.assertEqual(int(cls(-5)), -5)
+            self.assertEqual(int(cls(2**63 - 1)), 2**63 - 1)
+            self.assertEqual(int(cls(-7.9)), -7)
+            self.assertEqual(int(cls('123')), 123)
+            self.assertEqual(int(cls(Pyint64(99))), 99)
+            self.assertIs(type(cls(1)), cls)
+            with self.assertRaises(TypeError):
+                cls(1, 2)
+            with self.assertRaises(TypeError):
+                cls([])
+            with self.assertRaises(OverflowError):
+                cls(2**63)
+
+    def test_copy_is_not_shared(self):
+        a = Pyint64(123456789)
+        b = Pyint64(a)
+        b.__init__(0)
+        self.assertEqual(int(a), 123456789)
+        self.assertEqual(int(b), 0)
+
+    def test_cached_values(self):
+        self.assertIs(Pyint64(5), Pyint64(Pyint64(5)))
+        with self.assertRaises(TypeError):
+            Pyint64(5).__init__(6)
+        self.assertEqual(int(Pyint64(5)), 5)
+
+
+class Reduced(Pyint64):
+    def __reduce__(self):
+        return (int, (int(self),))
+
+
+class PickleTest(unittest.TestCase):
+    def test_round_trip(self):
+        for protocol in range(pickle.HIGHEST_PROTOCOL + 1):
+            for value in (0, 5, -1, 2**63 - 1, -2**63):
+                for cls in (Pyint64, Sub):
+                    copy = pickle.loads(pickle.dumps(cls(value), protocol=protocol))
+                    self.assertIs(type(copy), cls)
+                    self.assertEqual(int(copy), value)
+
+    def test_subclass_reduce(self):
+        for protocol in range(pickle.HIGHEST_PROTOCOL + 1):
+            copy = pickle.loads(pickle.dumps(Reduced(7), protocol=protocol))
+            self.assertIs(type(copy), int)
+            self.assertEqual(copy, 7)
+
+
+class ReimportTest(unittest.TestCase):
+    """A second module object has its own types, the old objects keep theirs."""
+
+    def setUp(self):
+        del sys.modules['pyint64']
+        try:
+            self.fresh = importlib.import_module('pyint64')
+        finally:
+            sys.modules['pyint64'] = pyint64
+        self.assertIsNot(self.fresh.Pyint64, Pyint64)
+
+    def tearDown(self):
+        del self.fresh
+        gc.collect()
+
+    def test_values_keep_their_module(self):
+        for cls in (Pyint64, self.fresh.Pyint64):
+            self.assertIs(type(cls(2) + cls(3)), cls)
+            self.assertIs(type(-cls(3)), cls)
+            self.assertIs(type(cls(7) // 2), cls)
+            self.assertIs(type(divmod(cls(7), 2)[0]), cls)
+            self.assertIs(type(cls.from_bytes(bytes(8), 'little')), cls)
+
+    def test_subclasses_keep_their_module(self):
+        fresh_sub = type('FreshSub', (self.fresh.Pyint64,), {})
+        self.assertEqual(int(Sub(2) + Sub(3)), 5)
+        self.assertIs(type(Sub(2) * 3), Pyint64)
+        self.assertEqual(int(fresh_sub(4) - 1), 3)
+        self.assertIs(type(fresh_sub(4) - 1), self.fresh.Pyint64)
+
+    def test_containers_keep_their_module(self):
+        for module in (pyint64, self.fresh):
+            array = module.Int64Array([1, 2, 3])
+            self.assertIs(type(array + 1), module.Int64Array)
+            self.assertIs(type(array[0]), module.Pyint64)
+            self.assertIs(type(array[1:]), module.Int64Array)
+            self.assertIs(type(module.Int64Set([1]).pop()), module.Pyint64)
+            self.assertIs(type(module.argsort(array)), module.Int64Array)
+
+
+if __name__ == '__main__':
+    unittest.main()
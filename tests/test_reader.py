@@ -0,0 +1,134 @@
+"""
+TextReader against parse() and a Python reference: numbers cut by every
+possible chunk boundary, every kind of source, separators and ParseError
+offsets.
+"""
+import io
+import mmap
+import os
+import pathlib
+import random
+import tempfile
+import unittest
+
+import pyint64
+from pyint64 import ParseError, TextReader
+
+INT64_MIN = -2**63
+INT64_MAX = 2**63 - 1
+
+
+def read_all(reader):
+    values = []
+    for batch in reader:
+        values += batch.tolist()
+    return values
+
+
+class ReaderTestCase(unittest.TestCase):
+    def setUp(self):
+        rng = random.Random(77)
+        self.values = [INT64_MIN, INT64_MAX, 0, -1] + [
+            rng.choice((rng.randint(-999, 999), rng.randint(INT64_MIN, INT64_MAX)))
+            for _ in range(300)]
+        self.text = '\n'.join(map(str, self.values)).encode() + b'\n'
+
+        directory = tempfile.TemporaryDirectory()
+        self.addCleanup(directory.cleanup)
+        self.path = os.path.join(directory.name, 'values.txt')
+        with open(self.path, 'wb') as file:
+            file.write(self.text)
+
+
+class ChunkBoundaryTest(ReaderTestCase):
+    def test_every_chunk_size(self):
+        # Chunks up to the longest number cut every number at every position.
+        for chunk_size in list(range(1, 24)) + [64, 4096]:
+            for batch_size in (1, 7, 1000):
+                with self.subTest(chunk_size=chunk_size, batch_size=batch_size):
+                    reader = TextReader(self.path, chunk_size=chunk_size, batch_size=batch_size)
+                    batches = [batch.tolist() for batch in reader]
+                    self.assertEqual(sum(batches, []), self.values)
+                    self.assertTrue(all(len(batch) == batch_size for batch in batches[:-1]))
+                    self.assertEqual(reader.count, len(self.values))
+                    self.assertEqual(reader.offset, len(self.text))
+
+    def test_matches_parse(self):
+        for sep, text in ((None, b'  1\t-2 \n\n3  '), (b',', b'1,-2,3,'), (b';', b'1;-2;3')):
+            with self.subTest(sep=sep):
+                expected = pyint64.parse(text, sep=sep).tolist()
+                self.assertEqual(expected, [1, -2, 3])
+                for chunk_size in range(1, len(text) + 1):
+                    self.assertEqual(read_all(TextReader(text, sep=sep, chunk_size=chunk_size)),
+                                     expected)
+
+    def test_no_trailing_newline(self):
+        self.assertEqual(read_all(TextReader(self.text.rstrip(), chunk_size=5)), self.values)
+
+    def test_empty(self):
+        for text in (b'', b'\n', b'   \n\t'):
+            self.assertEqual(read_all(TextReader(text)), [])
+
+
+class SourceTest(ReaderTestCase):
+    def check(self, source, **options):
+        with TextReader(source, chunk_size=13, batch_size=50, **options) as reader:
+            self.assertEqual(read_all(reader), self.values)
+        self.assertTrue(reader.closed)
+
+    def test_paths(self):
+        self.check(self.path)
+        self.check(pathlib.Path(self.path))
+        self.check(self.path, background=True)
+
+    def test_file_objects(self):
+        self.check(io.BytesIO(self.text))
+        with open(self.path, 'rb') as file:
+            self.check(file)
+            self.assertFalse(file.closed)
+
+    def test_buffers(self):
+        self.check(self.text)
+        self.check(bytearray(self.text))
+        self.check(memoryview(self.text))
+        with open(self.path, 'rb') as file:
+            with mmap.mmap(file.fileno(), 0, access=mmap.ACCESS_READ) as mapping:
+                self.check(mapping)
+
+    def test_invalid_sources(self):
+        with self.assertRaises(TypeError):
+            TextReader(123)
+        with self.assertRaises(OSError):
+            TextReader(self.path + '.missing')
+        with self.assertRaises(ValueError):
+            TextReader(self.text, batch_size=0)
+        with self.assertRaises(ValueError):
+            TextReader(self.text, chunk_size=0)
+
+    def test_close(self):
+        reader = TextReader(self.path, chunk_size=16, batch_size=10)
+        self.assertEqual(len(next(reader)), 10)
+        reader.close()
+        self.assertTrue(reader.closed)
+        with self.assertRaises(ValueError):
+            next(reader)
+
+
+class ParseErrorTest(unittest.TestCase):
+    def check(self, text, offset, sep=None):
+        for chunk_size in range(1, len(text) + 2):
+            with self.subTest(text=text, chunk_size=chunk_size):
+                with self.assertRaises(ParseError) as context:
+                    read_all(TextReader(text, sep=sep, chunk_size=chunk_size))
+                self.assertEqual(context.exception.offset, offset)
+
+    def test_offsets(self):
+        self.check(b'1 2 x3 4', 4)
+        self.check(b'12 34 5-6', 6)
+        self.check(b'1 99999999999999999999 2', 2)
+        self.check(b'1 -9223372036854775809', 2)
+        self.check(b'1,2,,3', 4, sep=b',')
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,51 @@
+"""
+sort() and argsort() against sorted(), on random input and on input made
+of natural runs, which is merged instead of radix sorted.
+"""
+import array
+import random
+import unittest
+
+import pyint64
+from pyint64 import Int64Array
+
+
+def runs(rng, count, length, descending=False):
+    values = []
+    for run in range(count):
+        chunk = sorted(rng.randint(-50, 50) for _ in range(length))
+        if descending and run % 2:
+            chunk = sorted(set(chunk), reverse=True)
+        values += chunk
+    return values
+
+
+class SortTest(unittest.TestCase):
+    def inputs(self):
+        rng = random.Random(5)
+        yield [rng.randint(-2**63, 2**63 - 1) for _ in range(5000)]
+        yield [rng.randint(-3, 3) for _ in range(5000)]
+        yield list(range(1000)) + list(range(1000))
+        yield list(range(1000, 0, -1)) + [7] * 100 + list(range(500))
+        for count in (2, 3, 15, 16, 17, 40):
+            yield runs(rng, count, 300)
+            yield runs(rng, count, 300, descending=True)
+
+    def test_sort(self):
+        for values in self.inputs():
+            arr = Int64Array(values)
+            pyint64.sort(arr)
+            self.assertEqual(arr.tolist(), sorted(values))
+
+            buf = array.array('q', values)
+            pyint64.sort(memoryview(buf)[::-1])
+            self.assertEqual(buf.tolist(), sorted(values, reverse=True))
+
+    def test_argsort_is_stable(self):
+        for values in self.inputs():
+            expected = sorted(range(len(values)), key=values.__getitem__)
+            self.assertEqual(pyint64.argsort(values).tolist(), expected)
+
+
+if __name__ == '__main__':
+    unittest.main()